@@ -51,7 +51,7 @@ static gchar *set_logging_str;
 static GOptionEntry entries[] = {
     { "set-logging", 'G', 0, G_OPTION_ARG_STRING, &set_logging_str,
       "Set logging level in the ModemManager daemon",
-      "[ERR,WARN,INFO,DEBUG]",
+      "[ERR,WARN,INFO,DEBUG][,MODULE=LEVEL...]",
     },
     { "list-modems", 'L', 0, G_OPTION_ARG_NONE, &list_modems_flag,
       "List available modems",
@@ -18,6 +18,9 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <gio/gio.h>
+#if defined (__SSE2__)
+# include <emmintrin.h>
+#endif
 
 #include <ModemManager.h>
 
@@ -1551,11 +1554,7 @@ mm_utils_hex2byte (const gchar *hex)
 gchar *
 mm_utils_hexstr2bin (const gchar *hex, gsize *out_len)
 {
-    const gchar *ipos = hex;
-    gchar *buf = NULL;
-    gsize i;
-    gint a;
-    gchar *opos;
+    gchar *buf;
     gsize len;
 
     len = strlen (hex);
@@ -1563,16 +1562,12 @@ mm_utils_hexstr2bin (const gchar *hex, gsize *out_len)
     /* Length must be a multiple of 2 */
     g_return_val_if_fail ((len % 2) == 0, NULL);
 
-    opos = buf = g_malloc0 ((len / 2) + 1);
-    for (i = 0; i < len; i += 2) {
-        a = mm_utils_hex2byte (ipos);
-        if (a < 0) {
-            g_free (buf);
-            return NULL;
-        }
-        *opos++ = a;
-        ipos += 2;
+    buf = g_malloc ((len / 2) + 1);
+    if (!mm_utils_hexstr2bin_buf (hex, len, (guint8 *) buf)) {
+        g_free (buf);
+        return NULL;
     }
+    buf[len / 2] = '\0';
     *out_len = len / 2;
     return buf;
 }
@@ -1607,15 +1602,142 @@ mm_utils_ishexstr (const gchar *hex)
 gchar *
 mm_utils_bin2hexstr (const guint8 *bin, gsize len)
 {
-    GString *ret;
-    gsize i;
+    gchar *ret;
 
     g_return_val_if_fail (bin != NULL, NULL);
 
-    ret = g_string_sized_new (len * 2 + 1);
-    for (i = 0; i < len; i++)
-        g_string_append_printf (ret, "%.2X", bin[i]);
-    return g_string_free (ret, FALSE);
+    ret = g_malloc (len * 2 + 1);
+    mm_utils_bin2hexstr_buf (bin, len, ret);
+    return ret;
+}
+
+/*****************************************************************************/
+/* Hex codecs on caller-provided buffers */
+
+/* Value of each hex digit with 0x10 set, 0 if not a hex digit */
+static const guint8 hex_digit_values[256] = {
+    ['0'] = 0x10 | 0,  ['1'] = 0x10 | 1,  ['2'] = 0x10 | 2,  ['3'] = 0x10 | 3,
+    ['4'] = 0x10 | 4,  ['5'] = 0x10 | 5,  ['6'] = 0x10 | 6,  ['7'] = 0x10 | 7,
+    ['8'] = 0x10 | 8,  ['9'] = 0x10 | 9,
+    ['a'] = 0x10 | 10, ['b'] = 0x10 | 11, ['c'] = 0x10 | 12, ['d'] = 0x10 | 13,
+    ['e'] = 0x10 | 14, ['f'] = 0x10 | 15,
+    ['A'] = 0x10 | 10, ['B'] = 0x10 | 11, ['C'] = 0x10 | 12, ['D'] = 0x10 | 13,
+    ['E'] = 0x10 | 14, ['F'] = 0x10 | 15,
+};
+
+static const gchar hex_digits[] = "0123456789ABCDEF";
+
+#if defined (__SSE2__)
+
+/* Decode 32 hex digits into 16 bytes; FALSE if any is not a hex digit */
+static inline gboolean
+hex_decode_32_sse2 (const gchar *hex,
+                    guint8 *out)
+{
+    __m128i words[2];
+    guint i;
+
+    for (i = 0; i < 2; i++) {
+        __m128i c, d, l, is_digit, is_letter, v;
+
+        c = _mm_loadu_si128 ((const __m128i *) (hex + 16 * i));
+
+        /* Digits: c - '0' in [0,9] */
+        d = _mm_sub_epi8 (c, _mm_set1_epi8 ('0'));
+        is_digit = _mm_and_si128 (_mm_cmpgt_epi8 (d, _mm_set1_epi8 (-1)),
+                                  _mm_cmplt_epi8 (d, _mm_set1_epi8 (10)));
+        /* Letters, either case: (c | 0x20) - 'a' in [0,5] */
+        l = _mm_sub_epi8 (_mm_or_si128 (c, _mm_set1_epi8 (0x20)), _mm_set1_epi8 ('a'));
+        is_letter = _mm_and_si128 (_mm_cmpgt_epi8 (l, _mm_set1_epi8 (-1)),
+                                   _mm_cmplt_epi8 (l, _mm_set1_epi8 (6)));
+        if (_mm_movemask_epi8 (_mm_or_si128 (is_digit, is_letter)) != 0xFFFF)
+            return FALSE;
+
+        v = _mm_or_si128 (_mm_and_si128 (is_digit, d),
+                          _mm_and_si128 (is_letter, _mm_add_epi8 (l, _mm_set1_epi8 (10))));
+
+        /* Each 16-bit lane holds the high nibble in its low byte and the low
+         * nibble in its high byte */
+        words[i] = _mm_or_si128 (_mm_slli_epi16 (_mm_and_si128 (v, _mm_set1_epi16 (0x00FF)), 4),
+                                 _mm_srli_epi16 (v, 8));
+    }
+
+    _mm_storeu_si128 ((__m128i *) out, _mm_packus_epi16 (words[0], words[1]));
+    return TRUE;
+}
+
+/* Encode 16 bytes as 32 uppercase hex digits */
+static inline void
+hex_encode_16_sse2 (const guint8 *bin,
+                    gchar *out)
+{
+    const __m128i mask = _mm_set1_epi8 (0x0F);
+    __m128i b, hi, lo;
+
+    b = _mm_loadu_si128 ((const __m128i *) bin);
+    hi = _mm_and_si128 (_mm_srli_epi16 (b, 4), mask);
+    lo = _mm_and_si128 (b, mask);
+
+    /* n + '0', plus 7 more for 'A'-'F' */
+    hi = _mm_add_epi8 (_mm_add_epi8 (hi, _mm_set1_epi8 ('0')),
+                       _mm_and_si128 (_mm_cmpgt_epi8 (hi, _mm_set1_epi8 (9)), _mm_set1_epi8 (7)));
+    lo = _mm_add_epi8 (_mm_add_epi8 (lo, _mm_set1_epi8 ('0')),
+                       _mm_and_si128 (_mm_cmpgt_epi8 (lo, _mm_set1_epi8 (9)), _mm_set1_epi8 (7)));
+
+    _mm_storeu_si128 ((__m128i *) out,        _mm_unpacklo_epi8 (hi, lo));
+    _mm_storeu_si128 ((__m128i *) (out + 16), _mm_unpackhi_epi8 (hi, lo));
+}
+
+#endif /* __SSE2__ */
+
+gboolean
+mm_utils_hexstr2bin_buf (const gchar *hex,
+                         gsize hex_len,
+                         guint8 *out)
+{
+    guint8 valid = 0x10;
+    gsize i = 0;
+
+    if (hex_len % 2 != 0)
+        return FALSE;
+
+#if defined (__SSE2__)
+    for (; i + 32 <= hex_len; i += 32) {
+        if (!hex_decode_32_sse2 (hex + i, out + i / 2))
+            return FALSE;
+    }
+#endif
+
+    for (; i < hex_len; i += 2) {
+        guint8 a, b;
+
+        a = hex_digit_values[(guint8) hex[i]];
+        b = hex_digit_values[(guint8) hex[i + 1]];
+        /* Valid digits have 0x10 set, checked once at the end */
+        valid &= a & b;
+        out[i / 2] = (guint8) ((a << 4) | (b & 0x0F));
+    }
+
+    return !!valid;
+}
+
+void
+mm_utils_bin2hexstr_buf (const guint8 *bin,
+                         gsize len,
+                         gchar *out)
+{
+    gsize i = 0;
+
+#if defined (__SSE2__)
+    for (; i + 16 <= len; i += 16)
+        hex_encode_16_sse2 (bin + i, out + 2 * i);
+#endif
+
+    for (; i < len; i++) {
+        out[2 * i]     = hex_digits[bin[i] >> 4];
+        out[2 * i + 1] = hex_digits[bin[i] & 0x0F];
+    }
+    out[2 * len] = '\0';
 }
 
 gboolean
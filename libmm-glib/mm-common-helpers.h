@@ -161,6 +161,15 @@ gchar    *mm_utils_hexstr2bin (const gchar *hex, gsize *out_len);
 gchar    *mm_utils_bin2hexstr (const guint8 *bin, gsize len);
 gboolean  mm_utils_ishexstr   (const gchar *hex);
 
+/* 'out' must have room for hex_len / 2 bytes */
+gboolean  mm_utils_hexstr2bin_buf (const gchar *hex,
+                                   gsize hex_len,
+                                   guint8 *out);
+/* 'out' must have room for len * 2 + 1 chars; NUL-terminated */
+void      mm_utils_bin2hexstr_buf (const guint8 *bin,
+                                   gsize len,
+                                   gchar *out);
+
 gboolean  mm_utils_check_for_single_value (guint32 value);
 
 #endif /* MM_COMMON_HELPERS_H */
@@ -708,6 +708,189 @@ mm_modem_messaging_delete_sync (MMModemMessaging *self,
 
 /*****************************************************************************/
 
+/**
+ * mm_modem_messaging_delete_many_finish:
+ * @self: A #MMModemMessaging.
+ * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to mm_modem_messaging_delete_many().
+ * @error: Return location for error or %NULL.
+ *
+ * Finishes an operation started with mm_modem_messaging_delete_many().
+ *
+ * Returns: %TRUE if the messages were deleted, %FALSE if @error is set.
+ */
+gboolean
+mm_modem_messaging_delete_many_finish (MMModemMessaging *self,
+                                       GAsyncResult *res,
+                                       GError **error)
+{
+    g_return_val_if_fail (MM_IS_MODEM_MESSAGING (self), FALSE);
+
+    return mm_gdbus_modem_messaging_call_delete_many_finish (MM_GDBUS_MODEM_MESSAGING (self), res, error);
+}
+
+/**
+ * mm_modem_messaging_delete_many:
+ * @self: A #MMModemMessaging.
+ * @sms: (array zero-terminated=1): %NULL-terminated array of paths of the #MMSms to delete.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @callback: A #GAsyncReadyCallback to call when the request is satisfied or %NULL.
+ * @user_data: User data to pass to @callback.
+ *
+ * Asynchronously deletes multiple #MMSms from the modem.
+ *
+ * When the operation is finished, @callback will be invoked in the <link linkend="g-main-context-push-thread-default">thread-default main loop</link> of the thread you are calling this method from.
+ * You can then call mm_modem_messaging_delete_many_finish() to get the result of the operation.
+ *
+ * See mm_modem_messaging_delete_many_sync() for the synchronous, blocking version of this method.
+ */
+void
+mm_modem_messaging_delete_many (MMModemMessaging *self,
+                                const gchar *const *sms,
+                                GCancellable *cancellable,
+                                GAsyncReadyCallback callback,
+                                gpointer user_data)
+{
+    g_return_if_fail (MM_IS_MODEM_MESSAGING (self));
+
+    mm_gdbus_modem_messaging_call_delete_many (MM_GDBUS_MODEM_MESSAGING (self),
+                                               sms,
+                                               cancellable,
+                                               callback,
+                                               user_data);
+}
+
+/**
+ * mm_modem_messaging_delete_many_sync:
+ * @self: A #MMModemMessaging.
+ * @sms: (array zero-terminated=1): %NULL-terminated array of paths of the #MMSms to delete.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @error: Return location for error or %NULL.
+
+ * Synchronously deletes multiple #MMSms from the modem.
+ *
+ * The calling thread is blocked until a reply is received. See mm_modem_messaging_delete_many()
+ * for the asynchronous version of this method.
+ *
+ * Returns: %TRUE if the messages were deleted, %FALSE if @error is set.
+ */
+gboolean
+mm_modem_messaging_delete_many_sync (MMModemMessaging *self,
+                                     const gchar *const *sms,
+                                     GCancellable *cancellable,
+                                     GError **error)
+{
+    g_return_val_if_fail (MM_IS_MODEM_MESSAGING (self), FALSE);
+
+    return mm_gdbus_modem_messaging_call_delete_many_sync (MM_GDBUS_MODEM_MESSAGING (self),
+                                                           sms,
+                                                           cancellable,
+                                                           error);
+}
+
+/*****************************************************************************/
+
+static GVariant *
+sms_states_to_variant (const MMSmsState *states,
+                       guint n_states)
+{
+    GVariantBuilder builder;
+    guint i;
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("au"));
+    for (i = 0; i < n_states; i++)
+        g_variant_builder_add_value (&builder, g_variant_new_uint32 ((guint32)states[i]));
+    return g_variant_builder_end (&builder);
+}
+
+/**
+ * mm_modem_messaging_delete_all_finish:
+ * @self: A #MMModemMessaging.
+ * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to mm_modem_messaging_delete_all().
+ * @error: Return location for error or %NULL.
+ *
+ * Finishes an operation started with mm_modem_messaging_delete_all().
+ *
+ * Returns: %TRUE if the messages were deleted, %FALSE if @error is set.
+ */
+gboolean
+mm_modem_messaging_delete_all_finish (MMModemMessaging *self,
+                                      GAsyncResult *res,
+                                      GError **error)
+{
+    g_return_val_if_fail (MM_IS_MODEM_MESSAGING (self), FALSE);
+
+    return mm_gdbus_modem_messaging_call_delete_all_finish (MM_GDBUS_MODEM_MESSAGING (self), res, error);
+}
+
+/**
+ * mm_modem_messaging_delete_all:
+ * @self: A #MMModemMessaging.
+ * @states: (array length=n_states): The #MMSmsState values of the #MMSms to delete, or %NULL to delete all of them.
+ * @n_states: Number of elements in @states.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @callback: A #GAsyncReadyCallback to call when the request is satisfied or %NULL.
+ * @user_data: User data to pass to @callback.
+ *
+ * Asynchronously deletes all #MMSms in the given states from the modem. Only
+ * %MM_SMS_STATE_RECEIVED, %MM_SMS_STATE_SENT and %MM_SMS_STATE_STORED are
+ * allowed.
+ *
+ * When the operation is finished, @callback will be invoked in the <link linkend="g-main-context-push-thread-default">thread-default main loop</link> of the thread you are calling this method from.
+ * You can then call mm_modem_messaging_delete_all_finish() to get the result of the operation.
+ *
+ * See mm_modem_messaging_delete_all_sync() for the synchronous, blocking version of this method.
+ */
+void
+mm_modem_messaging_delete_all (MMModemMessaging *self,
+                               const MMSmsState *states,
+                               guint n_states,
+                               GCancellable *cancellable,
+                               GAsyncReadyCallback callback,
+                               gpointer user_data)
+{
+    g_return_if_fail (MM_IS_MODEM_MESSAGING (self));
+
+    mm_gdbus_modem_messaging_call_delete_all (MM_GDBUS_MODEM_MESSAGING (self),
+                                              sms_states_to_variant (states, n_states),
+                                              cancellable,
+                                              callback,
+                                              user_data);
+}
+
+/**
+ * mm_modem_messaging_delete_all_sync:
+ * @self: A #MMModemMessaging.
+ * @states: (array length=n_states): The #MMSmsState values of the #MMSms to delete, or %NULL to delete all of them.
+ * @n_states: Number of elements in @states.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @error: Return location for error or %NULL.
+
+ * Synchronously deletes all #MMSms in the given states from the modem. Only
+ * %MM_SMS_STATE_RECEIVED, %MM_SMS_STATE_SENT and %MM_SMS_STATE_STORED are
+ * allowed.
+ *
+ * The calling thread is blocked until a reply is received. See mm_modem_messaging_delete_all()
+ * for the asynchronous version of this method.
+ *
+ * Returns: %TRUE if the messages were deleted, %FALSE if @error is set.
+ */
+gboolean
+mm_modem_messaging_delete_all_sync (MMModemMessaging *self,
+                                    const MMSmsState *states,
+                                    guint n_states,
+                                    GCancellable *cancellable,
+                                    GError **error)
+{
+    g_return_val_if_fail (MM_IS_MODEM_MESSAGING (self), FALSE);
+
+    return mm_gdbus_modem_messaging_call_delete_all_sync (MM_GDBUS_MODEM_MESSAGING (self),
+                                                          sms_states_to_variant (states, n_states),
+                                                          cancellable,
+                                                          error);
+}
+
+/*****************************************************************************/
+
 static void
 mm_modem_messaging_init (MMModemMessaging *self)
 {
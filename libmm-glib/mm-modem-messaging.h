@@ -115,6 +115,34 @@ gboolean mm_modem_messaging_delete_sync   (MMModemMessaging *self,
                                            GCancellable *cancellable,
                                            GError **error);
 
+void     mm_modem_messaging_delete_many        (MMModemMessaging *self,
+                                                const gchar *const *sms,
+                                                GCancellable *cancellable,
+                                                GAsyncReadyCallback callback,
+                                                gpointer user_data);
+gboolean mm_modem_messaging_delete_many_finish (MMModemMessaging *self,
+                                                GAsyncResult *res,
+                                                GError **error);
+gboolean mm_modem_messaging_delete_many_sync   (MMModemMessaging *self,
+                                                const gchar *const *sms,
+                                                GCancellable *cancellable,
+                                                GError **error);
+
+void     mm_modem_messaging_delete_all        (MMModemMessaging *self,
+                                               const MMSmsState *states,
+                                               guint n_states,
+                                               GCancellable *cancellable,
+                                               GAsyncReadyCallback callback,
+                                               gpointer user_data);
+gboolean mm_modem_messaging_delete_all_finish (MMModemMessaging *self,
+                                               GAsyncResult *res,
+                                               GError **error);
+gboolean mm_modem_messaging_delete_all_sync   (MMModemMessaging *self,
+                                               const MMSmsState *states,
+                                               guint n_states,
+                                               GCancellable *cancellable,
+                                               GError **error);
+
 G_END_DECLS
 
 #endif /* _MM_MODEM_MESSAGING_H_ */
@@ -22,6 +22,8 @@
 
 QcdmResult *qcdm_result_new (void);
 
+/* Keys are not copied, they must be static strings */
+
 void qcdm_result_add_string (QcdmResult *result,
                              const char *key,
                              const char *str);
@@ -24,7 +24,12 @@
 
 /*********************************************************/
 
-typedef struct Val Val;
+/* Values are kept in a flat array, and strings and arrays are copied into a
+ * single data area, so that a result usually takes just one allocation for
+ * the whole response.  Keys are not copied: they are the static strings
+ * defined by the commands, so lookups usually succeed on pointer comparison
+ * before falling back to strcmp().
+ */
 
 typedef enum {
     VAL_TYPE_NONE = 0,
@@ -35,151 +40,34 @@ typedef enum {
     VAL_TYPE_U16_ARRAY = 5,
 } ValType;
 
-struct Val {
-    char *key;
+typedef struct {
+    const char *key;
     u_int8_t type;
     union {
-        char *s;
         u_int8_t u8;
         u_int32_t u32;
-        u_int8_t *u8_array;
-        u_int16_t *u16_array;
+        size_t offset;   /* of strings and arrays, in the data area */
     } u;
     u_int32_t array_len;
-    Val *next;
-};
-
-static void
-val_free (Val *v)
-{
-    if (v->type == VAL_TYPE_STRING) {
-        free (v->u.s);
-    } else if (v->type == VAL_TYPE_U8_ARRAY) {
-        free (v->u.u8_array);
-    } else if (v->type == VAL_TYPE_U16_ARRAY) {
-        free (v->u.u16_array);
-    }
-    free (v->key);
-    memset (v, 0, sizeof (*v));
-    free (v);
-}
-
-static Val *
-val_new_string (const char *key, const char *value)
-{
-    Val *v;
-
-    qcdm_return_val_if_fail (key != NULL, NULL);
-    qcdm_return_val_if_fail (key[0] != '\0', NULL);
-    qcdm_return_val_if_fail (value != NULL, NULL);
-
-    v = calloc (sizeof (Val), 1);
-    if (v == NULL)
-        return NULL;
-
-    v->key = strdup (key);
-    v->type = VAL_TYPE_STRING;
-    v->u.s = strdup (value);
-    return v;
-}
-
-static Val *
-val_new_u8 (const char *key, u_int8_t u)
-{
-    Val *v;
-
-    qcdm_return_val_if_fail (key != NULL, NULL);
-    qcdm_return_val_if_fail (key[0] != '\0', NULL);
-
-    v = calloc (sizeof (Val), 1);
-    if (v == NULL)
-        return NULL;
-
-    v->key = strdup (key);
-    v->type = VAL_TYPE_U8;
-    v->u.u8 = u;
-    return v;
-}
-
-static Val *
-val_new_u8_array (const char *key, const u_int8_t *array, size_t array_len)
-{
-    Val *v;
-
-    qcdm_return_val_if_fail (key != NULL, NULL);
-    qcdm_return_val_if_fail (key[0] != '\0', NULL);
-    qcdm_return_val_if_fail (array != NULL, NULL);
-    qcdm_return_val_if_fail (array_len > 0, NULL);
-
-    v = calloc (sizeof (Val), 1);
-    if (v == NULL)
-        return NULL;
-
-    v->key = strdup (key);
-    v->type = VAL_TYPE_U8_ARRAY;
-    v->u.u8_array = malloc (array_len);
-    if (v->u.u8_array == NULL) {
-        val_free (v);
-        return NULL;
-    }
-    memcpy (v->u.u8_array, array, array_len);
-    v->array_len = array_len;
-
-    return v;
-}
-
-static Val *
-val_new_u32 (const char *key, u_int32_t u)
-{
-    Val *v;
-
-    qcdm_return_val_if_fail (key != NULL, NULL);
-    qcdm_return_val_if_fail (key[0] != '\0', NULL);
-
-    v = calloc (sizeof (Val), 1);
-    if (v == NULL)
-        return NULL;
-
-    v->key = strdup (key);
-    v->type = VAL_TYPE_U32;
-    v->u.u32 = u;
-    return v;
-}
+} Val;
 
-static Val *
-val_new_u16_array (const char *key, const u_int16_t *array, size_t array_len)
-{
-    Val *v;
-    size_t sz;
+#define INLINE_VALS      16
+#define INLINE_DATA_SIZE 256
 
-    qcdm_return_val_if_fail (key != NULL, NULL);
-    qcdm_return_val_if_fail (key[0] != '\0', NULL);
-    qcdm_return_val_if_fail (array != NULL, NULL);
-    qcdm_return_val_if_fail (array_len > 0, NULL);
-
-    v = calloc (sizeof (Val), 1);
-    if (v == NULL)
-        return NULL;
-
-    v->key = strdup (key);
-    v->type = VAL_TYPE_U16_ARRAY;
-    sz = sizeof (u_int16_t) * array_len;
-    v->u.u16_array = malloc (sz);
-    if (v->u.u16_array == NULL) {
-        val_free (v);
-        return NULL;
-    }
-    memcpy (v->u.u16_array, array, sz);
-    v->array_len = array_len;
+struct QcdmResult {
+    u_int32_t refcount;
 
-    return v;
-}
+    Val *vals;
+    u_int32_t n_vals;
+    u_int32_t vals_size;
 
-/*********************************************************/
+    char *data;
+    size_t data_len;
+    size_t data_size;
 
-struct QcdmResult {
-    u_int32_t refcount;
-    Val *first;
+    /* Storage used until the result outgrows it */
+    Val inline_vals[INLINE_VALS];
+    u_int64_t inline_data[INLINE_DATA_SIZE / sizeof (u_int64_t)];
 };
 
 QcdmResult *
@@ -187,9 +75,16 @@ qcdm_result_new (void)
 {
     QcdmResult *r;
 
-    r = calloc (sizeof (QcdmResult), 1);
-    if (r)
+    r = malloc (sizeof (QcdmResult));
+    if (r) {
         r->refcount = 1;
+        r->vals = r->inline_vals;
+        r->n_vals = 0;
+        r->vals_size = INLINE_VALS;
+        r->data = (char *) r->inline_data;
+        r->data_len = 0;
+        r->data_size = INLINE_DATA_SIZE;
+    }
     return r;
 }
 
@@ -206,14 +101,10 @@ qcdm_result_ref (QcdmResult *r)
 static void
 qcdm_result_free (QcdmResult *r)
 {
-    Val *v, *n;
-
-    v = r->first;
-    while (v) {
-        n = v->next;
-        val_free (v);
-        v = n;
-    }
+    if (r->vals != r->inline_vals)
+        free (r->vals);
+    if (r->data != (char *) r->inline_data)
+        free (r->data);
     memset (r, 0, sizeof (*r));
     free (r);
 }
@@ -229,20 +120,86 @@ qcdm_result_unref (QcdmResult *r)
         qcdm_result_free (r);
 }
 
+/* Returns a new value to fill in, or NULL on failure */
+static Val *
+add_val (QcdmResult *r, const char *key, ValType type)
+{
+    Val *v;
+
+    qcdm_return_val_if_fail (key[0] != '\0', NULL);
+
+    if (r->n_vals == r->vals_size) {
+        Val *vals;
+
+        if (r->vals == r->inline_vals) {
+            vals = malloc (sizeof (Val) * r->vals_size * 2);
+            if (vals)
+                memcpy (vals, r->vals, sizeof (Val) * r->n_vals);
+        } else
+            vals = realloc (r->vals, sizeof (Val) * r->vals_size * 2);
+        if (vals == NULL)
+            return NULL;
+
+        r->vals = vals;
+        r->vals_size *= 2;
+    }
+
+    v = &r->vals[r->n_vals++];
+    memset (v, 0, sizeof (*v));
+    v->key = key;
+    v->type = type;
+    return v;
+}
+
+/* Copies data into the data area, suitably aligned for any value type;
+ * returns 0 on success */
+static int
+add_data (QcdmResult *r, const void *src, size_t len, size_t *out_offset)
+{
+    size_t offset;
+    size_t size;
+
+    offset = (r->data_len + sizeof (u_int64_t) - 1) & ~(sizeof (u_int64_t) - 1);
+    if (offset + len > r->data_size) {
+        char *data;
+
+        size = r->data_size * 2;
+        while (offset + len > size)
+            size *= 2;
+
+        if (r->data == (char *) r->inline_data) {
+            data = malloc (size);
+            if (data)
+                memcpy (data, r->data, r->data_len);
+        } else
+            data = realloc (r->data, size);
+        if (data == NULL)
+            return -1;
+
+        r->data = data;
+        r->data_size = size;
+    }
+
+    memcpy (&r->data[offset], src, len);
+    r->data_len = offset + len;
+    *out_offset = offset;
+    return 0;
+}
+
 static Val *
 find_val (QcdmResult *r, const char *key, ValType expected_type)
 {
-    Val *v, *n;
+    u_int32_t i;
+
+    /* Latest value added wins */
+    for (i = r->n_vals; i > 0; i--) {
+        Val *v = &r->vals[i - 1];
 
-    v = r->first;
-    while (v) {
-        n = v->next;
-        if (strcmp (v->key, key) == 0) {
+        if (v->key == key || strcmp (v->key, key) == 0) {
             /* Check type */
             qcdm_return_val_if_fail (v->type == expected_type, NULL);
             return v;
         }
-        v = n;
     }
     return NULL;
 }
@@ -253,16 +210,17 @@ qcdm_result_add_string (QcdmResult *r,
                        const char *str)
 {
     Val *v;
+    size_t offset;
 
     qcdm_return_if_fail (r != NULL);
     qcdm_return_if_fail (r->refcount > 0);
     qcdm_return_if_fail (key != NULL);
     qcdm_return_if_fail (str != NULL);
 
-    v = val_new_string (key, str);
+    qcdm_return_if_fail (add_data (r, str, strlen (str) + 1, &offset) == 0);
+    v = add_val (r, key, VAL_TYPE_STRING);
     qcdm_return_if_fail (v != NULL);
-    v->next = r->first;
-    r->first = v;
+    v->u.offset = offset;
 }
 
 int
@@ -282,7 +240,7 @@ qcdm_result_get_string (QcdmResult *r,
     if (v == NULL)
         return -QCDM_ERROR_VALUE_NOT_FOUND;
 
-    *out_val = v->u.s;
+    *out_val = &r->data[v->u.offset];
     return 0;
 }
 
@@ -297,10 +255,9 @@ qcdm_result_add_u8 (QcdmResult *r,
     qcdm_return_if_fail (r->refcount > 0);
     qcdm_return_if_fail (key != NULL);
 
-    v = val_new_u8 (key, num);
+    v = add_val (r, key, VAL_TYPE_U8);
     qcdm_return_if_fail (v != NULL);
-    v->next = r->first;
-    r->first = v;
+    v->u.u8 = num;
 }
 
 int
@@ -330,17 +287,19 @@ qcdm_result_add_u8_array (QcdmResult *r,
                           size_t array_len)
 {
     Val *v;
+    size_t offset;
 
     qcdm_return_if_fail (r != NULL);
     qcdm_return_if_fail (r->refcount > 0);
     qcdm_return_if_fail (key != NULL);
     qcdm_return_if_fail (array != NULL);
-    qcdm_return_if_fail (array_len >= 0);
+    qcdm_return_if_fail (array_len > 0);
 
-    v = val_new_u8_array (key, array, array_len);
+    qcdm_return_if_fail (add_data (r, array, array_len, &offset) == 0);
+    v = add_val (r, key, VAL_TYPE_U8_ARRAY);
     qcdm_return_if_fail (v != NULL);
-    v->next = r->first;
-    r->first = v;
+    v->u.offset = offset;
+    v->array_len = array_len;
 }
 
 int
@@ -361,7 +320,7 @@ qcdm_result_get_u8_array (QcdmResult *r,
     if (v == NULL)
         return -QCDM_ERROR_VALUE_NOT_FOUND;
 
-    *out_val = v->u.u8_array;
+    *out_val = (const u_int8_t *) &r->data[v->u.offset];
     *out_len = v->array_len;
     return 0;
 }
@@ -377,10 +336,9 @@ qcdm_result_add_u32 (QcdmResult *r,
     qcdm_return_if_fail (r->refcount > 0);
     qcdm_return_if_fail (key != NULL);
 
-    v = val_new_u32 (key, num);
+    v = add_val (r, key, VAL_TYPE_U32);
     qcdm_return_if_fail (v != NULL);
-    v->next = r->first;
-    r->first = v;
+    v->u.u32 = num;
 }
 
 int
@@ -410,17 +368,19 @@ qcdm_result_add_u16_array (QcdmResult *r,
                            size_t array_len)
 {
     Val *v;
+    size_t offset;
 
     qcdm_return_if_fail (r != NULL);
     qcdm_return_if_fail (r->refcount > 0);
     qcdm_return_if_fail (key != NULL);
     qcdm_return_if_fail (array != NULL);
-    qcdm_return_if_fail (array_len >= 0);
+    qcdm_return_if_fail (array_len > 0);
 
-    v = val_new_u16_array (key, array, array_len);
+    qcdm_return_if_fail (add_data (r, array, sizeof (u_int16_t) * array_len, &offset) == 0);
+    v = add_val (r, key, VAL_TYPE_U16_ARRAY);
     qcdm_return_if_fail (v != NULL);
-    v->next = r->first;
-    r->first = v;
+    v->u.offset = offset;
+    v->array_len = array_len;
 }
 
 int
@@ -441,8 +401,7 @@ qcdm_result_get_u16_array (QcdmResult *r,
     if (v == NULL)
         return -QCDM_ERROR_VALUE_NOT_FOUND;
 
-    *out_val = v->u.u16_array;
+    *out_val = (const u_int16_t *) &r->data[v->u.offset];
     *out_len = v->array_len;
     return 0;
 }
-
@@ -59,5 +59,33 @@ qcdmbool dm_decapsulate_buffer (const char *inbuf,
                                 size_t *out_used,
                                 qcdmbool *out_need_more);
 
+/* Incremental decoding of QCDM frames out of a stream of bytes */
+
+typedef enum {
+    DM_FRAME_NEED_MORE = 0,
+    DM_FRAME_READY     = 1,
+    DM_FRAME_INVALID   = 2,
+} DmFrameStatus;
+
+typedef struct {
+    char *buf;
+    size_t buf_len;
+    size_t len;
+    qcdmbool escaping;
+    qcdmbool corrupt;
+} DmFrameDecoder;
+
+void dm_frame_decoder_init (DmFrameDecoder *decoder,
+                            char *buf,
+                            size_t buf_len);
+
+void dm_frame_decoder_reset (DmFrameDecoder *decoder);
+
+DmFrameStatus dm_frame_decoder_feed (DmFrameDecoder *decoder,
+                                     const char *inbuf,
+                                     size_t inbuf_len,
+                                     size_t *out_used,
+                                     size_t *out_frame_len);
+
 #endif  /* LIBQCDM_UTILS_H */
 
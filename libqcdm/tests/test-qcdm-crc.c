@@ -63,3 +63,29 @@ test_crc16_1 (void *f, void *data)
     g_assert (crc == expected);
 }
 
+
+void
+test_crc16_long (void *f, void *data)
+{
+    char buf[1031];
+    guint i, len;
+
+    for (i = 0; i < sizeof (buf); i++)
+        buf[i] = (char) g_test_rand_int ();
+
+    /* Compare against a plain bitwise CRC for every length, so that both the
+     * 8-bytes-at-a-time loop and the trailing bytes get checked */
+    for (len = 0; len <= sizeof (buf); len++) {
+        guint16 expected = 0xFFFF;
+        guint j;
+
+        for (i = 0; i < len; i++) {
+            expected ^= (guint8) buf[i];
+            for (j = 0; j < 8; j++)
+                expected = (expected & 1) ? (expected >> 1) ^ 0x8408 : (expected >> 1);
+        }
+        expected = ~expected;
+
+        g_assert_cmpuint (dm_crc16 (buf, len), ==, expected);
+    }
+}
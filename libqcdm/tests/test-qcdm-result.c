@@ -21,6 +21,8 @@
 #include "test-qcdm-result.h"
 #include "result.h"
 #include "result-private.h"
+#include "commands.h"
+#include "dm-commands.h"
 
 #define TEST_TAG "test"
 
@@ -91,3 +93,115 @@ test_result_uint8_array (void *f, void *data)
     qcdm_result_unref (result);
 }
 
+
+void
+test_result_many_values (void *f, void *data)
+{
+    static const char *keys[] = {
+        "k00", "k01", "k02", "k03", "k04", "k05", "k06", "k07", "k08", "k09",
+        "k10", "k11", "k12", "k13", "k14", "k15", "k16", "k17", "k18", "k19",
+    };
+    u_int8_t array[100];
+    const u_int8_t *tmp_array;
+    size_t tmp_len;
+    guint32 tmp;
+    QcdmResult *result;
+    guint i;
+
+    /* Enough values and data to outgrow the storage of a new result */
+    result = qcdm_result_new ();
+    for (i = 0; i < G_N_ELEMENTS (keys); i++) {
+        memset (array, i, sizeof (array));
+        qcdm_result_add_u8_array (result, keys[i], array, sizeof (array) - i);
+        qcdm_result_add_u32 (result, TEST_TAG, i);
+    }
+
+    for (i = 0; i < G_N_ELEMENTS (keys); i++) {
+        gchar *key;
+
+        /* Look up with a key which is not the one given when adding */
+        key = g_strdup (keys[i]);
+        tmp_array = NULL;
+        tmp_len = 0;
+        g_assert_cmpint (qcdm_result_get_u8_array (result, key, &tmp_array, &tmp_len), ==, 0);
+        g_assert_cmpuint (tmp_len, ==, sizeof (array) - i);
+        g_assert_cmpuint (tmp_array[0], ==, i);
+        g_assert_cmpuint (tmp_array[tmp_len - 1], ==, i);
+        g_free (key);
+    }
+
+    /* Latest value added wins */
+    g_assert_cmpint (qcdm_result_get_u32 (result, TEST_TAG, &tmp), ==, 0);
+    g_assert_cmpuint (tmp, ==, G_N_ELEMENTS (keys) - 1);
+
+    qcdm_result_unref (result);
+}
+
+/*****************************************************************************/
+/* Benchmarks, only run in perf mode (gtester -m perf) */
+
+#define PERF_ITERATIONS 200000
+
+static const char verinfo_rsp[] = {
+    0x00, 0x41, 0x75, 0x67, 0x20, 0x31, 0x39, 0x20, 0x32, 0x30, 0x30, 0x38,
+    0x32, 0x30, 0x3a, 0x34, 0x38, 0x3a, 0x34, 0x37, 0x4f, 0x63, 0x74, 0x20,
+    0x32, 0x39, 0x20, 0x32, 0x30, 0x30, 0x37, 0x31, 0x39, 0x3a, 0x30, 0x30,
+    0x3a, 0x30, 0x30, 0x53, 0x43, 0x4e, 0x52, 0x5a, 0x2e, 0x2e, 0x2e, 0x2a,
+    0x06, 0x04, 0xb9, 0x0b, 0x02, 0x00, 0xb2
+};
+
+void
+test_result_perf_parse (void *f, void *data)
+{
+    DMCmdStatusSnapshotRsp snapshot;
+    DMCmdPilotSetsRsp pilot_sets;
+    QcdmResult *result;
+    const char *str;
+    u_int32_t num;
+    u_int32_t pn_offset, ecio;
+    float db;
+    guint i;
+
+    if (!g_test_perf ())
+        return;
+
+    memset (&snapshot, 0, sizeof (snapshot));
+    snapshot.code = DIAG_CMD_STATUS_SNAPSHOT;
+    snapshot.esn[0] = 0x5a;
+    snapshot.esn[3] = 0x9f;
+    snapshot.mcc = GUINT16_TO_LE (310);
+    snapshot.state = 0x02;
+
+    memset (&pilot_sets, 0, sizeof (pilot_sets));
+    pilot_sets.code = DIAG_CMD_PILOT_SETS;
+    pilot_sets.active_count = 2;
+    pilot_sets.candidate_count = 3;
+    pilot_sets.neighbor_count = 20;
+
+    g_test_timer_start ();
+    for (i = 0; i < PERF_ITERATIONS; i++) {
+        result = qcdm_cmd_version_info_result (verinfo_rsp, sizeof (verinfo_rsp), NULL);
+        g_assert (result);
+        str = NULL;
+        qcdm_result_get_string (result, QCDM_CMD_VERSION_INFO_ITEM_MODEL, &str);
+        g_assert (str);
+        qcdm_result_unref (result);
+
+        result = qcdm_cmd_status_snapshot_result ((const char *) &snapshot, sizeof (snapshot), NULL);
+        g_assert (result);
+        str = NULL;
+        qcdm_result_get_string (result, QCDM_CMD_STATUS_SNAPSHOT_ITEM_ESN, &str);
+        g_assert (str);
+        qcdm_result_get_u32 (result, QCDM_CMD_STATUS_SNAPSHOT_ITEM_HOME_MCC, &num);
+        qcdm_result_unref (result);
+
+        result = qcdm_cmd_pilot_sets_result ((const char *) &pilot_sets, sizeof (pilot_sets), NULL);
+        g_assert (result);
+        g_assert (qcdm_cmd_pilot_sets_result_get_num (result, QCDM_CMD_PILOT_SETS_TYPE_NEIGHBOR, &num));
+        g_assert (qcdm_cmd_pilot_sets_result_get_pilot (result, QCDM_CMD_PILOT_SETS_TYPE_NEIGHBOR, num - 1, &pn_offset, &ecio, &db));
+        qcdm_result_unref (result);
+    }
+
+    num = PERF_ITERATIONS * 3 / g_test_timer_elapsed ();
+    g_test_maximized_result (num, "Parsed %u responses/s", num);
+}
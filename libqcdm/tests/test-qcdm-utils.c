@@ -104,3 +104,193 @@ test_utils_decapsulate_sierra_cns (void *f, void *data)
     g_assert (success == FALSE);
 }
 
+
+void
+test_utils_frame_decoder (void *f, void *data)
+{
+    static const char garbage[] = { 'A', 'T', 'Z', 0x7e };
+    char expected[512];
+    char buf[512];
+    gsize expected_len = 0;
+    gsize used = 0;
+    gsize frame_len = 0;
+    qcdmbool more = FALSE;
+    DmFrameDecoder decoder;
+    DmFrameStatus status;
+    guint i;
+
+    g_assert (dm_decapsulate_buffer (decap_inbuf, sizeof (decap_inbuf),
+                                     expected, sizeof (expected),
+                                     &expected_len, &used, &more));
+
+    dm_frame_decoder_init (&decoder, buf, sizeof (buf));
+
+    /* Data that isn't a valid frame */
+    status = dm_frame_decoder_feed (&decoder, garbage, sizeof (garbage), &used, &frame_len);
+    g_assert_cmpint (status, ==, DM_FRAME_INVALID);
+    g_assert_cmpuint (used, ==, sizeof (garbage));
+
+    /* A frame fed one byte at a time, preceded by a start marker */
+    status = dm_frame_decoder_feed (&decoder, &garbage[3], 1, &used, &frame_len);
+    g_assert_cmpint (status, ==, DM_FRAME_NEED_MORE);
+    for (i = 0; i < sizeof (decap_inbuf) - 1; i++) {
+        status = dm_frame_decoder_feed (&decoder, &decap_inbuf[i], 1, &used, &frame_len);
+        g_assert_cmpint (status, ==, DM_FRAME_NEED_MORE);
+        g_assert_cmpuint (used, ==, 1);
+    }
+    status = dm_frame_decoder_feed (&decoder, &decap_inbuf[i], 1, &used, &frame_len);
+    g_assert_cmpint (status, ==, DM_FRAME_READY);
+    g_assert_cmpuint (frame_len, ==, expected_len);
+    g_assert (memcmp (buf, expected, frame_len) == 0);
+
+    /* Two frames in a row, the second one with a bad CRC */
+    memcpy (expected, encap_outbuf, sizeof (encap_outbuf));
+    memcpy (&expected[sizeof (encap_outbuf)], cns_inbuf, sizeof (cns_inbuf));
+    status = dm_frame_decoder_feed (&decoder, expected, sizeof (encap_outbuf) + sizeof (cns_inbuf), &used, &frame_len);
+    g_assert_cmpint (status, ==, DM_FRAME_READY);
+    g_assert_cmpuint (used, ==, sizeof (encap_outbuf));
+    g_assert_cmpuint (frame_len, ==, 4);
+    g_assert (memcmp (buf, encap_outbuf, frame_len) == 0);
+    status = dm_frame_decoder_feed (&decoder, &expected[used], sizeof (cns_inbuf), &used, &frame_len);
+    g_assert_cmpint (status, ==, DM_FRAME_INVALID);
+    g_assert_cmpuint (used, ==, sizeof (cns_inbuf));
+
+    /* A frame not fitting in the decoder buffer */
+    dm_frame_decoder_init (&decoder, buf, 100);
+    status = dm_frame_decoder_feed (&decoder, decap_inbuf, sizeof (decap_inbuf), &used, &frame_len);
+    g_assert_cmpint (status, ==, DM_FRAME_INVALID);
+    g_assert_cmpuint (used, ==, sizeof (decap_inbuf));
+}
+
+/*****************************************************************************/
+/* Benchmarks, only run in perf mode (gtester -m perf) */
+
+#define PERF_STREAM_SIZE (256 * 1024)
+#define PERF_ITERATIONS  50
+
+static GByteArray *
+build_perf_stream (guint *n_frames)
+{
+    GByteArray *stream;
+    char frame[514];
+    char encap[1100];
+    gsize frame_len;
+    gsize encap_len;
+    guint i;
+
+    *n_frames = 0;
+    stream = g_byte_array_sized_new (PERF_STREAM_SIZE + sizeof (encap));
+    while (stream->len < PERF_STREAM_SIZE) {
+        /* Mostly log packets of a few hundred bytes, as in DIAG log streams */
+        frame_len = g_test_rand_int_range (16, 512);
+        for (i = 0; i < frame_len; i++)
+            frame[i] = (char) g_test_rand_int ();
+        encap_len = dm_encapsulate_buffer (frame, frame_len, sizeof (frame), encap, sizeof (encap));
+        g_assert (encap_len > 0);
+        g_byte_array_append (stream, (const guint8 *) encap, encap_len);
+        (*n_frames)++;
+    }
+
+    return stream;
+}
+
+static void
+report_throughput (const gchar *what,
+                   gsize total,
+                   gdouble elapsed)
+{
+    gdouble mbps;
+
+    mbps = elapsed > 0 ? (total / (1024.0 * 1024.0)) / elapsed : 0;
+    g_test_maximized_result (mbps, "%s: %.1f MB/s", what, mbps);
+}
+
+void
+test_utils_perf_crc16 (void *f, void *data)
+{
+    GByteArray *stream;
+    guint n_frames;
+    guint i;
+    guint16 crc = 0;
+
+    if (!g_test_perf ())
+        return;
+
+    stream = build_perf_stream (&n_frames);
+    g_test_timer_start ();
+    for (i = 0; i < PERF_ITERATIONS; i++)
+        crc += dm_crc16 ((const char *) stream->data, stream->len);
+    report_throughput ("dm_crc16", (gsize) stream->len * PERF_ITERATIONS, g_test_timer_elapsed ());
+    g_test_message ("CRC: 0x%04x", crc);
+    g_byte_array_unref (stream);
+}
+
+void
+test_utils_perf_decapsulate (void *f, void *data)
+{
+    GByteArray *stream;
+    char buf[2048];
+    gsize decap_len;
+    gsize used;
+    qcdmbool more;
+    guint n_frames;
+    guint n_decoded = 0;
+    guint i;
+    gsize pos;
+
+    if (!g_test_perf ())
+        return;
+
+    stream = build_perf_stream (&n_frames);
+    g_test_timer_start ();
+    for (i = 0; i < PERF_ITERATIONS; i++) {
+        for (pos = 0; pos < stream->len; pos += used) {
+            if (dm_decapsulate_buffer ((const char *) &stream->data[pos], stream->len - pos,
+                                       buf, sizeof (buf), &decap_len, &used, &more) && !more)
+                n_decoded++;
+            if (!used)
+                break;
+        }
+    }
+    report_throughput ("dm_decapsulate_buffer", (gsize) stream->len * PERF_ITERATIONS, g_test_timer_elapsed ());
+    g_assert_cmpuint (n_decoded, ==, n_frames * PERF_ITERATIONS);
+    g_byte_array_unref (stream);
+}
+
+void
+test_utils_perf_frame_decoder (void *f, void *data)
+{
+    GByteArray *stream;
+    char buf[1024];
+    DmFrameDecoder decoder;
+    gsize frame_len;
+    gsize used;
+    guint n_frames;
+    guint n_decoded = 0;
+    guint i;
+    gsize pos;
+    gsize chunk;
+
+    if (!g_test_perf ())
+        return;
+
+    stream = build_perf_stream (&n_frames);
+    dm_frame_decoder_init (&decoder, buf, sizeof (buf));
+    g_test_timer_start ();
+    for (i = 0; i < PERF_ITERATIONS; i++) {
+        /* Feed the stream in chunks the size of a typical tty read */
+        for (pos = 0; pos < stream->len; pos += chunk) {
+            const char *p = (const char *) &stream->data[pos];
+
+            chunk = MIN (stream->len - pos, 4096);
+            for (used = 0; p < (const char *) &stream->data[pos + chunk]; p += used) {
+                if (dm_frame_decoder_feed (&decoder, p, (const char *) &stream->data[pos + chunk] - p,
+                                           &used, &frame_len) == DM_FRAME_READY)
+                    n_decoded++;
+            }
+        }
+    }
+    report_throughput ("dm_frame_decoder_feed", (gsize) stream->len * PERF_ITERATIONS, g_test_timer_elapsed ());
+    g_assert_cmpuint (n_decoded, ==, n_frames * PERF_ITERATIONS);
+    g_byte_array_unref (stream);
+}
@@ -24,5 +24,13 @@ void test_utils_encapsulate_buffer (void *f, void *data);
 
 void test_utils_decapsulate_sierra_cns (void *f, void *data);
 
+void test_utils_frame_decoder (void *f, void *data);
+
+void test_utils_perf_crc16 (void *f, void *data);
+
+void test_utils_perf_decapsulate (void *f, void *data);
+
+void test_utils_perf_frame_decoder (void *f, void *data);
+
 #endif  /* TEST_QCDM_UTILS_H */
 
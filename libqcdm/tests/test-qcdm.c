@@ -80,16 +80,23 @@ int main (int argc, char **argv)
 
     g_test_suite_add (suite, TESTCASE (test_crc16_1, NULL));
     g_test_suite_add (suite, TESTCASE (test_crc16_2, NULL));
+    g_test_suite_add (suite, TESTCASE (test_crc16_long, NULL));
     g_test_suite_add (suite, TESTCASE (test_escape1, NULL));
     g_test_suite_add (suite, TESTCASE (test_escape2, NULL));
     g_test_suite_add (suite, TESTCASE (test_escape_unescape, NULL));
     g_test_suite_add (suite, TESTCASE (test_utils_decapsulate_buffer, NULL));
     g_test_suite_add (suite, TESTCASE (test_utils_encapsulate_buffer, NULL));
     g_test_suite_add (suite, TESTCASE (test_utils_decapsulate_sierra_cns, NULL));
+    g_test_suite_add (suite, TESTCASE (test_utils_frame_decoder, NULL));
+    g_test_suite_add (suite, TESTCASE (test_utils_perf_crc16, NULL));
+    g_test_suite_add (suite, TESTCASE (test_utils_perf_decapsulate, NULL));
+    g_test_suite_add (suite, TESTCASE (test_utils_perf_frame_decoder, NULL));
     g_test_suite_add (suite, TESTCASE (test_result_string, NULL));
     g_test_suite_add (suite, TESTCASE (test_result_uint32, NULL));
     g_test_suite_add (suite, TESTCASE (test_result_uint8, NULL));
     g_test_suite_add (suite, TESTCASE (test_result_uint8_array, NULL));
+    g_test_suite_add (suite, TESTCASE (test_result_many_values, NULL));
+    g_test_suite_add (suite, TESTCASE (test_result_perf_parse, NULL));
 
     /* Live tests */
     if (port) {
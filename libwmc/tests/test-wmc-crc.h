@@ -20,6 +20,7 @@
 
 void test_crc16_2 (void *f, void *data);
 void test_crc16_1 (void *f, void *data);
+void test_crc16_long (void *f, void *data);
 
 #endif  /* TEST_WMC_CRC_H */
 
@@ -82,6 +82,7 @@ int main (int argc, char **argv)
     suite = g_test_get_root ();
     g_test_suite_add (suite, TESTCASE (test_crc16_1, NULL));
     g_test_suite_add (suite, TESTCASE (test_crc16_2, NULL));
+    g_test_suite_add (suite, TESTCASE (test_crc16_long, NULL));
     g_test_suite_add (suite, TESTCASE (test_escape1, NULL));
     g_test_suite_add (suite, TESTCASE (test_escape2, NULL));
     g_test_suite_add (suite, TESTCASE (test_escape_ctrl, NULL));
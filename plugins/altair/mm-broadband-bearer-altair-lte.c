@@ -157,7 +157,7 @@ connect_3gpp_apnsettings_ready (MMBaseModem *modem,
     mm_base_modem_at_command_full (ctx->modem,
                                    ctx->primary,
                                    "%DPDNACT=1",
-                                   20, /* timeout */
+                                   20000, /* timeout */
                                    FALSE, /* allow_cached */
                                    FALSE, /* is_raw */
                                    ctx->cancellable,
@@ -236,7 +236,7 @@ connect_3gpp (MMBroadbandBearer *self,
     mm_base_modem_at_command_full (ctx->modem,
                                    ctx->primary,
                                    command,
-                                   10, /* timeout */
+                                   10000, /* timeout */
                                    FALSE, /* allow_cached */
                                    FALSE, /* is_raw */
                                    ctx->cancellable,
@@ -352,7 +352,7 @@ disconnect_3gpp (MMBroadbandBearer *self,
     mm_base_modem_at_command_full (ctx->modem,
                                    ctx->primary,
                                    "%DPDNACT=0",
-                                   20, /* timeout */
+                                   20000, /* timeout */
                                    FALSE, /* allow_cached */
                                    FALSE, /* is_raw */
                                    NULL, /* cancellable */
@@ -90,7 +90,7 @@ modem_power_down (MMIfaceModem *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CFUN=4",
-                              20,
+                              20000,
                               FALSE,
                               callback,
                               user_data);
@@ -218,7 +218,7 @@ load_unlock_retries (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         "%CPININFO",
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)load_unlock_retries_ready,
         g_simple_async_result_new (G_OBJECT (self),
@@ -338,7 +338,7 @@ load_supported_bands (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         "%BANDCAP=",
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)load_supported_bands_done,
         result);
@@ -419,7 +419,7 @@ load_current_bands (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         "%GETCFG=\"BAND\"",
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)load_current_bands_done,
         result);
@@ -443,7 +443,7 @@ reset (MMIfaceModem *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "ATZ",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -529,7 +529,7 @@ run_registration_checks_ready (MMIfaceModem3gpp *self,
     mm_dbg ("Checking if SIM is unprovisioned (ignoring registration state).");
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CEER",
-                              6,
+                              6000,
                               FALSE,
                               (GAsyncReadyCallback) run_registration_checks_subscription_state_ready,
                               operation_result);
@@ -583,7 +583,7 @@ modem_3gpp_register_in_network (MMIfaceModem3gpp *self,
     mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                    mm_base_modem_peek_best_at_port (MM_BASE_MODEM (self), NULL),
                                    "%CMATT=1",
-                                   3,
+                                   3000,
                                    FALSE,
                                    FALSE, /* raw */
                                    cancellable,
@@ -632,7 +632,7 @@ altair_deregister_ready (MMBaseModem *self,
     mm_base_modem_at_command (
         self,
         "%CMATT=1",
-        10,
+        10000,
         FALSE, /* allow_cached */
         (GAsyncReadyCallback)altair_reregister_ready,
         NULL);
@@ -665,7 +665,7 @@ altair_load_own_numbers_ready (MMIfaceModem *iface_modem,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         "%CMATT=0",
-        10,
+        10000,
         FALSE, /* allow_cached */
         (GAsyncReadyCallback)altair_deregister_ready,
         NULL);
@@ -906,9 +906,9 @@ response_processor_no_result_stop_on_error (MMBaseModem *self,
 }
 
 static const MMBaseModemAtCommand unsolicited_events_enable_sequence[] = {
-  { "%STATCM=1", 10, FALSE, response_processor_no_result_stop_on_error },
-  { "%NOTIFYEV=\"SIMREFRESH\",1", 10, FALSE, NULL },
-  { "%PCOINFO=1", 10, FALSE, NULL },
+  { "%STATCM=1", 10000, FALSE, response_processor_no_result_stop_on_error },
+  { "%NOTIFYEV=\"SIMREFRESH\",1", 10000, FALSE, NULL },
+  { "%PCOINFO=1", 10000, FALSE, NULL },
   { NULL }
 };
 
@@ -983,9 +983,9 @@ modem_3gpp_enable_unsolicited_events (MMIfaceModem3gpp *self,
 /* Disabling unsolicited events (3GPP interface) */
 
 static const MMBaseModemAtCommand unsolicited_events_disable_sequence[] = {
-  { "%STATCM=0", 10, FALSE, NULL },
-  { "%NOTIFYEV=\"SIMREFRESH\",0", 10, FALSE, NULL },
-  { "%PCOINFO=0", 10, FALSE, NULL },
+  { "%STATCM=0", 10000, FALSE, NULL },
+  { "%NOTIFYEV=\"SIMREFRESH\",0", 10000, FALSE, NULL },
+  { "%PCOINFO=0", 10000, FALSE, NULL },
   { NULL }
 };
 
@@ -1087,14 +1087,14 @@ modem_3gpp_load_operator_code (MMIfaceModem3gpp *self,
 
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+COPS=3,2",
-                              6,
+                              6000,
                               FALSE,
                               NULL,
                               NULL);
 
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+COPS?",
-                              6,
+                              6000,
                               FALSE,
                               callback,
                               user_data);
@@ -1131,14 +1131,14 @@ modem_3gpp_load_operator_name (MMIfaceModem3gpp *self,
 
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+COPS=3,0",
-                              6,
+                              6000,
                               FALSE,
                               NULL,
                               NULL);
 
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+COPS?",
-                              6,
+                              6000,
                               FALSE,
                               callback,
                               user_data);
@@ -1248,7 +1248,7 @@ modem_3gpp_load_subscription_state (MMIfaceModem3gpp *self,
     mm_dbg ("Loading vendor PCO info...");
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "%PCOINFO?",
-                              6,
+                              6000,
                               FALSE,
                               (GAsyncReadyCallback)altair_load_vendor_pco_info_ready,
                               ctx);
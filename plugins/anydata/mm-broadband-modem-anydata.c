@@ -221,7 +221,7 @@ state_ready (MMIfaceModemCdma *self,
     /* Try for EVDO state too */
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "*HSTATE?",
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)hstate_ready,
                               ctx);
@@ -248,7 +248,7 @@ get_detailed_registration_state (MMIfaceModemCdma *self,
 
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "*STATE?",
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)state_ready,
                               ctx);
@@ -272,7 +272,7 @@ reset (MMIfaceModem *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "*RESET",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
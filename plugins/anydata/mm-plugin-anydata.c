@@ -78,6 +78,7 @@ mm_plugin_create (void)
                       MM_PLUGIN_ALLOWED_VENDOR_IDS, vendor_ids,
                       MM_PLUGIN_ALLOWED_AT,         TRUE,
                       MM_PLUGIN_ALLOWED_QCDM,       TRUE,
+                      MM_PLUGIN_AT_QCDM_PROBE,      TRUE,
                       MM_PLUGIN_ALLOWED_QMI,        TRUE,
                       NULL));
 }
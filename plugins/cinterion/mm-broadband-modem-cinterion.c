@@ -117,7 +117,7 @@ enable_unsolicited_events (MMIfaceModem3gpp *self,
      */
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CMER=3,0,0,2",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -252,7 +252,7 @@ messaging_enable_unsolicited_events (MMIfaceModemMessaging *_self,
 
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               cmd->str,
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)cnmi_test_ready,
                               simple);
@@ -331,7 +331,7 @@ messaging_check_support (MMIfaceModemMessaging *self,
     /* Check CNMI support */
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CNMI=?",
-                              3,
+                              3000,
                               TRUE,
                               (GAsyncReadyCallback)cnmi_format_check_ready,
                               result);
@@ -376,7 +376,7 @@ send_sleep_mode_command (MMBroadbandModemCinterion *self,
         self->priv->sleep_mode_cmd[0]) {
         mm_base_modem_at_command (MM_BASE_MODEM (self),
                                   self->priv->sleep_mode_cmd,
-                                  5,
+                                  5000,
                                   FALSE,
                                   (GAsyncReadyCallback)sleep_ready,
                                   operation_result);
@@ -452,7 +452,7 @@ modem_power_down (MMIfaceModem *self,
         mm_base_modem_at_command (
             MM_BASE_MODEM (self),
             "+CFUN=?",
-            3,
+            3000,
             FALSE,
             (GAsyncReadyCallback)supported_functionality_status_query_ready,
             result);
@@ -602,7 +602,7 @@ modem_power_off (MMIfaceModem *self,
     mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                    ctx->port,
                                    "^SMSO",
-                                   5,
+                                   5000,
                                    FALSE, /* allow_cached */
                                    FALSE, /* is_raw */
                                    NULL, /* cancellable */
@@ -811,7 +811,7 @@ sind_query_ready (MMBroadbandModemCinterion *self,
         mm_base_modem_at_command (
             MM_BASE_MODEM (self),
             "^SMONG",
-            3,
+            3000,
             FALSE,
             (GAsyncReadyCallback)smong_query_ready,
             operation_result);
@@ -838,7 +838,7 @@ load_access_technologies (MMIfaceModem *self,
         mm_base_modem_at_command (
             MM_BASE_MODEM (self),
             "^SIND?",
-            3,
+            3000,
             FALSE,
             (GAsyncReadyCallback)sind_query_ready,
             result);
@@ -848,7 +848,7 @@ load_access_technologies (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         "^SMONG",
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)smong_query_ready,
         result);
@@ -1010,7 +1010,7 @@ set_current_modes (MMIfaceModem *_self,
         mm_base_modem_at_command (
             MM_BASE_MODEM (self),
             command,
-            20,
+            20000,
             FALSE,
             (GAsyncReadyCallback)allowed_access_technology_update_ready,
             result);
@@ -1096,7 +1096,7 @@ register_in_network (MMIfaceModem3gpp *self,
     mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                    mm_base_modem_peek_best_at_port (MM_BASE_MODEM (self), NULL),
                                    command,
-                                   120,
+                                   120000,
                                    FALSE,
                                    FALSE, /* raw */
                                    cancellable,
@@ -1162,7 +1162,7 @@ load_supported_bands (MMIfaceModem *self,
 
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "AT^SCFG=?",
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)scfg_test_ready,
                               simple);
@@ -1221,7 +1221,7 @@ load_current_bands (MMIfaceModem *self,
 
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "AT^SCFG=\"Radio/Band\"",
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)get_band_ready,
                               result);
@@ -1291,7 +1291,7 @@ set_bands_3g (MMIfaceModem *_self,
     cmd = g_strdup_printf ("^SCFG=\"Radio/Band\",%u,1", band);
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               cmd,
-                              15,
+                              15000,
                               FALSE,
                               (GAsyncReadyCallback)scfg_set_ready,
                               simple);
@@ -1343,7 +1343,7 @@ set_bands_2g (MMIfaceModem *_self,
 
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               cmd,
-                              15,
+                              15000,
                               FALSE,
                               (GAsyncReadyCallback)scfg_set_ready,
                               simple);
@@ -1421,7 +1421,7 @@ setup_flow_control (MMIfaceModem *self,
     /* We need to enable RTS/CTS so that CYCLIC SLEEP mode works */
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "\\Q3",
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)setup_flow_control_ready,
                               result);
@@ -1520,7 +1520,7 @@ load_unlock_retries_context_step (LoadUnlockRetriesContext *ctx)
     mm_base_modem_at_command (
         MM_BASE_MODEM (ctx->self),
         unlock_retries_map[ctx->i].command,
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)spic_ready,
         ctx);
@@ -1635,7 +1635,7 @@ after_sim_unlock_context_step (AfterSimUnlockContext *ctx)
     ctx->retries--;
     mm_base_modem_at_command (MM_BASE_MODEM (ctx->self),
                               "^SIND=\"simstatus\",1",
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)simstatus_check_ready,
                               ctx);
@@ -206,7 +206,7 @@ internal_disable_location_gathering (LocationGatheringContext *ctx)
         mm_base_modem_at_command_full (MM_BASE_MODEM (ctx->self),
                                        mm_base_modem_peek_best_at_port (MM_BASE_MODEM (ctx->self), NULL),
                                        "AT^SGPSS=0",
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE, /* raw */
                                        NULL, /* cancellable */
@@ -364,7 +364,7 @@ parent_enable_location_gathering_ready (MMIfaceModemLocation *self,
         mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                        mm_base_modem_peek_best_at_port (MM_BASE_MODEM (self), NULL),
                                        "AT^SGPSS=4",
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE, /* raw */
                                        NULL, /* cancellable */
@@ -447,7 +447,7 @@ mm_common_cinterion_setup_gps_port (MMBroadbandModem *self)
         mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                        mm_base_modem_peek_best_at_port (MM_BASE_MODEM (self), NULL),
                                        "AT^SGPSS=0",
-                                       3, FALSE, FALSE, NULL, NULL, NULL);
+                                       3000, FALSE, FALSE, NULL, NULL, NULL);
 
         /* Add handler for the NMEA traces */
         mm_port_serial_gps_add_trace_handler (gps_data_port,
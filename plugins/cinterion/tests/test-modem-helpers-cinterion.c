@@ -367,6 +367,8 @@ test_sind_response_simstatus (void)
 
 /*****************************************************************************/
 
+MM_LOG_DEFINE_LEVELS (LOGL_ALL);
+
 void
 _mm_log (const char *loc,
          const char *func,
@@ -245,7 +245,7 @@ custom_init_step (CustomInitContext *ctx)
         ctx->gmi_retries--;
         mm_port_serial_at_command (ctx->port,
                                    "AT+GMI",
-                                   3,
+                                   3000,
                                    FALSE, /* raw */
                                    FALSE, /* allow_cached */
                                    ctx->cancellable,
@@ -258,7 +258,7 @@ custom_init_step (CustomInitContext *ctx)
         ctx->cgmi_retries--;
         mm_port_serial_at_command (ctx->port,
                                    "AT+CGMI",
-                                   3,
+                                   3000,
                                    FALSE, /* raw */
                                    FALSE, /* allow_cached */
                                    ctx->cancellable,
@@ -272,7 +272,7 @@ custom_init_step (CustomInitContext *ctx)
         /* Note: in Ericsson devices, ATI3 seems to reply the vendor string */
         mm_port_serial_at_command (ctx->port,
                                    "ATI1I2I3",
-                                   3,
+                                   3000,
                                    FALSE, /* raw */
                                    FALSE, /* allow_cached */
                                    ctx->cancellable,
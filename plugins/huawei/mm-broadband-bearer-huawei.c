@@ -241,7 +241,7 @@ connect_3gpp_context_step (Connect3gppContext *ctx)
             mm_base_modem_at_command_full (ctx->modem,
                                            ctx->primary,
                                            "^NDISDUP=1,0",
-                                           3,
+                                           3000,
                                            FALSE,
                                            FALSE,
                                            NULL,
@@ -329,7 +329,7 @@ connect_3gpp_context_step (Connect3gppContext *ctx)
         mm_base_modem_at_command_full (ctx->modem,
                                        ctx->primary,
                                        command,
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE,
                                        NULL,
@@ -372,7 +372,7 @@ connect_3gpp_context_step (Connect3gppContext *ctx)
         mm_base_modem_at_command_full (ctx->modem,
                                        ctx->primary,
                                        "^NDISSTATQRY?",
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE,
                                        NULL,
@@ -605,7 +605,7 @@ disconnect_3gpp_context_step (Disconnect3gppContext *ctx)
         mm_base_modem_at_command_full (ctx->modem,
                                        ctx->primary,
                                        "^NDISDUP=1,0",
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE,
                                        NULL,
@@ -643,7 +643,7 @@ disconnect_3gpp_context_step (Disconnect3gppContext *ctx)
         mm_base_modem_at_command_full (ctx->modem,
                                        ctx->primary,
                                        "^NDISSTATQRY?",
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE,
                                        NULL,
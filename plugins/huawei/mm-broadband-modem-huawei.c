@@ -264,7 +264,7 @@ run_sysinfo (MMBroadbandModemHuawei *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "^SYSINFO",
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)run_sysinfo_ready,
                               result);
@@ -333,7 +333,7 @@ run_sysinfoex (MMBroadbandModemHuawei *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "^SYSINFOEX",
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)run_sysinfoex_ready,
                               result);
@@ -386,7 +386,7 @@ reset (MMIfaceModem *self,
 
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               command,
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -691,7 +691,7 @@ load_unlock_retries (MMIfaceModem *self,
     mm_dbg ("loading unlock retries (huawei)...");
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "^CPIN?",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -868,7 +868,7 @@ load_current_bands (MMIfaceModem *self,
     mm_dbg ("loading current bands (huawei)...");
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "^SYSCFG?",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -936,7 +936,7 @@ set_current_bands (MMIfaceModem *self,
     cmd = g_strdup_printf ("AT^SYSCFG=16,3,%X,2,4", huawei_band);
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               cmd,
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)syscfg_set_ready,
                               result);
@@ -1082,7 +1082,7 @@ syscfgex_test_ready (MMBroadbandModemHuawei *self,
     /* Try with SYSCFG */
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "^SYSCFG=?",
-                              3,
+                              3000,
                               TRUE,
                               (GAsyncReadyCallback)syscfg_test_ready,
                               simple);
@@ -1158,7 +1158,7 @@ load_supported_modes (MMIfaceModem *_self,
         self->priv->syscfgex_support = FEATURE_NOT_SUPPORTED;
         mm_base_modem_at_command (MM_BASE_MODEM (self),
                                   "^PREFMODE=?",
-                                  3,
+                                  3000,
                                   TRUE,
                                   (GAsyncReadyCallback)prefmode_test_ready,
                                   result);
@@ -1169,7 +1169,7 @@ load_supported_modes (MMIfaceModem *_self,
     self->priv->prefmode_support = FEATURE_NOT_SUPPORTED;
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "^SYSCFGEX=?",
-                              3,
+                              3000,
                               TRUE,
                               (GAsyncReadyCallback)syscfgex_test_ready,
                               result);
@@ -1301,7 +1301,7 @@ load_current_modes (MMIfaceModem *_self,
         mm_base_modem_at_command (
             MM_BASE_MODEM (self),
             "^SYSCFGEX?",
-            3,
+            3000,
             FALSE,
             (GAsyncReadyCallback)syscfgex_load_current_modes_ready,
             result);
@@ -1313,7 +1313,7 @@ load_current_modes (MMIfaceModem *_self,
         mm_base_modem_at_command (
             MM_BASE_MODEM (self),
             "^SYSCFG?",
-            3,
+            3000,
             FALSE,
             (GAsyncReadyCallback)syscfg_load_current_modes_ready,
             result);
@@ -1325,7 +1325,7 @@ load_current_modes (MMIfaceModem *_self,
         mm_base_modem_at_command (
             MM_BASE_MODEM (self),
             "^PREFMODE?",
-            3,
+            3000,
             FALSE,
             (GAsyncReadyCallback)prefmode_load_current_modes_ready,
             result);
@@ -1403,7 +1403,7 @@ prefmode_set_current_modes (MMBroadbandModemHuawei *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         command,
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)set_current_modes_ready,
         simple);
@@ -1448,7 +1448,7 @@ syscfg_set_current_modes (MMBroadbandModemHuawei *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         command,
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)set_current_modes_ready,
         simple);
@@ -1492,7 +1492,7 @@ syscfgex_set_current_modes (MMBroadbandModemHuawei *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         command,
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)set_current_modes_ready,
         simple);
@@ -1898,8 +1898,8 @@ own_enable_unsolicited_events_ready (MMBaseModem *self,
 static const MMBaseModemAtCommand unsolicited_enable_sequence[] = {
     /* With ^PORTSEL we specify whether we want the PCUI port (0) or the
      * modem port (1) to receive the unsolicited messages */
-    { "^PORTSEL=0", 5, FALSE, NULL },
-    { "^CURC=1",    3, FALSE, NULL },
+    { "^PORTSEL=0", 5000, FALSE, NULL },
+    { "^CURC=1",    3000, FALSE, NULL },
     { NULL }
 };
 
@@ -2012,7 +2012,7 @@ modem_3gpp_disable_unsolicited_events (MMIfaceModem3gpp *self,
         MM_BASE_MODEM (self),
         mm_base_modem_peek_port_primary (MM_BASE_MODEM (self)),
         "^CURC=0",
-        5,
+        5000,
         FALSE, /* allow_cached */
         FALSE, /* raw */
         NULL, /* cancellable */
@@ -2055,7 +2055,7 @@ modem_3gpp_load_operator_name (MMIfaceModem3gpp *self,
     mm_dbg ("loading Operator Name (huawei)...");
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+COPS=3,0;+COPS?",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -2479,7 +2479,7 @@ modem_load_signal_quality (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         command,
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)signal_ready,
         result);
@@ -3122,7 +3122,7 @@ own_voice_enable_unsolicited_events_ready (MMBaseModem *self,
 
 static const MMBaseModemAtCommand unsolicited_voice_enable_sequence[] = {
     /* With ^DDTMFCFG we active the DTMF Decoder */
-    { "^DDTMFCFG=0,1", 3, FALSE, NULL },
+    { "^DDTMFCFG=0,1", 3000, FALSE, NULL },
     { NULL }
 };
 
@@ -3199,7 +3199,7 @@ own_voice_disable_unsolicited_events_ready (MMBaseModem *self,
 
 static const MMBaseModemAtCommand unsolicited_voice_disable_sequence[] = {
     /* With ^DDTMFCFG we deactivate the DTMF Decoder */
-    { "^DDTMFCFG=1,0", 3, FALSE, NULL },
+    { "^DDTMFCFG=1,0", 3000, FALSE, NULL },
     { NULL }
 };
 
@@ -3305,7 +3305,7 @@ modem_time_load_network_time_or_zone (MMIfaceModemTime *_self,
 
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               command,
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -3458,7 +3458,7 @@ load_power_state (MMIfaceModem *self,
                                                            FALSE /* enable */);
         mm_base_modem_at_command (MM_BASE_MODEM (self),
                                   "^RFSWITCH?",
-                                  3,
+                                  3000,
                                   FALSE,
                                   (GAsyncReadyCallback)huawei_rfswitch_check_ready,
                                   result);
@@ -3496,7 +3496,7 @@ huawei_modem_power_up (MMIfaceModem *self,
     case FEATURE_NOT_SUPPORTED:
         mm_base_modem_at_command (MM_BASE_MODEM (self),
                                   "+CFUN=1",
-                                  30,
+                                  30000,
                                   FALSE,
                                   callback,
                                   user_data);
@@ -3504,7 +3504,7 @@ huawei_modem_power_up (MMIfaceModem *self,
     case FEATURE_SUPPORTED:
         mm_base_modem_at_command (MM_BASE_MODEM (self),
                                   "^RFSWITCH=1",
-                                  30,
+                                  30000,
                                   FALSE,
                                   callback,
                                   user_data);
@@ -3537,7 +3537,7 @@ huawei_modem_power_down (MMIfaceModem *self,
          * thus we use +CFUN=0 to put the modem in low power state. */
         mm_base_modem_at_command (MM_BASE_MODEM (self),
                                   "+CFUN=0",
-                                  30,
+                                  30000,
                                   FALSE,
                                   callback,
                                   user_data);
@@ -3545,7 +3545,7 @@ huawei_modem_power_down (MMIfaceModem *self,
     case FEATURE_SUPPORTED:
         mm_base_modem_at_command (MM_BASE_MODEM (self),
                                   "^RFSWITCH=0",
-                                  30,
+                                  30000,
                                   FALSE,
                                   callback,
                                   user_data);
@@ -3731,7 +3731,7 @@ disable_location_gathering (MMIfaceModemLocation *_self,
         mm_base_modem_at_command_full (MM_BASE_MODEM (_self),
                                        mm_base_modem_peek_port_primary (MM_BASE_MODEM (_self)),
                                        "^WPEND",
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE, /* raw */
                                        NULL, /* cancellable */
@@ -3784,7 +3784,7 @@ gps_enabled_ready (MMBaseModem *self,
        mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                       mm_base_modem_peek_port_primary (MM_BASE_MODEM (self)),
                                       gps_startup[ctx->idx],
-                                      3,
+                                      3000,
                                       FALSE,
                                       FALSE, /* raw */
                                       NULL, /* cancellable */
@@ -3846,7 +3846,7 @@ parent_enable_location_gathering_ready (MMIfaceModemLocation *self,
         mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                        mm_base_modem_peek_port_primary (MM_BASE_MODEM (self)),
                                        gps_startup[ctx->idx],
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE, /* raw */
                                        NULL, /* cancellable */
@@ -3940,8 +3940,8 @@ modem_check_time_reply (MMBaseModem *_self,
 }
 
 static const MMBaseModemAtCommand time_cmd_sequence[] = {
-    { "^NTCT?", 3, FALSE, modem_check_time_reply }, /* 3GPP/LTE */
-    { "^TIME",  3, FALSE, modem_check_time_reply }, /* CDMA */
+    { "^NTCT?", 3000, FALSE, modem_check_time_reply }, /* 3GPP/LTE */
+    { "^TIME",  3000, FALSE, modem_check_time_reply }, /* CDMA */
     { NULL }
 };
 
@@ -4079,7 +4079,7 @@ setup_ports (MMBroadbandModem *self)
         mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                        mm_base_modem_peek_port_primary (MM_BASE_MODEM (self)),
                                        "^WPEND",
-                                       3, FALSE, FALSE, NULL, NULL, NULL);
+                                       3000, FALSE, FALSE, NULL, NULL, NULL);
         /* Add handler for the NMEA traces */
         mm_port_serial_gps_add_trace_handler (gps_data_port,
                                               (MMPortSerialGpsTraceFn)gps_trace_received,
@@ -4113,54 +4113,54 @@ mm_broadband_modem_huawei_init (MMBroadbandModemHuawei *self)
                                               MM_TYPE_BROADBAND_MODEM_HUAWEI,
                                               MMBroadbandModemHuaweiPrivate);
     /* Prepare regular expressions to setup */
-    self->priv->rssi_regex = g_regex_new ("\\r\\n\\^RSSI:\\s*(\\d+)\\r\\n",
-                                           G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->rssilvl_regex = g_regex_new ("\\r\\n\\^RSSILVL:\\s*(\\d+)\\r+\\n",
-                                             G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->hrssilvl_regex = g_regex_new ("\\r\\n\\^HRSSILVL:\\s*(\\d+)\\r+\\n",
-                                              G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->rssi_regex = mm_regex_registry_get ("\\r\\n\\^RSSI:\\s*(\\d+)\\r\\n",
+                                                    G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->rssilvl_regex = mm_regex_registry_get ("\\r\\n\\^RSSILVL:\\s*(\\d+)\\r+\\n",
+                                                       G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->hrssilvl_regex = mm_regex_registry_get ("\\r\\n\\^HRSSILVL:\\s*(\\d+)\\r+\\n",
+                                                        G_REGEX_RAW | G_REGEX_OPTIMIZE);
 
     /* 3GPP: <cr><lf>^MODE:5<cr><lf>
      * CDMA: <cr><lf>^MODE: 2<cr><cr><lf>
      */
-    self->priv->mode_regex = g_regex_new ("\\r\\n\\^MODE:\\s*(\\d*),?(\\d*)\\r+\\n",
-                                          G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->dsflowrpt_regex = g_regex_new ("\\r\\n\\^DSFLOWRPT:(.+)\\r\\n",
-                                               G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->ndisstat_regex = g_regex_new ("\\r\\n(\\^NDISSTAT:.+)\\r+\\n",
-                                              G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->boot_regex = g_regex_new ("\\r\\n\\^BOOT:.+\\r\\n",
-                                          G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->connect_regex = g_regex_new ("\\r\\n\\^CONNECT .+\\r\\n",
-                                          G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->csnr_regex = g_regex_new ("\\r\\n\\^CSNR:.+\\r\\n",
-                                          G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->cusatp_regex = g_regex_new ("\\r\\n\\+CUSATP:.+\\r\\n",
-                                            G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->cusatend_regex = g_regex_new ("\\r\\n\\+CUSATEND\\r\\n",
-                                              G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->dsdormant_regex = g_regex_new ("\\r\\n\\^DSDORMANT:.+\\r\\n",
-                                               G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->simst_regex = g_regex_new ("\\r\\n\\^SIMST:.+\\r\\n",
-                                           G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->srvst_regex = g_regex_new ("\\r\\n\\^SRVST:.+\\r\\n",
-                                           G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->stin_regex = g_regex_new ("\\r\\n\\^STIN:.+\\r\\n",
-                                          G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->hcsq_regex = g_regex_new ("\\r\\n\\^HCSQ:.+\\r+\\n",
-                                          G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->pdpdeact_regex = g_regex_new ("\\r\\n\\^PDPDEACT:.+\\r+\\n",
-                                              G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->ndisend_regex = g_regex_new ("\\r\\n\\^NDISEND:.+\\r+\\n",
-                                             G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->rfswitch_regex = g_regex_new ("\\r\\n\\^RFSWITCH:.+\\r\\n",
-                                              G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->position_regex = g_regex_new ("\\r\\n\\^POSITION:.+\\r\\n",
-                                              G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->posend_regex = g_regex_new ("\\r\\n\\^POSEND:.+\\r\\n",
-                                            G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->ecclist_regex = g_regex_new ("\\r\\n\\^ECCLIST:.+\\r\\n",
-                                             G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->mode_regex = mm_regex_registry_get ("\\r\\n\\^MODE:\\s*(\\d*),?(\\d*)\\r+\\n",
+                                                    G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->dsflowrpt_regex = mm_regex_registry_get ("\\r\\n\\^DSFLOWRPT:(.+)\\r\\n",
+                                                         G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->ndisstat_regex = mm_regex_registry_get ("\\r\\n(\\^NDISSTAT:.+)\\r+\\n",
+                                                        G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->boot_regex = mm_regex_registry_get ("\\r\\n\\^BOOT:.+\\r\\n",
+                                                    G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->connect_regex = mm_regex_registry_get ("\\r\\n\\^CONNECT .+\\r\\n",
+                                                       G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->csnr_regex = mm_regex_registry_get ("\\r\\n\\^CSNR:.+\\r\\n",
+                                                    G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->cusatp_regex = mm_regex_registry_get ("\\r\\n\\+CUSATP:.+\\r\\n",
+                                                      G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->cusatend_regex = mm_regex_registry_get ("\\r\\n\\+CUSATEND\\r\\n",
+                                                        G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->dsdormant_regex = mm_regex_registry_get ("\\r\\n\\^DSDORMANT:.+\\r\\n",
+                                                         G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->simst_regex = mm_regex_registry_get ("\\r\\n\\^SIMST:.+\\r\\n",
+                                                     G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->srvst_regex = mm_regex_registry_get ("\\r\\n\\^SRVST:.+\\r\\n",
+                                                     G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->stin_regex = mm_regex_registry_get ("\\r\\n\\^STIN:.+\\r\\n",
+                                                    G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->hcsq_regex = mm_regex_registry_get ("\\r\\n\\^HCSQ:.+\\r+\\n",
+                                                    G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->pdpdeact_regex = mm_regex_registry_get ("\\r\\n\\^PDPDEACT:.+\\r+\\n",
+                                                        G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->ndisend_regex = mm_regex_registry_get ("\\r\\n\\^NDISEND:.+\\r+\\n",
+                                                       G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->rfswitch_regex = mm_regex_registry_get ("\\r\\n\\^RFSWITCH:.+\\r\\n",
+                                                        G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->position_regex = mm_regex_registry_get ("\\r\\n\\^POSITION:.+\\r\\n",
+                                                        G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->posend_regex = mm_regex_registry_get ("\\r\\n\\^POSEND:.+\\r\\n",
+                                                      G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->ecclist_regex = mm_regex_registry_get ("\\r\\n\\^ECCLIST:.+\\r\\n",
+                                                       G_REGEX_RAW | G_REGEX_OPTIMIZE);
 
     /* Voice related regex
      * <CR><LF>^ORIG: <call_x>,<call_type><CR><LF>
@@ -4168,28 +4168,28 @@ mm_broadband_modem_huawei_init (MMBroadbandModemHuawei *self)
      * <CR><LF>^CONN: <call_x>,<call_type><CR><LF>
      * <CR><LF>^CEND: <call_x>,<duration>,<end_status>[,<cc_cause>]<CR><LF>
      */
-    self->priv->orig_regex = g_regex_new ("\\r\\n\\^ORIG:\\s*(\\d+),(\\d+)\\r\\n",
-                                              G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->conf_regex = g_regex_new ("\\r\\n\\^CONF:\\s*(\\d+)\\r\\n",
-                                              G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->conn_regex = g_regex_new ("\\r\\n\\^CONN:\\s*(\\d+),(\\d+)\\r\\n",
-                                              G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->cend_regex = g_regex_new ("\\r\\n\\^CEND:\\s*(\\d+),\\s*(\\d+),\\s*(\\d+),?\\s*(\\d*)\\r\\n",
-                                              G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->orig_regex = mm_regex_registry_get ("\\r\\n\\^ORIG:\\s*(\\d+),(\\d+)\\r\\n",
+                                                    G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->conf_regex = mm_regex_registry_get ("\\r\\n\\^CONF:\\s*(\\d+)\\r\\n",
+                                                    G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->conn_regex = mm_regex_registry_get ("\\r\\n\\^CONN:\\s*(\\d+),(\\d+)\\r\\n",
+                                                    G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->cend_regex = mm_regex_registry_get ("\\r\\n\\^CEND:\\s*(\\d+),\\s*(\\d+),\\s*(\\d+),?\\s*(\\d*)\\r\\n",
+                                                    G_REGEX_RAW | G_REGEX_OPTIMIZE);
 
     /* Voice: receive DTMF regex
      * <CR><LF>^DDTMF: <key><CR><LF>
      * Key should be 0-9, A-D, *, #
      */
-    self->priv->ddtmf_regex = g_regex_new ("\\r\\n\\^DDTMF:\\s*([0-9A-D\\*\\#])\\r\\n",
-                                              G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->ddtmf_regex = mm_regex_registry_get ("\\r\\n\\^DDTMF:\\s*([0-9A-D\\*\\#])\\r\\n",
+                                                     G_REGEX_RAW | G_REGEX_OPTIMIZE);
 
     /* Voice: Unknown message that's broke ATA command
      * <CR><LF>^CSCHANNELINFO: <number>,<number><CR><LF>
      * Key should be 0-9, A-D, *, #
      */
-    self->priv->cschannelinfo_regex = g_regex_new ("\\r\\n\\^CSCHANNELINFO:\\s*(\\d+),(\\d+)\\r\\n",
-                                                    G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->cschannelinfo_regex = mm_regex_registry_get ("\\r\\n\\^CSCHANNELINFO:\\s*(\\d+),(\\d+)\\r\\n",
+                                                             G_REGEX_RAW | G_REGEX_OPTIMIZE);
 
 
     self->priv->ndisdup_support = FEATURE_SUPPORT_UNKNOWN;
@@ -126,7 +126,7 @@ call_start (MMBaseCall *self,
     cmd = g_strdup_printf ("ATD%s;", mm_gdbus_call_get_number (MM_GDBUS_CALL (self)));
     mm_base_modem_at_command (ctx->modem,
                               cmd,
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)call_start_ready,
                               ctx);
@@ -281,7 +281,7 @@ huawei_custom_init_step (HuaweiCustomInitContext *ctx)
         mm_port_serial_at_command (
             ctx->port,
             "AT^CURC=0",
-            3,
+            3000,
             FALSE, /* raw */
             FALSE, /* allow_cached */
             ctx->cancellable,
@@ -303,7 +303,7 @@ huawei_custom_init_step (HuaweiCustomInitContext *ctx)
         mm_port_serial_at_command (
             ctx->port,
             "AT^GETPORTMODE",
-            3,
+            3000,
             FALSE, /* raw */
             FALSE, /* allow_cached */
             ctx->cancellable,
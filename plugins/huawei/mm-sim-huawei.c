@@ -119,7 +119,7 @@ load_sim_identifier (MMBaseSim *self,
     mm_base_modem_at_command (
         modem,
         "^ICCID?",
-        5,
+        5000,
         FALSE,
         (GAsyncReadyCallback)iccid_read_ready,
         g_simple_async_result_new (G_OBJECT (self),
@@ -1143,6 +1143,8 @@ test_time (void)
 
 /*****************************************************************************/
 
+MM_LOG_DEFINE_LEVELS (LOGL_ALL);
+
 void
 _mm_log (const char *loc,
          const char *func,
@@ -205,7 +205,7 @@ get_ip_config_3gpp (MMBroadbandBearer *self,
         mm_base_modem_at_command_full (MM_BASE_MODEM (modem),
                                        primary,
                                        command,
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE, /* raw */
                                        NULL, /* cancellable */
@@ -403,7 +403,7 @@ disconnect_3gpp (MMBroadbandBearer *bearer,
         MM_BASE_MODEM (modem),
         primary,
         command,
-        60,
+        60000,
         FALSE,
         FALSE, /* raw */
         NULL, /* cancellable */
@@ -500,7 +500,7 @@ connect_reset (Dial3gppContext *ctx)
     mm_base_modem_at_command_full (ctx->modem,
                                    ctx->primary,
                                    command,
-                                   3,
+                                   3000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -681,7 +681,7 @@ report_connect_status (MMBroadbandBearerIcera *self,
             ctx->modem,
             ctx->primary,
             "%IER?",
-            60,
+            60000,
             FALSE,
             FALSE, /* raw */
             NULL, /* cancellable */
@@ -780,7 +780,7 @@ deactivate_ready (MMBaseModem *modem,
         ctx->modem,
         ctx->primary,
         command,
-        60,
+        60000,
         FALSE,
         FALSE, /* raw */
         NULL, /* cancellable */
@@ -838,7 +838,7 @@ authenticate_ready (MMBaseModem *modem,
         ctx->modem,
         ctx->primary,
         command,
-        60,
+        60000,
         FALSE,
         FALSE, /* raw */
         NULL, /* cancellable */
@@ -903,7 +903,7 @@ authenticate (Dial3gppContext *ctx)
     mm_base_modem_at_command_full (ctx->modem,
                                    ctx->primary,
                                    command,
-                                   60,
+                                   60000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -216,7 +216,7 @@ load_supported_modes (MMIfaceModem *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "%IPSYS=?",
-                              3,
+                              3000,
                               TRUE,
                               callback,
                               user_data);
@@ -291,7 +291,7 @@ modem_load_current_modes (MMIfaceModem *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "%IPSYS?",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -385,7 +385,7 @@ modem_set_current_modes (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         command,
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)allowed_mode_update_ready,
         result);
@@ -647,7 +647,7 @@ modem_load_access_technologies (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         "%NWSTATE",
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)nwstate_query_ready,
         result);
@@ -779,7 +779,7 @@ parent_enable_unsolicited_events_ready (MMIfaceModem3gpp *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         "%NWSTATE=1",
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)own_enable_unsolicited_events_ready,
         simple);
@@ -844,7 +844,7 @@ modem_3gpp_disable_unsolicited_events (MMIfaceModem3gpp *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         "%NWSTATE=0",
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)own_disable_unsolicited_events_ready,
         g_simple_async_result_new (G_OBJECT (self),
@@ -987,7 +987,7 @@ modem_power_up (MMIfaceModem *self,
 
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CFUN=1",
-                              10,
+                              10000,
                               FALSE,
                               (GAsyncReadyCallback)cfun_enable_ready,
                               result);
@@ -1018,7 +1018,7 @@ modem_power_down (MMIfaceModem *self,
                                * It's better to have a long timeout here than to have the
                                * modem not responding to subsequent AT commands until +CFUN=4
                                * completes. */
-                              40,
+                              40000,
                               FALSE,
                               callback,
                               user_data);
@@ -1042,7 +1042,7 @@ modem_reset (MMIfaceModem *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "%IRESET",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -1110,7 +1110,7 @@ modem_load_unlock_retries (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         "%PINNUM?",
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)load_unlock_retries_ready,
         g_simple_async_result_new (G_OBJECT (self),
@@ -1353,7 +1353,7 @@ load_supported_bands_get_current_bands_ready (MMIfaceModem *self,
         } else {
             /* Check support for disabled band */
             ctx->cmds[i].command = g_strdup_printf ("%%IPBM=\"%s\",0", b->name);
-            ctx->cmds[i].timeout = 10;
+            ctx->cmds[i].timeout_ms = 10000;
             ctx->cmds[i].allow_cached = FALSE;
             ctx->cmds[i].response_processor = load_supported_bands_response_processor;
             i++;
@@ -1382,7 +1382,7 @@ modem_load_supported_bands (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         "%IPBM?",
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)load_supported_bands_get_current_bands_ready,
         g_simple_async_result_new (G_OBJECT (self),
@@ -1451,7 +1451,7 @@ modem_load_current_bands (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         "%IPBM?",
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)load_current_bands_ready,
         g_simple_async_result_new (G_OBJECT (self),
@@ -1551,7 +1551,7 @@ set_one_band (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         command,
-        10,
+        10000,
         FALSE,
         (GAsyncReadyCallback)set_current_bands_next,
         ctx);
@@ -1756,7 +1756,7 @@ modem_time_load_network_timezone (MMIfaceModemTime *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "*TLTS",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -1787,7 +1787,7 @@ modem_time_load_network_time (MMIfaceModemTime *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "*TLTS",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -175,6 +175,8 @@ test_ipdpaddr (void)
 
 /*****************************************************************************/
 
+MM_LOG_DEFINE_LEVELS (LOGL_ALL);
+
 void
 _mm_log (const char *loc,
          const char *func,
@@ -125,7 +125,7 @@ dial_ready (MMBaseModem *modem,
             modem,
             ctx->primary,
             "+CEER",
-            3,
+            3000,
             FALSE,
             FALSE, /* raw */
             NULL, /* cancellable */
@@ -183,7 +183,7 @@ service_type_ready (MMBaseModem *modem,
         modem,
         ctx->primary,
         "ATDT008816000025",
-        60,
+        60000,
         FALSE,
         FALSE, /* raw */
         NULL, /* cancellable */
@@ -224,7 +224,7 @@ connect (MMBaseBearer *self,
         modem,
         ctx->primary,
         "+CBST=71,0,1",
-        3,
+        3000,
         FALSE,
         FALSE, /* raw */
         NULL, /* cancellable */
@@ -105,7 +105,7 @@ messaging_enable_unsolicited_events (MMIfaceModemMessaging *self,
      */
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CNMI=2,1,0,0,1",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -154,7 +154,7 @@ load_signal_quality (MMIfaceModem *self,
      * returns right away the last signal quality value retrieved */
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CSQF",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -210,7 +210,7 @@ setup_flow_control (MMIfaceModem *self,
      */
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "&K3",
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)setup_flow_control_ready,
                               result);
@@ -179,7 +179,7 @@ load_current_modes (MMIfaceModem *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CFUN?",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -265,7 +265,7 @@ set_current_modes (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         command,
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)allowed_mode_update_ready,
         result);
@@ -185,7 +185,7 @@ load_current_modes (MMIfaceModem *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+MODODR?",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -273,7 +273,7 @@ set_current_modes (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         command,
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)allowed_mode_update_ready,
         result);
@@ -310,7 +310,7 @@ load_access_technologies (MMIfaceModem *self,
     mm_dbg ("loading access technology (longcheer)...");
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+PSRAT",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -383,7 +383,7 @@ load_unlock_retries (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         "+CPNNUM",
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)load_unlock_retries_ready,
         g_simple_async_result_new (G_OBJECT (self),
@@ -133,7 +133,7 @@ longcheer_custom_init_step (LongcheerCustomInitContext *ctx)
     mm_port_serial_at_command (
         ctx->port,
         "AT+GMR",
-        3,
+        3000,
         FALSE, /* raw */
         FALSE, /* allow_cached */
         ctx->cancellable,
@@ -279,7 +279,7 @@ poll_timeout_cb (MMBroadbandBearerMbm *self)
     mm_base_modem_at_command_full (ctx->modem,
                                    ctx->primary,
                                    "AT*ENAP?",
-                                   3,
+                                   3000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -353,7 +353,7 @@ activate (Dial3gppContext *ctx)
     mm_base_modem_at_command_full (ctx->modem,
                                    ctx->primary,
                                    command,
-                                   3,
+                                   3000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -412,7 +412,7 @@ authenticate (Dial3gppContext *ctx)
         mm_base_modem_at_command_full (ctx->modem,
                                        ctx->primary,
                                        command,
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE, /* raw */
                                        NULL, /* cancellable */
@@ -616,7 +616,7 @@ get_ip_config_3gpp (MMBroadbandBearer *self,
     mm_base_modem_at_command_full (MM_BASE_MODEM (modem),
                                    primary,
                                    "*E2IPCFG?",
-                                   3,
+                                   3000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -697,7 +697,7 @@ disconnect_3gpp (MMBroadbandBearer *self,
     mm_base_modem_at_command_full (MM_BASE_MODEM (modem),
                                    primary,
                                    "*ENAP=0",
-                                   3,
+                                   3000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
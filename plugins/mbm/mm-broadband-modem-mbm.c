@@ -257,7 +257,7 @@ load_supported_modes (MMIfaceModem *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CFUN=?",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -323,7 +323,7 @@ load_current_modes (MMIfaceModem *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CFUN?",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -425,7 +425,7 @@ set_current_modes (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         command,
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)allowed_mode_update_ready,
         ctx);
@@ -470,9 +470,9 @@ enabling_init_sequence_ready (MMBaseModem *self,
 
 static const MMBaseModemAtCommand enabling_modem_init_sequence[] = {
     /* Init command */
-    { "&F", 3, FALSE, NULL },
+    { "&F", 3000, FALSE, NULL },
     /* Ensure disconnected */
-    { "*ENAP=0", 3, FALSE, NULL },
+    { "*ENAP=0", 3000, FALSE, NULL },
     { NULL }
 };
 
@@ -540,7 +540,7 @@ enabling_modem_init (MMBroadbandModem *self,
 
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "*EMRDY?",
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)emrdy_ready,
                               ctx);
@@ -566,7 +566,7 @@ modem_power_down (MMIfaceModem *self,
      * keeps access to the SIM */
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CFUN=4",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -600,7 +600,7 @@ modem_power_up (MMIfaceModem *_self,
     command = g_strdup_printf ("+CFUN=%u", self->priv->mbm_mode);
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               command,
-                              5,
+                              5000,
                               FALSE,
                               callback,
                               user_data);
@@ -654,7 +654,7 @@ load_power_state (MMIfaceModem *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CFUN?",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -680,7 +680,7 @@ reset (MMIfaceModem *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "*E2RESET",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -701,18 +701,18 @@ factory_reset_finish (MMIfaceModem *self,
 
 static const MMBaseModemAtCommand factory_reset_sequence[] = {
     /* Init command */
-    { "&F +CMEE=0", 3, FALSE, NULL },
-    { "+COPS=0", 3, FALSE, NULL },
-    { "+CR=0", 3, FALSE, NULL },
-    { "+CRC=0", 3, FALSE, NULL },
-    { "+CREG=0", 3, FALSE, NULL },
-    { "+CMER=0", 3, FALSE, NULL },
-    { "*EPEE=0", 3, FALSE, NULL },
-    { "+CNMI=2, 0, 0, 0, 0", 3, FALSE, NULL },
-    { "+CGREG=0", 3, FALSE, NULL },
-    { "*EIAD=0", 3, FALSE, NULL },
-    { "+CGSMS=3", 3, FALSE, NULL },
-    { "+CSCA=\"\",129", 3, FALSE, NULL },
+    { "&F +CMEE=0", 3000, FALSE, NULL },
+    { "+COPS=0", 3000, FALSE, NULL },
+    { "+CR=0", 3000, FALSE, NULL },
+    { "+CRC=0", 3000, FALSE, NULL },
+    { "+CREG=0", 3000, FALSE, NULL },
+    { "+CMER=0", 3000, FALSE, NULL },
+    { "*EPEE=0", 3000, FALSE, NULL },
+    { "+CNMI=2, 0, 0, 0, 0", 3000, FALSE, NULL },
+    { "+CGREG=0", 3000, FALSE, NULL },
+    { "*EIAD=0", 3000, FALSE, NULL },
+    { "+CGSMS=3", 3000, FALSE, NULL },
+    { "+CSCA=\"\",129", 3000, FALSE, NULL },
     { NULL }
 };
 
@@ -785,7 +785,7 @@ load_unlock_retries (MMIfaceModem *self,
     mm_dbg ("loading unlock retries (mbm)...");
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "*EPIN?",
-                              10,
+                              10000,
                               FALSE,
                               callback,
                               user_data);
@@ -1046,8 +1046,8 @@ own_enable_unsolicited_events_ready (MMBaseModem *self,
 }
 
 static const MMBaseModemAtCommand unsolicited_enable_sequence[] = {
-    { "*ERINFO=1", 5, FALSE, NULL },
-    { "*E2NAP=1",  5, FALSE, NULL },
+    { "*ERINFO=1", 5000, FALSE, NULL },
+    { "*E2NAP=1",  5000, FALSE, NULL },
     { NULL }
 };
 
@@ -1144,8 +1144,8 @@ own_disable_unsolicited_events_ready (MMBaseModem *self,
 }
 
 static const MMBaseModemAtCommand unsolicited_disable_sequence[] = {
-    { "*ERINFO=0", 5, FALSE, NULL },
-    { "*E2NAP=0",  5, FALSE, NULL },
+    { "*ERINFO=0", 5000, FALSE, NULL },
+    { "*E2NAP=0",  5000, FALSE, NULL },
     { NULL }
 };
 
@@ -1323,7 +1323,7 @@ disable_location_gathering (MMIfaceModemLocation *_self,
         mm_base_modem_at_command_full (MM_BASE_MODEM (_self),
                                        mm_base_modem_peek_port_primary (MM_BASE_MODEM (_self)),
                                        "AT*E2GPSCTL=0",
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE, /* raw */
                                        NULL, /* cancellable */
@@ -1388,7 +1388,7 @@ gps_enabled_ready (MMBaseModem *self,
             g_byte_array_append (buf, (const guint8 *) command, strlen (command));
             mm_port_serial_command (MM_PORT_SERIAL (gps_port),
                                     buf,
-                                    3,
+                                    3000,
                                     FALSE,
                                     NULL,
                                     NULL,
@@ -1435,7 +1435,7 @@ parent_enable_location_gathering_ready (MMIfaceModemLocation *self,
         mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                        mm_base_modem_peek_port_primary (MM_BASE_MODEM (self)),
                                        "AT*E2GPSCTL=1," MBM_GPS_NMEA_INTERVAL ",0",
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE, /* raw */
                                        NULL, /* cancellable */
@@ -1558,7 +1558,7 @@ setup_ports (MMBroadbandModem *_self)
         mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                        mm_base_modem_peek_port_primary (MM_BASE_MODEM (self)),
                                        "AT*E2GPSCTL=0",
-                                       3, FALSE, FALSE, NULL, NULL, NULL);
+                                       3000, FALSE, FALSE, NULL, NULL, NULL);
         /* Add handler for the NMEA traces */
         mm_port_serial_gps_add_trace_handler (gps_data_port,
                                               (MMPortSerialGpsTraceFn)gps_trace_received,
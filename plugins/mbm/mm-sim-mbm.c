@@ -86,7 +86,7 @@ cpin_query_cb (SendPinPukContext *ctx)
 {
     mm_base_modem_at_command (ctx->modem,
                               "+CPIN?",
-                              20,
+                              20000,
                               FALSE,
                               (GAsyncReadyCallback)cpin_query_ready,
                               ctx);
@@ -157,7 +157,7 @@ common_send_pin_puk (MMBaseSim *self,
                g_strdup_printf ("+CPIN=\"%s\"", pin));
     mm_base_modem_at_command (ctx->modem,
                               command,
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)send_pin_puk_ready,
                               ctx);
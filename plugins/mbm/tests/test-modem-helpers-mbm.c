@@ -190,6 +190,8 @@ test_cfun (void)
 
 /*****************************************************************************/
 
+MM_LOG_DEFINE_LEVELS (LOGL_ALL);
+
 void
 _mm_log (const char *loc,
          const char *func,
@@ -145,7 +145,7 @@ load_unlock_retries (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         "+EPINC?",
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)load_unlock_retries_ready,
         g_simple_async_result_new (G_OBJECT (self),
@@ -314,7 +314,7 @@ load_supported_modes (MMIfaceModem *self,
     mm_base_modem_at_command (
                 MM_BASE_MODEM (self),
                 "+EGMR=0,0",
-                3,
+                3000,
                 FALSE,
                 (GAsyncReadyCallback)get_supported_modes_ready,
                 g_simple_async_result_new (
@@ -454,7 +454,7 @@ load_current_modes (MMIfaceModem *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+ERAT?",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -561,7 +561,7 @@ set_current_modes (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         command,
-        30,
+        30000,
         FALSE,
         (GAsyncReadyCallback)allowed_mode_update_ready,
         result);
@@ -779,13 +779,13 @@ modem_3gpp_cleanup_unsolicited_events (MMIfaceModem3gpp *self,
 
 static const MMBaseModemAtCommand unsolicited_enable_sequence[] = {
     /* enable signal URC */
-    {"+ECSQ=2", 5, FALSE, NULL},
+    {"+ECSQ=2", 5000, FALSE, NULL},
     {NULL}
 };
 
 static const MMBaseModemAtCommand unsolicited_disable_sequence[] = {
     /* disable signal URC */
-    {"+ECSQ=0", 5, FALSE, NULL},
+    {"+ECSQ=0", 5000, FALSE, NULL},
     {NULL}
 };
 
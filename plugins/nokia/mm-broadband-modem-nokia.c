@@ -177,7 +177,7 @@ load_access_technologies (MMIfaceModem *self,
 
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "*CNTI=0",
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)access_tech_ready,
                               result);
@@ -214,7 +214,7 @@ load_supported_charsets (MMIfaceModem *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CSCS=?",
-                              20,
+                              20000,
                               TRUE,
                               callback,
                               user_data);
@@ -284,7 +284,7 @@ retry_atz (EnablingModemInitContext *ctx)
     mm_base_modem_at_command_full (MM_BASE_MODEM (ctx->self),
                                    mm_base_modem_peek_port_primary (MM_BASE_MODEM (ctx->self)),
                                    "Z",
-                                   6,
+                                   6000,
                                    FALSE,
                                    FALSE,
                                    NULL, /* cancellable */
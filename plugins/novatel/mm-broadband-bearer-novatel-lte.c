@@ -155,7 +155,7 @@ poll_connection (MMBroadbandBearerNovatelLte *bearer)
     mm_base_modem_at_command (
         modem,
         "$NWQMISTATUS",
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)poll_connection_ready,
         bearer);
@@ -241,7 +241,7 @@ connect_3gpp_qmistatus (DetailedConnectContext *ctx)
         ctx->modem,
         ctx->primary,
         "$NWQMISTATUS",
-        3, /* timeout */
+        3000, /* timeout */
         FALSE, /* allow_cached */
         FALSE, /* is_raw */
         ctx->cancellable,
@@ -295,7 +295,7 @@ connect_3gpp_authenticate (DetailedConnectContext *ctx)
         ctx->modem,
         ctx->primary,
         command,
-        10, /* timeout */
+        10000, /* timeout */
         FALSE, /* allow_cached */
         FALSE, /* is_raw */
         ctx->cancellable,
@@ -457,7 +457,7 @@ disconnect_3gpp_qmistatus (DetailedDisconnectContext *ctx)
         ctx->modem,
         ctx->primary,
         "$NWQMISTATUS",
-        3, /* timeout */
+        3000, /* timeout */
         FALSE, /* allow_cached */
         FALSE, /* is_raw */
         NULL, /* cancellable */
@@ -507,7 +507,7 @@ disconnect_3gpp (MMBroadbandBearer *self,
         ctx->modem,
         ctx->primary,
         "$NWQMIDISCONNECT",
-        10, /* timeout */
+        10000, /* timeout */
         FALSE, /* allow_cached */
         FALSE, /* is_raw */
         NULL, /* cancellable */
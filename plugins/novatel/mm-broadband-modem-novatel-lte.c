@@ -60,7 +60,7 @@ modem_power_down (MMIfaceModem *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CFUN=4",
-                              6,
+                              6000,
                               FALSE,
                               callback,
                               user_data);
@@ -265,8 +265,8 @@ response_processor_nwmdn_ignore_at_errors (MMBaseModem *self,
 }
 
 static const MMBaseModemAtCommand own_numbers_commands[] = {
-    { "+CNUM",  3, TRUE, response_processor_cnum_ignore_at_errors },
-    { "$NWMDN", 3, TRUE, response_processor_nwmdn_ignore_at_errors },
+    { "+CNUM",  3000, TRUE, response_processor_cnum_ignore_at_errors },
+    { "$NWMDN", 3000, TRUE, response_processor_nwmdn_ignore_at_errors },
     { NULL }
 };
 
@@ -437,7 +437,7 @@ load_current_bands (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         "$NWBAND?",
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)load_current_bands_done,
         result);
@@ -517,7 +517,7 @@ load_access_technologies (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         "$NWSYSMODE",
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)load_access_technologies_ready,
         result);
@@ -541,7 +541,7 @@ reset (MMIfaceModem *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CFUN=6",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -631,7 +631,7 @@ scan_networks (MMIfaceModem3gpp *self,
 
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+COPS=?",
-                              120,
+                              120000,
                               FALSE,
                               (GAsyncReadyCallback)cops_query_ready,
                               result);
@@ -281,7 +281,7 @@ load_current_modes (MMIfaceModem *self,
 
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "$NWRAT?",
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)nwrat_query_ready,
                               result);
@@ -389,7 +389,7 @@ set_current_modes (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         command,
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)allowed_mode_update_ready,
         result);
@@ -519,7 +519,7 @@ nw_snapshot_new_cb (MMPortSerialQcdm *port,
     g_assert (nwsnap->len);
     mm_port_serial_qcdm_command (port,
                                  nwsnap,
-                                 3,
+                                 3000,
                                  NULL,
                                  (GAsyncReadyCallback)nw_snapshot_old_cb,
                                  ctx);
@@ -554,7 +554,7 @@ get_nw_modem_snapshot (MMBaseModem *self,
     g_assert (nwsnap->len);
     mm_port_serial_qcdm_command (port,
                                  nwsnap,
-                                 3,
+                                 3000,
                                  NULL,
                                  (GAsyncReadyCallback)nw_snapshot_new_cb,
                                  ctx);
@@ -699,7 +699,7 @@ modem_load_access_technologies (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         "$CNTI=0",
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)cnti_set_ready,
         result);
@@ -859,7 +859,7 @@ modem_load_signal_quality (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         "$NWRSSI",
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)nwrssi_ready,
         result);
@@ -884,7 +884,7 @@ messaging_enable_unsolicited_events (MMIfaceModemMessaging *self,
     /* Many Qualcomm chipsets don't support mode=2 */
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CNMI=1,1,2,1,0",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -1046,7 +1046,7 @@ reg_eri_6800_cb (MMPortSerialQcdm *port,
             g_assert (nweri->len);
             mm_port_serial_qcdm_command (port,
                                          nweri,
-                                         3,
+                                         3000,
                                          NULL,
                                          (GAsyncReadyCallback)reg_eri_6500_cb,
                                          ctx);
@@ -1089,7 +1089,7 @@ modem_cdma_get_detailed_registration_state (MMIfaceModemCdma *self,
     g_assert (nweri->len);
     mm_port_serial_qcdm_command (port,
                                  nweri,
-                                 3,
+                                 3000,
                                  NULL,
                                  (GAsyncReadyCallback)reg_eri_6800_cb,
                                  ctx);
@@ -1187,7 +1187,7 @@ modem_time_load_network_time (MMIfaceModemTime *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "$NWLTIME",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -1217,7 +1217,7 @@ modem_time_load_network_timezone (MMIfaceModemTime *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "$NWLTIME",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -1242,7 +1242,7 @@ modem_time_check_support (MMIfaceModemTime *self,
     /* Only CDMA devices support this at the moment */
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "$NWLTIME",
-                              3,
+                              3000,
                               TRUE,
                               callback,
                               user_data);
@@ -118,7 +118,7 @@ custom_init_step (CustomInitContext *ctx)
         ctx->nwdmat_retries--;
         mm_port_serial_at_command (ctx->port,
                                    "$NWDMAT=1",
-                                   3,
+                                   3000,
                                    FALSE, /* raw */
                                    FALSE, /* allow_cached */
                                    ctx->cancellable,
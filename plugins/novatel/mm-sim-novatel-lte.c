@@ -190,7 +190,7 @@ load_imsi (MMBaseSim *self,
     mm_base_modem_at_command (
         modem,
         "+CRSM=176,28423,0,0,9",
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)imsi_read_ready,
         g_simple_async_result_new (G_OBJECT (self),
@@ -209,7 +209,7 @@ get_ip_config_3gpp (MMBroadbandBearer *self,
         MM_BASE_MODEM (modem),
         primary,
         command,
-        3,
+        3000,
         FALSE,
         FALSE, /* raw */
         NULL, /* cancellable */
@@ -307,7 +307,7 @@ connect_reset (Dial3gppContext *ctx)
     mm_base_modem_at_command_full (ctx->modem,
                                    ctx->primary,
                                    command,
-                                   3,
+                                   3000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -559,7 +559,7 @@ authenticate_ready (MMBaseModem *modem,
     mm_base_modem_at_command_full (ctx->modem,
                                    ctx->primary,
                                    command,
-                                   3,
+                                   3000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -648,7 +648,7 @@ authenticate (Dial3gppContext *ctx)
     mm_base_modem_at_command_full (ctx->modem,
                                    ctx->primary,
                                    command,
-                                   3,
+                                   3000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -776,7 +776,7 @@ disconnect_3gpp (MMBroadbandBearer *self,
     mm_base_modem_at_command_full (MM_BASE_MODEM (modem),
                                    primary,
                                    command,
-                                   3,
+                                   3000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
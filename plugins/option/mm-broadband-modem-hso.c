@@ -202,7 +202,7 @@ load_unlock_retries (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         "_OERCN?",
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)load_unlock_retries_ready,
         g_simple_async_result_new (G_OBJECT (self),
@@ -538,7 +538,7 @@ disable_location_gathering (MMIfaceModemLocation *self,
         mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                        mm_base_modem_peek_port_gps_control (MM_BASE_MODEM (self)),
                                        "_OGPS=0",
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE, /* raw */
                                        NULL, /* cancellable */
@@ -635,7 +635,7 @@ parent_enable_location_gathering_ready (MMIfaceModemLocation *self,
         mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                        mm_base_modem_peek_port_gps_control (MM_BASE_MODEM (self)),
                                        "_OGPS=2",
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE, /* raw */
                                        NULL, /* cancellable */
@@ -736,7 +736,7 @@ setup_ports (MMBroadbandModem *self)
         mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                        gps_control_port,
                                        "_OGPS=0",
-                                       3, FALSE, FALSE, NULL, NULL, NULL);
+                                       3000, FALSE, FALSE, NULL, NULL, NULL);
 
         /* Add handler for the NMEA traces */
         mm_port_serial_gps_add_trace_handler (gps_data_port,
@@ -208,7 +208,7 @@ load_current_modes (MMIfaceModem *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "_OPSYS?",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -297,7 +297,7 @@ set_current_modes (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         command,
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)allowed_mode_update_ready,
         result);
@@ -571,7 +571,7 @@ load_access_technologies_step (AccessTechnologiesContext *ctx)
     case ACCESS_TECHNOLOGIES_STEP_OSSYS:
         mm_base_modem_at_command (MM_BASE_MODEM (ctx->self),
                                   "_OSSYS?",
-                                  3,
+                                  3000,
                                   FALSE,
                                   (GAsyncReadyCallback)ossys_query_ready,
                                   ctx);
@@ -581,7 +581,7 @@ load_access_technologies_step (AccessTechnologiesContext *ctx)
         if (ctx->check_2g) {
             mm_base_modem_at_command (MM_BASE_MODEM (ctx->self),
                                       "_OCTI?",
-                                      3,
+                                      3000,
                                       FALSE,
                                       (GAsyncReadyCallback)octi_query_ready,
                                       ctx);
@@ -594,7 +594,7 @@ load_access_technologies_step (AccessTechnologiesContext *ctx)
         if (ctx->check_3g) {
             mm_base_modem_at_command (MM_BASE_MODEM (ctx->self),
                                       "_OWCTI?",
-                                      3,
+                                      3000,
                                       FALSE,
                                       (GAsyncReadyCallback)owcti_query_ready,
                                       ctx);
@@ -736,7 +736,7 @@ modem_3gpp_load_imei (MMIfaceModem3gpp *self,
     mm_dbg ("loading (Option) IMEI...");
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CGSN",
-                              3,
+                              3000,
                               TRUE,
                               callback,
                               user_data);
@@ -1002,10 +1002,10 @@ own_enable_unsolicited_events_ready (MMBaseModem *self,
 }
 
 static const MMBaseModemAtCommand unsolicited_enable_sequence[] = {
-    { "_OSSYS=1",  3, FALSE, NULL },
-    { "_OCTI=1",   3, FALSE, NULL },
-    { "_OUWCTI=1", 3, FALSE, NULL },
-    { "_OSQI=1",   3, FALSE, NULL },
+    { "_OSSYS=1",  3000, FALSE, NULL },
+    { "_OCTI=1",   3000, FALSE, NULL },
+    { "_OUWCTI=1", 3000, FALSE, NULL },
+    { "_OSQI=1",   3000, FALSE, NULL },
     { NULL }
 };
 
@@ -1065,10 +1065,10 @@ modem_3gpp_disable_unsolicited_events_finish (MMIfaceModem3gpp *self,
 }
 
 static const MMBaseModemAtCommand unsolicited_disable_sequence[] = {
-    { "_OSSYS=0",  3, FALSE, NULL },
-    { "_OCTI=0",   3, FALSE, NULL },
-    { "_OUWCTI=0", 3, FALSE, NULL },
-    { "_OSQI=0",   3, FALSE, NULL },
+    { "_OSSYS=0",  3000, FALSE, NULL },
+    { "_OCTI=0",   3000, FALSE, NULL },
+    { "_OUWCTI=0", 3000, FALSE, NULL },
+    { "_OSQI=0",   3000, FALSE, NULL },
     { NULL }
 };
 
@@ -187,7 +187,7 @@ dial_3gpp_context_step (Dial3gppContext *ctx)
         mm_base_modem_at_command_full (ctx->modem,
                                        ctx->primary,
                                        "+CGATT=1",
-                                       10,
+                                       10000,
                                        FALSE,
                                        FALSE, /* raw */
                                        NULL, /* cancellable */
@@ -264,7 +264,7 @@ dial_3gpp_context_step (Dial3gppContext *ctx)
             mm_base_modem_at_command_full (ctx->modem,
                                            ctx->primary,
                                            command,
-                                           3,
+                                           3000,
                                            FALSE,
                                            FALSE, /* raw */
                                            NULL, /* cancellable */
@@ -287,7 +287,7 @@ dial_3gpp_context_step (Dial3gppContext *ctx)
             mm_base_modem_at_command_full (ctx->modem,
                                            ctx->primary,
                                            command,
-                                           10,
+                                           10000,
                                            FALSE,
                                            FALSE, /* raw */
                                            NULL, /* cancellable */
@@ -419,7 +419,7 @@ disconnect_3gpp (MMBroadbandBearer *self,
         mm_base_modem_at_command_full (MM_BASE_MODEM (modem),
                                        primary,
                                        command,
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE, /* raw */
                                        NULL, /* cancellable */
@@ -111,7 +111,7 @@ load_unlock_retries (MMIfaceModem *self,
     mm_dbg ("loading unlock retries (sierra)...");
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CPINC?",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -495,7 +495,7 @@ load_access_technologies (MMIfaceModem *self,
     if (mm_iface_modem_is_3gpp (self)) {
         mm_base_modem_at_command (MM_BASE_MODEM (self),
                                   "*CNTI=0",
-                                  3,
+                                  3000,
                                   FALSE,
                                   (GAsyncReadyCallback)access_tech_3gpp_ready,
                                   result);
@@ -505,7 +505,7 @@ load_access_technologies (MMIfaceModem *self,
     if (mm_iface_modem_is_cdma (self)) {
         mm_base_modem_at_command (MM_BASE_MODEM (self),
                                   "!STATUS",
-                                  3,
+                                  3000,
                                   FALSE,
                                   (GAsyncReadyCallback)access_tech_cdma_ready,
                                   result);
@@ -787,7 +787,7 @@ load_current_modes (MMIfaceModem *self,
     mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                    primary,
                                    "!SELRAT?",
-                                   3,
+                                   3000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -912,7 +912,7 @@ set_current_modes (MMIfaceModem *self,
     mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                    primary,
                                    command,
-                                   3,
+                                   3000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -1079,7 +1079,7 @@ modem_load_own_numbers (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         "~NAMVAL?0",
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)own_numbers_ready,
         result);
@@ -1160,7 +1160,7 @@ modem_reset (MMIfaceModem *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "!RESET",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -1208,7 +1208,7 @@ modem_power_down (MMIfaceModem *self,
     if (mm_iface_modem_is_cdma_only (self)) {
         mm_base_modem_at_command (MM_BASE_MODEM (self),
                                   "!pcstate=0",
-                                  5,
+                                  5000,
                                   FALSE,
                                   (GAsyncReadyCallback)modem_power_down_ready,
                                   result);
@@ -1218,7 +1218,7 @@ modem_power_down (MMIfaceModem *self,
     /* For GSM modems, run AT+CFUN=4 (power save) */
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CFUN=4",
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)modem_power_down_ready,
                               result);
@@ -1404,7 +1404,7 @@ get_detailed_registration_state (MMIfaceModemCdma *self,
 
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "!STATUS",
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)status_ready,
                               ctx);
@@ -1525,7 +1525,7 @@ modem_time_load_network_time (MMIfaceModemTime *self,
 
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               command,
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -1594,8 +1594,8 @@ parse_time_reply (MMBaseModem *self,
 }
 
 static const MMBaseModemAtCommand time_check_sequence[] = {
-    { "!TIME?", 3, FALSE, parse_time_reply },    /* 3GPP */
-    { "!SYSTIME?", 3, FALSE, parse_time_reply }, /* CDMA */
+    { "!TIME?", 3000, FALSE, parse_time_reply },    /* 3GPP */
+    { "!SYSTIME?", 3000, FALSE, parse_time_reply }, /* CDMA */
     { NULL }
 };
 
@@ -210,7 +210,7 @@ sierra_custom_init_step (SierraCustomInitContext *ctx)
     mm_port_serial_at_command (
         ctx->port,
         "ATI",
-        3,
+        3000,
         FALSE, /* raw */
         FALSE, /* allow_cached */
         ctx->cancellable,
@@ -328,7 +328,7 @@ mm_common_sierra_modem_power_up (MMIfaceModem *self,
     if (mm_iface_modem_is_cdma_only (self)) {
         mm_base_modem_at_command (MM_BASE_MODEM (self),
                                   "!pcstate=1",
-                                  5,
+                                  5000,
                                   FALSE,
                                   (GAsyncReadyCallback)pcstate_enable_ready,
                                   result);
@@ -343,7 +343,7 @@ mm_common_sierra_modem_power_up (MMIfaceModem *self,
      */
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CFUN=1,0", /* ",0" requests no reset */
-                              10,
+                              10000,
                               FALSE,
                               (GAsyncReadyCallback)cfun_enable_ready,
                               result);
@@ -443,7 +443,7 @@ mm_common_sierra_load_power_state (MMIfaceModem *self,
     if (mm_iface_modem_is_cdma_only (self)) {
         mm_base_modem_at_command (MM_BASE_MODEM (self),
                                   "!pcstate?",
-                                  3,
+                                  3000,
                                   FALSE,
                                   (GAsyncReadyCallback)pcstate_query_ready,
                                   result);
@@ -227,9 +227,9 @@ own_enable_unsolicited_events_ready (MMBaseModem *self,
 
 static const MMBaseModemAtCommand unsolicited_enable_sequence[] = {
     /* Autoreport access technology changes */
-    { "+CNSMOD=1",    5, FALSE, NULL },
+    { "+CNSMOD=1",    5000, FALSE, NULL },
     /* Autoreport CSQ (first arg), and only report when it changes (second arg) */
-    { "+AUTOCSQ=1,1", 5, FALSE, NULL },
+    { "+AUTOCSQ=1,1", 5000, FALSE, NULL },
     { NULL }
 };
 
@@ -289,8 +289,8 @@ modem_3gpp_disable_unsolicited_events_finish (MMIfaceModem3gpp *self,
 }
 
 static const MMBaseModemAtCommand unsolicited_disable_sequence[] = {
-    { "+CNSMOD=0",  3, FALSE, NULL },
-    { "+AUTOCSQ=0", 3, FALSE, NULL },
+    { "+CNSMOD=0",  3000, FALSE, NULL },
+    { "+AUTOCSQ=0", 3000, FALSE, NULL },
     { NULL }
 };
 
@@ -439,7 +439,7 @@ load_access_technologies (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         "AT+CNSMOD?",
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)cnsmod_query_ready,
         result);
@@ -694,7 +694,7 @@ cnaop_query_ready (MMBroadbandModemSimtech *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         "+CNMP?",
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)cnmp_query_ready,
         ctx);
@@ -719,7 +719,7 @@ load_current_modes (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         "+CNAOP?",
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)cnaop_query_ready,
         ctx);
@@ -789,7 +789,7 @@ cnmp_set_ready (MMBaseModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         command,
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)cnaop_set_ready,
         ctx);
@@ -859,7 +859,7 @@ set_current_modes (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         command,
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)cnmp_set_ready,
         ctx);
@@ -150,7 +150,7 @@ modem_set_current_bands (MMIfaceModem *self,
                                      modem_set_current_bands);
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               cmd,
-                              20,
+                              20000,
                               FALSE,
                               (GAsyncReadyCallback)modem_set_current_bands_ready,
                               res);
@@ -239,7 +239,7 @@ modem_load_current_bands (MMIfaceModem *self,
 
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "#BND?",
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback) load_bands_ready,
                               ctx);
@@ -271,7 +271,7 @@ modem_load_supported_bands (MMIfaceModem *self,
 
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "#BND=?",
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback) load_bands_ready,
                               ctx);
@@ -284,7 +284,7 @@ modem_load_supported_bands (MMIfaceModem *self,
 #define CSIM_QUERY_PUK_RETRIES_STR  "+CSIM=10,002C000100"
 #define CSIM_QUERY_PIN2_RETRIES_STR "+CSIM=10,0020008100"
 #define CSIM_QUERY_PUK2_RETRIES_STR "+CSIM=10,002C008100"
-#define CSIM_QUERY_TIMEOUT 3
+#define CSIM_QUERY_TIMEOUT 3000
 
 typedef enum {
     LOAD_UNLOCK_RETRIES_STEP_FIRST,
@@ -475,7 +475,7 @@ modem_power_down (MMIfaceModem *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CFUN=4",
-                              20,
+                              20000,
                               FALSE,
                               callback,
                               user_data);
@@ -499,7 +499,7 @@ modem_reset (MMIfaceModem *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "AT#REBOOT",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -622,8 +622,8 @@ response_processor_service_ignore_at_errors (MMBaseModem *self,
 }
 
 static const MMBaseModemAtCommand access_tech_commands[] = {
-    { "#PSNT?",  3, TRUE, response_processor_psnt_ignore_at_errors },
-    { "+SERVICE?", 3, TRUE, response_processor_service_ignore_at_errors },
+    { "#PSNT?",  3000, TRUE, response_processor_psnt_ignore_at_errors },
+    { "+SERVICE?", 3000, TRUE, response_processor_service_ignore_at_errors },
     { NULL }
 };
 
@@ -674,7 +674,7 @@ setup_flow_control (MMIfaceModem *self,
     cmd = g_strdup_printf ("+IFC=%u,%u", flow_control, flow_control);
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               cmd,
-                              3,
+                              3000,
                               FALSE,
                               NULL,
                               NULL);
@@ -762,7 +762,7 @@ load_current_modes (MMIfaceModem *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+WS46?",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -857,7 +857,7 @@ set_current_modes (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         command,
-        10,
+        10000,
         FALSE,
         (GAsyncReadyCallback)ws46_set_ready,
         result);
@@ -980,9 +980,9 @@ modem_3gpp_enable_unsolicited_events_finish (MMIfaceModem3gpp *self,
 
 static const MMBaseModemAtCommand unsolicited_enable_sequence[] = {
     /* Enable +CIEV only for: signal, service, roam */
-    { "AT+CIND=0,1,1,0,0,0,1,0,0", 5, FALSE, NULL },
+    { "AT+CIND=0,1,1,0,0,0,1,0,0", 5000, FALSE, NULL },
     /* Telit modems +CMER command supports only <ind>=2 */
-    { "+CMER=3,0,0,2", 5, FALSE, NULL },
+    { "+CMER=3,0,0,2", 5000, FALSE, NULL },
     { NULL }
 };
 
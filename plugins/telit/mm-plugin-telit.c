@@ -298,7 +298,7 @@ telit_custom_init_step (TelitCustomInitContext *ctx)
         mm_port_serial_at_command (
             ctx->port,
             "AT#PORTCFG?",
-            2,
+            2000,
             FALSE, /* raw */
             FALSE, /* allow_cached */
             ctx->cancellable,
@@ -374,6 +374,7 @@ mm_plugin_create (void)
                       MM_PLUGIN_ALLOWED_AT,         TRUE,
                       MM_PLUGIN_ALLOWED_UDEV_TAGS,  udev_tags,
                       MM_PLUGIN_CUSTOM_INIT,        &custom_init,
+                      MM_PLUGIN_CONCAT_COMMANDS,    TRUE,
                       NULL));
 }
 
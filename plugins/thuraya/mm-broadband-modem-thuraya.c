@@ -218,7 +218,7 @@ modem_messaging_load_supported_storages (MMIfaceModemMessaging *self,
     /* Check support storages */
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CPMS=?",
-                              3,
+                              3000,
                               TRUE,
                               (GAsyncReadyCallback)cpms_format_check_ready,
                               result);
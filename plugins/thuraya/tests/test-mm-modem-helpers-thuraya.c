@@ -91,6 +91,8 @@ test_cpms_response_thuraya (void *f, gpointer d)
 
 /*****************************************************************************/
 
+MM_LOG_DEFINE_LEVELS (LOGL_ALL);
+
 void
 _mm_log (const char *loc,
          const char *func,
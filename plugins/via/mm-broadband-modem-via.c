@@ -287,7 +287,7 @@ get_detailed_registration_state (MMIfaceModemCdma *self,
 
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "^SYSINFO",
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)sysinfo_ready,
                               ctx);
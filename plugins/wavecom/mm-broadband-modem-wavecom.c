@@ -199,7 +199,7 @@ load_supported_modes (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         "+CGCLASS=?",
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)supported_ms_classes_query_ready,
         g_simple_async_result_new (G_OBJECT (self),
@@ -353,7 +353,7 @@ current_ms_class_ready (MMBaseModem *self,
         /* For 3G devices, query WWSM status */
         mm_base_modem_at_command (MM_BASE_MODEM (self),
                                   "+WWSM?",
-                                  3,
+                                  3000,
                                   FALSE,
                                   (GAsyncReadyCallback)wwsm_read_ready,
                                   simple);
@@ -409,7 +409,7 @@ load_current_modes (MMIfaceModem *self,
 
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CGCLASS?",
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)current_ms_class_ready,
                               result);
@@ -484,7 +484,7 @@ cgclass_update_ready (MMBaseModem *self,
 
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               ctx->wwsm_command,
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)wwsm_update_ready,
                               ctx);
@@ -561,7 +561,7 @@ set_current_modes (MMIfaceModem *self,
 
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               ctx->cgclass_command,
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)cgclass_update_ready,
                               ctx);
@@ -771,14 +771,14 @@ load_current_bands (MMIfaceModem *self,
     if (mm_iface_modem_is_3g (self))
         mm_base_modem_at_command (MM_BASE_MODEM (self),
                                   "AT+WUBS?",
-                                  3,
+                                  3000,
                                   FALSE,
                                   (GAsyncReadyCallback)get_3g_band_ready,
                                   result);
     else
         mm_base_modem_at_command (MM_BASE_MODEM (self),
                                   "AT+WMBS?",
-                                  3,
+                                  3000,
                                   FALSE,
                                   (GAsyncReadyCallback)get_2g_band_ready,
                                   result);
@@ -866,7 +866,7 @@ set_bands_3g (MMIfaceModem *self,
     cmd = g_strdup_printf ("+WMBS=\"%u\",1", wavecom_band);
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               cmd,
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)wmbs_set_ready,
                               result);
@@ -938,7 +938,7 @@ set_bands_2g (MMIfaceModem *self,
     cmd = g_strdup_printf ("+WMBS=%c,1", wavecom_band);
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               cmd,
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)wmbs_set_ready,
                               result);
@@ -1041,7 +1041,7 @@ load_access_technologies (MMIfaceModem *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+WGPRS=9,2",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -1193,7 +1193,7 @@ register_in_network (MMIfaceModem3gpp *self,
         /* Check which is the current operator selection status */
         mm_base_modem_at_command (MM_BASE_MODEM (self),
                                   "+COPS?",
-                                  3,
+                                  3000,
                                   FALSE,
                                   (GAsyncReadyCallback)cops_ready,
                                   ctx);
@@ -1260,7 +1260,7 @@ setup_flow_control (MMIfaceModem *self,
     /* Wavecom doesn't have XOFF/XON flow control, so we enable RTS/CTS */
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+IFC=2,2",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -1290,7 +1290,7 @@ modem_power_up (MMIfaceModem *self,
      */
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CFUN=1,0",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -1316,7 +1316,7 @@ modem_power_down (MMIfaceModem *self,
      * keeps access to the SIM */
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CFUN=4",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -1340,7 +1340,7 @@ modem_power_off (MMIfaceModem *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CPOF=1",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -187,7 +187,7 @@ load_current_modes (MMIfaceModem *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+SYSSEL?",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -272,7 +272,7 @@ set_current_modes (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         command,
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)allowed_mode_update_ready,
         result);
@@ -309,7 +309,7 @@ load_access_technologies (MMIfaceModem *self,
     mm_dbg ("loading access technology (x22x)...");
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+SSND?",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -136,7 +136,7 @@ x22x_custom_init_step (X22xCustomInitContext *ctx)
     mm_port_serial_at_command (
         ctx->port,
         "AT+GMR",
-        3,
+        3000,
         FALSE, /* raw */
         FALSE, /* allow_cached */
         ctx->cancellable,
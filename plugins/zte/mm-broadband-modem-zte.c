@@ -108,7 +108,7 @@ load_unlock_retries (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         "+ZPINPUK=?",
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)load_unlock_retries_ready,
         g_simple_async_result_new (G_OBJECT (self),
@@ -194,7 +194,7 @@ modem_after_sim_unlock_context_step (ModemAfterSimUnlockContext *ctx)
 
     mm_base_modem_at_command (MM_BASE_MODEM (ctx->self),
                               "+CPMS?",
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)cpms_try_ready,
                               ctx);
@@ -243,7 +243,7 @@ modem_power_down (MMIfaceModem *self,
      * keeps access to the SIM */
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CFUN=4",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -440,7 +440,7 @@ load_current_modes (MMIfaceModem *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+ZSNT?",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -545,7 +545,7 @@ set_current_modes (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         command,
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)allowed_mode_update_ready,
         result);
@@ -602,7 +602,7 @@ load_access_technologies (MMIfaceModem *self,
 
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+ZPAS?",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
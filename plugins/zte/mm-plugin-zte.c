@@ -51,9 +51,9 @@ int mm_plugin_minor_version = MM_PLUGIN_MINOR_VERSION;
  * We use this command also for checking AT support in the port.
  */
 static const MMPortProbeAtCommand custom_at_probe[] = {
-    { "ATE0+CPMS?", 3, mm_port_probe_response_processor_is_at },
-    { "ATE0+CPMS?", 3, mm_port_probe_response_processor_is_at },
-    { "ATE0+CPMS?", 3, mm_port_probe_response_processor_is_at },
+    { "ATE0+CPMS?", 3000, mm_port_probe_response_processor_is_at },
+    { "ATE0+CPMS?", 3000, mm_port_probe_response_processor_is_at },
+    { "ATE0+CPMS?", 3000, mm_port_probe_response_processor_is_at },
     { NULL }
 };
 
@@ -27,6 +27,9 @@
 #include "ModemManager.h"
 
 #include "mm-base-manager.h"
+#include "mm-modem-helpers.h"
+#include "mm-port-serial.h"
+#include "mm-main-loop-profiler.h"
 #include "mm-log.h"
 #include "mm-context.h"
 
@@ -134,6 +137,8 @@ main (int argc, char *argv[])
     GMainLoop *inner;
     GError *err = NULL;
     guint name_id;
+    guint n_compiled;
+    guint n_hits;
 
     g_type_init ();
 
@@ -145,12 +150,16 @@ main (int argc, char *argv[])
                        mm_context_get_timestamps (),
                        mm_context_get_relative_timestamps (),
                        mm_context_get_debug (),
+                       mm_context_get_log_flush_interval (),
+                       mm_context_get_log_flush_size (),
                        &err)) {
         g_warning ("Failed to set up logging: %s", err->message);
         g_error_free (err);
         exit (1);
     }
 
+    mm_port_serial_set_io_worker_enabled (mm_context_get_serial_io_worker ());
+
     g_unix_signal_add (SIGTERM, quit_cb, NULL);
     g_unix_signal_add (SIGINT, quit_cb, NULL);
 
@@ -177,8 +186,13 @@ main (int argc, char *argv[])
 #endif
 
     /* Go into the main loop */
-    loop = g_main_loop_new (NULL, FALSE);
-    g_main_loop_run (loop);
+    if (mm_context_get_profile_main_loop ()) {
+        loop = g_main_loop_new (NULL, TRUE);
+        mm_main_loop_profiler_run (loop, mm_context_get_profile_main_loop ());
+    } else {
+        loop = g_main_loop_new (NULL, FALSE);
+        g_main_loop_run (loop);
+    }
 
     /* Clear the global variable, so that subsequent requests to
      * exit succeed. */
@@ -215,6 +229,12 @@ main (int argc, char *argv[])
 
     g_bus_unown_name (name_id);
 
+    mm_regex_registry_get_stats (&n_compiled, &n_hits);
+    mm_dbg ("Regex registry: %u regexes compiled, %u reused", n_compiled, n_hits);
+
+    if (mm_log_get_n_dropped ())
+        mm_warn ("%u log messages were dropped", mm_log_get_n_dropped ());
+
     mm_info ("ModemManager is shut down");
 
     mm_log_shutdown ();
@@ -22,6 +22,7 @@
 #include "mm-errors-types.h"
 
 #include "mm-log.h"
+#include "mm-main-loop-profiler.h"
 #include "mm-auth-provider-polkit.h"
 
 G_DEFINE_TYPE (MMAuthProviderPolkit, mm_auth_provider_polkit, MM_TYPE_AUTH_PROVIDER)
@@ -79,6 +80,8 @@ check_authorization_ready (PolkitAuthority *authority,
     PolkitAuthorizationResult *pk_result;
     GError *error = NULL;
 
+    mm_main_loop_profiler_callback_dispatched ("polkit authorization");
+
     if (g_cancellable_is_cancelled (ctx->cancellable)) {
         g_simple_async_result_set_error (ctx->result,
                                          MM_CORE_ERROR,
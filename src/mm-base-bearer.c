@@ -35,6 +35,7 @@
 #include "mm-base-bearer.h"
 #include "mm-base-modem-at.h"
 #include "mm-base-modem.h"
+#include "mm-main-loop-profiler.h"
 #include "mm-log.h"
 #include "mm-modem-helpers.h"
 #include "mm-bearer-stats.h"
@@ -987,6 +988,7 @@ base_bearer_dbus_export (MMBaseBearer *self)
                       G_CALLBACK (handle_disconnect),
                       NULL);
 
+    mm_main_loop_profiler_watch_skeleton (self);
     if (!g_dbus_interface_skeleton_export (G_DBUS_INTERFACE_SKELETON (self),
                                            self->priv->connection,
                                            self->priv->path,
@@ -30,6 +30,7 @@
 #include "mm-iface-modem-voice.h"
 #include "mm-base-modem-at.h"
 #include "mm-base-modem.h"
+#include "mm-main-loop-profiler.h"
 #include "mm-log.h"
 #include "mm-modem-helpers.h"
 
@@ -513,6 +514,7 @@ call_dbus_export (MMBaseCall *self)
                       NULL);
 
 
+    mm_main_loop_profiler_watch_skeleton (self);
     if (!g_dbus_interface_skeleton_export (G_DBUS_INTERFACE_SKELETON (self),
                                            self->priv->connection,
                                            self->priv->path,
@@ -666,7 +668,7 @@ call_start (MMBaseCall *self,
     cmd = g_strdup_printf ("ATD%s;", mm_gdbus_call_get_number (MM_GDBUS_CALL (self)) );
     mm_base_modem_at_command (ctx->modem,
                               cmd,
-                              90,
+                              90000,
                               FALSE,
                               (GAsyncReadyCallback)call_start_ready,
                               ctx);
@@ -769,7 +771,7 @@ call_accept (MMBaseCall *self,
     cmd = g_strdup_printf ("ATA");
     mm_base_modem_at_command (ctx->modem,
                               cmd,
-                              2,
+                              2000,
                               FALSE,
                               (GAsyncReadyCallback)call_accept_ready,
                               ctx);
@@ -858,7 +860,7 @@ call_hangup (MMBaseCall *self,
     cmd = g_strdup_printf ("+CHUP");
     mm_base_modem_at_command (ctx->modem,
                               cmd,
-                              2,
+                              2000,
                               FALSE,
                               (GAsyncReadyCallback)call_hangup_ready,
                               ctx);
@@ -933,7 +935,7 @@ call_send_dtmf (MMBaseCall *self,
     cmd = g_strdup_printf ("AT+VTS=%c", dtmf[0]);
     mm_base_modem_at_command (ctx->modem,
                               cmd,
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)call_send_dtmf_ready,
                               ctx);
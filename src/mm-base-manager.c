@@ -32,6 +32,9 @@
 #include "mm-plugin-manager.h"
 #include "mm-auth.h"
 #include "mm-plugin.h"
+#include "mm-port-serial.h"
+#include "mm-main-loop-profiler.h"
+#include "mm-iface-modem-messaging.h"
 #include "mm-log.h"
 
 static void initable_iface_init (GInitableIface *iface);
@@ -166,6 +169,8 @@ device_support_check_ready (MMPluginManager          *plugin_manager,
         mm_warn ("Couldn't create modem for device at '%s': %s",
                  mm_device_get_path (ctx->device), error->message);
         g_error_free (error);
+        /* Don't trust the cached probing results of this device any more */
+        mm_plugin_manager_invalidate_cached_results (plugin_manager, ctx->device);
         find_device_support_context_free (ctx);
         return;
     }
@@ -435,6 +440,8 @@ handle_uevent (GUdevClient *client,
     const gchar *subsys;
     const gchar *name;
 
+    mm_main_loop_profiler_callback_dispatched ("udev uevent");
+
     g_return_if_fail (action != NULL);
 
     /* A bit paranoid */
@@ -741,6 +748,176 @@ handle_scan_devices (MmGdbusOrgFreedesktopModemManager1 *manager,
     return TRUE;
 }
 
+/*****************************************************************************/
+/* Serial command statistics */
+
+static gboolean
+handle_get_command_statistics (MmGdbusTest *skeleton,
+                               GDBusMethodInvocation *invocation,
+                               MMBaseManager *self)
+{
+    GVariantBuilder builder;
+    GHashTableIter iter;
+    gpointer key, value;
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(sssuutuau)"));
+    g_hash_table_iter_init (&iter, self->priv->devices);
+    while (g_hash_table_iter_next (&iter, &key, &value)) {
+        MMBaseModem *modem;
+        const gchar *path;
+        GList *ports;
+        GList *l;
+
+        modem = mm_device_peek_modem (MM_DEVICE (value));
+        if (!modem)
+            continue;
+
+        path = g_dbus_object_get_object_path (G_DBUS_OBJECT (modem));
+        if (!path)
+            continue;
+
+        ports = mm_base_modem_find_ports (modem, MM_PORT_SUBSYS_UNKNOWN, MM_PORT_TYPE_UNKNOWN, NULL);
+        for (l = ports; l; l = g_list_next (l)) {
+            if (MM_IS_PORT_SERIAL (l->data))
+                mm_port_serial_get_command_stats (MM_PORT_SERIAL (l->data), path, &builder);
+        }
+        g_list_free_full (ports, (GDestroyNotify) g_object_unref);
+    }
+
+    mm_gdbus_test_complete_get_command_statistics (skeleton,
+                                                   invocation,
+                                                   mm_port_serial_get_command_stats_bounds (),
+                                                   g_variant_builder_end (&builder));
+    return TRUE;
+}
+
+/*****************************************************************************/
+/* Main loop profile */
+
+static gboolean
+handle_get_main_loop_profile (MmGdbusTest *skeleton,
+                              GDBusMethodInvocation *invocation,
+                              guint top,
+                              MMBaseManager *self)
+{
+    mm_gdbus_test_complete_get_main_loop_profile (skeleton,
+                                                  invocation,
+                                                  mm_main_loop_profiler_get_top (top));
+    return TRUE;
+}
+
+/*****************************************************************************/
+/* SMS send queue statistics */
+
+static gboolean
+handle_get_sms_send_queue_statistics (MmGdbusTest *skeleton,
+                                      GDBusMethodInvocation *invocation,
+                                      MMBaseManager *self)
+{
+    GVariantBuilder builder;
+    GHashTableIter iter;
+    gpointer key, value;
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(suttttt)"));
+    g_hash_table_iter_init (&iter, self->priv->devices);
+    while (g_hash_table_iter_next (&iter, &key, &value)) {
+        MMBaseModem *modem;
+        const gchar *path;
+        MMIfaceModemMessagingSendQueueStats stats;
+
+        modem = mm_device_peek_modem (MM_DEVICE (value));
+        if (!modem || !MM_IS_IFACE_MODEM_MESSAGING (modem))
+            continue;
+
+        path = g_dbus_object_get_object_path (G_DBUS_OBJECT (modem));
+        if (!path)
+            continue;
+
+        mm_iface_modem_messaging_get_send_queue_stats (MM_IFACE_MODEM_MESSAGING (modem), &stats);
+        g_variant_builder_add (&builder, "(suttttt)",
+                               path,
+                               stats.pending,
+                               stats.sent,
+                               stats.failed,
+                               stats.batches,
+                               stats.storage_locks,
+                               stats.busy_ms);
+    }
+
+    mm_gdbus_test_complete_get_sms_send_queue_statistics (skeleton,
+                                                          invocation,
+                                                          g_variant_builder_end (&builder));
+    return TRUE;
+}
+
+/*****************************************************************************/
+/* Serial I/O worker statistics */
+
+static gboolean
+handle_get_serial_io_worker_statistics (MmGdbusTest *skeleton,
+                                        GDBusMethodInvocation *invocation,
+                                        MMBaseManager *self)
+{
+    GVariantBuilder builder;
+    GHashTableIter iter;
+    gpointer key, value;
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(ssutt)"));
+    g_hash_table_iter_init (&iter, self->priv->devices);
+    while (g_hash_table_iter_next (&iter, &key, &value)) {
+        MMBaseModem *modem;
+        const gchar *path;
+        GList *ports;
+        GList *l;
+
+        modem = mm_device_peek_modem (MM_DEVICE (value));
+        if (!modem)
+            continue;
+
+        path = g_dbus_object_get_object_path (G_DBUS_OBJECT (modem));
+        if (!path)
+            continue;
+
+        ports = mm_base_modem_find_ports (modem, MM_PORT_SUBSYS_UNKNOWN, MM_PORT_TYPE_UNKNOWN, NULL);
+        for (l = ports; l; l = g_list_next (l)) {
+            guint n_dispatches;
+            guint64 total_delay;
+            guint64 max_delay;
+
+            if (!MM_IS_PORT_SERIAL (l->data))
+                continue;
+
+            mm_port_serial_get_io_worker_stats (MM_PORT_SERIAL (l->data), &n_dispatches, &total_delay, &max_delay);
+            g_variant_builder_add (&builder, "(ssutt)",
+                                   path,
+                                   mm_port_get_device (MM_PORT (l->data)),
+                                   n_dispatches,
+                                   total_delay,
+                                   max_delay);
+        }
+        g_list_free_full (ports, (GDestroyNotify) g_object_unref);
+    }
+
+    mm_gdbus_test_complete_get_serial_io_worker_statistics (skeleton,
+                                                            invocation,
+                                                            g_variant_builder_end (&builder));
+    return TRUE;
+}
+
+/*****************************************************************************/
+/* Log statistics */
+
+static gboolean
+handle_get_log_statistics (MmGdbusTest *skeleton,
+                           GDBusMethodInvocation *invocation,
+                           MMBaseManager *self)
+{
+    mm_gdbus_test_complete_get_log_statistics (skeleton,
+                                               invocation,
+                                               mm_log_get_n_dropped ());
+    return TRUE;
+}
+
 /*****************************************************************************/
 /* Test profile setup */
 
@@ -958,6 +1135,7 @@ initable_init (GInitable *initable,
         return FALSE;
 
     /* Export the manager interface */
+    mm_main_loop_profiler_watch_skeleton (initable);
     if (!g_dbus_interface_skeleton_export (G_DBUS_INTERFACE_SKELETON (initable),
                                            priv->connection,
                                            MM_DBUS_PATH,
@@ -975,6 +1153,27 @@ initable_init (GInitable *initable,
                           "handle-set-profile",
                           G_CALLBACK (handle_set_profile),
                           initable);
+        g_signal_connect (priv->test_skeleton,
+                          "handle-get-command-statistics",
+                          G_CALLBACK (handle_get_command_statistics),
+                          initable);
+        g_signal_connect (priv->test_skeleton,
+                          "handle-get-main-loop-profile",
+                          G_CALLBACK (handle_get_main_loop_profile),
+                          initable);
+        g_signal_connect (priv->test_skeleton,
+                          "handle-get-sms-send-queue-statistics",
+                          G_CALLBACK (handle_get_sms_send_queue_statistics),
+                          initable);
+        g_signal_connect (priv->test_skeleton,
+                          "handle-get-serial-io-worker-statistics",
+                          G_CALLBACK (handle_get_serial_io_worker_statistics),
+                          initable);
+        g_signal_connect (priv->test_skeleton,
+                          "handle-get-log-statistics",
+                          G_CALLBACK (handle_get_log_statistics),
+                          initable);
+        mm_main_loop_profiler_watch_skeleton (priv->test_skeleton);
         if (!g_dbus_interface_skeleton_export (G_DBUS_INTERFACE_SKELETON (priv->test_skeleton),
                                                priv->connection,
                                                MM_DBUS_PATH,
@@ -218,7 +218,7 @@ at_sequence_parse_response (MMPortSerialAt *port,
             mm_port_serial_at_command (
                 ctx->port,
                 ctx->current->command,
-                ctx->current->timeout,
+                ctx->current->timeout_ms,
                 FALSE,
                 ctx->current->allow_cached,
                 ctx->cancellable,
@@ -299,7 +299,7 @@ mm_base_modem_at_sequence_full (MMBaseModem *self,
     mm_port_serial_at_command (
         ctx->port,
         ctx->current->command,
-        ctx->current->timeout,
+        ctx->current->timeout_ms,
         FALSE,
         FALSE,
         ctx->cancellable,
@@ -508,7 +508,7 @@ void
 mm_base_modem_at_command_full (MMBaseModem *self,
                                MMPortSerialAt *port,
                                const gchar *command,
-                               guint timeout,
+                               guint timeout_ms,
                                gboolean allow_cached,
                                gboolean is_raw,
                                GCancellable *cancellable,
@@ -549,7 +549,7 @@ mm_base_modem_at_command_full (MMBaseModem *self,
     mm_port_serial_at_command (
         port,
         command,
-        timeout,
+        timeout_ms,
         is_raw,
         allow_cached,
         ctx->cancellable,
@@ -568,7 +568,7 @@ mm_base_modem_at_command_finish (MMBaseModem *self,
 static void
 _at_command (MMBaseModem *self,
              const gchar *command,
-             guint timeout,
+             guint timeout_ms,
              gboolean allow_cached,
              gboolean is_raw,
              GAsyncReadyCallback callback,
@@ -591,7 +591,7 @@ _at_command (MMBaseModem *self,
     mm_base_modem_at_command_full (self,
                                    port,
                                    command,
-                                   timeout,
+                                   timeout_ms,
                                    allow_cached,
                                    is_raw,
                                    NULL,
@@ -602,21 +602,21 @@ _at_command (MMBaseModem *self,
 void
 mm_base_modem_at_command (MMBaseModem *self,
                           const gchar *command,
-                          guint timeout,
+                          guint timeout_ms,
                           gboolean allow_cached,
                           GAsyncReadyCallback callback,
                           gpointer user_data)
 {
-    _at_command (self, command, timeout, allow_cached, FALSE, callback, user_data);
+    _at_command (self, command, timeout_ms, allow_cached, FALSE, callback, user_data);
 }
 
 void
 mm_base_modem_at_command_raw (MMBaseModem *self,
                               const gchar *command,
-                              guint timeout,
+                              guint timeout_ms,
                               gboolean allow_cached,
                               GAsyncReadyCallback callback,
                               gpointer user_data)
 {
-    _at_command (self, command, timeout, allow_cached, TRUE, callback, user_data);
+    _at_command (self, command, timeout_ms, allow_cached, TRUE, callback, user_data);
 }
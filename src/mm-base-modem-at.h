@@ -55,8 +55,8 @@ typedef gboolean (* MMBaseModemAtResponseProcessor) (MMBaseModem *self,
 typedef struct {
     /* The AT command */
     gchar *command;
-    /* Timeout of the command, in seconds */
-    guint timeout;
+    /* Timeout of the command, in milliseconds */
+    guint timeout_ms;
     /* Flag to allow cached replies */
     gboolean allow_cached;
     /* The response processor */
@@ -134,14 +134,14 @@ gboolean mm_base_modem_response_processor_continue_on_error (MMBaseModem *self,
  * explicit cancellations. */
 void mm_base_modem_at_command                (MMBaseModem *self,
                                               const gchar *command,
-                                              guint timeout,
+                                              guint timeout_ms,
                                               gboolean allow_cached,
                                               GAsyncReadyCallback callback,
                                               gpointer user_data);
 /* Like mm_base_modem_at_command() except does not prefix with AT */
 void mm_base_modem_at_command_raw            (MMBaseModem *self,
                                               const gchar *command,
-                                              guint timeout,
+                                              guint timeout_ms,
                                               gboolean allow_cached,
                                               GAsyncReadyCallback callback,
                                               gpointer user_data);
@@ -154,7 +154,7 @@ const gchar *mm_base_modem_at_command_finish (MMBaseModem *self,
 void mm_base_modem_at_command_full                (MMBaseModem *self,
                                                    MMPortSerialAt *port,
                                                    const gchar *command,
-                                                   guint timeout,
+                                                   guint timeout_ms,
                                                    gboolean allow_cached,
                                                    gboolean is_raw,
                                                    GCancellable *cancellable,
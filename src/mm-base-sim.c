@@ -30,6 +30,7 @@
 #include "mm-base-sim.h"
 #include "mm-base-modem-at.h"
 #include "mm-base-modem.h"
+#include "mm-main-loop-profiler.h"
 #include "mm-log.h"
 #include "mm-modem-helpers.h"
 
@@ -127,7 +128,7 @@ change_pin (MMBaseSim *self,
                                new_pin);
     mm_base_modem_at_command (MM_BASE_MODEM (self->priv->modem),
                               command,
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)change_pin_ready,
                               result);
@@ -299,7 +300,7 @@ enable_pin (MMBaseSim *self,
                                pin);
     mm_base_modem_at_command (MM_BASE_MODEM (self->priv->modem),
                               command,
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)enable_pin_ready,
                               result);
@@ -472,7 +473,7 @@ common_send_pin_puk (MMBaseSim *self,
 
     mm_base_modem_at_command (MM_BASE_MODEM (self->priv->modem),
                               command,
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)send_pin_puk_ready,
                               result);
@@ -886,6 +887,7 @@ sim_dbus_export (MMBaseSim *self)
                       G_CALLBACK (handle_send_puk),
                       NULL);
 
+    mm_main_loop_profiler_watch_skeleton (self);
     if (!g_dbus_interface_skeleton_export (G_DBUS_INTERFACE_SKELETON (self),
                                            self->priv->connection,
                                            self->priv->path,
@@ -1007,7 +1009,7 @@ load_sim_identifier (MMBaseSim *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self->priv->modem),
         "+CRSM=176,12258,0,0,10",
-        20,
+        20000,
         FALSE,
         (GAsyncReadyCallback)load_sim_identifier_command_ready,
         g_simple_async_result_new (G_OBJECT (self),
@@ -1076,7 +1078,7 @@ load_imsi (MMBaseSim *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self->priv->modem),
         "+CIMI",
-        3,
+        3000,
         FALSE,
         (GAsyncReadyCallback)load_imsi_command_ready,
         g_simple_async_result_new (G_OBJECT (self),
@@ -1197,7 +1199,7 @@ load_operator_identifier (MMBaseSim *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self->priv->modem),
         "+CRSM=176,28589,0,0,4",
-        10,
+        10000,
         FALSE,
         (GAsyncReadyCallback)load_operator_identifier_command_ready,
         g_simple_async_result_new (G_OBJECT (self),
@@ -1292,7 +1294,7 @@ load_operator_name (MMBaseSim *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self->priv->modem),
         "+CRSM=176,28486,0,0,17",
-        10,
+        10000,
         FALSE,
         (GAsyncReadyCallback)load_operator_name_command_ready,
         g_simple_async_result_new (G_OBJECT (self),
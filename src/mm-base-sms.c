@@ -15,6 +15,8 @@
  * Copyright (C) 2012 Google, Inc.
  */
 
+#define MM_LOG_MODULE MM_LOG_MODULE_SMS
+
 #include <config.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -33,6 +35,7 @@
 #include "mm-sms-part-3gpp.h"
 #include "mm-base-modem-at.h"
 #include "mm-base-modem.h"
+#include "mm-main-loop-profiler.h"
 #include "mm-log.h"
 #include "mm-modem-helpers.h"
 
@@ -510,16 +513,16 @@ handle_send_context_free (HandleSendContext *ctx)
 }
 
 static void
-handle_send_ready (MMBaseSms *self,
+handle_send_ready (MMIfaceModemMessaging *modem,
                    GAsyncResult *res,
                    HandleSendContext *ctx)
 {
     GError *error = NULL;
 
-    if (!MM_BASE_SMS_GET_CLASS (self)->send_finish (self, res, &error)) {
+    if (!mm_iface_modem_messaging_queue_send_finish (modem, res, &error)) {
         /* On error, clear up the parts we generated */
-        g_list_free_full (self->priv->parts, (GDestroyNotify)mm_sms_part_free);
-        self->priv->parts = NULL;
+        g_list_free_full (ctx->self->priv->parts, (GDestroyNotify)mm_sms_part_free);
+        ctx->self->priv->parts = NULL;
         g_dbus_method_invocation_take_error (ctx->invocation, error);
     } else {
         /* Transition from Unknown->Sent or Stored->Sent */
@@ -622,9 +625,11 @@ handle_send_auth_ready (MMBaseModem *modem,
         return;
     }
 
-    MM_BASE_SMS_GET_CLASS (ctx->self)->send (ctx->self,
-                                             (GAsyncReadyCallback)handle_send_ready,
-                                             ctx);
+    /* Sends from all messages are serialized in the modem's queue */
+    mm_iface_modem_messaging_queue_send (MM_IFACE_MODEM_MESSAGING (ctx->modem),
+                                         ctx->self,
+                                         (GAsyncReadyCallback)handle_send_ready,
+                                         ctx);
 }
 
 static gboolean
@@ -688,6 +693,7 @@ sms_dbus_export (MMBaseSms *self)
                       G_CALLBACK (handle_send),
                       NULL);
 
+    mm_main_loop_profiler_watch_skeleton (self);
     if (!g_dbus_interface_skeleton_export (G_DBUS_INTERFACE_SKELETON (self),
                                            self->priv->connection,
                                            self->priv->path,
@@ -721,6 +727,24 @@ mm_base_sms_get_storage (MMBaseSms *self)
     return mm_gdbus_sms_get_storage (MM_GDBUS_SMS (self));
 }
 
+/* The filter under which this SMS gets deleted */
+MMSmsDeleteFilter
+mm_base_sms_get_delete_filter (MMBaseSms *self)
+{
+    switch (mm_gdbus_sms_get_state (MM_GDBUS_SMS (self))) {
+    case MM_SMS_STATE_RECEIVING:
+    case MM_SMS_STATE_RECEIVED:
+        return MM_SMS_DELETE_FILTER_RECEIVED;
+    case MM_SMS_STATE_STORED:
+    case MM_SMS_STATE_SENDING:
+        return MM_SMS_DELETE_FILTER_UNSENT;
+    case MM_SMS_STATE_SENT:
+        return MM_SMS_DELETE_FILTER_SENT;
+    default:
+        return MM_SMS_DELETE_FILTER_NONE;
+    }
+}
+
 gboolean
 mm_base_sms_is_multipart (MMBaseSms *self)
 {
@@ -919,7 +943,7 @@ store_ready (MMBaseModem *modem,
     /* Send the actual message data */
     mm_base_modem_at_command_raw (ctx->modem,
                                   ctx->msg_data,
-                                  10,
+                                  10000,
                                   FALSE,
                                   (GAsyncReadyCallback)store_msg_data_ready,
                                   ctx);
@@ -959,7 +983,7 @@ sms_store_next_part (SmsStoreContext *ctx)
 
     mm_base_modem_at_command (ctx->modem,
                               cmd,
-                              10,
+                              10000,
                               FALSE,
                               (GAsyncReadyCallback)store_ready,
                               ctx);
@@ -1033,11 +1057,20 @@ typedef struct {
     gboolean use_pdu_mode;
     GList *current;
     gchar *msg_data;
+    /* Latency reporting */
+    guint n_parts;
+    guint n_sent;
+    gint64 start_time;
+    gint64 part_start_time;
 } SmsSendContext;
 
 static void
 sms_send_context_complete_and_free (SmsSendContext *ctx)
 {
+    if (ctx->n_sent == ctx->n_parts && ctx->n_parts > 1)
+        mm_dbg ("Sent %u SMS parts in %" G_GINT64_FORMAT " ms",
+                ctx->n_parts,
+                (g_get_monotonic_time () - ctx->start_time) / 1000);
     g_simple_async_result_complete_in_idle (ctx->result);
     g_object_unref (ctx->result);
     /* Unlock mem2 storage if we had the lock */
@@ -1084,6 +1117,23 @@ read_message_reference_from_reply (const gchar *response,
     return idx;
 }
 
+static void
+sms_send_part_done (SmsSendContext *ctx,
+                    gint message_reference)
+{
+    mm_sms_part_set_message_reference ((MMSmsPart *)ctx->current->data,
+                                       (guint)message_reference);
+
+    ctx->n_sent++;
+    mm_dbg ("Sent SMS part %u/%u in %" G_GINT64_FORMAT " ms",
+            ctx->n_sent,
+            ctx->n_parts,
+            (g_get_monotonic_time () - ctx->part_start_time) / 1000);
+
+    ctx->current = g_list_next (ctx->current);
+    sms_send_next_part (ctx);
+}
+
 static void
 send_generic_msg_data_ready (MMBaseModem *modem,
                              GAsyncResult *res,
@@ -1107,11 +1157,7 @@ send_generic_msg_data_ready (MMBaseModem *modem,
         return;
     }
 
-    mm_sms_part_set_message_reference ((MMSmsPart *)ctx->current->data,
-                                       (guint)message_reference);
-
-    ctx->current = g_list_next (ctx->current);
-    sms_send_next_part (ctx);
+    sms_send_part_done (ctx, message_reference);
 }
 
 static void
@@ -1131,7 +1177,7 @@ send_generic_ready (MMBaseModem *modem,
     /* Send the actual message data */
     mm_base_modem_at_command_raw (ctx->modem,
                                   ctx->msg_data,
-                                  10,
+                                  10000,
                                   FALSE,
                                   (GAsyncReadyCallback)send_generic_msg_data_ready,
                                   ctx);
@@ -1170,11 +1216,7 @@ send_from_storage_ready (MMBaseModem *modem,
         return;
     }
 
-    mm_sms_part_set_message_reference ((MMSmsPart *)ctx->current->data,
-                                       (guint)message_reference);
-
-    ctx->current = g_list_next (ctx->current);
-    sms_send_next_part (ctx);
+    sms_send_part_done (ctx, message_reference);
 }
 
 static void
@@ -1190,13 +1232,15 @@ sms_send_next_part (SmsSendContext *ctx)
         return;
     }
 
+    ctx->part_start_time = g_get_monotonic_time ();
+
     /* Send from storage */
     if (ctx->from_storage) {
         cmd = g_strdup_printf ("+CMSS=%d",
                                mm_sms_part_get_index ((MMSmsPart *)ctx->current->data));
         mm_base_modem_at_command (ctx->modem,
                                   cmd,
-                                  30,
+                                  30000,
                                   FALSE,
                                   (GAsyncReadyCallback)send_from_storage_ready,
                                   ctx);
@@ -1226,13 +1270,48 @@ sms_send_next_part (SmsSendContext *ctx)
     g_assert (ctx->msg_data != NULL);
     mm_base_modem_at_command (ctx->modem,
                               cmd,
-                              30,
+                              30000,
                               FALSE,
                               (GAsyncReadyCallback)send_generic_ready,
                               ctx);
     g_free (cmd);
 }
 
+static void
+keep_sms_link_open_ready (MMBroadbandModem *modem,
+                          GAsyncResult *res,
+                          SmsSendContext *ctx)
+{
+    GError *error = NULL;
+
+    /* Not critical, parts will just be sent with the link released in between */
+    if (!mm_broadband_modem_keep_sms_link_open_finish (modem, res, &error)) {
+        mm_dbg ("Couldn't keep the SMS relay link open: '%s'", error->message);
+        g_error_free (error);
+    }
+
+    sms_send_next_part (ctx);
+}
+
+static void
+sms_send_parts (SmsSendContext *ctx)
+{
+    ctx->current = ctx->self->priv->parts;
+    ctx->n_parts = g_list_length (ctx->current);
+    ctx->start_time = g_get_monotonic_time ();
+
+    /* Keep the relay link open between the parts of a multipart message, so
+     * that they go out back to back */
+    if (ctx->n_parts > 1 && MM_IS_BROADBAND_MODEM (ctx->modem)) {
+        mm_broadband_modem_keep_sms_link_open (MM_BROADBAND_MODEM (ctx->modem),
+                                               (GAsyncReadyCallback)keep_sms_link_open_ready,
+                                               ctx);
+        return;
+    }
+
+    sms_send_next_part (ctx);
+}
+
 static void
 send_lock_sms_storages_ready (MMBroadbandModem *modem,
                               GAsyncResult *res,
@@ -1251,8 +1330,7 @@ send_lock_sms_storages_ready (MMBroadbandModem *modem,
     ctx->need_unlock = TRUE;
 
     /* Go on to send the parts */
-    ctx->current = ctx->self->priv->parts;
-    sms_send_next_part (ctx);
+    sms_send_parts (ctx);
 }
 
 static void
@@ -1289,8 +1367,13 @@ sms_send (MMBaseSms *self,
     g_object_get (self->priv->modem,
                   MM_IFACE_MODEM_MESSAGING_SMS_PDU_MODE, &ctx->use_pdu_mode,
                   NULL);
-    ctx->current = self->priv->parts;
-    sms_send_next_part (ctx);
+    sms_send_parts (ctx);
+}
+
+gboolean
+mm_base_sms_is_sent_with_at (MMBaseSms *self)
+{
+    return MM_BASE_SMS_GET_CLASS (self)->send == sms_send;
 }
 
 /*****************************************************************************/
@@ -1379,7 +1462,7 @@ delete_next_part (SmsDeletePartsContext *ctx)
                            mm_sms_part_get_index ((MMSmsPart *)ctx->current->data));
     mm_base_modem_at_command (ctx->modem,
                               cmd,
-                              10,
+                              10000,
                               FALSE,
                               (GAsyncReadyCallback)delete_part_ready,
                               ctx);
@@ -34,6 +34,16 @@
 #define MM_IS_BASE_SMS_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass),  MM_TYPE_BASE_SMS))
 #define MM_BASE_SMS_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj),  MM_TYPE_BASE_SMS, MMBaseSmsClass))
 
+/* Which messages to remove when deleting all the ones in a storage */
+typedef enum {
+    MM_SMS_DELETE_FILTER_NONE     = 0,
+    MM_SMS_DELETE_FILTER_RECEIVED = 1 << 0,
+    MM_SMS_DELETE_FILTER_SENT     = 1 << 1,
+    MM_SMS_DELETE_FILTER_UNSENT   = 1 << 2,
+    /* Everything, including the messages not yet read from the device */
+    MM_SMS_DELETE_FILTER_ALL      = 1 << 3,
+} MMSmsDeleteFilter;
+
 typedef struct _MMBaseSms MMBaseSms;
 typedef struct _MMBaseSmsClass MMBaseSmsClass;
 typedef struct _MMBaseSmsPrivate MMBaseSmsPrivate;
@@ -106,6 +116,7 @@ void          mm_base_sms_export      (MMBaseSms *self);
 void          mm_base_sms_unexport    (MMBaseSms *self);
 const gchar  *mm_base_sms_get_path    (MMBaseSms *self);
 MMSmsStorage  mm_base_sms_get_storage (MMBaseSms *self);
+MMSmsDeleteFilter mm_base_sms_get_delete_filter (MMBaseSms *self);
 
 gboolean     mm_base_sms_has_part_index (MMBaseSms *self,
                                          guint index);
@@ -116,6 +127,9 @@ guint        mm_base_sms_get_multipart_reference (MMBaseSms *self);
 gboolean     mm_base_sms_multipart_is_complete   (MMBaseSms *self);
 gboolean     mm_base_sms_multipart_is_assembled  (MMBaseSms *self);
 
+/* Whether the SMS is sent with the generic AT command based implementation */
+gboolean mm_base_sms_is_sent_with_at (MMBaseSms *self);
+
 void     mm_base_sms_delete        (MMBaseSms *self,
                                     GAsyncReadyCallback callback,
                                     gpointer user_data);
@@ -14,6 +14,8 @@
  * Copyright (C) 2015 Azimut Electronics
  */
 
+#define MM_LOG_MODULE MM_LOG_MODULE_QMI
+
 #include <config.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -285,7 +285,7 @@ cdma_connect_context_dial (DetailedConnectContext *ctx)
     mm_base_modem_at_command_full (ctx->modem,
                                    MM_PORT_SERIAL_AT (ctx->data),
                                    command,
-                                   90,
+                                   90000,
                                    FALSE,
                                    FALSE,
                                    NULL,
@@ -372,7 +372,7 @@ current_rm_protocol_ready (MMBaseModem *self,
         mm_base_modem_at_command_full (ctx->modem,
                                        ctx->primary,
                                        command,
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE,
                                        NULL,
@@ -426,7 +426,7 @@ connect_cdma (MMBroadbandBearer *self,
         mm_base_modem_at_command_full (ctx->modem,
                                        ctx->primary,
                                        "+CRM?",
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE, /* raw */
                                        NULL, /* cancellable */
@@ -556,7 +556,7 @@ atd_ready (MMBaseModem *modem,
         mm_base_modem_at_command_full (ctx->modem,
                                        ctx->primary,
                                        "+CEER",
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE, /* raw */
                                        NULL, /* cancellable */
@@ -610,7 +610,7 @@ dial_3gpp (MMBroadbandBearer *self,
     mm_base_modem_at_command_full (ctx->modem,
                                    ctx->dial_port,
                                    command,
-                                   60,
+                                   60000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -837,7 +837,7 @@ find_cid_ready (MMBaseModem *modem,
     mm_base_modem_at_command_full (ctx->modem,
                                    ctx->primary,
                                    command,
-                                   3,
+                                   3000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -1015,8 +1015,8 @@ parse_pdp_list (MMBaseModem *modem,
 }
 
 static const MMBaseModemAtCommand find_cid_sequence[] = {
-    { "+CGDCONT?",  3, FALSE, (MMBaseModemAtResponseProcessor)parse_pdp_list  },
-    { "+CGDCONT=?", 3, TRUE,  (MMBaseModemAtResponseProcessor)parse_cid_range },
+    { "+CGDCONT?",  3000, FALSE, (MMBaseModemAtResponseProcessor)parse_pdp_list  },
+    { "+CGDCONT=?", 3000, TRUE,  (MMBaseModemAtResponseProcessor)parse_cid_range },
     { NULL }
 };
 
@@ -1524,7 +1524,7 @@ data_flash_3gpp_ready (MMPortSerial *data,
     mm_base_modem_at_command_full (ctx->modem,
                                    ctx->primary,
                                    ctx->cgact_command,
-                                   10,
+                                   10000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -1621,7 +1621,7 @@ disconnect_3gpp (MMBroadbandBearer *self,
         mm_base_modem_at_command_full (ctx->modem,
                                        ctx->primary,
                                        ctx->cgact_command,
-                                       10,
+                                       10000,
                                        FALSE,
                                        FALSE, /* raw */
                                        NULL, /* cancellable */
@@ -1640,7 +1640,7 @@ disconnect_3gpp (MMBroadbandBearer *self,
         mm_base_modem_at_command_full (ctx->modem,
                                        ctx->secondary,
                                        ctx->cgact_command,
-                                       10,
+                                       10000,
                                        FALSE,
                                        FALSE, /* raw */
                                        NULL, /* cancellable */
@@ -1972,7 +1972,7 @@ interface_initialization_step (InitAsyncContext *ctx)
             mm_base_modem_at_command_full (ctx->modem,
                                            ctx->port,
                                            "+CRM=?",
-                                           3,
+                                           3000,
                                            TRUE, /* getting range, so reply can be cached */
                                            FALSE, /* raw */
                                            NULL, /* cancellable */
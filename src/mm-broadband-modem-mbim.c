@@ -13,6 +13,8 @@
  * Copyright (C) 2013 Aleksander Morgado <aleksander@gnu.org>
  */
 
+#define MM_LOG_MODULE MM_LOG_MODULE_MBIM
+
 #include <config.h>
 
 #include <stdlib.h>
@@ -2989,6 +2991,9 @@ iface_modem_messaging_init (MMIfaceModemMessaging *iface)
     iface->disable_unsolicited_events = disable_unsolicited_events_messaging;
     iface->disable_unsolicited_events_finish = common_enable_disable_unsolicited_events_messaging_finish;
     iface->create_sms = messaging_create_sms;
+    /* No bulk removal; SMS are deleted one by one */
+    iface->delete_sms_many = NULL;
+    iface->delete_sms_many_finish = NULL;
 }
 
 static void
@@ -14,6 +14,8 @@
  * Copyright (C) 2014 Aleksander Morgado <aleksander@aleksander.es>
  */
 
+#define MM_LOG_MODULE MM_LOG_MODULE_QMI
+
 #include <config.h>
 
 #include <stdlib.h>
@@ -8291,6 +8293,389 @@ messaging_enable_unsolicited_events (MMIfaceModemMessaging *_self,
                                                         user_data);
 }
 
+/*****************************************************************************/
+/* Delete multiple SMS from the same storage (Messaging interface) */
+
+static const QmiWmsMessageMode delete_sms_many_modes[] = {
+    QMI_WMS_MESSAGE_MODE_GSM_WCDMA,
+    QMI_WMS_MESSAGE_MODE_CDMA
+};
+
+/* Message tags to remove for each filter */
+static const struct {
+    MMSmsDeleteFilter filter;
+    QmiWmsMessageTagType tag;
+} delete_sms_many_tags[] = {
+    { MM_SMS_DELETE_FILTER_RECEIVED, QMI_WMS_MESSAGE_TAG_TYPE_MT_READ     },
+    { MM_SMS_DELETE_FILTER_RECEIVED, QMI_WMS_MESSAGE_TAG_TYPE_MT_NOT_READ },
+    { MM_SMS_DELETE_FILTER_SENT,     QMI_WMS_MESSAGE_TAG_TYPE_MO_SENT     },
+    { MM_SMS_DELETE_FILTER_UNSENT,   QMI_WMS_MESSAGE_TAG_TYPE_MO_NOT_SENT },
+};
+
+/* A single WMS Delete without memory index, removing all the messages of the
+ * given mode, and of the given tag if any, in the storage */
+typedef struct {
+    guint mode_i;
+    MMSmsDeleteFilter filter;
+    gint tag; /* -1 if none */
+} DeleteSmsManyRequest;
+
+typedef struct {
+    MMBroadbandModemQmi *self;
+    QmiClientWms *client;
+    GSimpleAsyncResult *result;
+    MMSmsStorage storage;
+    /* List of MMBaseSms, non-owned; the caller keeps them alive */
+    GList *sms_list;
+    /* List of MMSmsPart, non-owned */
+    GList *parts;
+    GList *current;
+    guint n_failed;
+    /* Bulk removal requests */
+    GArray *requests;
+    guint request_i;
+    /* Filters requested and failed, per message mode */
+    MMSmsDeleteFilter requested[G_N_ELEMENTS (delete_sms_many_modes)];
+    MMSmsDeleteFilter failed[G_N_ELEMENTS (delete_sms_many_modes)];
+} DeleteSmsManyContext;
+
+static void
+delete_sms_many_context_complete_and_free (DeleteSmsManyContext *ctx)
+{
+    g_simple_async_result_complete_in_idle (ctx->result);
+    g_object_unref (ctx->result);
+    g_array_unref (ctx->requests);
+    g_list_free (ctx->parts);
+    g_list_free (ctx->sms_list);
+    g_object_unref (ctx->client);
+    g_object_unref (ctx->self);
+    g_slice_free (DeleteSmsManyContext, ctx);
+}
+
+static gboolean
+messaging_delete_sms_many_finish (MMIfaceModemMessaging *_self,
+                                  GAsyncResult *res,
+                                  GError **error)
+{
+    MMBroadbandModemQmi *self = MM_BROADBAND_MODEM_QMI (_self);
+
+    /* Handle fallback */
+    if (self->priv->messaging_fallback_at) {
+        return iface_modem_messaging_parent->delete_sms_many_finish (_self, res, error);
+    }
+
+    return !g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error);
+}
+
+static QmiWmsMessageMode
+part_message_mode (MMSmsPart *part)
+{
+    return (MM_SMS_PART_IS_3GPP (part) ?
+            QMI_WMS_MESSAGE_MODE_GSM_WCDMA :
+            QMI_WMS_MESSAGE_MODE_CDMA);
+}
+
+/* Whether there's any stored part of the given mode in a SMS matching the
+ * filter */
+static gboolean
+delete_sms_many_has_parts (DeleteSmsManyContext *ctx,
+                           QmiWmsMessageMode mode,
+                           MMSmsDeleteFilter filter)
+{
+    GList *l;
+
+    for (l = ctx->sms_list; l; l = g_list_next (l)) {
+        GList *p;
+
+        if (filter != MM_SMS_DELETE_FILTER_ALL &&
+            !(mm_base_sms_get_delete_filter (MM_BASE_SMS (l->data)) & filter))
+            continue;
+
+        for (p = mm_base_sms_get_parts (MM_BASE_SMS (l->data)); p; p = g_list_next (p)) {
+            if (part_message_mode ((MMSmsPart *)p->data) == mode &&
+                mm_sms_part_get_index ((MMSmsPart *)p->data) != SMS_PART_INVALID_INDEX)
+                return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static void delete_sms_many_next_part (DeleteSmsManyContext *ctx);
+
+static void
+wms_delete_part_ready (QmiClientWms *client,
+                       GAsyncResult *res,
+                       DeleteSmsManyContext *ctx)
+{
+    QmiMessageWmsDeleteOutput *output = NULL;
+    GError *error = NULL;
+
+    output = qmi_client_wms_delete_finish (client, res, &error);
+    if (!output) {
+        ctx->n_failed++;
+        mm_dbg ("QMI operation failed: Couldn't delete SMS part with index %u: '%s'",
+                mm_sms_part_get_index ((MMSmsPart *)ctx->current->data),
+                error->message);
+        g_error_free (error);
+    } else if (!qmi_message_wms_delete_output_get_result (output, &error)) {
+        ctx->n_failed++;
+        mm_dbg ("Couldn't delete SMS part with index %u: '%s'",
+                mm_sms_part_get_index ((MMSmsPart *)ctx->current->data),
+                error->message);
+        g_error_free (error);
+    } else
+        /* We reset the index, as there is no longer that part */
+        mm_sms_part_set_index ((MMSmsPart *)ctx->current->data, SMS_PART_INVALID_INDEX);
+
+    if (output)
+        qmi_message_wms_delete_output_unref (output);
+
+    ctx->current = g_list_next (ctx->current);
+    delete_sms_many_next_part (ctx);
+}
+
+static void
+delete_sms_many_next_part (DeleteSmsManyContext *ctx)
+{
+    QmiMessageWmsDeleteInput *input;
+
+    /* Skip parts already removed */
+    while (ctx->current &&
+           mm_sms_part_get_index ((MMSmsPart *)ctx->current->data) == SMS_PART_INVALID_INDEX)
+        ctx->current = g_list_next (ctx->current);
+
+    /* If all removed, we're done */
+    if (!ctx->current) {
+        if (ctx->n_failed > 0)
+            g_simple_async_result_set_error (ctx->result,
+                                             MM_CORE_ERROR,
+                                             MM_CORE_ERROR_FAILED,
+                                             "Couldn't delete %u SMS parts from storage '%s'",
+                                             ctx->n_failed,
+                                             mm_sms_storage_get_string (ctx->storage));
+        else
+            g_simple_async_result_set_op_res_gboolean (ctx->result, TRUE);
+
+        delete_sms_many_context_complete_and_free (ctx);
+        return;
+    }
+
+    input = qmi_message_wms_delete_input_new ();
+    qmi_message_wms_delete_input_set_memory_storage (
+        input,
+        mm_sms_storage_to_qmi_storage_type (ctx->storage),
+        NULL);
+    qmi_message_wms_delete_input_set_memory_index (
+        input,
+        (guint32)mm_sms_part_get_index ((MMSmsPart *)ctx->current->data),
+        NULL);
+    qmi_message_wms_delete_input_set_message_mode (
+        input,
+        part_message_mode ((MMSmsPart *)ctx->current->data),
+        NULL);
+    qmi_client_wms_delete (ctx->client,
+                           input,
+                           5,
+                           NULL,
+                           (GAsyncReadyCallback)wms_delete_part_ready,
+                           ctx);
+    qmi_message_wms_delete_input_unref (input);
+}
+
+/* Resets the index of the parts removed by the bulk requests; a filter only
+ * counts as removed if all its requests succeeded */
+static void
+delete_sms_many_bulk_done (DeleteSmsManyContext *ctx)
+{
+    GList *l;
+
+    for (l = ctx->sms_list; l; l = g_list_next (l)) {
+        MMSmsDeleteFilter sms_filter;
+        GList *p;
+
+        sms_filter = mm_base_sms_get_delete_filter (MM_BASE_SMS (l->data));
+        for (p = mm_base_sms_get_parts (MM_BASE_SMS (l->data)); p; p = g_list_next (p)) {
+            MMSmsDeleteFilter removed;
+            guint i;
+
+            for (i = 0; i < G_N_ELEMENTS (delete_sms_many_modes); i++) {
+                if (delete_sms_many_modes[i] == part_message_mode ((MMSmsPart *)p->data))
+                    break;
+            }
+            g_assert (i < G_N_ELEMENTS (delete_sms_many_modes));
+
+            removed = ctx->requested[i] & ~ctx->failed[i];
+            if ((removed & MM_SMS_DELETE_FILTER_ALL) || (removed & sms_filter))
+                mm_sms_part_set_index ((MMSmsPart *)p->data, SMS_PART_INVALID_INDEX);
+        }
+    }
+
+    /* Delete any leftover one by one */
+    ctx->current = ctx->parts;
+    delete_sms_many_next_part (ctx);
+}
+
+static void delete_sms_many_next_request (DeleteSmsManyContext *ctx);
+
+static void
+wms_delete_request_ready (QmiClientWms *client,
+                          GAsyncResult *res,
+                          DeleteSmsManyContext *ctx)
+{
+    QmiMessageWmsDeleteOutput *output = NULL;
+    GError *error = NULL;
+    const DeleteSmsManyRequest *request;
+
+    request = &g_array_index (ctx->requests, DeleteSmsManyRequest, ctx->request_i);
+
+    output = qmi_client_wms_delete_finish (client, res, &error);
+    if (output && !qmi_message_wms_delete_output_get_result (output, &error))
+        g_clear_pointer (&output, qmi_message_wms_delete_output_unref);
+
+    if (!output) {
+        /* Parts of this mode and filter will be removed one by one afterwards */
+        mm_dbg ("Couldn't delete '%s' SMS%s%s from storage '%s': '%s'",
+                qmi_wms_message_mode_get_string (delete_sms_many_modes[request->mode_i]),
+                request->tag != -1 ? " tagged " : "",
+                request->tag != -1 ? qmi_wms_message_tag_type_get_string ((QmiWmsMessageTagType)request->tag) : "",
+                mm_sms_storage_get_string (ctx->storage),
+                error->message);
+        g_error_free (error);
+        ctx->failed[request->mode_i] |= request->filter;
+    } else
+        qmi_message_wms_delete_output_unref (output);
+
+    ctx->request_i++;
+    delete_sms_many_next_request (ctx);
+}
+
+static void
+delete_sms_many_next_request (DeleteSmsManyContext *ctx)
+{
+    QmiMessageWmsDeleteInput *input;
+    const DeleteSmsManyRequest *request;
+
+    if (ctx->request_i == ctx->requests->len) {
+        delete_sms_many_bulk_done (ctx);
+        return;
+    }
+
+    request = &g_array_index (ctx->requests, DeleteSmsManyRequest, ctx->request_i);
+
+    /* No memory index given, so all messages of this mode, and tag if any,
+     * in the storage are removed */
+    input = qmi_message_wms_delete_input_new ();
+    qmi_message_wms_delete_input_set_memory_storage (
+        input,
+        mm_sms_storage_to_qmi_storage_type (ctx->storage),
+        NULL);
+    qmi_message_wms_delete_input_set_message_mode (
+        input,
+        delete_sms_many_modes[request->mode_i],
+        NULL);
+    if (request->tag != -1)
+        qmi_message_wms_delete_input_set_message_tag (
+            input,
+            (QmiWmsMessageTagType)request->tag,
+            NULL);
+    qmi_client_wms_delete (ctx->client,
+                           input,
+                           30,
+                           NULL,
+                           (GAsyncReadyCallback)wms_delete_request_ready,
+                           ctx);
+    qmi_message_wms_delete_input_unref (input);
+}
+
+/* Only request bulk removals for modes and filters with stored parts */
+static void
+delete_sms_many_add_requests (DeleteSmsManyContext *ctx,
+                              MMSmsDeleteFilter filter)
+{
+    guint i;
+    guint j;
+
+    for (i = 0; i < G_N_ELEMENTS (delete_sms_many_modes); i++) {
+        DeleteSmsManyRequest request;
+
+        request.mode_i = i;
+
+        if (filter == MM_SMS_DELETE_FILTER_ALL) {
+            if (!delete_sms_many_has_parts (ctx, delete_sms_many_modes[i], filter))
+                continue;
+            request.filter = MM_SMS_DELETE_FILTER_ALL;
+            request.tag = -1;
+            g_array_append_val (ctx->requests, request);
+            ctx->requested[i] |= request.filter;
+            continue;
+        }
+
+        for (j = 0; j < G_N_ELEMENTS (delete_sms_many_tags); j++) {
+            if (!(delete_sms_many_tags[j].filter & filter) ||
+                !delete_sms_many_has_parts (ctx, delete_sms_many_modes[i], delete_sms_many_tags[j].filter))
+                continue;
+            request.filter = delete_sms_many_tags[j].filter;
+            request.tag = delete_sms_many_tags[j].tag;
+            g_array_append_val (ctx->requests, request);
+            ctx->requested[i] |= request.filter;
+        }
+    }
+}
+
+static void
+messaging_delete_sms_many (MMIfaceModemMessaging *_self,
+                           MMSmsStorage storage,
+                           GList *sms_list,
+                           MMSmsDeleteFilter filter,
+                           GAsyncReadyCallback callback,
+                           gpointer user_data)
+{
+    MMBroadbandModemQmi *self = MM_BROADBAND_MODEM_QMI (_self);
+    DeleteSmsManyContext *ctx;
+    QmiClient *client = NULL;
+    GList *l;
+
+    /* Handle fallback */
+    if (self->priv->messaging_fallback_at) {
+        return iface_modem_messaging_parent->delete_sms_many (_self, storage, sms_list, filter, callback, user_data);
+    }
+
+    if (!ensure_qmi_client (MM_BROADBAND_MODEM_QMI (self),
+                            QMI_SERVICE_WMS, &client,
+                            callback, user_data))
+        return;
+
+    ctx = g_slice_new0 (DeleteSmsManyContext);
+    ctx->self = g_object_ref (self);
+    ctx->client = g_object_ref (client);
+    ctx->result = g_simple_async_result_new (G_OBJECT (self),
+                                             callback,
+                                             user_data,
+                                             messaging_delete_sms_many);
+    ctx->storage = storage;
+    ctx->sms_list = g_list_copy (sms_list);
+    ctx->requests = g_array_new (FALSE, FALSE, sizeof (DeleteSmsManyRequest));
+
+    /* Collect all stored parts */
+    for (l = sms_list; l; l = g_list_next (l)) {
+        GList *p;
+
+        for (p = mm_base_sms_get_parts (MM_BASE_SMS (l->data)); p; p = g_list_next (p)) {
+            if (mm_sms_part_get_index ((MMSmsPart *)p->data) != SMS_PART_INVALID_INDEX)
+                ctx->parts = g_list_prepend (ctx->parts, p->data);
+        }
+    }
+    ctx->parts = g_list_reverse (ctx->parts);
+
+    mm_dbg ("Deleting %u SMS parts from storage '%s'",
+            g_list_length (ctx->parts),
+            mm_sms_storage_get_string (storage));
+
+    if (filter != MM_SMS_DELETE_FILTER_NONE)
+        delete_sms_many_add_requests (ctx, filter);
+    delete_sms_many_next_request (ctx);
+}
+
 /*****************************************************************************/
 /* Create SMS (Messaging interface) */
 
@@ -11555,6 +11940,8 @@ iface_modem_messaging_init (MMIfaceModemMessaging *iface)
     iface->disable_unsolicited_events = messaging_disable_unsolicited_events;
     iface->disable_unsolicited_events_finish = messaging_disable_unsolicited_events_finish;
     iface->create_sms = messaging_create_sms;
+    iface->delete_sms_many = messaging_delete_sms_many;
+    iface->delete_sms_many_finish = messaging_delete_sms_many_finish;
 }
 
 static void
@@ -193,7 +193,11 @@ struct _MMBroadbandModemPrivate {
     gboolean mem1_storage_locked;
     MMSmsStorage current_sms_mem1_storage;
     gboolean mem2_storage_locked;
+    guint mem2_storage_lock_count;
+    gboolean mem2_storage_lock_ready;
     MMSmsStorage current_sms_mem2_storage;
+    gboolean sms_cmms_support_checked;
+    gboolean sms_cmms_supported;
 
     /*<--- Modem Voice interface --->*/
     /* Properties */
@@ -513,10 +517,10 @@ parse_caps_cgmm (MMBaseModem *self,
 }
 
 static const MMBaseModemAtCommand capabilities[] = {
-    { "+GCAP",  2, TRUE,  parse_caps_gcap },
-    { "I",      1, TRUE,  parse_caps_gcap }, /* yes, really parse as +GCAP */
-    { "+CPIN?", 1, FALSE, parse_caps_cpin },
-    { "+CGMM",  1, TRUE,  parse_caps_cgmm },
+    { "+GCAP",  2000, TRUE,  parse_caps_gcap },
+    { "I",      1000, TRUE,  parse_caps_gcap }, /* yes, really parse as +GCAP */
+    { "+CPIN?", 1000, FALSE, parse_caps_cpin },
+    { "+CGMM",  1000, TRUE,  parse_caps_cgmm },
     { NULL }
 };
 
@@ -562,7 +566,7 @@ capabilities_sequence_ready (MMBaseModem *self,
         mm_base_modem_at_command (
             MM_BASE_MODEM (ctx->self),
             "+WS46=?",
-            3,
+            3000,
             TRUE, /* allow caching, it's a test command */
             (GAsyncReadyCallback)current_capabilities_ws46_test_ready,
             ctx);
@@ -693,7 +697,7 @@ load_current_capabilities_qcdm (LoadCapabilitiesContext *ctx)
 
     mm_port_serial_qcdm_command (ctx->qcdm_port,
                                  cmd,
-                                 3,
+                                 3000,
                                  NULL,
                                  (GAsyncReadyCallback)mode_pref_qcdm_ready,
                                  ctx);
@@ -757,17 +761,31 @@ modem_load_manufacturer_finish (MMIfaceModem *self,
 }
 
 static const MMBaseModemAtCommand manufacturers[] = {
-    { "+CGMI",  3, TRUE, response_processor_string_ignore_at_errors },
-    { "+GMI",   3, TRUE, response_processor_string_ignore_at_errors },
+    { "+CGMI",  3000, TRUE, response_processor_string_ignore_at_errors },
+    { "+GMI",   3000, TRUE, response_processor_string_ignore_at_errors },
     { NULL }
 };
 
+/* Identification queries replying with a single line each, which ports
+ * flagged with MM_PORT_SERIAL_AT_CONCAT_COMMANDS get in one command line.
+ * The split replies are cached, so the manufacturer, model, revision and
+ * equipment identifier loading steps get them without any further I/O. */
+static const gchar *identification_queries[] = {
+    "+CGMI", "+CGMM", "+CGMR", "+CGSN", NULL
+};
+
+typedef struct {
+    MMIfaceModem *self;
+    MMPortSerialAt *port;
+    GAsyncReadyCallback callback;
+    gpointer user_data;
+} LoadManufacturerContext;
+
 static void
-modem_load_manufacturer (MMIfaceModem *self,
-                         GAsyncReadyCallback callback,
-                         gpointer user_data)
+load_manufacturer_sequence (MMIfaceModem *self,
+                            GAsyncReadyCallback callback,
+                            gpointer user_data)
 {
-    mm_dbg ("loading manufacturer...");
     mm_base_modem_at_sequence (
         MM_BASE_MODEM (self),
         manufacturers,
@@ -777,6 +795,67 @@ modem_load_manufacturer (MMIfaceModem *self,
         user_data);
 }
 
+static void
+identification_queries_ready (MMPortSerialAt *port,
+                              GAsyncResult *res,
+                              LoadManufacturerContext *ctx)
+{
+    gchar **responses;
+    GError *error = NULL;
+
+    responses = mm_port_serial_at_command_concat_finish (port, res, &error);
+    if (!responses) {
+        /* Not critical, each query will be sent on its own */
+        mm_dbg ("couldn't load identification in a single command line: %s", error->message);
+        g_error_free (error);
+    }
+    g_strfreev (responses);
+
+    mm_port_serial_close (MM_PORT_SERIAL (ctx->port));
+
+    /* Replies were cached, so this won't need to talk to the modem */
+    load_manufacturer_sequence (ctx->self, ctx->callback, ctx->user_data);
+
+    g_object_unref (ctx->port);
+    g_object_unref (ctx->self);
+    g_slice_free (LoadManufacturerContext, ctx);
+}
+
+static void
+modem_load_manufacturer (MMIfaceModem *self,
+                         GAsyncReadyCallback callback,
+                         gpointer user_data)
+{
+    MMPortSerialAt *port;
+
+    mm_dbg ("loading manufacturer...");
+
+    port = mm_base_modem_peek_best_at_port (MM_BASE_MODEM (self), NULL);
+    if (port &&
+        mm_port_serial_at_get_concat_commands (port) &&
+        !mm_port_get_connected (MM_PORT (port)) &&
+        mm_port_serial_open (MM_PORT_SERIAL (port), NULL)) {
+        LoadManufacturerContext *ctx;
+
+        ctx = g_slice_new0 (LoadManufacturerContext);
+        ctx->self = g_object_ref (self);
+        ctx->port = g_object_ref (port);
+        ctx->callback = callback;
+        ctx->user_data = user_data;
+
+        mm_port_serial_at_command_concat (port,
+                                          identification_queries,
+                                          6000,
+                                          TRUE,
+                                          NULL,
+                                          (GAsyncReadyCallback) identification_queries_ready,
+                                          ctx);
+        return;
+    }
+
+    load_manufacturer_sequence (self, callback, user_data);
+}
+
 /*****************************************************************************/
 /* Model loading (Modem interface) */
 
@@ -797,8 +876,8 @@ modem_load_model_finish (MMIfaceModem *self,
 }
 
 static const MMBaseModemAtCommand models[] = {
-    { "+CGMM",  3, TRUE, response_processor_string_ignore_at_errors },
-    { "+GMM",   3, TRUE, response_processor_string_ignore_at_errors },
+    { "+CGMM",  3000, TRUE, response_processor_string_ignore_at_errors },
+    { "+GMM",   3000, TRUE, response_processor_string_ignore_at_errors },
     { NULL }
 };
 
@@ -837,8 +916,8 @@ modem_load_revision_finish (MMIfaceModem *self,
 }
 
 static const MMBaseModemAtCommand revisions[] = {
-    { "+CGMR",  3, TRUE, response_processor_string_ignore_at_errors },
-    { "+GMR",   3, TRUE, response_processor_string_ignore_at_errors },
+    { "+CGMR",  3000, TRUE, response_processor_string_ignore_at_errors },
+    { "+GMR",   3000, TRUE, response_processor_string_ignore_at_errors },
     { NULL }
 };
 
@@ -896,8 +975,8 @@ modem_load_equipment_identifier_finish (MMIfaceModem *self,
 }
 
 static const MMBaseModemAtCommand equipment_identifiers[] = {
-    { "+CGSN",  3, TRUE, response_processor_string_ignore_at_errors },
-    { "+GSN",   3, TRUE, response_processor_string_ignore_at_errors },
+    { "+CGSN",  3000, TRUE, response_processor_string_ignore_at_errors },
+    { "+GSN",   3000, TRUE, response_processor_string_ignore_at_errors },
     { NULL }
 };
 
@@ -986,8 +1065,8 @@ parse_ati_reply (MMBaseModem *self,
 }
 
 static const MMBaseModemAtCommand device_identifier_steps[] = {
-    { "ATI",  3, TRUE, (MMBaseModemAtResponseProcessor)parse_ati_reply },
-    { "ATI1", 3, TRUE, (MMBaseModemAtResponseProcessor)parse_ati_reply },
+    { "ATI",  3000, TRUE, (MMBaseModemAtResponseProcessor)parse_ati_reply },
+    { "ATI1", 3000, TRUE, (MMBaseModemAtResponseProcessor)parse_ati_reply },
     { NULL }
 };
 
@@ -1132,7 +1211,7 @@ modem_load_own_numbers_done (MMIfaceModem *self,
 
             mm_port_serial_qcdm_command (ctx->qcdm,
                                          mdn,
-                                         3,
+                                         3000,
                                          NULL,
                                          (GAsyncReadyCallback)mdn_qcdm_ready,
                                          ctx);
@@ -1180,7 +1259,7 @@ modem_load_own_numbers (MMIfaceModem *self,
     mm_dbg ("loading own numbers...");
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CNUM",
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)modem_load_own_numbers_done,
                               ctx);
@@ -1302,7 +1381,7 @@ modem_load_unlock_required (MMIfaceModem *self,
     mm_dbg ("checking if unlock required...");
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CPIN?",
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)cpin_query_ready,
                               result);
@@ -1560,7 +1639,7 @@ load_supported_modes_step (LoadSupportedModesContext *ctx)
         mm_base_modem_at_command (
             MM_BASE_MODEM (ctx->self),
             "*CNTI=2",
-            3,
+            3000,
             FALSE,
             (GAsyncReadyCallback)supported_modes_cnti_ready,
             ctx);
@@ -1571,7 +1650,7 @@ load_supported_modes_step (LoadSupportedModesContext *ctx)
         mm_base_modem_at_command (
             MM_BASE_MODEM (ctx->self),
             "+WS46=?",
-            3,
+            3000,
             TRUE, /* allow caching, it's a test command */
             (GAsyncReadyCallback)supported_modes_ws46_test_ready,
             ctx);
@@ -1582,7 +1661,7 @@ load_supported_modes_step (LoadSupportedModesContext *ctx)
         mm_base_modem_at_command (
             MM_BASE_MODEM (ctx->self),
             "+GCAP",
-            3,
+            3000,
             TRUE, /* allow caching */
             (GAsyncReadyCallback)supported_modes_gcap_ready,
             ctx);
@@ -1704,7 +1783,7 @@ modem_load_supported_ip_families (MMIfaceModem *self,
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
         "+CGDCONT=?",
-        3,
+        3000,
         TRUE, /* allow caching, it's a test command */
         (GAsyncReadyCallback)supported_ip_families_cgdcont_test_ready,
         result);
@@ -1793,8 +1872,8 @@ signal_quality_csq_ready (MMBroadbandModem *self,
  * try the other command if the first one fails.
  */
 static const MMBaseModemAtCommand signal_quality_csq_sequence[] = {
-    { "+CSQ",  3, TRUE, response_processor_string_ignore_at_errors },
-    { "+CSQ?", 3, TRUE, response_processor_string_ignore_at_errors },
+    { "+CSQ",  3000, TRUE, response_processor_string_ignore_at_errors },
+    { "+CSQ?", 3000, TRUE, response_processor_string_ignore_at_errors },
     { NULL }
 };
 
@@ -1898,7 +1977,7 @@ signal_quality_cind (SignalQualityContext *ctx)
     mm_base_modem_at_command_full (MM_BASE_MODEM (ctx->self),
                                    MM_PORT_SERIAL_AT (ctx->port),
                                    "+CIND?",
-                                   3,
+                                   3000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -1985,7 +2064,7 @@ signal_quality_qcdm (SignalQualityContext *ctx)
 
     mm_port_serial_qcdm_command (MM_PORT_SERIAL_QCDM (ctx->port),
                                  pilot_sets,
-                                 3,
+                                 3000,
                                  NULL,
                                  (GAsyncReadyCallback)signal_quality_qcdm_ready,
                                  ctx);
@@ -2239,7 +2318,7 @@ access_tech_qcdm_gsm_ready (MMPortSerialQcdm *port,
 
     mm_port_serial_qcdm_command (port,
                                  cmd,
-                                 3,
+                                 3000,
                                  NULL,
                                  (GAsyncReadyCallback)access_tech_qcdm_wcdma_ready,
                                  ctx);
@@ -2329,7 +2408,7 @@ access_tech_qcdm_cdma_ready (MMPortSerialQcdm *port,
 
     mm_port_serial_qcdm_command (port,
                                  cmd,
-                                 3,
+                                 3000,
                                  NULL,
                                  (GAsyncReadyCallback)access_tech_qcdm_hdr_ready,
                                  ctx);
@@ -2412,7 +2491,7 @@ modem_load_access_technologies (MMIfaceModem *self,
 
         mm_port_serial_qcdm_command (ctx->port,
                                      cmd,
-                                     3,
+                                     3000,
                                      NULL,
                                      (GAsyncReadyCallback)access_tech_qcdm_gsm_ready,
                                      ctx);
@@ -2427,7 +2506,7 @@ modem_load_access_technologies (MMIfaceModem *self,
 
         mm_port_serial_qcdm_command (ctx->port,
                                      cmd,
-                                     3,
+                                     3000,
                                      NULL,
                                      (GAsyncReadyCallback)access_tech_qcdm_cdma_ready,
                                      ctx);
@@ -2607,7 +2686,7 @@ modem_3gpp_setup_unsolicited_events (MMIfaceModem3gpp *_self,
         self->priv->modem_cind_support_checked = TRUE;
         mm_base_modem_at_command (MM_BASE_MODEM (self),
                                   "+CIND=?",
-                                  3,
+                                  3000,
                                   TRUE,
                                   (GAsyncReadyCallback)cind_format_check_ready,
                                   result);
@@ -2718,7 +2797,7 @@ run_unsolicited_events_setup (UnsolicitedEventsContext *ctx)
         mm_base_modem_at_command_full (MM_BASE_MODEM (ctx->self),
                                        port,
                                        ctx->command,
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE, /* raw */
                                        NULL, /* cancellable */
@@ -2884,7 +2963,7 @@ charset_change_ready (MMBroadbandModem *self,
     /* Check whether we did properly set the charset */
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CSCS?",
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)current_charset_query_ready,
                               ctx);
@@ -2925,7 +3004,7 @@ modem_setup_charset (MMIfaceModem *self,
     ctx->charset = charset;
     /* First try, with quotes */
     ctx->charset_commands[0].command = g_strdup_printf ("+CSCS=\"%s\"", charset_str);
-    ctx->charset_commands[0].timeout = 3;
+    ctx->charset_commands[0].timeout_ms = 3000;
     ctx->charset_commands[0].allow_cached = FALSE;
     ctx->charset_commands[0].response_processor = mm_base_modem_response_processor_no_result;
     /* Second try.
@@ -2933,7 +3012,7 @@ modem_setup_charset (MMIfaceModem *self,
      * set name, so lets try it again without them.
      */
     ctx->charset_commands[1].command = g_strdup_printf ("+CSCS=%s", charset_str);
-    ctx->charset_commands[1].timeout = 3;
+    ctx->charset_commands[1].timeout_ms = 3000;
     ctx->charset_commands[1].allow_cached = FALSE;
     ctx->charset_commands[1].response_processor = mm_base_modem_response_processor_no_result;
 
@@ -3014,7 +3093,7 @@ modem_load_supported_charsets (MMIfaceModem *self,
 
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CSCS=?",
-                              3,
+                              3000,
                               TRUE,
                               (GAsyncReadyCallback)cscs_format_check_ready,
                               result);
@@ -3042,7 +3121,7 @@ modem_setup_flow_control (MMIfaceModem *self,
     /* By default, try to set XOFF/XON flow control */
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+IFC=1,1",
-                              3,
+                              3000,
                               FALSE,
                               NULL,
                               NULL);
@@ -3144,7 +3223,7 @@ load_power_state (MMIfaceModem *self,
     mm_dbg ("loading power state...");
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CFUN?",
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)cfun_query_ready,
                               result);
@@ -3177,7 +3256,7 @@ modem_power_up (MMIfaceModem *self,
     else
         mm_base_modem_at_command (MM_BASE_MODEM (self),
                                   "+CFUN=1",
-                                  5,
+                                  5000,
                                   FALSE,
                                   NULL,
                                   NULL);
@@ -3212,7 +3291,8 @@ modem_command (MMIfaceModem *self,
                gpointer user_data)
 {
 
-    mm_base_modem_at_command (MM_BASE_MODEM (self), cmd, timeout,
+    /* The D-Bus Command() timeout is given in seconds */
+    mm_base_modem_at_command (MM_BASE_MODEM (self), cmd, timeout * 1000,
                               FALSE,
                               callback,
                               user_data);
@@ -3247,7 +3327,7 @@ modem_3gpp_load_imei (MMIfaceModem3gpp *self,
     mm_dbg ("loading IMEI...");
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CGSN",
-                              3,
+                              3000,
                               TRUE,
                               callback,
                               user_data);
@@ -3330,7 +3410,7 @@ get_next_facility_lock_status (LoadEnabledFacilityLocksContext *ctx)
                                    mm_3gpp_facility_to_acronym (facility));
             mm_base_modem_at_command (MM_BASE_MODEM (ctx->self),
                                       cmd,
-                                      3,
+                                      3000,
                                       FALSE,
                                       (GAsyncReadyCallback)clck_single_query_ready,
                                       ctx);
@@ -3406,7 +3486,7 @@ modem_3gpp_load_enabled_facility_locks (MMIfaceModem3gpp *self,
     mm_dbg ("loading enabled facility locks...");
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CLCK=?",
-                              3,
+                              3000,
                               TRUE,
                               (GAsyncReadyCallback)clck_test_ready,
                               ctx);
@@ -3442,7 +3522,7 @@ modem_3gpp_load_operator_code (MMIfaceModem3gpp *self,
     mm_dbg ("loading Operator Code...");
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+COPS=3,2;+COPS?",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -3478,7 +3558,7 @@ modem_3gpp_load_operator_name (MMIfaceModem3gpp *self,
     mm_dbg ("loading Operator Name...");
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+COPS=3,0;+COPS?",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -3699,7 +3779,7 @@ modem_3gpp_scan_networks (MMIfaceModem3gpp *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+COPS=?",
-                              120,
+                              120000,
                               FALSE,
                               callback,
                               user_data);
@@ -3740,7 +3820,7 @@ modem_3gpp_register_in_network (MMIfaceModem3gpp *self,
     mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                    mm_base_modem_peek_best_at_port (MM_BASE_MODEM (self), NULL),
                                    command,
-                                   120,
+                                   120000,
                                    FALSE,
                                    FALSE, /* raw */
                                    cancellable,
@@ -3941,7 +4021,7 @@ run_registration_checks_context_step (RunRegistrationChecksContext *ctx)
         /* Check current CS-registration state. */
         mm_base_modem_at_command (MM_BASE_MODEM (ctx->self),
                                   "+CREG?",
-                                  10,
+                                  10000,
                                   FALSE,
                                   (GAsyncReadyCallback)registration_status_check_ready,
                                   ctx);
@@ -3954,7 +4034,7 @@ run_registration_checks_context_step (RunRegistrationChecksContext *ctx)
         /* Check current PS-registration state. */
         mm_base_modem_at_command (MM_BASE_MODEM (ctx->self),
                                   "+CGREG?",
-                                  10,
+                                  10000,
                                   FALSE,
                                   (GAsyncReadyCallback)registration_status_check_ready,
                                   ctx);
@@ -3967,7 +4047,7 @@ run_registration_checks_context_step (RunRegistrationChecksContext *ctx)
         /* Check current EPS-registration state. */
         mm_base_modem_at_command (MM_BASE_MODEM (ctx->self),
                                   "+CEREG?",
-                                  10,
+                                  10000,
                                   FALSE,
                                   (GAsyncReadyCallback)registration_status_check_ready,
                                   ctx);
@@ -4112,43 +4192,43 @@ parse_registration_setup_reply (MMBaseModem *self,
 
 static const MMBaseModemAtCommand cs_registration_sequence[] = {
     /* Enable unsolicited registration notifications in CS network, with location */
-    { "+CREG=2", 3, FALSE, parse_registration_setup_reply },
+    { "+CREG=2", 3000, FALSE, parse_registration_setup_reply },
     /* Enable unsolicited registration notifications in CS network, without location */
-    { "+CREG=1", 3, FALSE, parse_registration_setup_reply },
+    { "+CREG=1", 3000, FALSE, parse_registration_setup_reply },
     { NULL }
 };
 
 static const MMBaseModemAtCommand cs_unregistration_sequence[] = {
     /* Disable unsolicited registration notifications in CS network */
-    { "+CREG=0", 3, FALSE, parse_registration_setup_reply },
+    { "+CREG=0", 3000, FALSE, parse_registration_setup_reply },
     { NULL }
 };
 
 static const MMBaseModemAtCommand ps_registration_sequence[] = {
     /* Enable unsolicited registration notifications in PS network, with location */
-    { "+CGREG=2", 3, FALSE, parse_registration_setup_reply },
+    { "+CGREG=2", 3000, FALSE, parse_registration_setup_reply },
     /* Enable unsolicited registration notifications in PS network, without location */
-    { "+CGREG=1", 3, FALSE, parse_registration_setup_reply },
+    { "+CGREG=1", 3000, FALSE, parse_registration_setup_reply },
     { NULL }
 };
 
 static const MMBaseModemAtCommand ps_unregistration_sequence[] = {
     /* Disable unsolicited registration notifications in PS network */
-    { "+CGREG=0", 3, FALSE, parse_registration_setup_reply },
+    { "+CGREG=0", 3000, FALSE, parse_registration_setup_reply },
     { NULL }
 };
 
 static const MMBaseModemAtCommand eps_registration_sequence[] = {
     /* Enable unsolicited registration notifications in EPS network, with location */
-    { "+CEREG=2", 3, FALSE, parse_registration_setup_reply },
+    { "+CEREG=2", 3000, FALSE, parse_registration_setup_reply },
     /* Enable unsolicited registration notifications in EPS network, without location */
-    { "+CEREG=1", 3, FALSE, parse_registration_setup_reply },
+    { "+CEREG=1", 3000, FALSE, parse_registration_setup_reply },
     { NULL }
 };
 
 static const MMBaseModemAtCommand eps_unregistration_sequence[] = {
     /* Disable unsolicited registration notifications in PS network */
-    { "+CEREG=0", 3, FALSE, parse_registration_setup_reply },
+    { "+CEREG=0", 3000, FALSE, parse_registration_setup_reply },
     { NULL }
 };
 
@@ -4240,7 +4320,7 @@ unsolicited_registration_events_sequence_ready (MMBroadbandModem *self,
                 MM_BASE_MODEM (self),
                 secondary,
                 g_variant_get_string (command, NULL),
-                3,
+                3000,
                 FALSE,
                 FALSE, /* raw */
                 NULL, /* cancellable */
@@ -4434,7 +4514,7 @@ modem_3gpp_ussd_cancel (MMIfaceModem3gppUssd *self,
 
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CUSD=2",
-                              10,
+                              10000,
                               TRUE,
                               (GAsyncReadyCallback)cancel_command_ready,
                               result);
@@ -4571,7 +4651,7 @@ modem_3gpp_ussd_context_send_encoded (Modem3gppUssdSendContext *ctx)
 
     mm_base_modem_at_command (MM_BASE_MODEM (ctx->self),
                               at_command,
-                              10,
+                              10000,
                               FALSE,
                               (GAsyncReadyCallback)ussd_send_command_ready,
                               ctx);
@@ -4598,7 +4678,7 @@ modem_3gpp_ussd_context_send_unencoded (Modem3gppUssdSendContext *ctx)
 
     mm_base_modem_at_command (MM_BASE_MODEM (ctx->self),
                               at_command,
-                              10,
+                              10000,
                               FALSE,
                               (GAsyncReadyCallback)ussd_send_command_ready,
                               ctx);
@@ -4993,7 +5073,7 @@ modem_3gpp_ussd_disable_unsolicited_result_codes (MMIfaceModem3gppUssd *self,
 
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CUSD=0",
-                              3,
+                              3000,
                               TRUE,
                               (GAsyncReadyCallback)urc_enable_disable_ready,
                               result);
@@ -5013,7 +5093,7 @@ modem_3gpp_ussd_enable_unsolicited_result_codes (MMIfaceModem3gppUssd *self,
 
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CUSD=1",
-                              3,
+                              3000,
                               TRUE,
                               (GAsyncReadyCallback)urc_enable_disable_ready,
                               result);
@@ -5065,7 +5145,7 @@ modem_3gpp_ussd_check_support (MMIfaceModem3gppUssd *self,
     /* Check USSD support */
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CUSD=?",
-                              3,
+                              3000,
                               TRUE,
                               (GAsyncReadyCallback)cusd_format_check_ready,
                               result);
@@ -5130,7 +5210,7 @@ modem_messaging_check_support (MMIfaceModemMessaging *self,
     /* Check CNMI support */
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CNMI=?",
-                              3,
+                              3000,
                               TRUE,
                               (GAsyncReadyCallback)cnmi_format_check_ready,
                               result);
@@ -5235,7 +5315,7 @@ modem_messaging_load_supported_storages (MMIfaceModemMessaging *self,
     /* Check support storages */
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CPMS=?",
-                              3,
+                              3000,
                               TRUE,
                               (GAsyncReadyCallback)cpms_format_check_ready,
                               result);
@@ -5306,7 +5386,7 @@ modem_messaging_init_current_storages (MMIfaceModemMessaging *self,
     /* Check support storages */
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CPMS?",
-                              3,
+                              3000,
                               TRUE,
                               (GAsyncReadyCallback)cpms_query_ready,
                               result);
@@ -5329,6 +5409,10 @@ modem_messaging_init_current_storages (MMIfaceModemMessaging *self,
  *
  * Note that mem3 cannot be locked; we just set the default mem3 and that's it.
  *
+ * A mem2 lock that is already in place may be shared by further actions
+ * requesting the very same mem2 storage (and no mem1); the storage is only
+ * unlocked once all of them have released it.
+ *
  * When we unlock the storage, we don't go back to the default storage
  * automatically, we just keep track of which is the current one and only go to
  * the default one if needed.
@@ -5346,7 +5430,11 @@ mm_broadband_modem_unlock_sms_storages (MMBroadbandModem *self,
 
     if (mem2) {
         g_assert (self->priv->mem2_storage_locked);
-        self->priv->mem2_storage_locked = FALSE;
+        g_assert (self->priv->mem2_storage_lock_count > 0);
+        if (--self->priv->mem2_storage_lock_count == 0) {
+            self->priv->mem2_storage_locked = FALSE;
+            self->priv->mem2_storage_lock_ready = FALSE;
+        }
     }
 }
 
@@ -5394,10 +5482,13 @@ lock_storages_cpms_set_ready (MMBaseModem *self,
         if (ctx->mem2_locked) {
             ctx->self->priv->current_sms_mem2_storage = ctx->previous_mem2;
             ctx->self->priv->mem2_storage_locked = FALSE;
+            ctx->self->priv->mem2_storage_lock_count = 0;
         }
-    }
-    else
+    } else {
+        if (ctx->mem2_locked)
+            ctx->self->priv->mem2_storage_lock_ready = TRUE;
         g_simple_async_result_set_op_res_gboolean (ctx->result, TRUE);
+    }
 
     lock_sms_storages_context_complete_and_free (ctx);
 }
@@ -5414,6 +5505,26 @@ mm_broadband_modem_lock_sms_storages (MMBroadbandModem *self,
     gchar *mem1_str = NULL;
     gchar *mem2_str = NULL;
 
+    /* A mem2 lock already in place for the very same storage may be shared,
+     * e.g. by all the messages of a send batch */
+    if (mem1 == MM_SMS_STORAGE_UNKNOWN &&
+        mem2 != MM_SMS_STORAGE_UNKNOWN &&
+        self->priv->mem2_storage_locked &&
+        self->priv->mem2_storage_lock_ready &&
+        self->priv->current_sms_mem2_storage == mem2) {
+        GSimpleAsyncResult *result;
+
+        self->priv->mem2_storage_lock_count++;
+        result = g_simple_async_result_new (G_OBJECT (self),
+                                            callback,
+                                            user_data,
+                                            mm_broadband_modem_lock_sms_storages);
+        g_simple_async_result_set_op_res_gboolean (result, TRUE);
+        g_simple_async_result_complete_in_idle (result);
+        g_object_unref (result);
+        return;
+    }
+
     /* If storages are currently locked by someone else, just return an
      * error */
     if ((mem1 != MM_SMS_STORAGE_UNKNOWN && self->priv->mem1_storage_locked) ||
@@ -5451,6 +5562,7 @@ mm_broadband_modem_lock_sms_storages (MMBroadbandModem *self,
         ctx->mem2_locked = TRUE;
         ctx->previous_mem2 = self->priv->current_sms_mem2_storage;
         self->priv->mem2_storage_locked = TRUE;
+        self->priv->mem2_storage_lock_count = 1;
         self->priv->current_sms_mem2_storage = mem2;
         mem2_str = g_ascii_strup (mm_sms_storage_get_string (self->priv->current_sms_mem2_storage), -1);
 
@@ -5481,7 +5593,7 @@ mm_broadband_modem_lock_sms_storages (MMBroadbandModem *self,
 
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               cmd,
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)lock_storages_cpms_set_ready,
                               ctx);
@@ -5490,6 +5602,76 @@ mm_broadband_modem_lock_sms_storages (MMBroadbandModem *self,
     g_free (cmd);
 }
 
+/*****************************************************************************/
+/* Keeping the SMS relay link open
+ *
+ * With +CMMS=1 the modem keeps the relay protocol link up between sends, as
+ * long as the next send command comes in before the module timeout (1-5s);
+ * once the timeout expires the modem goes back to +CMMS=0 by itself, so there
+ * is no need to explicitly disable it afterwards.
+ */
+
+gboolean
+mm_broadband_modem_keep_sms_link_open_finish (MMBroadbandModem *self,
+                                              GAsyncResult *res,
+                                              GError **error)
+{
+    return !g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error);
+}
+
+static void
+cmms_set_ready (MMBaseModem *_self,
+                GAsyncResult *res,
+                GSimpleAsyncResult *simple)
+{
+    MMBroadbandModem *self = MM_BROADBAND_MODEM (_self);
+    GError *error = NULL;
+
+    mm_base_modem_at_command_finish (_self, res, &error);
+
+    /* Timeouts don't tell anything about whether the command is supported */
+    if (!self->priv->sms_cmms_support_checked &&
+        !g_error_matches (error, MM_SERIAL_ERROR, MM_SERIAL_ERROR_RESPONSE_TIMEOUT)) {
+        self->priv->sms_cmms_support_checked = TRUE;
+        self->priv->sms_cmms_supported = !error;
+        mm_dbg ("Keeping the SMS relay link open is %ssupported",
+                self->priv->sms_cmms_supported ? "" : "not ");
+    }
+
+    if (error)
+        g_simple_async_result_take_error (simple, error);
+    else
+        g_simple_async_result_set_op_res_gboolean (simple, TRUE);
+    g_simple_async_result_complete (simple);
+    g_object_unref (simple);
+}
+
+void
+mm_broadband_modem_keep_sms_link_open (MMBroadbandModem *self,
+                                       GAsyncReadyCallback callback,
+                                       gpointer user_data)
+{
+    if (self->priv->sms_cmms_support_checked && !self->priv->sms_cmms_supported) {
+        g_simple_async_report_error_in_idle (G_OBJECT (self),
+                                             callback,
+                                             user_data,
+                                             MM_CORE_ERROR,
+                                             MM_CORE_ERROR_UNSUPPORTED,
+                                             "Keeping the SMS relay link open is not supported");
+        return;
+    }
+
+    mm_base_modem_at_command (MM_BASE_MODEM (self),
+                              "+CMMS=1",
+                              3000,
+                              FALSE,
+                              (GAsyncReadyCallback)cmms_set_ready,
+                              g_simple_async_result_new (G_OBJECT (self),
+                                                         callback,
+                                                         user_data,
+                                                         mm_broadband_modem_keep_sms_link_open));
+}
+
 /*****************************************************************************/
 /* Set default SMS storage (Messaging interface) */
 
@@ -5547,7 +5729,7 @@ modem_messaging_set_default_storage (MMIfaceModemMessaging *_self,
                            mem_str);
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               cmd,
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)cpms_set_ready,
                               result);
@@ -5599,7 +5781,7 @@ set_preferred_sms_format (MMBroadbandModem *self,
                            self->priv->modem_messaging_sms_pdu_mode ? "0" : "1");
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               cmd,
-                              3,
+                              3000,
                               TRUE,
                               (GAsyncReadyCallback)cmgf_set_ready,
                               result);
@@ -5665,7 +5847,7 @@ modem_messaging_setup_sms_format (MMIfaceModemMessaging *self,
     /* Check supported SMS formats */
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CMGF=?",
-                              3,
+                              3000,
                               TRUE,
                               (GAsyncReadyCallback)cmgf_format_check_ready,
                               result);
@@ -5771,7 +5953,7 @@ indication_lock_storages_ready (MMBroadbandModem *self,
     command = g_strdup_printf ("+CMGR=%d", ctx->idx);
     mm_base_modem_at_command (MM_BASE_MODEM (ctx->self),
                               command,
-                              10,
+                              10000,
                               FALSE,
                               (GAsyncReadyCallback)sms_part_ready,
                               ctx);
@@ -5959,16 +6141,16 @@ cnmi_response_processor (MMBaseModem *self,
 }
 
 static const MMBaseModemAtCommand cnmi_sequence[] = {
-    { "+CNMI=2,1,2,1,0", 3, FALSE, cnmi_response_processor },
+    { "+CNMI=2,1,2,1,0", 3000, FALSE, cnmi_response_processor },
 
     /* Many Qualcomm-based devices don't support <ds> of '1', despite
      * reporting they support it in the +CNMI=? response.  But they do
      * accept '2'.
      */
-    { "+CNMI=2,1,2,2,0", 3, FALSE, cnmi_response_processor },
+    { "+CNMI=2,1,2,2,0", 3000, FALSE, cnmi_response_processor },
 
     /* Last resort: turn off delivery status reports altogether */
-    { "+CNMI=2,1,2,0,0", 3, FALSE, cnmi_response_processor },
+    { "+CNMI=2,1,2,0,0", 3000, FALSE, cnmi_response_processor },
     { NULL }
 };
 
@@ -6073,21 +6255,45 @@ modem_messaging_enable_unsolicited_events (MMIfaceModemMessaging *self,
 /*****************************************************************************/
 /* Load initial list of SMS parts (Messaging interface) */
 
+/* Max number of CMGL entries imported in a single main loop iteration */
+#define LIST_PARTS_CHUNK_SIZE 32
+
 typedef struct {
     MMBroadbandModem *self;
     GSimpleAsyncResult *result;
     MMSmsStorage list_storage;
+    MMSmsList *list;
+    gchar *response;
+    const gchar *response_cursor;
+    guint n_parts;
 } ListPartsContext;
 
 static void
 list_parts_context_complete_and_free (ListPartsContext *ctx)
 {
+    if (ctx->list) {
+        mm_sms_list_end_batch (ctx->list);
+        g_object_unref (ctx->list);
+    }
     g_simple_async_result_complete (ctx->result);
     g_object_unref (ctx->result);
     g_object_unref (ctx->self);
+    g_free (ctx->response);
     g_free (ctx);
 }
 
+static void
+list_parts_context_begin_batch (ListPartsContext *ctx)
+{
+    /* All parts found are reported as a single batch, so that the list of
+     * messages exposed in DBus gets updated just once */
+    g_object_get (ctx->self,
+                  MM_IFACE_MODEM_MESSAGING_SMS_LIST, &ctx->list,
+                  NULL);
+    if (ctx->list)
+        mm_sms_list_begin_batch (ctx->list);
+}
+
 static gboolean
 modem_messaging_load_initial_sms_parts_finish (MMIfaceModemMessaging *self,
                                                GAsyncResult *res,
@@ -6144,8 +6350,8 @@ sms_text_part_list_ready (MMBroadbandModem *self,
     }
 
     /* +CMGL: <index>,<stat>,<oa/da>,[alpha],<scts><CR><LF><data><CR><LF> */
-    r = g_regex_new ("\\+CMGL:\\s*(\\d+)\\s*,\\s*([^,]*),\\s*([^,]*),\\s*([^,]*),\\s*([^\\r\\n]*)\\r\\n([^\\r\\n]*)",
-                     0, 0, NULL);
+    r = mm_regex_registry_get ("\\+CMGL:\\s*(\\d+)\\s*,\\s*([^,]*),\\s*([^,]*),\\s*([^,]*),\\s*([^\\r\\n]*)\\r\\n([^\\r\\n]*)",
+                               0);
     g_assert (r);
 
     if (!g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, NULL)) {
@@ -6159,6 +6365,8 @@ sms_text_part_list_ready (MMBroadbandModem *self,
         return;
     }
 
+    list_parts_context_begin_batch (ctx);
+
     while (g_match_info_matches (match_info)) {
         MMSmsPart *part;
         guint matches, idx;
@@ -6254,41 +6462,36 @@ sms_state_from_index (guint index)
     }
 }
 
-static void
-sms_pdu_part_list_ready (MMBroadbandModem *self,
-                         GAsyncResult *res,
-                         ListPartsContext *ctx)
+static gboolean
+sms_pdu_part_list_process_chunk (ListPartsContext *ctx)
 {
-    const gchar *response;
     GError *error = NULL;
-    GList *info_list;
-    GList *l;
-
-    /* Always always always unlock mem1 storage. Warned you've been. */
-    mm_broadband_modem_unlock_sms_storages (self, TRUE, FALSE);
-
-    response = mm_base_modem_at_command_finish (MM_BASE_MODEM (self), res, &error);
-    if (error) {
-        g_simple_async_result_take_error (ctx->result, error);
-        list_parts_context_complete_and_free (ctx);
-        return;
-    }
-
-    info_list = mm_3gpp_parse_pdu_cmgl_response (response, &error);
-    if (error) {
-        g_simple_async_result_take_error (ctx->result, error);
-        list_parts_context_complete_and_free (ctx);
-        return;
-    }
+    guint i;
 
-    for (l = info_list; l; l = g_list_next (l)) {
-        MM3gppPduInfo *info = l->data;
+    for (i = 0; i < LIST_PARTS_CHUNK_SIZE; i++) {
+        MM3gppPduInfo *info;
         MMSmsPart *part;
 
+        info = mm_3gpp_parse_pdu_cmgl_response_next (&ctx->response_cursor, &error);
+        if (!info) {
+            if (error)
+                g_simple_async_result_take_error (ctx->result, error);
+            else {
+                mm_dbg ("Listed %u SMS parts in storage '%s'",
+                        ctx->n_parts,
+                        mm_sms_storage_get_string (ctx->list_storage));
+                /* We consider all done */
+                g_simple_async_result_set_op_res_gboolean (ctx->result, TRUE);
+            }
+            list_parts_context_complete_and_free (ctx);
+            return G_SOURCE_REMOVE;
+        }
+
+        ctx->n_parts++;
         part = mm_sms_part_3gpp_new_from_pdu (info->index, info->pdu, &error);
         if (part) {
             mm_dbg ("Correctly parsed PDU (%d)", info->index);
-            mm_iface_modem_messaging_take_part (MM_IFACE_MODEM_MESSAGING (self),
+            mm_iface_modem_messaging_take_part (MM_IFACE_MODEM_MESSAGING (ctx->self),
                                                 part,
                                                 sms_state_from_index (info->status),
                                                 ctx->list_storage);
@@ -6297,13 +6500,38 @@ sms_pdu_part_list_ready (MMBroadbandModem *self,
             mm_dbg ("Error parsing PDU (%d): %s", info->index, error->message);
             g_clear_error (&error);
         }
+        mm_3gpp_pdu_info_free (info);
     }
 
-    mm_3gpp_pdu_info_list_free (info_list);
+    /* Let the main loop run before going on with the next chunk */
+    return G_SOURCE_CONTINUE;
+}
 
-    /* We consider all done */
-    g_simple_async_result_set_op_res_gboolean (ctx->result, TRUE);
-    list_parts_context_complete_and_free (ctx);
+static void
+sms_pdu_part_list_ready (MMBroadbandModem *self,
+                         GAsyncResult *res,
+                         ListPartsContext *ctx)
+{
+    const gchar *response;
+    GError *error = NULL;
+
+    /* Always always always unlock mem1 storage. Warned you've been. */
+    mm_broadband_modem_unlock_sms_storages (self, TRUE, FALSE);
+
+    response = mm_base_modem_at_command_finish (MM_BASE_MODEM (self), res, &error);
+    if (error) {
+        g_simple_async_result_take_error (ctx->result, error);
+        list_parts_context_complete_and_free (ctx);
+        return;
+    }
+
+    /* Entries are parsed and imported in chunks, so that a full storage
+     * doesn't block the main loop while the SMS objects get created */
+    ctx->response = g_strdup (response);
+    ctx->response_cursor = ctx->response;
+    list_parts_context_begin_batch (ctx);
+    if (sms_pdu_part_list_process_chunk (ctx) == G_SOURCE_CONTINUE)
+        g_idle_add ((GSourceFunc)sms_pdu_part_list_process_chunk, ctx);
 }
 
 static void
@@ -6329,7 +6557,7 @@ list_parts_lock_storages_ready (MMBroadbandModem *self,
                               (MM_BROADBAND_MODEM (self)->priv->modem_messaging_sms_pdu_mode ?
                                "+CMGL=4" :
                                "+CMGL=\"ALL\""),
-                              20,
+                              20000,
                               FALSE,
                               (GAsyncReadyCallback) (MM_BROADBAND_MODEM (self)->priv->modem_messaging_sms_pdu_mode ?
                                                      sms_pdu_part_list_ready :
@@ -6364,6 +6592,234 @@ modem_messaging_load_initial_sms_parts (MMIfaceModemMessaging *self,
                                           ctx);
 }
 
+/*****************************************************************************/
+/* Delete multiple SMS from the same storage (Messaging interface) */
+
+typedef struct {
+    MMBroadbandModem *self;
+    GSimpleAsyncResult *result;
+    MMSmsStorage storage;
+    MMSmsDeleteFilter filter;
+    gboolean need_unlock;
+    /* List of MMSmsPart, non-owned; the caller keeps the SMS alive */
+    GList *parts;
+    GList *current;
+    guint n_failed;
+} DeleteSmsManyContext;
+
+static void
+delete_sms_many_context_complete_and_free (DeleteSmsManyContext *ctx)
+{
+    g_simple_async_result_complete_in_idle (ctx->result);
+    g_object_unref (ctx->result);
+    /* Unlock mem1 storage if we had the lock */
+    if (ctx->need_unlock)
+        mm_broadband_modem_unlock_sms_storages (ctx->self, TRUE, FALSE);
+    g_list_free (ctx->parts);
+    g_object_unref (ctx->self);
+    g_free (ctx);
+}
+
+static gboolean
+modem_messaging_delete_sms_many_finish (MMIfaceModemMessaging *self,
+                                        GAsyncResult *res,
+                                        GError **error)
+{
+    return !g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error);
+}
+
+static void delete_sms_many_next_part (DeleteSmsManyContext *ctx);
+
+static void
+delete_sms_many_part_ready (MMBaseModem *self,
+                            GAsyncResult *res,
+                            DeleteSmsManyContext *ctx)
+{
+    GError *error = NULL;
+
+    mm_base_modem_at_command_finish (self, res, &error);
+    if (error) {
+        ctx->n_failed++;
+        mm_dbg ("Couldn't delete SMS part with index %u: '%s'",
+                mm_sms_part_get_index ((MMSmsPart *)ctx->current->data),
+                error->message);
+        g_error_free (error);
+    } else
+        /* We reset the index, as there is no longer that part */
+        mm_sms_part_set_index ((MMSmsPart *)ctx->current->data, SMS_PART_INVALID_INDEX);
+
+    ctx->current = g_list_next (ctx->current);
+    delete_sms_many_next_part (ctx);
+}
+
+static void
+delete_sms_many_next_part (DeleteSmsManyContext *ctx)
+{
+    gchar *cmd;
+
+    /* If all removed, we're done */
+    if (!ctx->current) {
+        if (ctx->n_failed > 0)
+            g_simple_async_result_set_error (ctx->result,
+                                             MM_CORE_ERROR,
+                                             MM_CORE_ERROR_FAILED,
+                                             "Couldn't delete %u SMS parts from storage '%s'",
+                                             ctx->n_failed,
+                                             mm_sms_storage_get_string (ctx->storage));
+        else
+            g_simple_async_result_set_op_res_gboolean (ctx->result, TRUE);
+
+        delete_sms_many_context_complete_and_free (ctx);
+        return;
+    }
+
+    cmd = g_strdup_printf ("+CMGD=%d",
+                           mm_sms_part_get_index ((MMSmsPart *)ctx->current->data));
+    mm_base_modem_at_command (MM_BASE_MODEM (ctx->self),
+                              cmd,
+                              10000,
+                              FALSE,
+                              (GAsyncReadyCallback)delete_sms_many_part_ready,
+                              ctx);
+    g_free (cmd);
+}
+
+static void
+delete_sms_many_all_ready (MMBaseModem *self,
+                           GAsyncResult *res,
+                           DeleteSmsManyContext *ctx)
+{
+    GError *error = NULL;
+    GList *l;
+
+    mm_base_modem_at_command_finish (self, res, &error);
+    if (error) {
+        /* Not all modems support the delete flags; go one by one */
+        mm_dbg ("Couldn't delete all SMS from storage '%s', deleting one by one: '%s'",
+                mm_sms_storage_get_string (ctx->storage),
+                error->message);
+        g_error_free (error);
+        ctx->current = ctx->parts;
+        delete_sms_many_next_part (ctx);
+        return;
+    }
+
+    for (l = ctx->parts; l; l = g_list_next (l))
+        mm_sms_part_set_index ((MMSmsPart *)l->data, SMS_PART_INVALID_INDEX);
+
+    g_simple_async_result_set_op_res_gboolean (ctx->result, TRUE);
+    delete_sms_many_context_complete_and_free (ctx);
+}
+
+/* +CMGD <delflag> removing the messages matching the filter from the mem1
+ * storage, or -1 if there's none:
+ *   1: received read messages
+ *   2: received read and sent messages
+ *   3: received read, sent and unsent messages
+ *   4: all messages
+ * The received messages known are all read, as listing or reading them with
+ * +CMGL or +CMGR marks them so. */
+static gint
+delete_filter_to_cmgd_delflag (MMSmsDeleteFilter filter)
+{
+    switch ((guint) filter) {
+    case MM_SMS_DELETE_FILTER_RECEIVED:
+        return 1;
+    case MM_SMS_DELETE_FILTER_RECEIVED | MM_SMS_DELETE_FILTER_SENT:
+        return 2;
+    case MM_SMS_DELETE_FILTER_RECEIVED | MM_SMS_DELETE_FILTER_SENT | MM_SMS_DELETE_FILTER_UNSENT:
+        return 3;
+    case MM_SMS_DELETE_FILTER_ALL:
+        return 4;
+    default:
+        return -1;
+    }
+}
+
+static void
+delete_sms_many_lock_storages_ready (MMBroadbandModem *self,
+                                     GAsyncResult *res,
+                                     DeleteSmsManyContext *ctx)
+{
+    GError *error = NULL;
+    gchar *cmd;
+    gint delflag;
+
+    if (!mm_broadband_modem_lock_sms_storages_finish (self, res, &error)) {
+        g_simple_async_result_take_error (ctx->result, error);
+        delete_sms_many_context_complete_and_free (ctx);
+        return;
+    }
+
+    /* We are now locked. Whatever result we have here, we need to make sure
+     * we unlock the storages before finishing. */
+    ctx->need_unlock = TRUE;
+
+    /* Other filters need the messages removed one by one */
+    delflag = delete_filter_to_cmgd_delflag (ctx->filter);
+    if (delflag < 0 || !ctx->parts) {
+        ctx->current = ctx->parts;
+        delete_sms_many_next_part (ctx);
+        return;
+    }
+
+    /* The delete flag removes every message matching it in the mem1 storage
+     * in one go; the index is ignored but must still be given. */
+    cmd = g_strdup_printf ("+CMGD=%d,%d",
+                           mm_sms_part_get_index ((MMSmsPart *)ctx->parts->data),
+                           delflag);
+    mm_base_modem_at_command (MM_BASE_MODEM (self),
+                              cmd,
+                              30000,
+                              FALSE,
+                              (GAsyncReadyCallback)delete_sms_many_all_ready,
+                              ctx);
+    g_free (cmd);
+}
+
+static void
+modem_messaging_delete_sms_many (MMIfaceModemMessaging *self,
+                                 MMSmsStorage storage,
+                                 GList *sms_list,
+                                 MMSmsDeleteFilter filter,
+                                 GAsyncReadyCallback callback,
+                                 gpointer user_data)
+{
+    DeleteSmsManyContext *ctx;
+    GList *l;
+
+    ctx = g_new0 (DeleteSmsManyContext, 1);
+    ctx->self = g_object_ref (self);
+    ctx->result = g_simple_async_result_new (G_OBJECT (self),
+                                             callback,
+                                             user_data,
+                                             modem_messaging_delete_sms_many);
+    ctx->storage = storage;
+    ctx->filter = filter;
+
+    /* Collect all stored parts */
+    for (l = sms_list; l; l = g_list_next (l)) {
+        GList *p;
+
+        for (p = mm_base_sms_get_parts (MM_BASE_SMS (l->data)); p; p = g_list_next (p)) {
+            if (mm_sms_part_get_index ((MMSmsPart *)p->data) != SMS_PART_INVALID_INDEX)
+                ctx->parts = g_list_prepend (ctx->parts, p->data);
+        }
+    }
+    ctx->parts = g_list_reverse (ctx->parts);
+
+    mm_dbg ("Deleting %u SMS parts from storage '%s'",
+            g_list_length (ctx->parts),
+            mm_sms_storage_get_string (storage));
+
+    /* Select specific storage to delete from, once for all parts */
+    mm_broadband_modem_lock_sms_storages (ctx->self,
+                                          storage,
+                                          MM_SMS_STORAGE_UNKNOWN, /* none required for mem2 */
+                                          (GAsyncReadyCallback)delete_sms_many_lock_storages_ready,
+                                          ctx);
+}
+
 /*****************************************************************************/
 /* Create SMS (Messaging interface) */
 
@@ -6422,7 +6878,7 @@ modem_voice_check_support (MMIfaceModemVoice *self,
     /* Check ATH support */
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "H",
-                              3,
+                              3000,
                               TRUE,
                               (GAsyncReadyCallback)ath_format_check_ready,
                               result);
@@ -6612,9 +7068,9 @@ ring_response_processor (MMBaseModem *self,
 
 static const MMBaseModemAtCommand ring_sequence[] = {
     /* Show caller number on RING. */
-    { "+CLIP=1", 3, FALSE, ring_response_processor },
+    { "+CLIP=1", 3000, FALSE, ring_response_processor },
     /* Show difference between data call and voice call */
-    { "+CRC=1", 3, FALSE, ring_response_processor },
+    { "+CRC=1", 3000, FALSE, ring_response_processor },
     { NULL }
 };
 
@@ -6670,7 +7126,7 @@ modem_cdma_load_esn (MMIfaceModemCdma *self,
     mm_dbg ("loading ESN...");
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+GSN",
-                              3,
+                              3000,
                               TRUE,
                               callback,
                               user_data);
@@ -6706,7 +7162,7 @@ modem_cdma_load_meid (MMIfaceModemCdma *self,
     mm_dbg ("loading MEID...");
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+GSN",
-                              3,
+                              3000,
                               TRUE,
                               callback,
                               user_data);
@@ -6839,7 +7295,7 @@ modem_cdma_get_hdr_state (MMIfaceModemCdma *self,
 
     mm_port_serial_qcdm_command (ctx->qcdm,
                                  hdrstate,
-                                 3,
+                                 3000,
                                  NULL,
                                  (GAsyncReadyCallback)hdr_subsys_state_info_ready,
                                  ctx);
@@ -6967,7 +7423,7 @@ modem_cdma_get_call_manager_state (MMIfaceModemCdma *self,
 
     mm_port_serial_qcdm_command (ctx->qcdm,
                                  cmstate,
-                                 3,
+                                 3000,
                                  NULL,
                                  (GAsyncReadyCallback)cm_subsys_state_info_ready,
                                  ctx);
@@ -7184,7 +7640,7 @@ qcdm_cdma_status_ready (MMPortSerialQcdm *port,
         /* If there was some error, fall back to use +CSS like we did before QCDM */
         mm_base_modem_at_command (MM_BASE_MODEM (ctx->self),
                                   "+CSS?",
-                                  3,
+                                  3000,
                                   FALSE,
                                   (GAsyncReadyCallback)css_query_ready,
                                   ctx);
@@ -7249,7 +7705,7 @@ modem_cdma_get_cdma1x_serving_system (MMIfaceModemCdma *self,
         g_assert (cdma_status->len);
         mm_port_serial_qcdm_command (ctx->qcdm,
                                      cdma_status,
-                                     3,
+                                     3000,
                                      NULL,
                                      (GAsyncReadyCallback)qcdm_cdma_status_ready,
                                      ctx);
@@ -7260,7 +7716,7 @@ modem_cdma_get_cdma1x_serving_system (MMIfaceModemCdma *self,
     /* Try with AT if we don't have QCDM */
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CSS?",
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)css_query_ready,
                               ctx);
@@ -7327,7 +7783,7 @@ modem_cdma_get_service_status (MMIfaceModemCdma *self,
 
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CAD?",
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)cad_query_ready,
                               result);
@@ -7476,7 +7932,7 @@ spservice_ready (MMIfaceModemCdma *self,
     /* Get roaming status to override generic registration state */
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "$SPERI?",
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)speri_ready,
                               ctx);
@@ -7521,7 +7977,7 @@ modem_cdma_get_detailed_registration_state (MMIfaceModemCdma *self,
      * supported, we checked it in setup_registration_checks() */
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+SPSERVICE?",
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)spservice_ready,
                               ctx);
@@ -7656,7 +8112,7 @@ spservice_check_ready (MMIfaceModemCdma *self,
     ctx->self->priv->has_spservice = TRUE;
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "$SPERI?",
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)speri_check_ready,
                               ctx);
@@ -7691,7 +8147,7 @@ modem_cdma_setup_registration_checks (MMIfaceModemCdma *self,
     /* Otherwise, launch Sprint command checks. */
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+SPSERVICE?",
-                              3,
+                              3000,
                               FALSE,
                               (GAsyncReadyCallback)spservice_check_ready,
                               ctx);
@@ -7978,7 +8434,7 @@ modem_time_load_network_time (MMIfaceModemTime *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CCLK?",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -8010,7 +8466,7 @@ modem_time_load_network_timezone (MMIfaceModemTime *self,
 {
     mm_base_modem_at_command (MM_BASE_MODEM (self),
                               "+CCLK?",
-                              3,
+                              3000,
                               FALSE,
                               callback,
                               user_data);
@@ -8020,8 +8476,8 @@ modem_time_load_network_timezone (MMIfaceModemTime *self,
 /* Check support (Time interface) */
 
 static const MMBaseModemAtCommand time_check_sequence[] = {
-    { "+CTZU=1",  3, TRUE, mm_base_modem_response_processor_no_result_continue },
-    { "+CCLK?",   3, TRUE, mm_base_modem_response_processor_string },
+    { "+CTZU=1",  3000, TRUE, mm_base_modem_response_processor_no_result_continue },
+    { "+CCLK?",   3000, TRUE, mm_base_modem_response_processor_string },
     { NULL }
 };
 
@@ -8267,12 +8723,12 @@ open_ports_initialization (MMBroadbandModem *self,
     /* Try to disable echo */
     mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                    ctx->primary,
-                                   "E0", 3,
+                                   "E0", 3000,
                                    FALSE, FALSE, NULL, NULL, NULL);
     /* Try to get extended errors */
     mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                    ctx->primary,
-                                   "+CMEE=1", 3,
+                                   "+CMEE=1", 3000,
                                    FALSE, FALSE, NULL, NULL, NULL);
 
     return TRUE;
@@ -8344,7 +8800,7 @@ enabling_modem_init (MMBroadbandModem *self,
     mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                    mm_base_modem_peek_port_primary (MM_BASE_MODEM (self)),
                                    "Z",
-                                   6,
+                                   6000,
                                    FALSE,
                                    FALSE,
                                    NULL, /* cancellable */
@@ -10478,6 +10934,8 @@ iface_modem_messaging_init (MMIfaceModemMessaging *iface)
     iface->cleanup_unsolicited_events = modem_messaging_cleanup_unsolicited_events;
     iface->cleanup_unsolicited_events_finish = modem_messaging_setup_cleanup_unsolicited_events_finish;
     iface->create_sms = modem_messaging_create_sms;
+    iface->delete_sms_many = modem_messaging_delete_sms_many;
+    iface->delete_sms_many_finish = modem_messaging_delete_sms_many_finish;
     iface->init_current_storages = modem_messaging_init_current_storages;
     iface->init_current_storages_finish = modem_messaging_init_current_storages_finish;
 }
@@ -128,4 +128,12 @@ void     mm_broadband_modem_unlock_sms_storages      (MMBroadbandModem *self,
                                                       gboolean mem1,
                                                       gboolean mem2);
 
+/* Keeping the SMS relay link open (+CMMS) while sending multiple messages */
+void     mm_broadband_modem_keep_sms_link_open        (MMBroadbandModem *self,
+                                                       GAsyncReadyCallback callback,
+                                                       gpointer user_data);
+gboolean mm_broadband_modem_keep_sms_link_open_finish (MMBroadbandModem *self,
+                                                       GAsyncResult *res,
+                                                       GError **error);
+
 #endif /* MM_BROADBAND_MODEM_H */
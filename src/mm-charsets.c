@@ -45,20 +45,41 @@ static CharsetEntry charset_map[] = {
     { NULL,      NULL,     NULL,        NULL,                  MM_MODEM_CHARSET_UNKNOWN }
 };
 
+/* Index in charset_map of each charset, by the bit set in its value */
+static const guint charset_map_index[] = {
+    3, /* GSM */
+    2, /* IRA */
+    4, /* 8859-1 */
+    0, /* UTF-8 */
+    1, /* UCS2 */
+    5, /* PCCP437 */
+    6, /* PCDN */
+    7, /* HEX */
+};
+
+static const CharsetEntry *
+charset_entry_lookup (MMModemCharset charset)
+{
+    gint bit;
+
+    bit = g_bit_nth_lsf (charset, -1);
+    if (bit < 0 || bit >= (gint) G_N_ELEMENTS (charset_map_index) || charset != (1u << bit))
+        return NULL;
+
+    g_assert (charset_map[charset_map_index[bit]].charset == charset);
+    return &charset_map[charset_map_index[bit]];
+}
+
 const char *
 mm_modem_charset_to_string (MMModemCharset charset)
 {
-    CharsetEntry *iter = &charset_map[0];
+    const CharsetEntry *entry;
 
     g_return_val_if_fail (charset != MM_MODEM_CHARSET_UNKNOWN, NULL);
 
-    while (iter->gsm_name) {
-        if (iter->charset == charset)
-            return iter->gsm_name;
-        iter++;
-    }
-    g_warn_if_reached ();
-    return NULL;
+    entry = charset_entry_lookup (charset);
+    g_warn_if_fail (entry != NULL);
+    return entry ? entry->gsm_name : NULL;
 }
 
 MMModemCharset
@@ -81,60 +102,303 @@ mm_modem_charset_from_string (const char *string)
 static const char *
 charset_iconv_to (MMModemCharset charset)
 {
-    CharsetEntry *iter = &charset_map[0];
+    const CharsetEntry *entry;
 
     g_return_val_if_fail (charset != MM_MODEM_CHARSET_UNKNOWN, NULL);
 
-    while (iter->gsm_name) {
-        if (iter->charset == charset)
-            return iter->iconv_to_name;
-        iter++;
-    }
-    g_warn_if_reached ();
-    return NULL;
+    entry = charset_entry_lookup (charset);
+    g_warn_if_fail (entry != NULL);
+    return entry ? entry->iconv_to_name : NULL;
 }
 
 static const char *
 charset_iconv_from (MMModemCharset charset)
 {
-    CharsetEntry *iter = &charset_map[0];
+    const CharsetEntry *entry;
 
     g_return_val_if_fail (charset != MM_MODEM_CHARSET_UNKNOWN, NULL);
 
-    while (iter->gsm_name) {
-        if (iter->charset == charset)
-            return iter->iconv_from_name;
-        iter++;
+    entry = charset_entry_lookup (charset);
+    g_warn_if_fail (entry != NULL);
+    return entry ? entry->iconv_from_name : NULL;
+}
+
+/*****************************************************************************/
+/* Cached iconv converters */
+
+typedef enum {
+    CONVERSION_TO_UTF8,            /* "UTF-8//TRANSLIT" <- iconv_from_name */
+    CONVERSION_FROM_UTF8,          /* iconv_from_name   <- "UTF-8" */
+    CONVERSION_FROM_UTF8_TRANSLIT, /* iconv_to_name     <- "UTF-8" */
+    N_CONVERSIONS
+} Conversion;
+
+/* Opening an iconv descriptor is expensive, so they're opened on first use
+ * and kept around; NULL if not yet opened, (GIConv)-1 if unsupported */
+static GIConv iconv_cache[G_N_ELEMENTS (charset_map)][N_CONVERSIONS];
+G_LOCK_DEFINE_STATIC (iconv_cache);
+
+static gchar *
+charset_iconv_convert (MMModemCharset charset,
+                       Conversion conversion,
+                       const gchar *str,
+                       gssize len,
+                       gsize *bytes_read,
+                       gsize *bytes_written,
+                       GError **error)
+{
+    const CharsetEntry *entry;
+    GIConv *cd;
+    gchar *converted;
+
+    entry = charset_entry_lookup (charset);
+    if (!entry || !entry->iconv_from_name) {
+        g_set_error (error, G_CONVERT_ERROR, G_CONVERT_ERROR_NO_CONVERSION,
+                     "No conversion available for charset '%s'",
+                     entry ? entry->gsm_name : "unknown");
+        return NULL;
+    }
+
+    G_LOCK (iconv_cache);
+
+    cd = &iconv_cache[entry - charset_map][conversion];
+    if (!*cd) {
+        switch (conversion) {
+        case CONVERSION_TO_UTF8:
+            *cd = g_iconv_open ("UTF-8//TRANSLIT", entry->iconv_from_name);
+            break;
+        case CONVERSION_FROM_UTF8:
+            *cd = g_iconv_open (entry->iconv_from_name, "UTF-8");
+            break;
+        case CONVERSION_FROM_UTF8_TRANSLIT:
+            *cd = g_iconv_open (entry->iconv_to_name, "UTF-8");
+            break;
+        default:
+            g_assert_not_reached ();
+        }
+    }
+
+    if (*cd == (GIConv) -1) {
+        G_UNLOCK (iconv_cache);
+        g_set_error (error, G_CONVERT_ERROR, G_CONVERT_ERROR_NO_CONVERSION,
+                     "Conversion for charset '%s' not supported",
+                     entry->gsm_name);
+        return NULL;
     }
-    g_warn_if_reached ();
+
+    /* Reset whatever state a previous failed conversion left behind */
+    g_iconv (*cd, NULL, NULL, NULL, NULL);
+    converted = g_convert_with_iconv (str, len, *cd, bytes_read, bytes_written, error);
+
+    G_UNLOCK (iconv_cache);
+
+    return converted;
+}
+
+/*****************************************************************************/
+/* Converters not requiring iconv */
+
+/* UCS-2 (big endian) to UTF-8. Surrogate pairs are also accepted, i.e. the
+ * input may really be UTF-16BE, as many modems report it as UCS2. Returns
+ * NULL if the input is not valid. */
+static gchar *
+ucs2_to_utf8 (const guint8 *in,
+              gsize len)
+{
+    gchar *out;
+    gchar *p;
+    gsize i;
+
+    if (len % 2)
+        return NULL;
+
+    /* At most 3 bytes per UCS-2 code unit; surrogate pairs take 4 bytes
+     * for 2 code units */
+    out = p = g_malloc ((len / 2) * 3 + 1);
+
+    for (i = 0; i < len; i += 2) {
+        gunichar c;
+
+        c = (in[i] << 8) | in[i + 1];
+        if (c < 0x80) {
+            *p++ = (gchar) c;
+            continue;
+        }
+
+        if (c >= 0xD800 && c <= 0xDFFF) {
+            gunichar low;
+
+            /* Only high surrogates followed by low surrogates allowed */
+            if (c > 0xDBFF || i + 3 >= len)
+                goto invalid;
+            low = (in[i + 2] << 8) | in[i + 3];
+            if (low < 0xDC00 || low > 0xDFFF)
+                goto invalid;
+            c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+            i += 2;
+        }
+
+        p += g_unichar_to_utf8 (c, p);
+    }
+    *p = '\0';
+    return out;
+
+invalid:
+    g_free (out);
     return NULL;
 }
 
+/* ISO 8859-1 to UTF-8, which can't fail */
+static gchar *
+latin1_to_utf8 (const guint8 *in,
+                gsize len)
+{
+    gchar *out;
+    gchar *p;
+    gsize i;
+
+    out = p = g_malloc (len * 2 + 1);
+    for (i = 0; i < len; i++) {
+        if (in[i] < 0x80)
+            *p++ = (gchar) in[i];
+        else {
+            *p++ = (gchar) (0xC0 | (in[i] >> 6));
+            *p++ = (gchar) (0x80 | (in[i] & 0x3F));
+        }
+    }
+    *p = '\0';
+    return out;
+}
+
+/* UTF-8 to UCS-2BE, ISO 8859-1 or ASCII; returns NULL if the input isn't
+ * valid UTF-8 or if any character is not representable in the target
+ * charset. The output is NUL-terminated, for consistency with iconv. */
+static gchar *
+utf8_to_fixed_width (const gchar *utf8,
+                     MMModemCharset charset,
+                     gsize *out_len)
+{
+    const guchar *p = (const guchar *) utf8;
+    gunichar max;
+    gsize width;
+    guint8 *out;
+    guint8 *q;
+
+    switch (charset) {
+    case MM_MODEM_CHARSET_UCS2:
+        max = 0xFFFF;
+        width = 2;
+        break;
+    case MM_MODEM_CHARSET_8859_1:
+        max = 0xFF;
+        width = 1;
+        break;
+    case MM_MODEM_CHARSET_IRA:
+        max = 0x7F;
+        width = 1;
+        break;
+    default:
+        g_assert_not_reached ();
+    }
+
+    /* Never more characters than bytes in the input */
+    out = q = g_malloc (strlen (utf8) * width + 2);
+
+    while (*p) {
+        gunichar c;
+
+        if (*p < 0x80)
+            c = *p++;
+        else {
+            c = g_utf8_get_char_validated ((const gchar *) p, -1);
+            if (c == (gunichar) -1 || c == (gunichar) -2 || c > max ||
+                (c >= 0xD800 && c <= 0xDFFF)) {
+                g_free (out);
+                return NULL;
+            }
+            p = (const guchar *) g_utf8_next_char (p);
+        }
+
+        if (width == 2)
+            *q++ = (guint8) (c >> 8);
+        *q++ = (guint8) c;
+    }
+
+    *out_len = q - out;
+    *q++ = '\0';
+    if (width == 2)
+        *q = '\0';
+    return (gchar *) out;
+}
+
+/* Convert from the given charset to UTF-8, avoiding iconv when possible */
+static gchar *
+charset_convert_to_utf8 (const gchar *str,
+                         gsize len,
+                         MMModemCharset charset)
+{
+    switch (charset) {
+    case MM_MODEM_CHARSET_UCS2:
+        return ucs2_to_utf8 ((const guint8 *) str, len);
+    case MM_MODEM_CHARSET_8859_1:
+        return latin1_to_utf8 ((const guint8 *) str, len);
+    default:
+        return charset_iconv_convert (charset, CONVERSION_TO_UTF8, str, len, NULL, NULL, NULL);
+    }
+}
+
+/* Convert from UTF-8 to the given charset, avoiding iconv when possible. If
+ * transliteration is requested, iconv is used for the characters not
+ * directly representable. */
+static gchar *
+charset_convert_from_utf8 (const gchar *utf8,
+                           MMModemCharset charset,
+                           gboolean translit,
+                           gsize *out_len)
+{
+    gchar *converted;
+
+    switch (charset) {
+    case MM_MODEM_CHARSET_UCS2:
+    case MM_MODEM_CHARSET_8859_1:
+    case MM_MODEM_CHARSET_IRA:
+        converted = utf8_to_fixed_width (utf8, charset, out_len);
+        if (converted || !translit)
+            return converted;
+        /* Let iconv transliterate */
+        return charset_iconv_convert (charset, CONVERSION_FROM_UTF8_TRANSLIT,
+                                      utf8, -1, NULL, out_len, NULL);
+    case MM_MODEM_CHARSET_UTF8:
+        if (!g_utf8_validate (utf8, -1, NULL))
+            return NULL;
+        *out_len = strlen (utf8);
+        return g_strdup (utf8);
+    default:
+        return charset_iconv_convert (charset,
+                                      translit ? CONVERSION_FROM_UTF8_TRANSLIT : CONVERSION_FROM_UTF8,
+                                      utf8, -1, NULL, out_len, NULL);
+    }
+}
+
+/*****************************************************************************/
+
 gboolean
 mm_modem_charset_byte_array_append (GByteArray *array,
                                     const char *utf8,
                                     gboolean quoted,
                                     MMModemCharset charset)
 {
-    const char *iconv_to;
     char *converted;
-    GError *error = NULL;
     gsize written = 0;
 
     g_return_val_if_fail (array != NULL, FALSE);
     g_return_val_if_fail (utf8 != NULL, FALSE);
+    g_return_val_if_fail (charset_iconv_to (charset) != NULL, FALSE);
 
-    iconv_to = charset_iconv_to (charset);
-    g_return_val_if_fail (iconv_to != NULL, FALSE);
-
-    converted = g_convert (utf8, -1, iconv_to, "UTF-8", NULL, &written, &error);
+    converted = charset_convert_from_utf8 (utf8, charset, TRUE, &written);
     if (!converted) {
-        if (error) {
-            g_warning ("%s: failed to convert '%s' to %s character set: (%d) %s",
-                       __func__, utf8, iconv_to,
-                       error->code, error->message);
-            g_error_free (error);
-        }
+        g_warning ("%s: failed to convert '%s' to %s character set",
+                   __func__, utf8, charset_iconv_to (charset));
         return FALSE;
     }
 
@@ -151,33 +415,31 @@ mm_modem_charset_byte_array_append (GByteArray *array,
 char *
 mm_modem_charset_hex_to_utf8 (const char *src, MMModemCharset charset)
 {
-    char *unconverted, *converted;
-    const char *iconv_from;
-    gsize unconverted_len = 0;
-    GError *error = NULL;
+    guint8 buf[256];
+    guint8 *unconverted;
+    char *converted;
+    gsize src_len;
 
     g_return_val_if_fail (src != NULL, NULL);
     g_return_val_if_fail (charset != MM_MODEM_CHARSET_UNKNOWN, NULL);
+    g_return_val_if_fail (charset_iconv_from (charset) != NULL, FALSE);
 
-    iconv_from = charset_iconv_from (charset);
-    g_return_val_if_fail (iconv_from != NULL, FALSE);
+    if (charset == MM_MODEM_CHARSET_UTF8 || charset == MM_MODEM_CHARSET_IRA) {
+        gsize unconverted_len = 0;
 
-    unconverted = mm_utils_hexstr2bin (src, &unconverted_len);
-    if (!unconverted)
-        return NULL;
-
-    if (charset == MM_MODEM_CHARSET_UTF8 || charset == MM_MODEM_CHARSET_IRA)
-        return unconverted;
+        return mm_utils_hexstr2bin (src, &unconverted_len);
+    }
 
-    converted = g_convert (unconverted, unconverted_len,
-                           "UTF-8//TRANSLIT", iconv_from,
-                           NULL, NULL, &error);
-    if (!converted || error) {
-        g_clear_error (&error);
+    /* Short strings are decoded in the stack, as they're converted right away */
+    src_len = strlen (src);
+    unconverted = (src_len / 2 <= sizeof (buf)) ? buf : g_malloc (src_len / 2);
+    if (!mm_utils_hexstr2bin_buf (src, src_len, unconverted))
         converted = NULL;
-    }
+    else
+        converted = charset_convert_to_utf8 ((const gchar *) unconverted, src_len / 2, charset);
 
-    g_free (unconverted);
+    if (unconverted != buf)
+        g_free (unconverted);
 
     return converted;
 }
@@ -187,27 +449,18 @@ mm_modem_charset_utf8_to_hex (const char *src, MMModemCharset charset)
 {
     gsize converted_len = 0;
     char *converted;
-    const char *iconv_to;
-    GError *error = NULL;
     gchar *hex;
 
     g_return_val_if_fail (src != NULL, NULL);
     g_return_val_if_fail (charset != MM_MODEM_CHARSET_UNKNOWN, NULL);
-
-    iconv_to = charset_iconv_from (charset);
-    g_return_val_if_fail (iconv_to != NULL, FALSE);
+    g_return_val_if_fail (charset_iconv_from (charset) != NULL, FALSE);
 
     if (charset == MM_MODEM_CHARSET_UTF8 || charset == MM_MODEM_CHARSET_IRA)
         return g_strdup (src);
 
-    converted = g_convert (src, strlen (src),
-                           iconv_to, "UTF-8//TRANSLIT",
-                           NULL, &converted_len, &error);
-    if (!converted || error) {
-        g_clear_error (&error);
-        g_free (converted);
+    converted = charset_convert_from_utf8 (src, charset, FALSE, &converted_len);
+    if (!converted)
         return NULL;
-    }
 
     /* Get hex representation of the string */
     hex = mm_utils_bin2hexstr ((guint8 *)converted, converted_len);
@@ -642,12 +895,34 @@ gsm_unpack (const guint8 *gsm,
             guint8 start_offset,  /* in _bits_ */
             guint32 *out_unpacked_len)
 {
-    GByteArray *unpacked;
-    int i;
+    guint8 *unpacked;
+    guint32 packed_len;
+    guint32 i = 0;
+
+    unpacked = g_malloc (num_septets + 1);
+
+    /* Number of bytes holding the septets */
+    packed_len = (start_offset + (num_septets * 7) + 7) / 8;
 
-    unpacked = g_byte_array_sized_new (num_septets + 1);
+    /* 8 septets are 7 bytes; load 8 bytes so that a non-zero bit offset
+     * still leaves all of them in the word */
+    for (; i + 8 <= num_septets; i += 8) {
+        guint32 octet;
+        guint64 word;
+        guint k;
 
-    for (i = 0; i < num_septets; i++) {
+        octet = (start_offset / 8) + ((i / 8) * 7);
+        if (octet + 8 > packed_len)
+            break;
+
+        memcpy (&word, &gsm[octet], sizeof (word));
+        word = GUINT64_FROM_LE (word) >> (start_offset % 8);
+        for (k = 0; k < 8; k++)
+            unpacked[i + k] = (word >> (7 * k)) & 0x7F;
+    }
+
+    /* Last septets one by one */
+    for (; i < num_septets; i++) {
         guint8 bits_here, bits_in_next, octet, offset, c;
         guint32 start_bit;
 
@@ -665,11 +940,12 @@ gsm_unpack (const guint8 *gsm,
             octet = gsm[(start_bit / 8) + 1];
             c |= (octet & (0xFF >> (8 - bits_in_next))) << bits_here;
         }
-        g_byte_array_append (unpacked, &c, 1);
+        unpacked[i] = c;
     }
+    unpacked[num_septets] = 0;
 
-    *out_unpacked_len = unpacked->len;
-    return g_byte_array_free (unpacked, FALSE);
+    *out_unpacked_len = num_septets;
+    return unpacked;
 }
 
 guint8 *
@@ -679,8 +955,8 @@ gsm_pack (const guint8 *src,
           guint32 *out_packed_len)
 {
     guint8 *packed;
-    guint octet = 0, lshift, plen;
-    int i = 0;
+    guint32 plen;
+    guint32 i = 0;
 
     g_return_val_if_fail (start_offset < 8, NULL);
 
@@ -691,16 +967,40 @@ gsm_pack (const guint8 *src,
 
     packed = g_malloc0 (plen);
 
-    for (i = 0, lshift = start_offset; i < src_len; i++) {
-        packed[octet] |= (src[i] & 0x7F) << lshift;
-        if (lshift > 1) {
-            /* Grab the lost bits and add to next octet */
-            g_assert (octet + 1 < plen);
-            packed[octet + 1] = (src[i] & 0x7F) >> (8 - lshift);
+    /* 8 septets into 7 bytes at a time, plus the spill over to an 8th byte
+     * given by the offset */
+    for (; i + 8 <= src_len; i += 8) {
+        guint32 octet;
+        guint64 word = 0;
+        guint k;
+
+        for (k = 0; k < 8; k++)
+            word |= (guint64) (src[i + k] & 0x7F) << (7 * k);
+        word <<= start_offset;
+
+        octet = (i / 8) * 7;
+        if (octet + 8 <= plen) {
+            guint64 current;
+
+            memcpy (&current, &packed[octet], sizeof (current));
+            current = GUINT64_TO_LE (GUINT64_FROM_LE (current) | word);
+            memcpy (&packed[octet], &current, sizeof (current));
+        } else {
+            for (k = 0; k < 8 && octet + k < plen; k++)
+                packed[octet + k] |= (guint8) (word >> (8 * k));
         }
-        if (lshift)
-            octet++;
-        lshift = lshift ? lshift - 1 : 7;
+    }
+
+    /* Last septets one by one */
+    for (; i < src_len; i++) {
+        guint32 start_bit;
+        guint16 c;
+
+        start_bit = start_offset + (i * 7);
+        c = (src[i] & 0x7F) << (start_bit % 8);
+        packed[start_bit / 8] |= (guint8) c;
+        if ((start_bit % 8) > 1)
+            packed[(start_bit / 8) + 1] |= (guint8) (c >> 8);
     }
 
     if (out_packed_len)
@@ -734,27 +1034,15 @@ mm_charset_take_and_convert_to_utf8 (gchar *str, MMModemCharset charset)
     case MM_MODEM_CHARSET_GSM:
     case MM_MODEM_CHARSET_8859_1:
     case MM_MODEM_CHARSET_PCCP437:
-    case MM_MODEM_CHARSET_PCDN: {
-        const gchar *iconv_from;
-        GError *error = NULL;
-
-        iconv_from = charset_iconv_from (charset);
-        utf8 = g_convert (str, strlen (str),
-                          "UTF-8//TRANSLIT", iconv_from,
-                          NULL, NULL, &error);
-        if (!utf8 || error) {
-            g_clear_error (&error);
-            utf8 = NULL;
-        }
-
+    case MM_MODEM_CHARSET_PCDN:
+        utf8 = charset_convert_to_utf8 (str, strlen (str), charset);
         g_free (str);
         break;
-    }
 
     case MM_MODEM_CHARSET_UCS2: {
         gsize len;
         gboolean possibly_hex = TRUE;
-        gsize bread = 0, bwritten = 0;
+        const gchar *end = NULL;
 
         /* If the string comes in hex-UCS-2, len needs to be a multiple of 4 */
         len = strlen (str);
@@ -778,28 +1066,23 @@ mm_charset_take_and_convert_to_utf8 (gchar *str, MMModemCharset charset)
         }
 
         /* If not hex, then it might be raw UCS-2 (very unlikely) or ASCII/UTF-8
-         * (much more likely).  Try to convert to UTF-8 and if that fails, use
-         * the partial conversion length to re-convert the part of the string
-         * that is UTF-8, if any.
+         * (much more likely).  If the string isn't valid UTF-8, keep the
+         * leading part of the string that is, if any.
          */
-        utf8 = g_convert (str, strlen (str),
-                          "UTF-8//TRANSLIT", "UTF-8//TRANSLIT",
-                          &bread, &bwritten, NULL);
+        if (g_utf8_validate (str, -1, &end)) {
+            utf8 = str;
+            break;
+        }
 
-        /* Valid conversion, or we didn't get enough valid UTF-8 */
-        if (utf8 || (bwritten <= 2)) {
+        /* We didn't get enough valid UTF-8 */
+        if (end - str <= 2) {
             g_free (str);
             break;
         }
 
-        /* Last try; chop off the original string at the conversion failure
-         * location and get what we can.
-         */
-        str[bread] = '\0';
-        utf8 = g_convert (str, strlen (str),
-                          "UTF-8//TRANSLIT", "UTF-8//TRANSLIT",
-                          NULL, NULL, NULL);
-        g_free (str);
+        /* Chop off the original string at the first invalid byte */
+        str[end - str] = '\0';
+        utf8 = str;
         break;
     }
 
@@ -858,36 +1141,18 @@ mm_utf8_take_and_convert_to_charset (gchar *str,
     case MM_MODEM_CHARSET_8859_1:
     case MM_MODEM_CHARSET_PCCP437:
     case MM_MODEM_CHARSET_PCDN: {
-        const gchar *iconv_to;
-        GError *error = NULL;
-
-        iconv_to = charset_iconv_from (charset);
-        encoded = g_convert (str, strlen (str),
-                             iconv_to, "UTF-8",
-                             NULL, NULL, &error);
-        if (!encoded || error) {
-            g_clear_error (&error);
-            encoded = NULL;
-        }
+        gsize encoded_len = 0;
 
+        encoded = charset_convert_from_utf8 (str, charset, FALSE, &encoded_len);
         g_free (str);
         break;
     }
 
     case MM_MODEM_CHARSET_UCS2: {
-        const gchar *iconv_to;
         gsize encoded_len = 0;
-        GError *error = NULL;
         gchar *hex;
 
-        iconv_to = charset_iconv_from (charset);
-        encoded = g_convert (str, strlen (str),
-                             iconv_to, "UTF-8",
-                             NULL, &encoded_len, &error);
-        if (!encoded || error) {
-            g_clear_error (&error);
-            encoded = NULL;
-        }
+        encoded = charset_convert_from_utf8 (str, charset, FALSE, &encoded_len);
 
         /* Get hex representation of the string */
         hex = mm_utils_bin2hexstr ((guint8 *)encoded, encoded_len);
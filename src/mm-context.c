@@ -16,6 +16,7 @@
 #include <stdlib.h>
 
 #include "mm-context.h"
+#include "mm-log.h"
 
 /*****************************************************************************/
 /* Application context */
@@ -26,14 +27,26 @@ static const gchar *log_level;
 static const gchar *log_file;
 static gboolean show_ts;
 static gboolean rel_ts;
+static gint log_flush_interval = -1;
+static gint log_flush_size = -1;
+static gboolean shared_probing;
+static gboolean probe_cache;
+static gboolean serial_io_worker;
+static gint profile_main_loop;
 
 static const GOptionEntry entries[] = {
     { "version", 'V', 0, G_OPTION_ARG_NONE, &version_flag, "Print version", NULL },
     { "debug", 0, 0, G_OPTION_ARG_NONE, &debug, "Run with extended debugging capabilities", NULL },
-    { "log-level", 0, 0, G_OPTION_ARG_STRING, &log_level, "Log level: one of [ERR, WARN, INFO, DEBUG]", "INFO" },
+    { "log-level", 0, 0, G_OPTION_ARG_STRING, &log_level, "Log level: one of [ERR, WARN, INFO, DEBUG], optionally followed by per-module levels (e.g. INFO,serial=DEBUG)", "INFO" },
     { "log-file", 0, 0, G_OPTION_ARG_STRING, &log_file, "Path to log file", NULL },
     { "timestamps", 0, 0, G_OPTION_ARG_NONE, &show_ts, "Show timestamps in log output", NULL },
     { "relative-timestamps", 0, 0, G_OPTION_ARG_NONE, &rel_ts, "Use relative timestamps (from MM start)", NULL },
+    { "log-flush-interval", 0, 0, G_OPTION_ARG_INT, &log_flush_interval, "Max time to keep log file output buffered, in ms; 0 writes and syncs every line", "500" },
+    { "log-flush-size", 0, 0, G_OPTION_ARG_INT, &log_flush_size, "Max amount of log file output to keep buffered, in bytes", "16384" },
+    { "shared-probing", 0, 0, G_OPTION_ARG_NONE, &shared_probing, "Probe each port once for all candidate plugins", NULL },
+    { "probe-cache", 0, 0, G_OPTION_ARG_NONE, &probe_cache, "Reuse port probing results of known devices across restarts", NULL },
+    { "serial-io-worker", 0, 0, G_OPTION_ARG_NONE, &serial_io_worker, "Read serial port input in a dedicated I/O thread", NULL },
+    { "profile-main-loop", 0, 0, G_OPTION_ARG_INT, &profile_main_loop, "Profile main loop dispatching, logging a summary every [SECS] seconds", "[SECS]" },
     { NULL }
 };
 
@@ -67,6 +80,42 @@ mm_context_get_relative_timestamps (void)
     return rel_ts;
 }
 
+guint
+mm_context_get_log_flush_interval (void)
+{
+    return (log_flush_interval >= 0 ? (guint) log_flush_interval : MM_LOG_DEFAULT_FLUSH_INTERVAL_MS);
+}
+
+gsize
+mm_context_get_log_flush_size (void)
+{
+    return (log_flush_size > 0 ? (gsize) log_flush_size : MM_LOG_DEFAULT_FLUSH_SIZE);
+}
+
+gboolean
+mm_context_get_shared_probing (void)
+{
+    return shared_probing;
+}
+
+gboolean
+mm_context_get_probe_cache (void)
+{
+    return probe_cache;
+}
+
+gboolean
+mm_context_get_serial_io_worker (void)
+{
+    return serial_io_worker;
+}
+
+guint
+mm_context_get_profile_main_loop (void)
+{
+    return (profile_main_loop > 0 ? (guint) profile_main_loop : 0);
+}
+
 /*****************************************************************************/
 /* Test context */
 
@@ -74,12 +123,14 @@ static gboolean test_session;
 static gboolean test_no_auto_scan;
 static gboolean test_enable;
 static gchar *test_plugin_dir;
+static gchar *test_probe_cache_file;
 
 static const GOptionEntry test_entries[] = {
     { "test-session", 0, 0, G_OPTION_ARG_NONE, &test_session, "Run in session DBus", NULL },
     { "test-no-auto-scan", 0, 0, G_OPTION_ARG_NONE, &test_no_auto_scan, "Don't auto-scan looking for devices", NULL },
     { "test-enable", 0, 0, G_OPTION_ARG_NONE, &test_enable, "Enable the Test interface in the daemon", NULL },
     { "test-plugin-dir", 0, 0, G_OPTION_ARG_STRING, &test_plugin_dir, "Path to look for plugins", "[PATH]" },
+    { "test-probe-cache-file", 0, 0, G_OPTION_ARG_STRING, &test_probe_cache_file, "Path to the probe cache file", "[PATH]" },
     { NULL }
 };
 
@@ -121,6 +172,12 @@ mm_context_get_test_plugin_dir (void)
     return test_plugin_dir ? test_plugin_dir : PLUGINDIR;
 }
 
+const gchar *
+mm_context_get_test_probe_cache_file (void)
+{
+    return test_probe_cache_file ? test_probe_cache_file : MMSTATEDIR "/probe-cache";
+}
+
 /*****************************************************************************/
 
 static void
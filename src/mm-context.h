@@ -31,11 +31,18 @@ const gchar *mm_context_get_log_level           (void);
 const gchar *mm_context_get_log_file            (void);
 gboolean     mm_context_get_timestamps          (void);
 gboolean     mm_context_get_relative_timestamps (void);
+guint        mm_context_get_log_flush_interval  (void);
+gsize        mm_context_get_log_flush_size      (void);
+gboolean     mm_context_get_shared_probing      (void);
+gboolean     mm_context_get_probe_cache         (void);
+gboolean     mm_context_get_serial_io_worker    (void);
+guint        mm_context_get_profile_main_loop   (void);
 
 /* Testing support */
 gboolean     mm_context_get_test_session        (void);
 gboolean     mm_context_get_test_no_auto_scan   (void);
 gboolean     mm_context_get_test_enable         (void);
 const gchar *mm_context_get_test_plugin_dir     (void);
+const gchar *mm_context_get_test_probe_cache_file (void);
 
 #endif /* MM_CONTEXT_H */
@@ -13,6 +13,8 @@
  * Copyright (C) 2012 Google, Inc.
  */
 
+#define MM_LOG_MODULE MM_LOG_MODULE_PLUGIN_MANAGER
+
 #include <config.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -25,6 +27,7 @@
 
 #include "mm-device.h"
 #include "mm-plugin.h"
+#include "mm-main-loop-profiler.h"
 #include "mm-log.h"
 
 G_DEFINE_TYPE (MMDevice, mm_device, G_TYPE_OBJECT);
@@ -437,6 +440,7 @@ export_modem (MMDevice *self)
                   NULL);
     g_object_unref (connection);
 
+    mm_main_loop_profiler_watch_skeleton (self->priv->modem);
     g_dbus_object_manager_server_export (self->priv->object_manager,
                                          G_DBUS_OBJECT_SKELETON (self->priv->modem));
 
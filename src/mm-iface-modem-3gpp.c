@@ -13,6 +13,8 @@
  * Copyright (C) 2011 - 2012 Google, Inc.
  */
 
+#define MM_LOG_MODULE MM_LOG_MODULE_MODEM
+
 #include <stdlib.h>
 #include <string.h>
 
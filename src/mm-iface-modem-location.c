@@ -14,6 +14,8 @@
  * Copyright (C) 2012 Lanedo GmbH <aleksander@lanedo.com>
  */
 
+#define MM_LOG_MODULE MM_LOG_MODULE_LOCATION
+
 #include <ModemManager.h>
 #define _LIBMM_INSIDE_MM
 #include <libmm-glib.h>
@@ -13,22 +13,27 @@
  * Copyright (C) 2012 Google, Inc.
  */
 
+#define MM_LOG_MODULE MM_LOG_MODULE_SMS
+
 #include <ModemManager.h>
 #define _LIBMM_INSIDE_MM
 #include <libmm-glib.h>
 
 #include "mm-iface-modem.h"
 #include "mm-iface-modem-messaging.h"
+#include "mm-broadband-modem.h"
 #include "mm-sms-list.h"
 #include "mm-log.h"
 
 #define SUPPORT_CHECKED_TAG "messaging-support-checked-tag"
 #define SUPPORTED_TAG       "messaging-supported-tag"
 #define STORAGE_CONTEXT_TAG "messaging-storage-context-tag"
+#define SEND_QUEUE_TAG      "messaging-send-queue-tag"
 
 static GQuark support_checked_quark;
 static GQuark supported_quark;
 static GQuark storage_context_quark;
+static GQuark send_queue_quark;
 
 /*****************************************************************************/
 
@@ -245,6 +250,170 @@ handle_delete (MmGdbusModemMessaging *skeleton,
 
 /*****************************************************************************/
 
+typedef struct {
+    MmGdbusModemMessaging *skeleton;
+    GDBusMethodInvocation *invocation;
+    MMIfaceModemMessaging *self;
+    /* NULL when deleting all */
+    gchar **paths;
+    MMSmsDeleteFilter filter;
+} HandleDeleteManyContext;
+
+static void
+handle_delete_many_context_free (HandleDeleteManyContext *ctx)
+{
+    g_object_unref (ctx->skeleton);
+    g_object_unref (ctx->invocation);
+    g_object_unref (ctx->self);
+    g_strfreev (ctx->paths);
+    g_free (ctx);
+}
+
+static void
+handle_delete_many_ready (MMSmsList *list,
+                          GAsyncResult *res,
+                          HandleDeleteManyContext *ctx)
+{
+    GError *error = NULL;
+
+    if (!mm_sms_list_delete_many_finish (list, res, &error))
+        g_dbus_method_invocation_take_error (ctx->invocation, error);
+    else if (ctx->paths)
+        mm_gdbus_modem_messaging_complete_delete_many (ctx->skeleton, ctx->invocation);
+    else
+        mm_gdbus_modem_messaging_complete_delete_all (ctx->skeleton, ctx->invocation);
+
+    handle_delete_many_context_free (ctx);
+}
+
+static void
+handle_delete_many_auth_ready (MMBaseModem *self,
+                               GAsyncResult *res,
+                               HandleDeleteManyContext *ctx)
+{
+    MMModemState modem_state = MM_MODEM_STATE_UNKNOWN;
+    MMSmsList *list = NULL;
+    GError *error = NULL;
+
+    if (!mm_base_modem_authorize_finish (self, res, &error)) {
+        g_dbus_method_invocation_take_error (ctx->invocation, error);
+        handle_delete_many_context_free (ctx);
+        return;
+    }
+
+    g_object_get (self,
+                  MM_IFACE_MODEM_STATE, &modem_state,
+                  NULL);
+
+    if (modem_state < MM_MODEM_STATE_ENABLED) {
+        g_dbus_method_invocation_return_error (ctx->invocation,
+                                               MM_CORE_ERROR,
+                                               MM_CORE_ERROR_WRONG_STATE,
+                                               "Cannot delete SMS: device not yet enabled");
+        handle_delete_many_context_free (ctx);
+        return;
+    }
+
+    g_object_get (self,
+                  MM_IFACE_MODEM_MESSAGING_SMS_LIST, &list,
+                  NULL);
+    if (!list) {
+        g_dbus_method_invocation_return_error (ctx->invocation,
+                                               MM_CORE_ERROR,
+                                               MM_CORE_ERROR_WRONG_STATE,
+                                               "Cannot delete SMS: missing SMS list");
+        handle_delete_many_context_free (ctx);
+        return;
+    }
+
+    mm_sms_list_delete_many (list,
+                             (const gchar *const *)ctx->paths,
+                             ctx->filter,
+                             (GAsyncReadyCallback)handle_delete_many_ready,
+                             ctx);
+    g_object_unref (list);
+}
+
+static void
+handle_delete_many_common (MmGdbusModemMessaging *skeleton,
+                           GDBusMethodInvocation *invocation,
+                           const gchar *const *paths,
+                           MMSmsDeleteFilter filter,
+                           MMIfaceModemMessaging *self)
+{
+    HandleDeleteManyContext *ctx;
+
+    ctx = g_new (HandleDeleteManyContext, 1);
+    ctx->skeleton = g_object_ref (skeleton);
+    ctx->invocation = g_object_ref (invocation);
+    ctx->self = g_object_ref (self);
+    ctx->paths = g_strdupv ((gchar **)paths);
+    ctx->filter = filter;
+
+    mm_base_modem_authorize (MM_BASE_MODEM (self),
+                             invocation,
+                             MM_AUTHORIZATION_MESSAGING,
+                             (GAsyncReadyCallback)handle_delete_many_auth_ready,
+                             ctx);
+}
+
+static gboolean
+handle_delete_many (MmGdbusModemMessaging *skeleton,
+                    GDBusMethodInvocation *invocation,
+                    const gchar *const *paths,
+                    MMIfaceModemMessaging *self)
+{
+    /* An empty list is not the same as deleting all */
+    if (!paths || !paths[0]) {
+        mm_gdbus_modem_messaging_complete_delete_many (skeleton, invocation);
+        return TRUE;
+    }
+
+    handle_delete_many_common (skeleton, invocation, paths, MM_SMS_DELETE_FILTER_NONE, self);
+    return TRUE;
+}
+
+static gboolean
+handle_delete_all (MmGdbusModemMessaging *skeleton,
+                   GDBusMethodInvocation *invocation,
+                   GVariant *states,
+                   MMIfaceModemMessaging *self)
+{
+    MMSmsDeleteFilter filter = MM_SMS_DELETE_FILTER_NONE;
+    GVariantIter iter;
+    guint32 state;
+
+    g_variant_iter_init (&iter, states);
+    while (g_variant_iter_next (&iter, "u", &state)) {
+        switch (state) {
+        case MM_SMS_STATE_RECEIVED:
+            filter |= MM_SMS_DELETE_FILTER_RECEIVED;
+            break;
+        case MM_SMS_STATE_SENT:
+            filter |= MM_SMS_DELETE_FILTER_SENT;
+            break;
+        case MM_SMS_STATE_STORED:
+            filter |= MM_SMS_DELETE_FILTER_UNSENT;
+            break;
+        default:
+            g_dbus_method_invocation_return_error (invocation,
+                                                   MM_CORE_ERROR,
+                                                   MM_CORE_ERROR_INVALID_ARGS,
+                                                   "Cannot delete SMS: unsupported state filter '%u'",
+                                                   state);
+            return TRUE;
+        }
+    }
+
+    if (filter == MM_SMS_DELETE_FILTER_NONE)
+        filter = MM_SMS_DELETE_FILTER_ALL;
+
+    handle_delete_many_common (skeleton, invocation, NULL, filter, self);
+    return TRUE;
+}
+
+/*****************************************************************************/
+
 typedef struct {
     MmGdbusModemMessaging *skeleton;
     GDBusMethodInvocation *invocation;
@@ -368,7 +537,6 @@ handle_list (MmGdbusModemMessaging *skeleton,
              GDBusMethodInvocation *invocation,
              MMIfaceModemMessaging *self)
 {
-    GStrv paths;
     MMSmsList *list = NULL;
     MMModemState modem_state;
 
@@ -397,11 +565,9 @@ handle_list (MmGdbusModemMessaging *skeleton,
         return TRUE;
     }
 
-    paths = mm_sms_list_get_paths (list);
     mm_gdbus_modem_messaging_complete_list (skeleton,
                                             invocation,
-                                            (const gchar *const *)paths);
-    g_strfreev (paths);
+                                            mm_sms_list_peek_paths (list));
     g_object_unref (list);
     return TRUE;
 }
@@ -437,6 +603,314 @@ mm_iface_modem_messaging_take_part (MMIfaceModemMessaging *self,
     return added;
 }
 
+/*****************************************************************************/
+/* Outbound SMS queue
+ *
+ * Send requests are queued per modem and processed in batches: all requests
+ * pending when a batch starts are grouped by the storage they're sent from,
+ * and each group is sent with that storage locked just once, so that the
+ * locks taken by each single message are shared and don't need a +CPMS of
+ * their own. The SMS relay link is also kept open during the whole batch.
+ */
+
+typedef struct {
+    MMBaseSms *sms;
+    GSimpleAsyncResult *result;
+    /* Storage that needs to be locked for the send, if any */
+    MMSmsStorage storage;
+} SendQueueItem;
+
+typedef struct {
+    GQueue *pending;
+    GList *batch;
+    guint batch_size;
+    gint64 batch_start_time;
+    MMSmsStorage locked_storage;
+    gboolean running;
+    guint run_id;
+    MMIfaceModemMessagingSendQueueStats stats;
+} SendQueue;
+
+static void
+send_queue_item_complete_and_free (SendQueueItem *item)
+{
+    g_simple_async_result_complete_in_idle (item->result);
+    g_object_unref (item->result);
+    g_object_unref (item->sms);
+    g_slice_free (SendQueueItem, item);
+}
+
+static void
+send_queue_free (SendQueue *queue)
+{
+    /* Items keep a reference to the modem, so no batch can be running */
+    g_assert (!queue->running && !queue->run_id);
+    g_queue_free (queue->pending);
+    g_slice_free (SendQueue, queue);
+}
+
+static SendQueue *
+get_send_queue (MMIfaceModemMessaging *self)
+{
+    SendQueue *queue;
+
+    if (G_UNLIKELY (!send_queue_quark))
+        send_queue_quark = (g_quark_from_static_string (
+                                SEND_QUEUE_TAG));
+
+    queue = g_object_get_qdata (G_OBJECT (self), send_queue_quark);
+    if (!queue) {
+        /* Create queue and keep it as object data */
+        queue = g_slice_new0 (SendQueue);
+        queue->pending = g_queue_new ();
+
+        g_object_set_qdata_full (
+            G_OBJECT (self),
+            send_queue_quark,
+            queue,
+            (GDestroyNotify)send_queue_free);
+    }
+
+    return queue;
+}
+
+static void send_queue_run_batch (MMIfaceModemMessaging *self);
+static void send_queue_next      (MMIfaceModemMessaging *self);
+
+static void
+send_queue_unlock_storage (MMIfaceModemMessaging *self,
+                           SendQueue *queue)
+{
+    if (queue->locked_storage == MM_SMS_STORAGE_UNKNOWN)
+        return;
+
+    mm_broadband_modem_unlock_sms_storages (MM_BROADBAND_MODEM (self), FALSE, TRUE);
+    queue->locked_storage = MM_SMS_STORAGE_UNKNOWN;
+}
+
+static void
+send_ready (MMBaseSms *sms,
+            GAsyncResult *res,
+            MMIfaceModemMessaging *self)
+{
+    SendQueue *queue;
+    SendQueueItem *item;
+    GError *error = NULL;
+
+    queue = get_send_queue (self);
+    item = queue->batch->data;
+    queue->batch = g_list_delete_link (queue->batch, queue->batch);
+
+    if (!MM_BASE_SMS_GET_CLASS (sms)->send_finish (sms, res, &error)) {
+        queue->stats.failed++;
+        g_simple_async_result_take_error (item->result, error);
+    } else {
+        queue->stats.sent++;
+        g_simple_async_result_set_op_res_gboolean (item->result, TRUE);
+    }
+    send_queue_item_complete_and_free (item);
+
+    send_queue_next (self);
+}
+
+static void
+send_queue_lock_storage_ready (MMBroadbandModem *modem,
+                               GAsyncResult *res,
+                               MMIfaceModemMessaging *self)
+{
+    SendQueue *queue;
+    SendQueueItem *item;
+    GError *error = NULL;
+
+    queue = get_send_queue (self);
+    item = queue->batch->data;
+
+    if (!mm_broadband_modem_lock_sms_storages_finish (modem, res, &error)) {
+        /* Fail just this message; the next one will retry the lock */
+        queue->batch = g_list_delete_link (queue->batch, queue->batch);
+        queue->stats.failed++;
+        g_simple_async_result_take_error (item->result, error);
+        send_queue_item_complete_and_free (item);
+        send_queue_next (self);
+        return;
+    }
+
+    queue->locked_storage = item->storage;
+    queue->stats.storage_locks++;
+    MM_BASE_SMS_GET_CLASS (item->sms)->send (item->sms,
+                                             (GAsyncReadyCallback)send_ready,
+                                             self);
+}
+
+static void
+send_queue_next (MMIfaceModemMessaging *self)
+{
+    SendQueue *queue;
+    SendQueueItem *item;
+
+    queue = get_send_queue (self);
+
+    if (!queue->batch) {
+        gint64 elapsed_ms;
+
+        send_queue_unlock_storage (self, queue);
+
+        elapsed_ms = (g_get_monotonic_time () - queue->batch_start_time) / 1000;
+        queue->stats.busy_ms += elapsed_ms;
+        mm_dbg ("SMS send batch finished: %u messages in %" G_GINT64_FORMAT " ms (%u pending)",
+                queue->batch_size,
+                elapsed_ms,
+                g_queue_get_length (queue->pending));
+
+        queue->running = FALSE;
+        send_queue_run_batch (self);
+        /* Reference taken when the batch was started */
+        g_object_unref (self);
+        return;
+    }
+
+    item = queue->batch->data;
+
+    /* Switch storages if needed */
+    if (item->storage != queue->locked_storage) {
+        send_queue_unlock_storage (self, queue);
+        if (item->storage != MM_SMS_STORAGE_UNKNOWN) {
+            mm_broadband_modem_lock_sms_storages (MM_BROADBAND_MODEM (self),
+                                                  MM_SMS_STORAGE_UNKNOWN,
+                                                  item->storage,
+                                                  (GAsyncReadyCallback)send_queue_lock_storage_ready,
+                                                  self);
+            return;
+        }
+    }
+
+    MM_BASE_SMS_GET_CLASS (item->sms)->send (item->sms,
+                                             (GAsyncReadyCallback)send_ready,
+                                             self);
+}
+
+static void
+send_queue_keep_link_open_ready (MMBroadbandModem *modem,
+                                 GAsyncResult *res,
+                                 MMIfaceModemMessaging *self)
+{
+    GError *error = NULL;
+
+    /* Not critical, messages will just be sent with the link released in between */
+    if (!mm_broadband_modem_keep_sms_link_open_finish (modem, res, &error)) {
+        mm_dbg ("Couldn't keep the SMS relay link open: '%s'", error->message);
+        g_error_free (error);
+    }
+
+    send_queue_next (self);
+}
+
+static gint
+send_queue_item_cmp (SendQueueItem *a,
+                     SendQueueItem *b)
+{
+    /* Messages not needing a storage go first */
+    return (gint)a->storage - (gint)b->storage;
+}
+
+static void
+send_queue_run_batch (MMIfaceModemMessaging *self)
+{
+    SendQueue *queue;
+    GList *l;
+    gboolean keep_link_open = FALSE;
+
+    queue = get_send_queue (self);
+    if (queue->running || g_queue_is_empty (queue->pending))
+        return;
+
+    /* Take all pending requests; the sort is stable so the original order is
+     * kept within each storage */
+    queue->batch_size = g_queue_get_length (queue->pending);
+    queue->batch = g_list_sort (queue->pending->head, (GCompareFunc)send_queue_item_cmp);
+    g_queue_init (queue->pending);
+
+    queue->running = TRUE;
+    queue->batch_start_time = g_get_monotonic_time ();
+    queue->stats.batches++;
+    g_object_ref (self);
+
+    mm_dbg ("Starting SMS send batch with %u messages", queue->batch_size);
+
+    for (l = queue->batch; l && !keep_link_open; l = g_list_next (l))
+        keep_link_open = mm_base_sms_is_sent_with_at (((SendQueueItem *)l->data)->sms);
+
+    if (keep_link_open && queue->batch_size > 1 && MM_IS_BROADBAND_MODEM (self)) {
+        mm_broadband_modem_keep_sms_link_open (MM_BROADBAND_MODEM (self),
+                                               (GAsyncReadyCallback)send_queue_keep_link_open_ready,
+                                               self);
+        return;
+    }
+
+    send_queue_next (self);
+}
+
+static gboolean
+send_queue_run_batch_idle (MMIfaceModemMessaging *self)
+{
+    get_send_queue (self)->run_id = 0;
+    send_queue_run_batch (self);
+    return G_SOURCE_REMOVE;
+}
+
+gboolean
+mm_iface_modem_messaging_queue_send_finish (MMIfaceModemMessaging *self,
+                                            GAsyncResult *res,
+                                            GError **error)
+{
+    return !g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error);
+}
+
+void
+mm_iface_modem_messaging_queue_send (MMIfaceModemMessaging *self,
+                                     MMBaseSms *sms,
+                                     GAsyncReadyCallback callback,
+                                     gpointer user_data)
+{
+    SendQueue *queue;
+    SendQueueItem *item;
+
+    item = g_slice_new0 (SendQueueItem);
+    item->sms = g_object_ref (sms);
+    item->result = g_simple_async_result_new (G_OBJECT (self),
+                                              callback,
+                                              user_data,
+                                              mm_iface_modem_messaging_queue_send);
+    /* Only sending stored messages through AT commands needs a storage */
+    if (MM_IS_BROADBAND_MODEM (self) && mm_base_sms_is_sent_with_at (sms))
+        item->storage = mm_base_sms_get_storage (sms);
+    else
+        item->storage = MM_SMS_STORAGE_UNKNOWN;
+
+    queue = get_send_queue (self);
+    g_queue_push_tail (queue->pending, item);
+
+    /* Let other requests arriving right now join the batch */
+    if (!queue->running && !queue->run_id)
+        queue->run_id = g_idle_add_full (G_PRIORITY_DEFAULT_IDLE,
+                                         (GSourceFunc)send_queue_run_batch_idle,
+                                         g_object_ref (self),
+                                         g_object_unref);
+}
+
+void
+mm_iface_modem_messaging_get_send_queue_stats (MMIfaceModemMessaging *self,
+                                               MMIfaceModemMessagingSendQueueStats *stats)
+{
+    SendQueue *queue;
+
+    queue = get_send_queue (self);
+    *stats = queue->stats;
+    stats->pending = g_queue_get_length (queue->pending);
+    if (queue->running)
+        stats->pending += g_list_length (queue->batch);
+}
+
 /*****************************************************************************/
 
 static gboolean
@@ -493,11 +967,7 @@ static void
 update_message_list (MmGdbusModemMessaging *skeleton,
                      MMSmsList *list)
 {
-    gchar **paths;
-
-    paths = mm_sms_list_get_paths (list);
-    mm_gdbus_modem_messaging_set_messages (skeleton, (const gchar *const *)paths);
-    g_strfreev (paths);
+    mm_gdbus_modem_messaging_set_messages (skeleton, mm_sms_list_peek_paths (list));
 }
 
 static void
@@ -509,17 +979,29 @@ sms_added (MMSmsList *list,
     mm_dbg ("Added %s SMS at '%s'",
             received ? "received" : "local",
             sms_path);
-    update_message_list (skeleton, list);
+    /* On batch operations the list is updated just once, at the end */
+    if (!mm_sms_list_in_batch (list))
+        update_message_list (skeleton, list);
     mm_gdbus_modem_messaging_emit_added (skeleton, sms_path, received);
 }
 
+static void
+sms_batch_done (MMSmsList *list,
+                guint n_changes,
+                MmGdbusModemMessaging *skeleton)
+{
+    mm_dbg ("Finished SMS list batch with %u changes", n_changes);
+    update_message_list (skeleton, list);
+}
+
 static void
 sms_deleted (MMSmsList *list,
              const gchar *sms_path,
              MmGdbusModemMessaging *skeleton)
 {
     mm_dbg ("Deleted SMS at '%s'", sms_path);
-    update_message_list (skeleton, list);
+    if (!mm_sms_list_in_batch (list))
+        update_message_list (skeleton, list);
     mm_gdbus_modem_messaging_emit_deleted (skeleton, sms_path);
 }
 
@@ -923,6 +1405,10 @@ interface_enabling_step (EnablingContext *ctx)
                           MM_SMS_DELETED,
                           G_CALLBACK (sms_deleted),
                           ctx->skeleton);
+        g_signal_connect (list,
+                          MM_SMS_BATCH_DONE,
+                          G_CALLBACK (sms_batch_done),
+                          ctx->skeleton);
 
         g_object_unref (list);
 
@@ -1333,6 +1819,14 @@ interface_initialization_step (InitializationContext *ctx)
                           "handle-delete",
                           G_CALLBACK (handle_delete),
                           ctx->self);
+        g_signal_connect (ctx->skeleton,
+                          "handle-delete-many",
+                          G_CALLBACK (handle_delete_many),
+                          ctx->self);
+        g_signal_connect (ctx->skeleton,
+                          "handle-delete-all",
+                          G_CALLBACK (handle_delete_all),
+                          ctx->self);
         g_signal_connect (ctx->skeleton,
                           "handle-list",
                           G_CALLBACK (handle_list),
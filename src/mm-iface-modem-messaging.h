@@ -131,6 +131,21 @@ struct _MMIfaceModemMessaging {
 
     /* Create SMS objects */
     MMBaseSms * (* create_sms) (MMIfaceModemMessaging *self);
+
+    /* Delete the stored parts of several SMS, all of them in the given
+     * storage, in one go (async). If 'filter' is not
+     * MM_SMS_DELETE_FILTER_NONE, the messages given are all the ones known in
+     * the storage matching the filter, and the implementation may just wipe
+     * the ones matching it from the storage. */
+    void (* delete_sms_many) (MMIfaceModemMessaging *self,
+                              MMSmsStorage storage,
+                              GList *sms_list,
+                              MMSmsDeleteFilter filter,
+                              GAsyncReadyCallback callback,
+                              gpointer user_data);
+    gboolean (* delete_sms_many_finish) (MMIfaceModemMessaging *self,
+                                         GAsyncResult *res,
+                                         GError **error);
 };
 
 GType mm_iface_modem_messaging_get_type (void);
@@ -168,6 +183,26 @@ void mm_iface_modem_messaging_shutdown (MMIfaceModemMessaging *self);
 void mm_iface_modem_messaging_bind_simple_status (MMIfaceModemMessaging *self,
                                                   MMSimpleStatus *status);
 
+/* Outbound SMS queue */
+typedef struct {
+    guint   pending;
+    guint64 sent;
+    guint64 failed;
+    guint64 batches;
+    guint64 storage_locks;
+    guint64 busy_ms;
+} MMIfaceModemMessagingSendQueueStats;
+
+void     mm_iface_modem_messaging_queue_send           (MMIfaceModemMessaging *self,
+                                                        MMBaseSms *sms,
+                                                        GAsyncReadyCallback callback,
+                                                        gpointer user_data);
+gboolean mm_iface_modem_messaging_queue_send_finish    (MMIfaceModemMessaging *self,
+                                                        GAsyncResult *res,
+                                                        GError **error);
+void     mm_iface_modem_messaging_get_send_queue_stats (MMIfaceModemMessaging *self,
+                                                        MMIfaceModemMessagingSendQueueStats *stats);
+
 /* Report new SMS part */
 gboolean mm_iface_modem_messaging_take_part (MMIfaceModemMessaging *self,
                                              MMSmsPart *sms_part,
@@ -15,6 +15,8 @@
  * Copyright (C) 2011 Google, Inc.
  */
 
+#define MM_LOG_MODULE MM_LOG_MODULE_MODEM
+
 #include <ModemManager.h>
 #define _LIBMM_INSIDE_MM
 #include <libmm-glib.h>
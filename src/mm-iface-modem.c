@@ -14,6 +14,8 @@
  */
 
 
+#define MM_LOG_MODULE MM_LOG_MODULE_MODEM
+
 #include <ModemManager.h>
 #define _LIBMM_INSIDE_MM
 #include <libmm-glib.h>
@@ -26,6 +28,7 @@
 #include "mm-bearer-list.h"
 #include "mm-log.h"
 #include "mm-context.h"
+#include "mm-main-loop-profiler.h"
 
 #define SIGNAL_QUALITY_RECENT_TIMEOUT_SEC        60
 #define SIGNAL_QUALITY_INITIAL_CHECK_TIMEOUT_SEC 3
@@ -125,6 +128,7 @@ mm_iface_modem_wait_for_final_state_finish (MMIfaceModem *self,
 static gboolean
 state_changed_wait_expired (WaitForFinalStateContext *ctx)
 {
+    mm_main_loop_profiler_source_dispatched ();
     g_simple_async_result_set_error (
         ctx->result,
         MM_CORE_ERROR,
@@ -208,6 +212,7 @@ mm_iface_modem_wait_for_final_state (MMIfaceModem *self,
     ctx->state_changed_wait_id = g_timeout_add_seconds (10,
                                                         (GSourceFunc)state_changed_wait_expired,
                                                         ctx);
+    g_source_set_name_by_id (ctx->state_changed_wait_id, "modem final state wait");
 }
 
 /*****************************************************************************/
@@ -247,6 +252,7 @@ static void internal_load_unlock_required_context_step (InternalLoadUnlockRequir
 static gboolean
 load_unlock_required_again (InternalLoadUnlockRequiredContext *ctx)
 {
+    mm_main_loop_profiler_source_dispatched ();
     ctx->pin_check_timeout_id = 0;
     /* Retry the step */
     internal_load_unlock_required_context_step (ctx);
@@ -293,6 +299,7 @@ load_unlock_required_ready (MMIfaceModem *self,
             ctx->pin_check_timeout_id = g_timeout_add_seconds (2,
                                                                (GSourceFunc)load_unlock_required_again,
                                                                ctx);
+            g_source_set_name_by_id (ctx->pin_check_timeout_id, "modem unlock required check");
             g_error_free (error);
             return;
         }
@@ -988,6 +995,8 @@ periodic_access_technologies_check (MMIfaceModem *self)
 {
     AccessTechnologiesCheckContext *ctx;
 
+    mm_main_loop_profiler_source_dispatched ();
+
     ctx = g_object_get_qdata (G_OBJECT (self), access_technologies_check_context_quark);
 
     /* Only launch a new one if not one running already OR if the last one run
@@ -1022,6 +1031,7 @@ mm_iface_modem_refresh_access_technologies (MMIfaceModem *self)
     ctx->timeout_source = g_timeout_add_seconds (ACCESS_TECHNOLOGIES_CHECK_TIMEOUT_SEC,
                                                  (GSourceFunc)periodic_access_technologies_check,
                                                  self);
+    g_source_set_name_by_id (ctx->timeout_source, "modem access technologies check");
 
     /* Get first access technology value */
     periodic_access_technologies_check (self);
@@ -1118,6 +1128,8 @@ expire_signal_quality (MMIfaceModem *self)
     MmGdbusModem *skeleton = NULL;
     SignalQualityUpdateContext *ctx;
 
+    mm_main_loop_profiler_source_dispatched ();
+
     g_object_get (self,
                   MM_IFACE_MODEM_DBUS_SKELETON, &skeleton,
                   NULL);
@@ -1160,7 +1172,6 @@ update_signal_quality (MMIfaceModem *self,
 {
     SignalQualityUpdateContext *ctx;
     MmGdbusModem *skeleton = NULL;
-    const gchar *dbus_path;
 
     g_object_get (self,
                   MM_IFACE_MODEM_DBUS_SKELETON, &skeleton,
@@ -1198,9 +1209,8 @@ update_signal_quality (MMIfaceModem *self,
                                                       signal_quality,
                                                       expire));
 
-    dbus_path = g_dbus_object_get_object_path (G_DBUS_OBJECT (self));
     mm_dbg ("Modem %s: signal quality updated (%u)",
-            dbus_path,
+            g_dbus_object_get_object_path (G_DBUS_OBJECT (self)),
             signal_quality);
 
     /* Remove any previous expiration refresh timeout */
@@ -1210,11 +1220,13 @@ update_signal_quality (MMIfaceModem *self,
     }
 
     /* If we got a new expirable value, setup new timeout */
-    if (expire)
+    if (expire) {
         ctx->recent_timeout_source = (g_timeout_add_seconds (
                                           SIGNAL_QUALITY_RECENT_TIMEOUT_SEC,
                                           (GSourceFunc)expire_signal_quality,
                                           self));
+        g_source_set_name_by_id (ctx->recent_timeout_source, "modem signal quality expiration");
+    }
 
     g_object_unref (skeleton);
 }
@@ -1276,6 +1288,7 @@ signal_quality_check_ready (MMIfaceModem *self,
                 ctx->timeout_source = g_timeout_add_seconds (ctx->interval,
                                                              (GSourceFunc)periodic_signal_quality_check,
                                                              self);
+                g_source_set_name_by_id (ctx->timeout_source, "modem signal quality check");
             }
         }
         ctx->running = FALSE;
@@ -1287,6 +1300,8 @@ periodic_signal_quality_check (MMIfaceModem *self)
 {
     SignalQualityCheckContext *ctx;
 
+    mm_main_loop_profiler_source_dispatched ();
+
     ctx = g_object_get_qdata (G_OBJECT (self), signal_quality_check_context_quark);
 
     /* Only launch a new one if not one running already OR if the last one run
@@ -1356,6 +1371,7 @@ periodic_signal_quality_check_enable (MMIfaceModem *self)
     ctx->timeout_source = g_timeout_add_seconds (ctx->interval,
                                                  (GSourceFunc)periodic_signal_quality_check,
                                                  self);
+    g_source_set_name_by_id (ctx->timeout_source, "modem signal quality check");
     g_object_set_qdata_full (G_OBJECT (self),
                              signal_quality_check_context_quark,
                              ctx,
@@ -2808,6 +2824,7 @@ reinitialize_ready (MMBaseModem *self,
 static gboolean
 restart_initialize_idle (MMIfaceModem *self)
 {
+    mm_main_loop_profiler_source_dispatched ();
     g_object_set_qdata (G_OBJECT (self), restart_initialize_idle_quark, NULL);
 
     /* If no wait needed, just go on */
@@ -2852,6 +2869,7 @@ set_lock_status (MMIfaceModem *self,
                     restart_initialize_idle_quark = (g_quark_from_static_string (RESTART_INITIALIZE_IDLE_TAG));
 
                 id = g_idle_add ((GSourceFunc)restart_initialize_idle, self);
+                g_source_set_name_by_id (id, "modem initialization restart");
                 g_object_set_qdata_full (G_OBJECT (self),
                                          restart_initialize_idle_quark,
                                          GUINT_TO_POINTER (id),
@@ -62,8 +62,339 @@ static const LogDesc level_descs[] = {
     { 0, NULL }
 };
 
-static GString *msgbuf = NULL;
-static volatile gsize msgbuf_once = 0;
+static const gchar *module_names[MM_LOG_MODULE_LAST] = {
+    [MM_LOG_MODULE_CORE]           = "core",
+    [MM_LOG_MODULE_SERIAL]         = "serial",
+    [MM_LOG_MODULE_QMI]            = "qmi",
+    [MM_LOG_MODULE_MBIM]           = "mbim",
+    [MM_LOG_MODULE_PLUGIN_MANAGER] = "plugin-manager",
+    [MM_LOG_MODULE_SMS]            = "sms",
+    [MM_LOG_MODULE_LOCATION]       = "location",
+    [MM_LOG_MODULE_MODEM]          = "modem",
+};
+
+MM_LOG_DEFINE_LEVELS (LOGL_INFO | LOGL_WARN | LOGL_ERR);
+
+/* Messages may be logged from the serial I/O worker thread as well, so each
+ * thread formats its messages in its own buffer */
+static void
+msgbuf_free (gpointer msgbuf)
+{
+    g_string_free ((GString *) msgbuf, TRUE);
+}
+
+static GPrivate msgbuf_key = G_PRIVATE_INIT (msgbuf_free);
+
+/*****************************************************************************/
+/* Asynchronous log file writer
+ *
+ * When logging to a file, formatted lines are not written right away; they are
+ * pushed into a bounded lock-free ring (multiple producers, single consumer)
+ * and a writer thread drains the ring in batches. The writer wakes up when the
+ * flush interval expires, when the amount of pending data reaches the flush
+ * size, or when a warning or error was logged. Only warnings, errors and the
+ * final flush on shutdown are synced to disk.
+ *
+ * If the ring is full the message is dropped and accounted; the writer reports
+ * the number of dropped messages in the log file itself.
+ *
+ * Fatal, error and critical GLib messages may abort the process right away, so
+ * they are written and synced from the calling thread, after draining whatever
+ * is still queued. */
+
+#define LOG_RING_SIZE 4096 /* must be a power of 2 */
+
+typedef struct {
+    volatile gint sequence;
+    gchar *str;
+    gsize len;
+} LogRecord;
+
+static LogRecord log_ring[LOG_RING_SIZE];
+static volatile gint log_ring_head;
+static guint log_ring_tail;
+
+static GThread *log_writer;
+static GMutex log_writer_mutex;
+static GCond log_writer_cond;
+static gboolean log_writer_wakeup;
+static gboolean log_writer_stop;
+/* Serializes draining the ring between the writer and direct writes */
+static GMutex log_drain_mutex;
+
+static volatile gint log_pending_bytes;
+static volatile gint log_sync_requested;
+static volatile gint log_n_dropped;
+/* Only used by whoever drains the ring */
+static guint log_n_dropped_reported;
+
+static guint flush_interval_ms = MM_LOG_DEFAULT_FLUSH_INTERVAL_MS;
+static gsize flush_size = MM_LOG_DEFAULT_FLUSH_SIZE;
+
+static void
+log_ring_init (void)
+{
+    guint i;
+
+    for (i = 0; i < LOG_RING_SIZE; i++) {
+        log_ring[i].sequence = (gint) i;
+        log_ring[i].str = NULL;
+        log_ring[i].len = 0;
+    }
+    log_ring_head = 0;
+    log_ring_tail = 0;
+}
+
+/* Sequence numbers wrap around, so always compare them as a signed distance */
+#define SEQUENCE_DIFF(a,b) ((gint) ((guint) (a) - (guint) (b)))
+
+static gboolean
+log_ring_push (gchar *str,
+               gsize len)
+{
+    LogRecord *record;
+    gint pos;
+
+    pos = g_atomic_int_get (&log_ring_head);
+    for (;;) {
+        gint diff;
+
+        record = &log_ring[(guint) pos & (LOG_RING_SIZE - 1)];
+        diff = SEQUENCE_DIFF (g_atomic_int_get (&record->sequence), pos);
+        if (diff == 0) {
+            /* Slot is free; try to claim it */
+            if (g_atomic_int_compare_and_exchange (&log_ring_head, pos, (gint) ((guint) pos + 1)))
+                break;
+        } else if (diff < 0) {
+            /* Slot still owned by the writer: ring full */
+            return FALSE;
+        }
+        pos = g_atomic_int_get (&log_ring_head);
+    }
+
+    record->str = str;
+    record->len = len;
+    /* Publish the record to the writer */
+    g_atomic_int_set (&record->sequence, (gint) ((guint) pos + 1));
+    return TRUE;
+}
+
+static gboolean
+log_ring_pop (gchar **str,
+              gsize *len)
+{
+    LogRecord *record;
+
+    record = &log_ring[log_ring_tail & (LOG_RING_SIZE - 1)];
+    if (SEQUENCE_DIFF (g_atomic_int_get (&record->sequence), log_ring_tail + 1) < 0)
+        return FALSE;
+
+    *str = record->str;
+    *len = record->len;
+    record->str = NULL;
+    /* Hand the slot back to the producers for the next lap */
+    g_atomic_int_set (&record->sequence, (gint) (log_ring_tail + LOG_RING_SIZE));
+    log_ring_tail++;
+    return TRUE;
+}
+
+static void
+log_fd_write (const gchar *str,
+              gsize len)
+{
+    while (len > 0) {
+        ssize_t written;
+
+        written = write (logfd, str, len);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            /* Nowhere to report this; just give up on this chunk */
+            return;
+        }
+        str += written;
+        len -= written;
+    }
+}
+
+static void
+log_writer_wake (void)
+{
+    g_mutex_lock (&log_writer_mutex);
+    log_writer_wakeup = TRUE;
+    g_cond_signal (&log_writer_cond);
+    g_mutex_unlock (&log_writer_mutex);
+}
+
+/* Must be called with the drain mutex held */
+static void
+log_writer_drain (GString *out)
+{
+    gchar *str;
+    gsize len;
+    guint n_dropped;
+
+    while (log_ring_pop (&str, &len)) {
+        g_atomic_int_add (&log_pending_bytes, - (gint) len);
+        g_string_append_len (out, str, len);
+        g_free (str);
+        if (out->len >= flush_size) {
+            log_fd_write (out->str, out->len);
+            g_string_truncate (out, 0);
+        }
+    }
+
+    n_dropped = (guint) g_atomic_int_get (&log_n_dropped);
+    if (n_dropped != log_n_dropped_reported) {
+        g_string_append_printf (out,
+                                "<warn>  Log ring full: %u messages dropped (%u in total)\n",
+                                n_dropped - log_n_dropped_reported,
+                                n_dropped);
+        log_n_dropped_reported = n_dropped;
+    }
+
+    if (out->len > 0) {
+        log_fd_write (out->str, out->len);
+        g_string_truncate (out, 0);
+    }
+}
+
+static gpointer
+log_writer_thread (gpointer unused)
+{
+    GString *out;
+    gboolean stop = FALSE;
+
+    out = g_string_sized_new (flush_size + 512);
+
+    while (!stop) {
+        gint64 deadline;
+
+        g_mutex_lock (&log_writer_mutex);
+        deadline = g_get_monotonic_time () + flush_interval_ms * G_TIME_SPAN_MILLISECOND;
+        while (!log_writer_wakeup && !log_writer_stop) {
+            if (!g_cond_wait_until (&log_writer_cond, &log_writer_mutex, deadline))
+                break;
+        }
+        log_writer_wakeup = FALSE;
+        stop = log_writer_stop;
+        g_mutex_unlock (&log_writer_mutex);
+
+        g_mutex_lock (&log_drain_mutex);
+        log_writer_drain (out);
+        g_mutex_unlock (&log_drain_mutex);
+
+        /* When stopping, the last sync is done once the thread is joined */
+        if (g_atomic_int_compare_and_exchange (&log_sync_requested, TRUE, FALSE) && !stop)
+            fdatasync (logfd);
+    }
+
+    g_string_free (out, TRUE);
+    return NULL;
+}
+
+static void
+log_writer_start (void)
+{
+    log_ring_init ();
+    log_n_dropped_reported = (guint) g_atomic_int_get (&log_n_dropped);
+    log_writer_wakeup = FALSE;
+    log_writer_stop = FALSE;
+    log_writer = g_thread_new ("mm-log-writer", log_writer_thread, NULL);
+}
+
+static void
+log_writer_finish (void)
+{
+    GThread *thread;
+    GString *out;
+
+    thread = log_writer;
+    if (!thread)
+        return;
+
+    g_mutex_lock (&log_writer_mutex);
+    log_writer_stop = TRUE;
+    g_cond_signal (&log_writer_cond);
+    g_mutex_unlock (&log_writer_mutex);
+
+    g_thread_join (thread);
+    log_writer = NULL;
+
+    /* Lines pushed while the writer was exiting are still in the ring; write
+     * them right here along with any last drop report, and sync it all */
+    out = g_string_new (NULL);
+    g_mutex_lock (&log_drain_mutex);
+    log_writer_drain (out);
+    g_mutex_unlock (&log_drain_mutex);
+    g_string_free (out, TRUE);
+    fdatasync (logfd);
+}
+
+/* Write a line to the log file from the calling thread, after any line still
+ * queued, and sync it before returning */
+static void
+log_file_write_now (const gchar *str,
+                    gsize len)
+{
+    GString *out;
+
+    out = g_string_new (NULL);
+    g_mutex_lock (&log_drain_mutex);
+    if (log_writer)
+        log_writer_drain (out);
+    log_fd_write (str, len);
+    fdatasync (logfd);
+    g_mutex_unlock (&log_drain_mutex);
+    g_string_free (out, TRUE);
+}
+
+/* Write a formatted log line to the log file; 'sync' requests it to reach
+ * the disk as soon as possible */
+static void
+log_file_write (const gchar *str,
+                gsize len,
+                gboolean sync)
+{
+    gchar *copy;
+    gint pending;
+
+    if (!log_writer) {
+        log_fd_write (str, len);
+        /* Without writer thread, keep the legacy behaviour of syncing
+         * every line, unless told it's not needed */
+        if (sync || flush_interval_ms == 0)
+            fdatasync (logfd);
+        return;
+    }
+
+    copy = g_strndup (str, len);
+    if (!log_ring_push (copy, len)) {
+        /* Ring full: drop the line and make sure the writer is awake. There
+         * is nothing new to sync, so don't request it; the writer reports
+         * the drops once woken. */
+        g_free (copy);
+        g_atomic_int_inc (&log_n_dropped);
+        log_writer_wake ();
+        return;
+    }
+
+    pending = g_atomic_int_add (&log_pending_bytes, (gint) len) + (gint) len;
+    if (sync) {
+        g_atomic_int_set (&log_sync_requested, TRUE);
+        log_writer_wake ();
+    } else if (pending >= (gint) flush_size && pending - (gint) len < (gint) flush_size)
+        /* Only the producer crossing the threshold wakes the writer */
+        log_writer_wake ();
+}
+
+guint
+mm_log_get_n_dropped (void)
+{
+    return (guint) g_atomic_int_get (&log_n_dropped);
+}
+
+/*****************************************************************************/
 
 void
 _mm_log (const char *loc,
@@ -74,15 +405,16 @@ _mm_log (const char *loc,
 {
     va_list args;
     GTimeVal tv;
+    GString *msgbuf;
     int syslog_priority = LOG_INFO;
-    ssize_t ign;
 
     if (!(log_level & level))
         return;
 
-    if (g_once_init_enter (&msgbuf_once)) {
+    msgbuf = g_private_get (&msgbuf_key);
+    if (!msgbuf) {
         msgbuf = g_string_sized_new (512);
-        g_once_init_leave (&msgbuf_once, 1);
+        g_private_set (&msgbuf_key, msgbuf);
     } else
         g_string_truncate (msgbuf, 0);
 
@@ -128,12 +460,8 @@ _mm_log (const char *loc,
 
     if (logfd < 0)
         syslog (syslog_priority, "%s", msgbuf->str);
-    else {
-        ign = write (logfd, msgbuf->str, msgbuf->len);
-        if (ign) {} /* whatever; really shut up about unused result */
-
-        fsync (logfd);  /* Make sure output is dumped to disk immediately */
-    }
+    else
+        log_file_write (msgbuf->str, msgbuf->len, level & (LOGL_WARN | LOGL_ERR) ? TRUE : FALSE);
 }
 
 static void
@@ -143,9 +471,8 @@ log_handler (const gchar *log_domain,
              gpointer ignored)
 {
     int syslog_priority;
-    ssize_t ign;
 
-    switch (level) {
+    switch (level & G_LOG_LEVEL_MASK) {
     case G_LOG_LEVEL_ERROR:
         syslog_priority = LOG_CRIT;
         break;
@@ -169,39 +496,117 @@ log_handler (const gchar *log_domain,
 
     if (logfd < 0)
         syslog (syslog_priority, "%s", message);
-    else {
-        ign = write (logfd, message, strlen (message));
-        if (ign) {} /* whatever; really shut up about unused result */
+    else if ((level & G_LOG_FLAG_FATAL) || syslog_priority <= LOG_ERR)
+        /* The process may be aborted as soon as we return */
+        log_file_write_now (message, strlen (message));
+    else
+        log_file_write (message, strlen (message), syslog_priority <= LOG_WARNING);
+}
+
+static gboolean
+parse_level (const gchar *str,
+             guint32 *level)
+{
+    const LogDesc *diter;
+
+    for (diter = &level_descs[0]; diter->name; diter++) {
+        if (!g_ascii_strcasecmp (diter->name, str)) {
+            *level = diter->num;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static gboolean
+parse_module (const gchar *str,
+              MMLogModule *module)
+{
+    guint i;
+
+    for (i = 0; i < MM_LOG_MODULE_LAST; i++) {
+        if (!g_ascii_strcasecmp (module_names[i], str)) {
+            *module = (MMLogModule) i;
+            return TRUE;
+        }
     }
+    return FALSE;
 }
 
 gboolean
 mm_log_set_level (const char *level, GError **error)
 {
-    gboolean found = FALSE;
-    const LogDesc *diter;
+    guint32 levels[MM_LOG_MODULE_LAST];
+    gchar *str;
+    gchar **items;
+    guint i;
+    gboolean found = TRUE;
+
+    /* An empty level would otherwise reset all modules to the default one */
+    str = g_strstrip (g_strdup (level ? level : ""));
+    if (!str[0]) {
+        g_free (str);
+        g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_INVALID_ARGS,
+                     "No log level given");
+        return FALSE;
+    }
 
-    for (diter = &level_descs[0]; diter->name; diter++) {
-        if (!strcasecmp (diter->name, level)) {
-            log_level = diter->num;
-            found = TRUE;
-            break;
+    /* Modules not given explicitly keep the default level */
+    for (i = 0; i < MM_LOG_MODULE_LAST; i++)
+        levels[i] = LOGL_INFO | LOGL_WARN | LOGL_ERR;
+
+    items = g_strsplit (str, ",", -1);
+    g_free (str);
+    for (i = 0; found && items[i]; i++) {
+        gchar *item;
+        gchar *equal;
+        guint32 item_level;
+
+        item = g_strstrip (items[i]);
+        equal = strchr (item, '=');
+        if (!equal) {
+            /* Global level, only allowed as the first item */
+            found = (i == 0 && parse_level (item, &item_level));
+            if (found) {
+                guint j;
+
+                for (j = 0; j < MM_LOG_MODULE_LAST; j++)
+                    levels[j] = item_level;
+            }
+        } else {
+            MMLogModule module;
+
+            *equal = '\0';
+            found = (parse_module (g_strstrip (item), &module) &&
+                     parse_level (g_strstrip (equal + 1), &item_level));
+            if (found)
+                levels[module] = item_level;
         }
     }
+    g_strfreev (items);
 
-    if (!found)
+    if (!found) {
         g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_INVALID_ARGS,
                      "Unknown log level '%s'", level);
+        return FALSE;
+    }
+
+    /* The global level is the union of all the module ones */
+    log_level = 0;
+    for (i = 0; i < MM_LOG_MODULE_LAST; i++) {
+        _mm_log_levels[i] = levels[i];
+        log_level |= levels[i];
+    }
 
 #if defined WITH_QMI
-    qmi_utils_set_traces_enabled (log_level & LOGL_DEBUG ? TRUE : FALSE);
+    qmi_utils_set_traces_enabled (mm_log_enabled (LOGL_DEBUG, MM_LOG_MODULE_QMI) ? TRUE : FALSE);
 #endif
 
 #if defined WITH_MBIM
-    mbim_utils_set_traces_enabled (log_level & LOGL_DEBUG ? TRUE : FALSE);
+    mbim_utils_set_traces_enabled (mm_log_enabled (LOGL_DEBUG, MM_LOG_MODULE_MBIM) ? TRUE : FALSE);
 #endif
 
-    return found;
+    return TRUE;
 }
 
 gboolean
@@ -210,6 +615,8 @@ mm_log_setup (const char *level,
               gboolean show_timestamps,
               gboolean rel_timestamps,
               gboolean debug_func_loc,
+              guint log_flush_interval_ms,
+              gsize log_flush_size,
               GError **error)
 {
     /* levels */
@@ -238,6 +645,12 @@ mm_log_setup (const char *level,
                          errno, strerror (errno));
             return FALSE;
         }
+
+        /* A flush interval of 0 disables the writer thread */
+        flush_interval_ms = log_flush_interval_ms;
+        flush_size = log_flush_size ? log_flush_size : MM_LOG_DEFAULT_FLUSH_SIZE;
+        if (flush_interval_ms > 0)
+            log_writer_start ();
     }
 
     g_log_set_handler (G_LOG_DOMAIN,
@@ -267,6 +680,9 @@ mm_log_shutdown (void)
 {
     if (logfd < 0)
         closelog ();
-    else
+    else {
+        log_writer_finish ();
         close (logfd);
+        logfd = -1;
+    }
 }
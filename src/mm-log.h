@@ -26,20 +26,59 @@ enum {
     LOGL_DEBUG = 0x00000008
 };
 
+#define LOGL_ALL (LOGL_ERR | LOGL_WARN | LOGL_INFO | LOGL_DEBUG)
+
+/* Log modules; each one may be given its own log level. Source files select
+ * the module their messages belong to by defining MM_LOG_MODULE before
+ * including any header. */
+typedef enum {
+    MM_LOG_MODULE_CORE = 0,
+    MM_LOG_MODULE_SERIAL,
+    MM_LOG_MODULE_QMI,
+    MM_LOG_MODULE_MBIM,
+    MM_LOG_MODULE_PLUGIN_MANAGER,
+    MM_LOG_MODULE_SMS,
+    MM_LOG_MODULE_LOCATION,
+    MM_LOG_MODULE_MODEM,
+    MM_LOG_MODULE_LAST
+} MMLogModule;
+
+#if !defined MM_LOG_MODULE
+# define MM_LOG_MODULE MM_LOG_MODULE_CORE
+#endif
+
+/* Levels enabled in each module; don't use directly, use mm_log_enabled() */
+extern guint32 _mm_log_levels[MM_LOG_MODULE_LAST];
+
+/* Defines the per-module levels array; only to be used by mm-log.c and by
+ * test programs providing their own _mm_log() implementation */
+#define MM_LOG_DEFINE_LEVELS(levels) \
+    guint32 _mm_log_levels[MM_LOG_MODULE_LAST] = { [0 ... MM_LOG_MODULE_LAST - 1] = (levels) }
+
+/* Check whether messages of the given level would be logged in the given
+ * module. The logging macros below do this check before evaluating any of
+ * their arguments, so it's only needed explicitly when building the message
+ * itself is expensive. */
+#define mm_log_enabled(level, module) \
+    (_mm_log_levels[(module)] & (level))
+
 #define mm_err(...) \
-    _mm_log (G_STRLOC, G_STRFUNC, LOGL_ERR, ## __VA_ARGS__ )
+    mm_log (LOGL_ERR, ## __VA_ARGS__ )
 
 #define mm_warn(...) \
-    _mm_log (G_STRLOC, G_STRFUNC, LOGL_WARN, ## __VA_ARGS__ )
+    mm_log (LOGL_WARN, ## __VA_ARGS__ )
 
 #define mm_info(...) \
-    _mm_log (G_STRLOC, G_STRFUNC, LOGL_INFO, ## __VA_ARGS__ )
+    mm_log (LOGL_INFO, ## __VA_ARGS__ )
 
 #define mm_dbg(...) \
-    _mm_log (G_STRLOC, G_STRFUNC, LOGL_DEBUG, ## __VA_ARGS__ )
+    mm_log (LOGL_DEBUG, ## __VA_ARGS__ )
 
-#define mm_log(level, ...) \
-    _mm_log (G_STRLOC, G_STRFUNC, level, ## __VA_ARGS__ )
+#define mm_log(level, ...)                                              \
+    G_STMT_START {                                                      \
+        if (mm_log_enabled (level, MM_LOG_MODULE))                      \
+            _mm_log (G_STRLOC, G_STRFUNC, level, ## __VA_ARGS__ );      \
+    } G_STMT_END
 
 void _mm_log (const char *loc,
               const char *func,
@@ -47,6 +86,12 @@ void _mm_log (const char *loc,
               const char *fmt,
               ...)  __attribute__((__format__ (__printf__, 4, 5)));
 
+/* Log file flushing defaults */
+#define MM_LOG_DEFAULT_FLUSH_INTERVAL_MS 500
+#define MM_LOG_DEFAULT_FLUSH_SIZE        16384
+
+/* Accepts a single level (e.g. "DEBUG") applied to all modules, optionally
+ * followed by per-module overrides (e.g. "INFO,serial=DEBUG,qmi=WARN") */
 gboolean mm_log_set_level (const char *level, GError **error);
 
 gboolean mm_log_setup (const char *level,
@@ -54,8 +99,13 @@ gboolean mm_log_setup (const char *level,
                        gboolean show_ts,
                        gboolean rel_ts,
                        gboolean debug_func_loc,
+                       guint log_flush_interval_ms,
+                       gsize log_flush_size,
                        GError **error);
 
+/* Number of log file messages dropped because the writer couldn't keep up */
+guint mm_log_get_n_dropped (void);
+
 void mm_log_shutdown (void);
 
 #endif  /* MM_LOG_H */
@@ -0,0 +1,365 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include "mm-main-loop-profiler.h"
+#include "mm-log.h"
+
+/*
+ * GLib doesn't tell when each source gets dispatched, so the sources worth
+ * profiling tell it themselves: they're given a name with g_source_set_name()
+ * when created, and their callbacks call
+ * mm_main_loop_profiler_source_dispatched() right away. The time from then
+ * until another source does the same or the dispatch finishes is accounted
+ * to g_source_get_name (g_main_current_source ()). Callbacks of sources
+ * created by others (udev monitor, D-Bus method calls, polkit replies) tell
+ * it with mm_main_loop_profiler_callback_dispatched() instead, giving the
+ * name themselves. Time spent dispatching sources that don't tell is
+ * accounted as "unnamed", along with the fds that were ready in that
+ * iteration, unless they run right after a named one in the same iteration,
+ * in which case it's accounted to the named one.
+ */
+
+#define UNNAMED_SOURCE "unnamed"
+
+typedef struct {
+    gchar *name;
+    guint32 dispatches;
+    guint64 total_us;
+    guint64 max_us;
+} SourceStats;
+
+static GHashTable *sources;
+static GMainContext *profiled_context;
+
+/* The source being dispatched, if it told so */
+static gboolean dispatching;
+static GSource *lap_source;
+static gchar *lap_name;
+static gint64 lap_start;
+
+/* The fds polled in the iteration being dispatched */
+static GPollFD *ready_fds;
+static gint n_ready_fds;
+
+static void
+source_stats_free (SourceStats *stats)
+{
+    g_free (stats->name);
+    g_slice_free (SourceStats, stats);
+}
+
+static void
+source_stats_record (const gchar *name,
+                     guint64 elapsed_us,
+                     gboolean dispatched)
+{
+    SourceStats *stats;
+
+    stats = g_hash_table_lookup (sources, name);
+    if (!stats) {
+        stats = g_slice_new0 (SourceStats);
+        stats->name = g_strdup (name);
+        g_hash_table_insert (sources, stats->name, stats);
+    }
+
+    if (dispatched)
+        stats->dispatches++;
+    stats->total_us += elapsed_us;
+    stats->max_us = MAX (stats->max_us, elapsed_us);
+}
+
+static gint
+source_stats_cmp_total (const SourceStats **a,
+                        const SourceStats **b)
+{
+    if ((*a)->total_us == (*b)->total_us)
+        return 0;
+    return ((*a)->total_us > (*b)->total_us) ? -1 : 1;
+}
+
+/* Sources sorted by total dispatch time, busiest first */
+static GPtrArray *
+source_stats_sorted (void)
+{
+    GPtrArray *sorted;
+    GHashTableIter iter;
+    gpointer value;
+
+    sorted = g_ptr_array_sized_new (g_hash_table_size (sources));
+    g_hash_table_iter_init (&iter, sources);
+    while (g_hash_table_iter_next (&iter, NULL, &value))
+        g_ptr_array_add (sorted, value);
+    g_ptr_array_sort (sorted, (GCompareFunc) source_stats_cmp_total);
+    return sorted;
+}
+
+GVariant *
+mm_main_loop_profiler_get_top (guint n)
+{
+    GVariantBuilder builder;
+    GPtrArray *sorted;
+    guint i;
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(sutt)"));
+    if (!sources)
+        return g_variant_builder_end (&builder);
+
+    sorted = source_stats_sorted ();
+    for (i = 0; i < sorted->len && i < n; i++) {
+        const SourceStats *stats = g_ptr_array_index (sorted, i);
+
+        g_variant_builder_add (&builder, "(sutt)",
+                               stats->name,
+                               stats->dispatches,
+                               stats->total_us,
+                               stats->max_us);
+    }
+    g_ptr_array_unref (sorted);
+
+    return g_variant_builder_end (&builder);
+}
+
+#define SUMMARY_TOP_N 10
+
+static gboolean
+log_summary (gpointer unused)
+{
+    GPtrArray *sorted;
+    guint i;
+
+    sorted = source_stats_sorted ();
+    mm_info ("main loop profile: %u sources dispatched", sorted->len);
+    for (i = 0; i < sorted->len && i < SUMMARY_TOP_N; i++) {
+        const SourceStats *stats = g_ptr_array_index (sorted, i);
+
+        mm_info ("  %s: %u dispatches, %" G_GUINT64_FORMAT " us total, %" G_GUINT64_FORMAT " us max",
+                 stats->name, stats->dispatches, stats->total_us, stats->max_us);
+    }
+    g_ptr_array_unref (sorted);
+
+    /* Start a new interval */
+    g_hash_table_remove_all (sources);
+    return G_SOURCE_CONTINUE;
+}
+
+/* Name for time not told about, after the fds which woke up the poll, so
+ * that e.g. an unnamed fd source can be told apart from idles and timeouts */
+static gchar *
+unnamed_lap_name (void)
+{
+    GString *name;
+    guint n_ready;
+    gint i;
+
+    name = g_string_new (UNNAMED_SOURCE);
+    for (i = 0, n_ready = 0; i < n_ready_fds; i++) {
+        if (!ready_fds[i].revents)
+            continue;
+        g_string_append_printf (name, "%s%d", n_ready++ ? "," : " (fd ", ready_fds[i].fd);
+    }
+    if (n_ready)
+        g_string_append_c (name, ')');
+
+    return g_string_free (name, FALSE);
+}
+
+/* Accounts the time since the last source told it was dispatched, or since
+ * the dispatch started */
+static void
+lap_finish (gint64 now,
+            gboolean last)
+{
+    if (lap_name)
+        source_stats_record (lap_name, (guint64) (now - lap_start), TRUE);
+    else if (last || now > lap_start) {
+        gchar *name;
+
+        /* Unnamed sources only count as dispatched if there was no other */
+        name = unnamed_lap_name ();
+        source_stats_record (name, (guint64) (now - lap_start), last);
+        g_free (name);
+    }
+
+    g_free (lap_name);
+    lap_name = NULL;
+    lap_source = NULL;
+    lap_start = now;
+}
+
+static void
+lap_start_source (const gchar *name)
+{
+    GSource *source;
+
+    /* Only the main context is profiled, and only while dispatching */
+    if (!dispatching || !g_main_context_is_owner (profiled_context))
+        return;
+
+    /* Callbacks may also get called directly by others */
+    source = g_main_current_source ();
+    if (!source)
+        return;
+
+    if (!name)
+        name = g_source_get_name (source);
+    if (!name)
+        name = UNNAMED_SOURCE;
+    if (source == lap_source && g_strcmp0 (name, lap_name) == 0)
+        return;
+
+    lap_finish (g_get_monotonic_time (), FALSE);
+    lap_source = source;
+    lap_name = g_strdup (name);
+}
+
+void
+mm_main_loop_profiler_source_dispatched (void)
+{
+    lap_start_source (NULL);
+}
+
+void
+mm_main_loop_profiler_callback_dispatched (const gchar *name)
+{
+    g_return_if_fail (name != NULL);
+
+    lap_start_source (name);
+}
+
+static void
+method_call_dispatched (GDBusMethodInvocation *invocation)
+{
+    gchar *name;
+
+    if (!dispatching)
+        return;
+
+    name = g_strdup_printf ("D-Bus %s.%s",
+                            g_dbus_method_invocation_get_interface_name (invocation),
+                            g_dbus_method_invocation_get_method_name (invocation));
+    lap_start_source (name);
+    g_free (name);
+}
+
+/* Never deny the call, just account it */
+static gboolean
+interface_skeleton_authorize_method (GDBusInterfaceSkeleton *skeleton,
+                                     GDBusMethodInvocation *invocation)
+{
+    method_call_dispatched (invocation);
+    return TRUE;
+}
+
+static gboolean
+object_skeleton_authorize_method (GDBusObjectSkeleton *skeleton,
+                                  GDBusInterfaceSkeleton *interface,
+                                  GDBusMethodInvocation *invocation)
+{
+    method_call_dispatched (invocation);
+    return TRUE;
+}
+
+void
+mm_main_loop_profiler_watch_skeleton (gpointer skeleton)
+{
+    /* Handlers of the authorize signals make GDBus go through the slower
+     * dispatch path, so only connect them when profiling */
+    if (!sources)
+        return;
+
+    if (G_IS_DBUS_OBJECT_SKELETON (skeleton))
+        g_signal_connect (skeleton,
+                          "authorize-method",
+                          G_CALLBACK (object_skeleton_authorize_method),
+                          NULL);
+    else if (G_IS_DBUS_INTERFACE_SKELETON (skeleton))
+        g_signal_connect (skeleton,
+                          "g-authorize-method",
+                          G_CALLBACK (interface_skeleton_authorize_method),
+                          NULL);
+    else
+        g_warn_if_reached ();
+}
+
+static void
+profiler_iterate (GMainContext *context,
+                  GPollFD **fds,
+                  gint *allocated_fds)
+{
+    GPollFunc poll_func;
+    gint max_priority;
+    gint timeout;
+    gint n_fds;
+
+    g_main_context_prepare (context, &max_priority);
+    while ((n_fds = g_main_context_query (context, max_priority, &timeout, *fds, *allocated_fds)) > *allocated_fds) {
+        *allocated_fds = n_fds;
+        *fds = g_renew (GPollFD, *fds, *allocated_fds);
+    }
+
+    poll_func = g_main_context_get_poll_func (context);
+    poll_func (*fds, n_fds, timeout);
+
+    if (!g_main_context_check (context, max_priority, *fds, n_fds))
+        return;
+
+    ready_fds = *fds;
+    n_ready_fds = n_fds;
+    lap_start = g_get_monotonic_time ();
+    dispatching = TRUE;
+    g_main_context_dispatch (context);
+    dispatching = FALSE;
+    lap_finish (g_get_monotonic_time (), TRUE);
+    ready_fds = NULL;
+    n_ready_fds = 0;
+}
+
+void
+mm_main_loop_profiler_run (GMainLoop *loop,
+                           guint summary_interval)
+{
+    GMainContext *context;
+    GPollFD *fds;
+    gint allocated_fds;
+    guint summary_id;
+
+    g_return_if_fail (sources == NULL);
+
+    sources = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify) source_stats_free);
+    summary_id = g_timeout_add_seconds (summary_interval, log_summary, NULL);
+
+    context = g_main_loop_get_context (loop);
+    profiled_context = context;
+    if (!g_main_context_acquire (context))
+        g_error ("Couldn't acquire the main context for profiling");
+
+    mm_info ("main loop profiling enabled, summary every %u seconds", summary_interval);
+
+    allocated_fds = 16;
+    fds = g_new (GPollFD, allocated_fds);
+
+    /* g_main_loop_quit() flags the loop as not running and wakes up the
+     * context, so this finishes just like g_main_loop_run() */
+    g_main_loop_ref (loop);
+    while (g_main_loop_is_running (loop))
+        profiler_iterate (context, &fds, &allocated_fds);
+    g_main_loop_unref (loop);
+
+    g_free (fds);
+    g_main_context_release (context);
+    profiled_context = NULL;
+
+    g_source_remove (summary_id);
+    g_hash_table_unref (sources);
+    sources = NULL;
+}
@@ -0,0 +1,47 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#ifndef MM_MAIN_LOOP_PROFILER_H
+#define MM_MAIN_LOOP_PROFILER_H
+
+#include <glib.h>
+#include <gio/gio.h>
+
+/* Run the main loop like g_main_loop_run(), but recording how long each
+ * named source takes to dispatch. A summary of the busiest sources is logged
+ * every summary_interval seconds. The loop must have been created as
+ * running, as there's no other way to flag it so. */
+void      mm_main_loop_profiler_run (GMainLoop *loop,
+                                     guint summary_interval);
+
+/* To be called first thing by the callbacks of the sources named with
+ * g_source_set_name(), so that their dispatch time is accounted to them.
+ * Does nothing if the profiler isn't running. */
+void      mm_main_loop_profiler_source_dispatched (void);
+
+/* Same as mm_main_loop_profiler_source_dispatched(), but for callbacks of
+ * sources created by others (e.g. GUdev or GDBus), which get their dispatch
+ * time accounted to the given name. */
+void      mm_main_loop_profiler_callback_dispatched (const gchar *name);
+
+/* Accounts the dispatch time of the D-Bus method calls handled by the given
+ * GDBusInterfaceSkeleton or GDBusObjectSkeleton to each method. Does nothing
+ * if the profiler isn't running. */
+void      mm_main_loop_profiler_watch_skeleton (gpointer skeleton);
+
+/* The busiest sources in the current summary interval, as an array of
+ * (source, dispatches, total dispatch us, max dispatch us); empty if the
+ * profiler isn't running */
+GVariant *mm_main_loop_profiler_get_top (guint n);
+
+#endif /* MM_MAIN_LOOP_PROFILER_H */
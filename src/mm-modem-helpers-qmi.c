@@ -13,6 +13,8 @@
  * Copyright (C) 2012 Google, Inc.
  */
 
+#define MM_LOG_MODULE MM_LOG_MODULE_QMI
+
 #include "mm-modem-helpers-qmi.h"
 #include "mm-enums-types.h"
 #include "mm-log.h"
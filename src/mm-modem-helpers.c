@@ -32,6 +32,82 @@
 #include "mm-modem-helpers.h"
 #include "mm-log.h"
 
+/*****************************************************************************/
+/* Regex registry */
+
+typedef struct {
+    GRegexCompileFlags compile_options;
+    GRegex *regex;
+} RegistryEntry;
+
+G_LOCK_DEFINE_STATIC (regex_registry);
+/* Pattern to list of RegistryEntry */
+static GHashTable *regex_registry;
+static guint regex_registry_n_compiled;
+static guint regex_registry_n_hits;
+
+GRegex *
+mm_regex_registry_get (const gchar *pattern,
+                       GRegexCompileFlags compile_options)
+{
+    GSList *entries;
+    GSList *l;
+    RegistryEntry *entry;
+    GRegex *regex = NULL;
+    GError *error = NULL;
+
+    g_return_val_if_fail (pattern != NULL, NULL);
+
+    G_LOCK (regex_registry);
+
+    if (G_UNLIKELY (!regex_registry))
+        regex_registry = g_hash_table_new (g_str_hash, g_str_equal);
+
+    entries = g_hash_table_lookup (regex_registry, pattern);
+    for (l = entries; l; l = g_slist_next (l)) {
+        entry = l->data;
+        if (entry->compile_options == compile_options) {
+            regex_registry_n_hits++;
+            regex = g_regex_ref (entry->regex);
+            goto out;
+        }
+    }
+
+    regex = g_regex_new (pattern, compile_options, 0, &error);
+    if (!regex) {
+        mm_warn ("Couldn't compile regex '%s': %s", pattern, error->message);
+        g_error_free (error);
+        goto out;
+    }
+
+    regex_registry_n_compiled++;
+
+    /* The registry keeps its own reference forever; the key is owned by
+     * the regex itself */
+    entry = g_slice_new (RegistryEntry);
+    entry->compile_options = compile_options;
+    entry->regex = g_regex_ref (regex);
+    g_hash_table_insert (regex_registry,
+                         (gpointer) g_regex_get_pattern (entry->regex),
+                         g_slist_prepend (entries, entry));
+
+out:
+    G_UNLOCK (regex_registry);
+    return regex;
+}
+
+void
+mm_regex_registry_get_stats (guint *n_compiled,
+                             guint *n_hits)
+{
+    G_LOCK (regex_registry);
+    if (n_compiled)
+        *n_compiled = regex_registry_n_compiled;
+    if (n_hits)
+        *n_hits = regex_registry_n_hits;
+    G_UNLOCK (regex_registry);
+}
+
 /*****************************************************************************/
 
 gchar *
@@ -392,10 +468,8 @@ mm_voice_ring_regex_get (void)
     /* Example:
      * <CR><LF>RING<CR><LF>
      */
-    return g_regex_new ("\\r\\nRING\\r\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                        0,
-                        NULL);
+    return mm_regex_registry_get ("\\r\\nRING\\r\\n",
+                                  G_REGEX_RAW | G_REGEX_OPTIMIZE);
 }
 
 GRegex *
@@ -405,10 +479,8 @@ mm_voice_cring_regex_get (void)
      * <CR><LF>+CRING: VOICE<CR><LF>
      * <CR><LF>+CRING: DATA<CR><LF>
      */
-    return g_regex_new ("\\r\\n\\+CRING:\\s*(\\S+)\\r\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                        0,
-                        NULL);
+    return mm_regex_registry_get ("\\r\\n\\+CRING:\\s*(\\S+)\\r\\n",
+                                  G_REGEX_RAW | G_REGEX_OPTIMIZE);
 }
 
 GRegex *
@@ -418,10 +490,8 @@ mm_voice_clip_regex_get (void)
      * <CR><LF>+CLIP: "+393351391306",145,,,,0<CR><LF>
      *                 \_ Number      \_ Type \_ Validity
      */
-    return g_regex_new ("\\r\\n\\+CLIP:\\s*(\\S+),\\s*(\\d+),\\s*,\\s*,\\s*,\\s*(\\d+)\\r\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                        0,
-                        NULL);
+    return mm_regex_registry_get ("\\r\\n\\+CLIP:\\s*(\\S+),\\s*(\\d+),\\s*,\\s*,\\s*,\\s*(\\d+)\\r\\n",
+                                  G_REGEX_RAW | G_REGEX_OPTIMIZE);
 }
 
 /*************************************************************************/
@@ -468,105 +538,105 @@ mm_3gpp_creg_regex_get (gboolean solicited)
 
     /* #1 */
     if (solicited)
-        regex = g_regex_new (CREG1 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_registry_get (CREG1 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE);
     else
-        regex = g_regex_new ("\\r\\n" CREG1 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_registry_get ("\\r\\n" CREG1 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE);
     g_assert (regex);
     g_ptr_array_add (array, regex);
 
     /* #2 */
     if (solicited)
-        regex = g_regex_new (CREG2 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_registry_get (CREG2 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE);
     else
-        regex = g_regex_new ("\\r\\n" CREG2 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_registry_get ("\\r\\n" CREG2 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE);
     g_assert (regex);
     g_ptr_array_add (array, regex);
 
     /* #3 */
     if (solicited)
-        regex = g_regex_new (CREG3 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_registry_get (CREG3 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE);
     else
-        regex = g_regex_new ("\\r\\n" CREG3 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_registry_get ("\\r\\n" CREG3 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE);
     g_assert (regex);
     g_ptr_array_add (array, regex);
 
     /* #4 */
     if (solicited)
-        regex = g_regex_new (CREG4 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_registry_get (CREG4 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE);
     else
-        regex = g_regex_new ("\\r\\n" CREG4 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_registry_get ("\\r\\n" CREG4 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE);
     g_assert (regex);
     g_ptr_array_add (array, regex);
 
     /* #5 */
     if (solicited)
-        regex = g_regex_new (CREG5 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_registry_get (CREG5 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE);
     else
-        regex = g_regex_new ("\\r\\n" CREG5 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_registry_get ("\\r\\n" CREG5 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE);
     g_assert (regex);
     g_ptr_array_add (array, regex);
 
     /* #6 */
     if (solicited)
-        regex = g_regex_new (CREG6 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_registry_get (CREG6 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE);
     else
-        regex = g_regex_new ("\\r\\n" CREG6 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_registry_get ("\\r\\n" CREG6 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE);
     g_assert (regex);
     g_ptr_array_add (array, regex);
 
     /* #7 */
     if (solicited)
-        regex = g_regex_new (CREG7 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_registry_get (CREG7 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE);
     else
-        regex = g_regex_new ("\\r\\n" CREG7 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_registry_get ("\\r\\n" CREG7 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE);
     g_assert (regex);
     g_ptr_array_add (array, regex);
 
     /* #8 */
     if (solicited)
-        regex = g_regex_new (CREG8 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_registry_get (CREG8 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE);
     else
-        regex = g_regex_new ("\\r\\n" CREG8 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_registry_get ("\\r\\n" CREG8 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE);
     g_assert (regex);
     g_ptr_array_add (array, regex);
 
     /* #9 */
     if (solicited)
-        regex = g_regex_new (CREG9 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_registry_get (CREG9 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE);
     else
-        regex = g_regex_new ("\\r\\n" CREG9 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_registry_get ("\\r\\n" CREG9 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE);
     g_assert (regex);
     g_ptr_array_add (array, regex);
 
     /* #10 */
     if (solicited)
-        regex = g_regex_new (CREG10 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_registry_get (CREG10 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE);
     else
-        regex = g_regex_new ("\\r\\n" CREG10 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_registry_get ("\\r\\n" CREG10 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE);
     g_assert (regex);
     g_ptr_array_add (array, regex);
 
     /* #11 */
     if (solicited)
-        regex = g_regex_new (CREG11 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_registry_get (CREG11 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE);
     else
-        regex = g_regex_new ("\\r\\n" CREG11 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_registry_get ("\\r\\n" CREG11 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE);
     g_assert (regex);
     g_ptr_array_add (array, regex);
 
     /* CEREG #1 */
     if (solicited)
-        regex = g_regex_new (CEREG1 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_registry_get (CEREG1 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE);
     else
-        regex = g_regex_new ("\\r\\n" CEREG1 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_registry_get ("\\r\\n" CEREG1 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE);
     g_assert (regex);
     g_ptr_array_add (array, regex);
 
     /* CEREG #2 */
     if (solicited)
-        regex = g_regex_new (CEREG2 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_registry_get (CEREG2 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE);
     else
-        regex = g_regex_new ("\\r\\n" CEREG2 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_registry_get ("\\r\\n" CEREG2 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE);
     g_assert (regex);
     g_ptr_array_add (array, regex);
 
@@ -585,10 +655,8 @@ mm_3gpp_creg_regex_destroy (GPtrArray *array)
 GRegex *
 mm_3gpp_ciev_regex_get (void)
 {
-    return g_regex_new ("\\r\\n\\+CIEV: (.*),(\\d)\\r\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                        0,
-                        NULL);
+    return mm_regex_registry_get ("\\r\\n\\+CIEV: (.*),(\\d)\\r\\n",
+                                  G_REGEX_RAW | G_REGEX_OPTIMIZE);
 }
 
 /*************************************************************************/
@@ -596,10 +664,8 @@ mm_3gpp_ciev_regex_get (void)
 GRegex *
 mm_3gpp_cusd_regex_get (void)
 {
-    return g_regex_new ("\\r\\n\\+CUSD:\\s*(.*)\\r\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                        0,
-                        NULL);
+    return mm_regex_registry_get ("\\r\\n\\+CUSD:\\s*(.*)\\r\\n",
+                                  G_REGEX_RAW | G_REGEX_OPTIMIZE);
 }
 
 /*************************************************************************/
@@ -607,10 +673,8 @@ mm_3gpp_cusd_regex_get (void)
 GRegex *
 mm_3gpp_cmti_regex_get (void)
 {
-    return g_regex_new ("\\r\\n\\+CMTI:\\s*\"(\\S+)\",\\s*(\\d+)\\r\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                        0,
-                        NULL);
+    return mm_regex_registry_get ("\\r\\n\\+CMTI:\\s*\"(\\S+)\",\\s*(\\d+)\\r\\n",
+                                  G_REGEX_RAW | G_REGEX_OPTIMIZE);
 }
 
 GRegex *
@@ -619,10 +683,8 @@ mm_3gpp_cds_regex_get (void)
     /* Example:
      * <CR><LF>+CDS: 24<CR><LF>07914356060013F10659098136395339F6219011707193802190117071938030<CR><LF>
      */
-    return g_regex_new ("\\r\\n\\+CDS:\\s*(\\d+)\\r\\n(.*)\\r\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                        0,
-                        NULL);
+    return mm_regex_registry_get ("\\r\\n\\+CDS:\\s*(\\d+)\\r\\n(.*)\\r\\n",
+                                  G_REGEX_RAW | G_REGEX_OPTIMIZE);
 }
 
 /*************************************************************************/
@@ -1985,47 +2047,126 @@ mm_3gpp_pdu_info_list_free (GList *info_list)
     g_list_free_full (info_list, (GDestroyNotify)mm_3gpp_pdu_info_free);
 }
 
-GList *
-mm_3gpp_parse_pdu_cmgl_response (const gchar *str,
-                                 GError **error)
+static const gchar *
+cmgl_skip_spaces (const gchar *p)
 {
-    GError *inner_error = NULL;
-    GList *list = NULL;
-    GMatchInfo *match_info;
-    GRegex *r;
+    while (*p == ' ' || *p == '\t')
+        p++;
+    return p;
+}
+
+static gboolean
+cmgl_read_int (const gchar **p,
+               gint *out)
+{
+    const gchar *s = *p;
+    guint64 value = 0;
+
+    if (!g_ascii_isdigit (*s))
+        return FALSE;
+
+    while (g_ascii_isdigit (*s)) {
+        value = (value * 10) + (*s - '0');
+        if (value > G_MAXINT)
+            return FALSE;
+        s++;
+    }
+
+    *out = (gint) value;
+    *p = s;
+    return TRUE;
+}
+
+MM3gppPduInfo *
+mm_3gpp_parse_pdu_cmgl_response_next (const gchar **str,
+                                      GError **error)
+{
+    const gchar *p;
+
+    g_return_val_if_fail (str != NULL && *str != NULL, NULL);
 
     /*
      * +CMGL: <index>, <status>, [<alpha>], <length>
      *   or
      * +CMGL: <index>, <status>, <length>
      *
-     * We just read <index>, <stat> and the PDU itself.
+     * We just read <index>, <stat> and the PDU itself, which comes in the
+     * next line. Anything not looking like a header (e.g. an URC which got
+     * in the middle) is skipped.
      */
-    r = g_regex_new ("\\+CMGL:\\s*(\\d+)\\s*,\\s*(\\d+)\\s*,(.*)\\r\\n([^\\r\\n]*)(\\r\\n)?",
-                     G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    g_assert (r != NULL);
-
-    g_regex_match_full (r, str, strlen (str), 0, 0, &match_info, &inner_error);
-    while (!inner_error && g_match_info_matches (match_info)) {
+    for (p = strstr (*str, "+CMGL:"); p; p = strstr (p, "+CMGL:")) {
         MM3gppPduInfo *info;
+        const gchar *header;
+        const gchar *pdu;
+        const gchar *pdu_end;
+        gint index;
+        gint status;
+
+        header = p;
+        p = cmgl_skip_spaces (p + strlen ("+CMGL:"));
+        if (!cmgl_read_int (&p, &index))
+            continue;
+        p = cmgl_skip_spaces (p);
+        if (*p != ',')
+            continue;
+        p = cmgl_skip_spaces (p + 1);
+        if (!cmgl_read_int (&p, &status))
+            continue;
+        p = cmgl_skip_spaces (p);
+        if (*p != ',')
+            continue;
 
-        info = g_new0 (MM3gppPduInfo, 1);
-        if (mm_get_int_from_match_info (match_info, 1, &info->index) &&
-            mm_get_int_from_match_info (match_info, 2, &info->status) &&
-            (info->pdu = mm_get_string_unquoted_from_match_info (match_info, 4)) != NULL) {
-            /* Append to our list of results and keep on */
-            list = g_list_append (list, info);
-            g_match_info_next (match_info, &inner_error);
-        } else {
-            inner_error = g_error_new (MM_CORE_ERROR,
-                                       MM_CORE_ERROR_FAILED,
-                                       "Error parsing +CMGL response: '%s'",
-                                       str);
+        /* The remainder of the header line isn't needed */
+        pdu = strstr (p, "\r\n");
+        if (!pdu)
+            break;
+        pdu += 2;
+        pdu_end = pdu + strcspn (pdu, "\r\n");
+
+        /* Unquote the PDU if needed */
+        if ((pdu_end - pdu) >= 2 && pdu[0] == '"' && pdu_end[-1] == '"') {
+            pdu++;
+            pdu_end--;
         }
+
+        if (pdu_end == pdu) {
+            gchar *entry;
+
+            entry = g_strndup (header, pdu_end - header);
+            g_set_error (error,
+                         MM_CORE_ERROR,
+                         MM_CORE_ERROR_FAILED,
+                         "Error parsing +CMGL response: '%s'",
+                         entry);
+            g_free (entry);
+            *str = pdu_end;
+            return NULL;
+        }
+
+        info = g_new0 (MM3gppPduInfo, 1);
+        info->index = index;
+        info->status = status;
+        info->pdu = g_strndup (pdu, pdu_end - pdu);
+
+        *str = pdu_end;
+        return info;
     }
 
-    g_match_info_free (match_info);
-    g_regex_unref (r);
+    /* No more entries */
+    *str += strlen (*str);
+    return NULL;
+}
+
+GList *
+mm_3gpp_parse_pdu_cmgl_response (const gchar *str,
+                                 GError **error)
+{
+    GError *inner_error = NULL;
+    GList *list = NULL;
+    MM3gppPduInfo *info;
+
+    while ((info = mm_3gpp_parse_pdu_cmgl_response_next (&str, &inner_error)) != NULL)
+        list = g_list_prepend (list, info);
 
     if (inner_error) {
         g_propagate_error (error, inner_error);
@@ -2033,7 +2174,7 @@ mm_3gpp_parse_pdu_cmgl_response (const gchar *str,
         return NULL;
     }
 
-    return list;
+    return g_list_reverse (list);
 }
 
 /*************************************************************************/
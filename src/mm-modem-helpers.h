@@ -47,6 +47,15 @@
     (MM_MODEM_CAPABILITY_GSM_UMTS |     \
      MM_MODEM_CAPABILITY_3GPP_LTE)
 
+/* Shared registry of compiled regular expressions. Each pattern/flags pair is
+ * compiled once per process, and a new reference to the same immutable GRegex
+ * is returned on every call; release it with g_regex_unref(). Returns NULL if
+ * the pattern cannot be compiled. */
+GRegex *mm_regex_registry_get       (const gchar *pattern,
+                                     GRegexCompileFlags compile_options);
+void    mm_regex_registry_get_stats (guint *n_compiled,
+                                     guint *n_hits);
+
 gchar       *mm_strip_quotes (gchar *str);
 const gchar *mm_strip_tag    (const gchar *str,
                               const gchar *cmd);
@@ -207,6 +216,10 @@ void   mm_3gpp_pdu_info_free           (MM3gppPduInfo *info);
 void   mm_3gpp_pdu_info_list_free      (GList *info_list);
 GList *mm_3gpp_parse_pdu_cmgl_response (const gchar *str,
                                         GError **error);
+/* Returns the next entry found in *str and moves *str past it; NULL
+ * without error once there are no more entries */
+MM3gppPduInfo *mm_3gpp_parse_pdu_cmgl_response_next (const gchar **str,
+                                                     GError **error);
 
 /* AT+CMGR (Read message) response parser */
 MM3gppPduInfo *mm_3gpp_parse_cmgr_read_response (const gchar *reply,
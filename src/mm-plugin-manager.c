@@ -16,6 +16,8 @@
  * Copyright (C) 2012 Google, Inc.
  */
 
+#define MM_LOG_MODULE MM_LOG_MODULE_PLUGIN_MANAGER
+
 #include <string.h>
 #include <ctype.h>
 
@@ -27,7 +29,10 @@
 
 #include "mm-plugin-manager.h"
 #include "mm-plugin.h"
+#include "mm-port-probe-cache.h"
+#include "mm-context.h"
 #include "mm-log.h"
+#include "mm-daemon-enums-types.h"
 
 static void initable_iface_init (GInitableIface *iface);
 
@@ -54,6 +59,16 @@ struct _MMPluginManagerPrivate {
 
     /* List of ongoing device support checks */
     GList *device_contexts;
+
+    /* Whether a single probe is shared by all plugins checking a port */
+    gboolean shared_probing;
+
+    /* Number of ports found in previously probed devices, keyed by port
+     * layout (see device_build_layout_key()) */
+    GHashTable *port_layouts;
+
+    /* Probing results and port layouts kept across restarts, if enabled */
+    MMPortProbeCache *probe_cache;
 };
 
 /*****************************************************************************/
@@ -161,6 +176,156 @@ common_async_context_new (MMPluginManager *self,
     return common;
 }
 
+/*****************************************************************************/
+/* Probe cache verification
+ *
+ * Probing results loaded from the probe cache are verified in the background
+ * once the support check is over, by probing again the ports that the modem
+ * doesn't use (the modem itself validates the ones it uses). Outdated results
+ * are removed from the cache, so that the port gets fully probed next time.
+ */
+
+/* Time to wait before verifying, so that the modem initialization is not
+ * disturbed */
+#define CACHE_VERIFY_DELAY_SECS 30
+
+typedef struct {
+    MMPluginManager *self;
+    /* The probe with the cached results */
+    MMPortProbe     *cached;
+    /* The probe verifying them */
+    MMPortProbe     *probe;
+    MMPortProbeFlag  flags;
+} CacheVerifyContext;
+
+static void
+cache_verify_context_free (CacheVerifyContext *ctx)
+{
+    if (ctx->probe)
+        g_object_unref (ctx->probe);
+    g_object_unref (ctx->cached);
+    g_object_unref (ctx->self);
+    g_slice_free (CacheVerifyContext, ctx);
+}
+
+static void
+cache_verify_ready (MMPortProbe        *probe,
+                    GAsyncResult       *res,
+                    CacheVerifyContext *ctx)
+{
+    GError *error = NULL;
+
+    if (!mm_port_probe_run_finish (probe, res, &error)) {
+        mm_dbg ("(%s/%s) couldn't verify cached probing results: '%s'",
+                mm_port_probe_get_port_subsys (probe),
+                mm_port_probe_get_port_name (probe),
+                error->message);
+        g_error_free (error);
+    } else if (((ctx->flags & MM_PORT_PROBE_AT) &&
+                mm_port_probe_is_at (probe) != mm_port_probe_is_at (ctx->cached)) ||
+               ((ctx->flags & MM_PORT_PROBE_QCDM) &&
+                mm_port_probe_is_qcdm (probe) != mm_port_probe_is_qcdm (ctx->cached))) {
+        mm_warn ("(%s/%s) cached probing results are outdated, port will be fully probed next time",
+                 mm_port_probe_get_port_subsys (probe),
+                 mm_port_probe_get_port_name (probe));
+        if (ctx->self->priv->probe_cache)
+            mm_port_probe_cache_remove_results (ctx->self->priv->probe_cache, ctx->cached);
+    } else
+        mm_dbg ("(%s/%s) cached probing results verified",
+                mm_port_probe_get_port_subsys (probe),
+                mm_port_probe_get_port_name (probe));
+
+    cache_verify_context_free (ctx);
+}
+
+static gboolean
+cache_verify_start (CacheVerifyContext *ctx)
+{
+    MMBaseModem *modem;
+    MMPort      *port;
+
+    /* If there is no modem, the device is either gone or unsupported */
+    modem = mm_device_peek_modem (mm_port_probe_peek_device (ctx->cached));
+    if (!modem) {
+        cache_verify_context_free (ctx);
+        return G_SOURCE_REMOVE;
+    }
+
+    /* Never disturb ports grabbed by the modem, not even the ignored ones:
+     * plugins ignore ports that shouldn't be touched */
+    port = mm_base_modem_get_port (modem,
+                                   mm_port_probe_get_port_subsys (ctx->cached),
+                                   mm_port_probe_get_port_name (ctx->cached));
+    if (port) {
+        cache_verify_context_free (ctx);
+        return G_SOURCE_REMOVE;
+    }
+
+    mm_dbg ("(%s/%s) verifying cached probing results",
+            mm_port_probe_get_port_subsys (ctx->cached),
+            mm_port_probe_get_port_name (ctx->cached));
+
+    ctx->probe = mm_port_probe_new (mm_port_probe_peek_device (ctx->cached),
+                                    mm_port_probe_peek_port (ctx->cached));
+    mm_port_probe_run (ctx->probe,
+                       ctx->flags,
+                       MM_PLUGIN_DEFAULT_SEND_DELAY,
+                       TRUE,  /* remove echo */
+                       FALSE, /* send LF */
+                       FALSE, /* AT and QCDM at once */
+                       NULL,
+                       NULL,
+                       NULL,
+                       (GAsyncReadyCallback) cache_verify_ready,
+                       ctx);
+    return G_SOURCE_REMOVE;
+}
+
+/* Plugins flag their GPS data ports with udev tags named e.g.
+ * ID_MM_HUAWEI_GPS_PORT or ID_MM_CINTERION_PORT_TYPE_GPS */
+static gboolean
+port_is_gps_tagged (GUdevDevice *port)
+{
+    const gchar * const *keys;
+    guint i;
+
+    keys = g_udev_device_get_property_keys (port);
+    for (i = 0; keys && keys[i]; i++) {
+        if (g_str_has_prefix (keys[i], "ID_MM_") &&
+            (strstr (keys[i], "_GPS") || strstr (keys[i], "_NMEA")) &&
+            g_udev_device_get_property_as_boolean (port, keys[i]))
+            return TRUE;
+    }
+    return FALSE;
+}
+
+static void
+cache_verify_schedule (MMPluginManager *self,
+                       MMPortProbe     *cached)
+{
+    CacheVerifyContext *ctx;
+    MMPortProbeFlag     flags;
+
+    /* Only serial ports are verified, and only the basic AT and QCDM results,
+     * which are the ones requiring the longest timeouts to get */
+    if (!g_str_equal (mm_port_probe_get_port_subsys (cached), "tty"))
+        return;
+
+    /* Ports flagged as ignored or as NMEA outputs must never be probed */
+    if (mm_port_probe_is_ignored (cached) ||
+        port_is_gps_tagged (mm_port_probe_peek_port (cached)))
+        return;
+    flags = mm_port_probe_get_probed_flags (cached) & (MM_PORT_PROBE_AT | MM_PORT_PROBE_QCDM);
+    if (flags == MM_PORT_PROBE_NONE)
+        return;
+
+    ctx = g_slice_new0 (CacheVerifyContext);
+    ctx->self = g_object_ref (self);
+    ctx->cached = g_object_ref (cached);
+    ctx->flags = flags;
+    g_timeout_add_seconds (CACHE_VERIFY_DELAY_SECS, (GSourceFunc) cache_verify_start, ctx);
+}
+
 /*****************************************************************************/
 /* Port context */
 
@@ -207,6 +372,15 @@ struct _PortContext {
     /* The probe must be deferred until a result is suggested by other
      * port probe results (e.g. for WWAN ports). */
     gboolean defer_until_suggested;
+
+    /* Plugins are first checked against the results of a shared probe */
+    gboolean shared_probing;
+
+    /* All plugins to try get the same results probing with the default
+     * setup; i.e. none of them has custom AT probing */
+    gboolean default_probing;
+    /* Probing results were loaded from the probe cache */
+    gboolean cached_results;
 };
 
 static void
@@ -250,10 +424,31 @@ port_context_run_finish (MMPluginManager  *self,
     return g_task_propagate_pointer (G_TASK (res), error);
 }
 
+static void
+port_context_update_probe_cache (PortContext     *port_context,
+                                 MMPluginManager *self)
+{
+    MMPortProbe *probe;
+
+    /* Results obtained with custom AT probing would not be valid for other
+     * plugins */
+    if (!port_context->default_probing)
+        return;
+
+    probe = MM_PORT_PROBE (mm_device_peek_port_probe (port_context->device, port_context->port));
+    if (!probe)
+        return;
+
+    mm_port_probe_cache_save_results (self->priv->probe_cache, probe);
+    if (port_context->cached_results)
+        cache_verify_schedule (self, probe);
+}
+
 static void
 port_context_complete (PortContext *port_context)
 {
-    GTask *task;
+    MMPluginManager *self;
+    GTask           *task;
 
     /* Steal the task from the task */
     g_assert (port_context->task);
@@ -264,6 +459,11 @@ port_context_complete (PortContext *port_context)
     mm_dbg ("[plugin manager] task %s: finished in '%lf' seconds",
             port_context->name, g_timer_elapsed (port_context->timer, NULL));
 
+    /* Keep the probing results for next time */
+    self = MM_PLUGIN_MANAGER (g_task_get_source_object (task));
+    if (self->priv->probe_cache && !g_cancellable_is_cancelled (port_context->cancellable))
+        port_context_update_probe_cache (port_context, self);
+
     if (!port_context->best_plugin)
         g_task_return_new_error (task, MM_CORE_ERROR, MM_CORE_ERROR_UNSUPPORTED, "Unsupported");
     else
@@ -455,22 +655,10 @@ port_context_defer_until_suggested (PortContext *port_context,
 }
 
 static void
-plugin_supports_port_ready (MMPlugin     *plugin,
-                            GAsyncResult *res,
-                            PortContext  *port_context)
+port_context_process_support_result (PortContext            *port_context,
+                                     MMPlugin               *plugin,
+                                     MMPluginSupportsResult  support_result)
 {
-    MMPluginSupportsResult  support_result;
-    GError                 *error = NULL;
-
-    /* Get supports check results */
-    support_result = mm_plugin_supports_port_finish (plugin, res, &error);
-    if (error) {
-        g_assert_cmpuint (support_result, ==, MM_PLUGIN_SUPPORTS_PORT_UNKNOWN);
-        mm_warn ("[plugin manager] task %s: error when checking support with plugin '%s': '%s'",
-                 port_context->name, mm_plugin_get_name (plugin), error->message);
-        g_error_free (error);
-    }
-
     switch (support_result) {
     case MM_PLUGIN_SUPPORTS_PORT_SUPPORTED:
         port_context_supported (port_context, plugin);
@@ -486,6 +674,26 @@ plugin_supports_port_ready (MMPlugin     *plugin,
         port_context_defer_until_suggested (port_context, plugin);
         break;
     }
+}
+
+static void
+plugin_supports_port_ready (MMPlugin     *plugin,
+                            GAsyncResult *res,
+                            PortContext  *port_context)
+{
+    MMPluginSupportsResult  support_result;
+    GError                 *error = NULL;
+
+    /* Get supports check results */
+    support_result = mm_plugin_supports_port_finish (plugin, res, &error);
+    if (error) {
+        g_assert_cmpuint (support_result, ==, MM_PLUGIN_SUPPORTS_PORT_UNKNOWN);
+        mm_warn ("[plugin manager] task %s: error when checking support with plugin '%s': '%s'",
+                 port_context->name, mm_plugin_get_name (plugin), error->message);
+        g_error_free (error);
+    }
+
+    port_context_process_support_result (port_context, plugin, support_result);
 
     /* We received a full reference, to make sure the context was always
      * valid during the async call */
@@ -509,12 +717,27 @@ port_context_next (PortContext *port_context)
         return;
     }
 
+    plugin = MM_PLUGIN (port_context->current->data);
+
+    /* If the shared probe already has all the results the plugin needs, just
+     * apply its filters right away */
+    if (port_context->shared_probing) {
+        MMPluginSupportsResult support_result;
+
+        support_result = mm_plugin_supports_port_cached (plugin, port_context->device, port_context->port);
+        if (support_result != MM_PLUGIN_SUPPORTS_PORT_UNKNOWN) {
+            mm_dbg ("[plugin manager] task %s: checked with plugin '%s' using shared probe",
+                    port_context->name, mm_plugin_get_name (plugin));
+            port_context_process_support_result (port_context, plugin, support_result);
+            return;
+        }
+    }
+
     /* Ask the current plugin to check support of this port.
      *
      * A full new reference to the port context is given as user data to the
      * async method because we want to make sure the context is still valid
      * once the method finishes. */
-    plugin = MM_PLUGIN (port_context->current->data);
     mm_dbg ("[plugin manager] task %s: checking with plugin '%s'",
             port_context->name, mm_plugin_get_name (plugin));
     mm_plugin_supports_port (plugin,
@@ -525,6 +748,96 @@ port_context_next (PortContext *port_context)
                              port_context_ref (port_context));
 }
 
+static void
+shared_probe_ready (MMPortProbe  *probe,
+                    GAsyncResult *res,
+                    PortContext  *port_context)
+{
+    GError *error = NULL;
+
+    /* Errors are not fatal here; plugins will just probe again on their own */
+    if (!mm_port_probe_run_finish (probe, res, &error)) {
+        mm_dbg ("[plugin manager] task %s: shared probe failed: '%s'",
+                port_context->name, error->message);
+        g_error_free (error);
+    }
+
+    port_context_next (port_context);
+
+    /* We received a full reference, to make sure the context was always
+     * valid during the async call */
+    port_context_unref (port_context);
+}
+
+/* Returns FALSE if no shared probe was launched */
+static gboolean
+port_context_run_shared_probe (PortContext *port_context)
+{
+    MMPortProbe     *probe;
+    MMPortProbeFlag  flags = MM_PORT_PROBE_NONE;
+    gboolean         at_qcdm_probe = TRUE;
+    GList           *l;
+    gchar           *probe_list_str;
+
+    probe = MM_PORT_PROBE (mm_device_peek_port_probe (port_context->device, port_context->port));
+    if (!probe)
+        return FALSE;
+
+    if (!port_context->default_probing) {
+        mm_dbg ("[plugin manager] task %s: no shared probe, custom AT probing required",
+                port_context->name);
+        return FALSE;
+    }
+
+    /* Build the superset of probing required by all plugins to try; AT and
+     * QCDM are only probed at once if all of them allow it */
+    for (l = port_context->current; l; l = g_list_next (l)) {
+        flags |= mm_plugin_get_shared_probe_flags (MM_PLUGIN (l->data), port_context->device, port_context->port);
+        if (!mm_plugin_get_at_qcdm_probe (MM_PLUGIN (l->data), port_context->port))
+            at_qcdm_probe = FALSE;
+    }
+
+    if (flags == MM_PORT_PROBE_NONE)
+        return FALSE;
+
+    probe_list_str = mm_port_probe_flag_build_string_from_mask (flags);
+    mm_dbg ("[plugin manager] task %s: running shared probe: '%s'",
+            port_context->name, probe_list_str);
+    g_free (probe_list_str);
+
+    mm_port_probe_run (probe,
+                       flags,
+                       MM_PLUGIN_DEFAULT_SEND_DELAY,
+                       TRUE,  /* remove echo */
+                       FALSE, /* send LF */
+                       at_qcdm_probe,
+                       NULL,
+                       NULL,
+                       port_context->cancellable,
+                       (GAsyncReadyCallback) shared_probe_ready,
+                       port_context_ref (port_context));
+    return TRUE;
+}
+
+static gboolean
+port_context_get_default_probing (PortContext *port_context)
+{
+    GList *l;
+
+    for (l = port_context->current; l; l = g_list_next (l)) {
+        MMPlugin *plugin;
+
+        plugin = MM_PLUGIN (l->data);
+        if (!mm_plugin_get_shared_probe_allowed (plugin, port_context->device, port_context->port)) {
+            mm_dbg ("[plugin manager] task %s: plugin '%s' uses custom AT probing",
+                    port_context->name, mm_plugin_get_name (plugin));
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
 static gboolean
 port_context_cancel (PortContext *port_context)
 {
@@ -634,6 +947,24 @@ port_context_run (MMPluginManager     *self,
 
     mm_dbg ("[plugin manager) task %s: started", port_context->name);
 
+    port_context->default_probing = port_context_get_default_probing (port_context);
+
+    /* Reuse the results found the last time the port was probed, if any */
+    if (self->priv->probe_cache && port_context->default_probing) {
+        MMPortProbe *probe;
+
+        probe = MM_PORT_PROBE (mm_device_peek_port_probe (port_context->device, port_context->port));
+        if (probe && mm_port_probe_cache_load_results (self->priv->probe_cache, probe)) {
+            mm_dbg ("[plugin manager] task %s: using cached probing results", port_context->name);
+            port_context->cached_results = TRUE;
+        }
+    }
+
+    /* If requested, probe once for all plugins before checking them */
+    port_context->shared_probing = self->priv->shared_probing;
+    if (port_context->shared_probing && port_context_run_shared_probe (port_context))
+        return;
+
     /* Go probe with the first plugin */
     port_context_next (port_context);
 }
@@ -661,7 +992,10 @@ port_context_new (MMPluginManager *self,
 /*****************************************************************************/
 /* Device context */
 
-/* Time to wait for ports to appear before starting to probe the first one */
+/* Time to wait for ports to appear before starting to probe the first one.
+ * If the number of ports expected in the device is known (given in udev rules
+ * or learnt from previous devices with the same layout), probing starts as
+ * soon as all of them are available instead. */
 #define MIN_WAIT_TIME_MSECS 1500
 
 /* Time to wait for other ports to appear once the first port is exposed
@@ -720,6 +1054,19 @@ struct _DeviceContext {
 
     /* Port support check contexts being run */
     GList *port_contexts;
+
+    /* Key identifying the port layout of the device, if any */
+    gchar *layout_key;
+    /* Number of ports expected in the device, 0 if unknown */
+    guint n_expected_ports;
+    /* Number of ports currently grabbed in the device */
+    guint n_ports;
+
+    /* Timing instrumentation, in seconds since the context was created, or
+     * negative if the event didn't happen */
+    gdouble first_port_time;
+    gdouble last_port_time;
+    gdouble probing_start_time;
 };
 
 static void
@@ -738,6 +1085,7 @@ device_context_unref (DeviceContext *device_context)
         g_assert (!device_context->task);
 
         g_free (device_context->name);
+        g_free (device_context->layout_key);
         g_timer_destroy (device_context->timer);
         if (device_context->cancellable)
             g_object_unref (device_context->cancellable);
@@ -798,6 +1146,32 @@ device_context_run_finish (MMPluginManager  *self,
     return MM_PLUGIN (g_task_propagate_pointer (G_TASK (res), error));
 }
 
+/* Learned port layouts are only ever raised: a device exposing fewer ports
+ * than before most likely had some of them missing or too slow to show up,
+ * and trusting that would stop us from waiting for them next time. */
+static void
+plugin_manager_learn_port_layout (MMPluginManager *self,
+                                  const gchar     *task_name,
+                                  const gchar     *layout_key,
+                                  guint            n_ports)
+{
+    guint learned;
+
+    learned = GPOINTER_TO_UINT (g_hash_table_lookup (self->priv->port_layouts, layout_key));
+    if (!learned && self->priv->probe_cache)
+        learned = mm_port_probe_cache_get_n_ports (self->priv->probe_cache, layout_key);
+    if (n_ports <= learned)
+        return;
+
+    mm_dbg ("[plugin manager] task %s: learned port layout '%s': %u ports",
+            task_name, layout_key, n_ports);
+    g_hash_table_insert (self->priv->port_layouts,
+                         g_strdup (layout_key),
+                         GUINT_TO_POINTER (n_ports));
+    if (self->priv->probe_cache)
+        mm_port_probe_cache_learn_n_ports (self->priv->probe_cache, layout_key, n_ports);
+}
+
 static void
 device_context_complete (DeviceContext *device_context)
 {
@@ -811,6 +1185,25 @@ device_context_complete (DeviceContext *device_context)
     /* Log about the time required to complete the checks */
     mm_dbg ("[plugin manager] task %s: finished in '%lf' seconds",
             device_context->name, g_timer_elapsed (device_context->timer, NULL));
+    mm_dbg ("[plugin manager] task %s: timing: first port at %.3lfs, last port at %.3lfs, "
+            "probing started at %.3lfs (%u ports, %u expected)",
+            device_context->name,
+            device_context->first_port_time,
+            device_context->last_port_time,
+            device_context->probing_start_time,
+            device_context->n_ports,
+            device_context->n_expected_ports);
+
+    /* Learn the port layout of the device, so that next time we don't need
+     * to wait for more ports than these */
+    if (device_context->best_plugin &&
+        device_context->layout_key &&
+        device_context->n_ports > 0 &&
+        !g_cancellable_is_cancelled (device_context->cancellable))
+        plugin_manager_learn_port_layout (device_context->self,
+                                          device_context->name,
+                                          device_context->layout_key,
+                                          device_context->n_ports);
 
     /* Remove signal handlers */
     if (device_context->grabbed_id) {
@@ -966,6 +1359,13 @@ device_context_set_best_plugin (DeviceContext *device_context,
             port_context->name, mm_plugin_get_name (best_plugin));
 }
 
+static gboolean
+device_context_all_ports_available (DeviceContext *device_context)
+{
+    return (device_context->n_expected_ports > 0 &&
+            device_context->n_ports >= device_context->n_expected_ports);
+}
+
 static void
 device_context_continue (DeviceContext *device_context)
 {
@@ -1107,6 +1507,7 @@ device_context_min_wait_time_elapsed (DeviceContext *device_context)
     self = MM_PLUGIN_MANAGER (device_context->self);
 
     device_context->min_wait_time_id = 0;
+    device_context->probing_start_time = g_timer_elapsed (device_context->timer, NULL);
     mm_dbg ("[plugin manager] task %s: min wait time elapsed", device_context->name);
 
     /* Move list of port contexts out of the wait list */
@@ -1130,6 +1531,9 @@ device_context_port_released (DeviceContext *device_context,
     mm_dbg ("[plugin manager] task %s: port released: %s",
             device_context->name, g_udev_device_get_name (port));
 
+    if (device_context->n_ports > 0)
+        device_context->n_ports--;
+
     /* Check if there's a waiting port context */
     port_context = device_context_peek_waiting_port_context (device_context, port);
     if (port_context) {
@@ -1191,12 +1595,27 @@ device_context_port_grabbed (DeviceContext *device_context,
     mm_dbg ("[plugin manager] task %s: new support task for port",
             port_context->name);
 
+    /* Keep track of when ports arrive */
+    device_context->n_ports++;
+    device_context->last_port_time = g_timer_elapsed (device_context->timer, NULL);
+    if (device_context->first_port_time < 0)
+        device_context->first_port_time = device_context->last_port_time;
+
     /* Îf still waiting the min wait time, store it in the waiting list */
     if (device_context->min_wait_time_id) {
         mm_dbg ("[plugin manager) task %s: deferred until min wait time elapsed",
                 port_context->name);
         /* Store the port reference in the list within the device */
         device_context->wait_port_contexts = g_list_prepend (device_context->wait_port_contexts, port_context);
+
+        /* If all expected ports are already around, there's no point in
+         * waiting any longer */
+        if (device_context_all_ports_available (device_context)) {
+            mm_dbg ("[plugin manager] task %s: all %u expected ports available, not waiting any longer",
+                    device_context->name, device_context->n_expected_ports);
+            g_source_remove (device_context->min_wait_time_id);
+            device_context_min_wait_time_elapsed (device_context);
+        }
         return;
     }
 
@@ -1293,6 +1712,64 @@ device_context_run (MMPluginManager     *self,
     device_context->task = g_task_new (self, device_context->cancellable, callback, user_data);
 }
 
+/* Devices with the same vendor and product IDs may still expose different
+ * sets of ports (e.g. in different USB configurations), so the number of
+ * interfaces is also part of the layout key */
+static gchar *
+device_build_layout_key (MMDevice *device)
+{
+    GUdevDevice *physdev;
+    guint16      vendor;
+    guint16      product;
+
+    if (mm_device_is_virtual (device))
+        return NULL;
+
+    vendor  = mm_device_get_vendor (device);
+    product = mm_device_get_product (device);
+    if (!vendor && !product)
+        return NULL;
+
+    physdev = mm_device_peek_udev_device (device);
+    return g_strdup_printf ("%04x:%04x:%d",
+                            vendor,
+                            product,
+                            g_udev_device_get_sysfs_attr_as_int (physdev, "bNumInterfaces"));
+}
+
+/* Number of ports the device is expected to expose: explicitly given in udev
+ * rules with the ID_MM_EXPECTED_PORTS tag, or as found the last time a device
+ * with the same layout was probed. 0 if unknown. */
+static guint
+plugin_manager_get_expected_ports (MMPluginManager *self,
+                                   MMDevice        *device,
+                                   const gchar     *layout_key)
+{
+    if (!mm_device_is_virtual (device)) {
+        GUdevDevice *physdev;
+
+        physdev = mm_device_peek_udev_device (device);
+        if (g_udev_device_has_property (physdev, "ID_MM_EXPECTED_PORTS")) {
+            gint n;
+
+            n = g_udev_device_get_property_as_int (physdev, "ID_MM_EXPECTED_PORTS");
+            if (n > 0)
+                return (guint) n;
+        }
+    }
+
+    if (layout_key) {
+        guint n;
+
+        n = GPOINTER_TO_UINT (g_hash_table_lookup (self->priv->port_layouts, layout_key));
+        if (!n && self->priv->probe_cache)
+            n = mm_port_probe_cache_get_n_ports (self->priv->probe_cache, layout_key);
+        return n;
+    }
+
+    return 0;
+}
+
 static DeviceContext *
 device_context_new (MMPluginManager *self,
                     MMDevice        *device)
@@ -1310,6 +1787,18 @@ device_context_new (MMPluginManager *self,
     /* Set context name (just for logging) */
     device_context->name = g_strdup_printf ("%lu", unique_task_id++);
 
+    /* Setup the port completeness model */
+    device_context->first_port_time    = -1.0;
+    device_context->last_port_time     = -1.0;
+    device_context->probing_start_time = -1.0;
+    device_context->layout_key = device_build_layout_key (device);
+    device_context->n_expected_ports = plugin_manager_get_expected_ports (self,
+                                                                          device,
+                                                                          device_context->layout_key);
+    if (device_context->n_expected_ports)
+        mm_dbg ("[plugin manager] task %s: expecting %u ports",
+                device_context->name, device_context->n_expected_ports);
+
     return device_context;
 }
 
@@ -1474,6 +1963,22 @@ mm_plugin_manager_peek_plugin (MMPluginManager *self,
     return NULL;
 }
 
+/*****************************************************************************/
+/* Drop cached probing results of a device */
+
+void
+mm_plugin_manager_invalidate_cached_results (MMPluginManager *self,
+                                             MMDevice        *device)
+{
+    GList *l;
+
+    if (!self->priv->probe_cache)
+        return;
+
+    for (l = mm_device_peek_port_probe_list (device); l; l = g_list_next (l))
+        mm_port_probe_cache_remove_results (self->priv->probe_cache, MM_PORT_PROBE (l->data));
+}
+
 /*****************************************************************************/
 
 static MMPlugin *
@@ -1635,6 +2140,11 @@ mm_plugin_manager_init (MMPluginManager *manager)
     manager->priv = G_TYPE_INSTANCE_GET_PRIVATE (manager,
                                                  MM_TYPE_PLUGIN_MANAGER,
                                                  MMPluginManagerPrivate);
+
+    manager->priv->shared_probing = mm_context_get_shared_probing ();
+    manager->priv->port_layouts = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    if (mm_context_get_probe_cache ())
+        manager->priv->probe_cache = mm_port_probe_cache_new (mm_context_get_test_probe_cache_file ());
 }
 
 static void
@@ -1695,6 +2205,12 @@ dispose (GObject *object)
     }
     g_clear_object (&self->priv->generic);
 
+    if (self->priv->port_layouts) {
+        g_hash_table_unref (self->priv->port_layouts);
+        self->priv->port_layouts = NULL;
+    }
+    g_clear_object (&self->priv->probe_cache);
+
     g_free (self->priv->plugin_dir);
     self->priv->plugin_dir = NULL;
 
@@ -60,5 +60,7 @@ MMPlugin *       mm_plugin_manager_device_support_check_finish (MMPluginManager
                                                                 GError              **error);
 MMPlugin        *mm_plugin_manager_peek_plugin                 (MMPluginManager      *self,
                                                                 const gchar          *plugin_name);
+void             mm_plugin_manager_invalidate_cached_results   (MMPluginManager      *self,
+                                                                MMDevice             *device);
 
 #endif /* MM_PLUGIN_MANAGER_H */
@@ -16,6 +16,7 @@
  */
 
 #define _GNU_SOURCE  /* for strcasestr */
+#define MM_LOG_MODULE MM_LOG_MODULE_PLUGIN_MANAGER
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -82,6 +83,10 @@ struct _MMPluginPrivate {
     guint64 send_delay;
     gboolean remove_echo;
     gboolean send_lf;
+    gboolean at_qcdm_probe;
+
+    /* Port setup */
+    gboolean concat_commands;
 
     /* Probing setup and/or post-probing filter.
      * Plugins may use this method to decide whether they support a given
@@ -115,6 +120,8 @@ enum {
     PROP_SEND_DELAY,
     PROP_REMOVE_ECHO,
     PROP_SEND_LF,
+    PROP_AT_QCDM_PROBE,
+    PROP_CONCAT_COMMANDS,
     LAST_PROP
 };
 
@@ -580,6 +587,71 @@ apply_post_probing_filters (MMPlugin *self,
     return FALSE;
 }
 
+static MMPortProbeFlag
+build_probe_run_flags (MMPlugin    *self,
+                       GUdevDevice *port,
+                       gboolean     need_vendor_probing,
+                       gboolean     need_product_probing)
+{
+    MMPortProbeFlag probe_run_flags = MM_PORT_PROBE_NONE;
+
+    if (!g_str_has_prefix (g_udev_device_get_name (port), "cdc-wdm")) {
+        /* Serial ports... */
+        if (self->priv->at)
+            probe_run_flags |= MM_PORT_PROBE_AT;
+        else if (self->priv->single_at)
+            probe_run_flags |= MM_PORT_PROBE_AT;
+        if (self->priv->qcdm)
+            probe_run_flags |= MM_PORT_PROBE_QCDM;
+    } else {
+        /* cdc-wdm ports... */
+        if (self->priv->qmi && !g_strcmp0 (mm_device_utils_get_port_driver (port), "qmi_wwan"))
+            probe_run_flags |= MM_PORT_PROBE_QMI;
+        else if (self->priv->mbim && !g_strcmp0 (mm_device_utils_get_port_driver (port), "cdc_mbim"))
+            probe_run_flags |= MM_PORT_PROBE_MBIM;
+        else
+            probe_run_flags |= MM_PORT_PROBE_AT;
+    }
+
+    /* For potential AT ports, check for more things */
+    if (probe_run_flags & MM_PORT_PROBE_AT) {
+        if (need_vendor_probing)
+            probe_run_flags |= MM_PORT_PROBE_AT_VENDOR;
+        if (need_product_probing)
+            probe_run_flags |= MM_PORT_PROBE_AT_PRODUCT;
+        if (self->priv->icera_probe || self->priv->allowed_icera || self->priv->forbidden_icera)
+            probe_run_flags |= MM_PORT_PROBE_AT_ICERA;
+    }
+
+    return probe_run_flags;
+}
+
+/* Whether the AT probing of this plugin differs from the default one */
+static gboolean
+has_custom_at_probing (MMPlugin *self)
+{
+    return (self->priv->custom_at_probe ||
+            self->priv->custom_init ||
+            self->priv->send_delay != MM_PLUGIN_DEFAULT_SEND_DELAY ||
+            !self->priv->remove_echo ||
+            self->priv->send_lf);
+}
+
+#define TAG_AT_QCDM_PROBE "ID_MM_AT_QCDM_PROBE"
+
+gboolean
+mm_plugin_get_at_qcdm_probe (MMPlugin    *self,
+                             GUdevDevice *port)
+{
+    g_return_val_if_fail (MM_IS_PLUGIN (self), FALSE);
+
+    /* Whether AT and QCDM may be probed at once is given by the plugin, but
+     * udev rules may also enable or disable it per port */
+    if (g_udev_device_has_property (port, TAG_AT_QCDM_PROBE))
+        return g_udev_device_get_property_as_boolean (port, TAG_AT_QCDM_PROBE);
+    return self->priv->at_qcdm_probe;
+}
+
 /* Context for the asynchronous probing operation */
 typedef struct {
     MMPlugin *self;
@@ -734,34 +806,7 @@ mm_plugin_supports_port (MMPlugin            *self,
     }
 
     /* Build flags depending on what probing needed */
-    probe_run_flags = MM_PORT_PROBE_NONE;
-    if (!g_str_has_prefix (g_udev_device_get_name (port), "cdc-wdm")) {
-        /* Serial ports... */
-        if (self->priv->at)
-            probe_run_flags |= MM_PORT_PROBE_AT;
-        else if (self->priv->single_at)
-            probe_run_flags |= MM_PORT_PROBE_AT;
-        if (self->priv->qcdm)
-            probe_run_flags |= MM_PORT_PROBE_QCDM;
-    } else {
-        /* cdc-wdm ports... */
-        if (self->priv->qmi && !g_strcmp0 (mm_device_utils_get_port_driver (port), "qmi_wwan"))
-            probe_run_flags |= MM_PORT_PROBE_QMI;
-        else if (self->priv->mbim && !g_strcmp0 (mm_device_utils_get_port_driver (port), "cdc_mbim"))
-            probe_run_flags |= MM_PORT_PROBE_MBIM;
-        else
-            probe_run_flags |= MM_PORT_PROBE_AT;
-    }
-
-    /* For potential AT ports, check for more things */
-    if (probe_run_flags & MM_PORT_PROBE_AT) {
-        if (need_vendor_probing)
-            probe_run_flags |= MM_PORT_PROBE_AT_VENDOR;
-        if (need_product_probing)
-            probe_run_flags |= MM_PORT_PROBE_AT_PRODUCT;
-        if (self->priv->icera_probe || self->priv->allowed_icera || self->priv->forbidden_icera)
-            probe_run_flags |= MM_PORT_PROBE_AT_ICERA;
-    }
+    probe_run_flags = build_probe_run_flags (self, port, need_vendor_probing, need_product_probing);
 
     /* If no explicit probing was required, just request to grab it without probing anything.
      * This may happen, e.g. with cdc-wdm ports which do not need QMI/MBIM probing. */
@@ -784,7 +829,7 @@ mm_plugin_supports_port (MMPlugin            *self,
 
         /* Assuming it won't be an AT port. We still run the probe anyway, in
          * case we need to check for other port types (e.g. QCDM) */
-        mm_port_probe_set_result_at (probe, FALSE);
+        mm_port_probe_set_result_at_assumed (probe, FALSE);
     }
 
     /* Setup async call context */
@@ -809,6 +854,7 @@ mm_plugin_supports_port (MMPlugin            *self,
                        self->priv->send_delay,
                        self->priv->remove_echo,
                        self->priv->send_lf,
+                       mm_plugin_get_at_qcdm_probe (self, port),
                        self->priv->custom_at_probe,
                        self->priv->custom_init,
                        cancellable,
@@ -818,6 +864,108 @@ mm_plugin_supports_port (MMPlugin            *self,
 
 /*****************************************************************************/
 
+/* Probing required by the plugin for the port, if any */
+static MMPortProbeFlag
+get_required_probe_flags (MMPlugin    *self,
+                          MMDevice    *device,
+                          GUdevDevice *port)
+{
+    gboolean need_vendor_probing;
+    gboolean need_product_probing;
+
+    /* Ports deferred or filtered before probing don't need anything */
+    if (g_str_equal (g_udev_device_get_subsystem (port), "net") ||
+        apply_pre_probing_filters (self, device, port, &need_vendor_probing, &need_product_probing))
+        return MM_PORT_PROBE_NONE;
+
+    return build_probe_run_flags (self, port, need_vendor_probing, need_product_probing);
+}
+
+MMPortProbeFlag
+mm_plugin_get_shared_probe_flags (MMPlugin    *self,
+                                  MMDevice    *device,
+                                  GUdevDevice *port)
+{
+    MMPortProbeFlag flags;
+
+    g_return_val_if_fail (MM_IS_PLUGIN (self), MM_PORT_PROBE_NONE);
+
+    flags = get_required_probe_flags (self, device, port);
+
+    /* Plugins expecting a single AT port may skip AT probing altogether, so
+     * don't assume they need it */
+    if (self->priv->single_at)
+        flags &= ~(MM_PORT_PROBE_AT | MM_PORT_PROBE_AT_VENDOR | MM_PORT_PROBE_AT_PRODUCT | MM_PORT_PROBE_AT_ICERA);
+
+    return flags;
+}
+
+gboolean
+mm_plugin_get_shared_probe_allowed (MMPlugin    *self,
+                                    MMDevice    *device,
+                                    GUdevDevice *port)
+{
+    g_return_val_if_fail (MM_IS_PLUGIN (self), FALSE);
+
+    /* If the plugin has its own AT probing setup and will be checked for this
+     * port, probing AT with the default setup in advance would modify the
+     * results it gets */
+    return (!has_custom_at_probing (self) ||
+            !(get_required_probe_flags (self, device, port) & MM_PORT_PROBE_AT));
+}
+
+MMPluginSupportsResult
+mm_plugin_supports_port_cached (MMPlugin    *self,
+                                MMDevice    *device,
+                                GUdevDevice *port)
+{
+    MMPortProbe *probe;
+    gboolean need_vendor_probing;
+    gboolean need_product_probing;
+    MMPortProbeFlag flags;
+
+    g_return_val_if_fail (MM_IS_PLUGIN (self), MM_PLUGIN_SUPPORTS_PORT_UNKNOWN);
+
+    /* Same steps as mm_plugin_supports_port(), but giving up as soon as
+     * anything other than applying filters is needed */
+    if (apply_pre_probing_filters (self, device, port, &need_vendor_probing, &need_product_probing))
+        return MM_PLUGIN_SUPPORTS_PORT_UNSUPPORTED;
+
+    if (g_str_equal (g_udev_device_get_subsystem (port), "net"))
+        return MM_PLUGIN_SUPPORTS_PORT_UNKNOWN;
+
+    probe = MM_PORT_PROBE (mm_device_peek_port_probe (device, port));
+    if (!probe)
+        return MM_PLUGIN_SUPPORTS_PORT_UNKNOWN;
+
+    flags = build_probe_run_flags (self, port, need_vendor_probing, need_product_probing);
+    if (flags == MM_PORT_PROBE_NONE ||
+        (mm_port_probe_get_probed_flags (probe) & flags) != flags)
+        return MM_PLUGIN_SUPPORTS_PORT_UNKNOWN;
+
+    mm_dbg ("(%s) [%s] checking support with cached probing results",
+            self->priv->name,
+            g_udev_device_get_name (port));
+
+    if (apply_post_probing_filters (self, flags, probe))
+        return MM_PLUGIN_SUPPORTS_PORT_UNSUPPORTED;
+
+    if (self->priv->single_at &&
+        flags & MM_PORT_PROBE_AT &&
+        mm_port_probe_is_at (probe)) {
+        GList *l;
+
+        for (l = mm_device_peek_port_probe_list (device); l; l = g_list_next (l)) {
+            if (l->data != probe)
+                mm_port_probe_run_cancel_at_probing (MM_PORT_PROBE (l->data));
+        }
+    }
+
+    return MM_PLUGIN_SUPPORTS_PORT_SUPPORTED;
+}
+
+/*****************************************************************************/
+
 MMPluginSupportsHint
 mm_plugin_discard_port_early (MMPlugin *self,
                               MMDevice *device,
@@ -849,6 +997,44 @@ mm_plugin_discard_port_early (MMPlugin *self,
 
 /*****************************************************************************/
 
+#define TAG_CONCAT_COMMANDS "ID_MM_CONCAT_COMMANDS"
+
+static void
+setup_grabbed_port (MMPlugin    *self,
+                    MMBaseModem *modem,
+                    MMPortProbe *probe)
+{
+    GUdevDevice *port;
+    MMPort *grabbed;
+    gboolean concat_commands;
+
+    if (g_strcmp0 (mm_port_probe_get_port_subsys (probe), "tty") != 0)
+        return;
+
+    grabbed = mm_base_modem_get_port (modem,
+                                      mm_port_probe_get_port_subsys (probe),
+                                      mm_port_probe_get_port_name (probe));
+    if (!grabbed || !MM_IS_PORT_SERIAL_AT (grabbed))
+        return;
+
+    /* Whether the AT port supports concatenated commands is given by the
+     * plugin, but udev rules may also enable or disable it per port */
+    port = mm_port_probe_peek_port (probe);
+    if (g_udev_device_has_property (port, TAG_CONCAT_COMMANDS))
+        concat_commands = g_udev_device_get_property_as_boolean (port, TAG_CONCAT_COMMANDS);
+    else
+        concat_commands = self->priv->concat_commands;
+
+    if (concat_commands) {
+        mm_dbg ("(%s/%s): port supports concatenated commands",
+                mm_port_probe_get_port_subsys (probe),
+                mm_port_probe_get_port_name (probe));
+        g_object_set (grabbed,
+                      MM_PORT_SERIAL_AT_CONCAT_COMMANDS, TRUE,
+                      NULL);
+    }
+}
+
 MMBaseModem *
 mm_plugin_create_modem (MMPlugin  *self,
                         MMDevice *device,
@@ -950,7 +1136,9 @@ mm_plugin_create_modem (MMPlugin  *self,
                                                    mm_port_probe_get_port_type (probe),
                                                    MM_PORT_SERIAL_AT_FLAG_NONE,
                                                    &inner_error);
-            if (!grabbed) {
+            if (grabbed)
+                setup_grabbed_port (self, modem, probe);
+            else {
                 mm_warn ("Could not grab port (%s/%s): '%s'",
                          mm_port_probe_get_port_subsys (MM_PORT_PROBE (l->data)),
                          mm_port_probe_get_port_name (MM_PORT_PROBE (l->data)),
@@ -996,7 +1184,7 @@ mm_plugin_init (MMPlugin *self)
                                               MMPluginPrivate);
 
     /* Defaults */
-    self->priv->send_delay = 100000;
+    self->priv->send_delay = MM_PLUGIN_DEFAULT_SEND_DELAY;
     self->priv->remove_echo = TRUE;
     self->priv->send_lf = FALSE;
 }
@@ -1106,6 +1294,14 @@ set_property (GObject *object,
         /* Construct only */
         self->priv->send_lf = g_value_get_boolean (value);
         break;
+    case PROP_AT_QCDM_PROBE:
+        /* Construct only */
+        self->priv->at_qcdm_probe = g_value_get_boolean (value);
+        break;
+    case PROP_CONCAT_COMMANDS:
+        /* Construct only */
+        self->priv->concat_commands = g_value_get_boolean (value);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
         break;
@@ -1193,6 +1389,12 @@ get_property (GObject *object,
     case PROP_SEND_LF:
         g_value_set_boolean (value, self->priv->send_lf);
         break;
+    case PROP_AT_QCDM_PROBE:
+        g_value_set_boolean (value, self->priv->at_qcdm_probe);
+        break;
+    case PROP_CONCAT_COMMANDS:
+        g_value_set_boolean (value, self->priv->concat_commands);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
         break;
@@ -1425,7 +1627,7 @@ mm_plugin_class_init (MMPluginClass *klass)
                               "Send delay",
                               "Send delay for characters in the AT port, "
                               "in microseconds",
-                              0, G_MAXUINT64, 100000,
+                              0, G_MAXUINT64, MM_PLUGIN_DEFAULT_SEND_DELAY,
                               G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY));
 
     g_object_class_install_property
@@ -1443,4 +1645,22 @@ mm_plugin_class_init (MMPluginClass *klass)
                                "Send line-feed at the end of each AT command sent",
                                FALSE,
                                G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY));
+
+    g_object_class_install_property
+        (object_class, PROP_AT_QCDM_PROBE,
+         g_param_spec_boolean (MM_PLUGIN_AT_QCDM_PROBE,
+                               "AT and QCDM probe",
+                               "Whether AT and QCDM probing may be done at once, "
+                               "sending both kinds of requests to the port",
+                               FALSE,
+                               G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY));
+
+    g_object_class_install_property
+        (object_class, PROP_CONCAT_COMMANDS,
+         g_param_spec_boolean (MM_PLUGIN_CONCAT_COMMANDS,
+                               "Concatenate commands",
+                               "Whether the AT ports of the modems created by the plugin "
+                               "support several commands concatenated in one command line",
+                               FALSE,
+                               G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY));
 }
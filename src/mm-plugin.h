@@ -62,6 +62,11 @@
 #define MM_PLUGIN_SEND_DELAY                "send-delay"
 #define MM_PLUGIN_REMOVE_ECHO               "remove-echo"
 #define MM_PLUGIN_SEND_LF                   "send-lf"
+#define MM_PLUGIN_AT_QCDM_PROBE             "at-qcdm-probe"
+#define MM_PLUGIN_CONCAT_COMMANDS           "concat-commands"
+
+/* Default AT command send delay, in us */
+#define MM_PLUGIN_DEFAULT_SEND_DELAY 100000
 
 typedef enum {
     MM_PLUGIN_SUPPORTS_PORT_UNKNOWN = -1,
@@ -130,6 +135,23 @@ MMPluginSupportsResult mm_plugin_supports_port_finish (MMPlugin             *plu
                                                        GAsyncResult         *result,
                                                        GError              **error);
 
+/* Shared probing support: a single probe run covering the needs of several
+ * plugins, whose filters are then applied to the cached probing results. */
+MMPortProbeFlag        mm_plugin_get_shared_probe_flags   (MMPlugin    *plugin,
+                                                           MMDevice    *device,
+                                                           GUdevDevice *port);
+gboolean               mm_plugin_get_shared_probe_allowed (MMPlugin    *plugin,
+                                                           MMDevice    *device,
+                                                           GUdevDevice *port);
+/* Whether AT and QCDM may be probed at once in the port */
+gboolean               mm_plugin_get_at_qcdm_probe        (MMPlugin    *plugin,
+                                                           GUdevDevice *port);
+/* Returns MM_PLUGIN_SUPPORTS_PORT_UNKNOWN if the support check cannot be
+ * decided without running mm_plugin_supports_port() */
+MMPluginSupportsResult mm_plugin_supports_port_cached     (MMPlugin    *plugin,
+                                                           MMDevice    *device,
+                                                           GUdevDevice *port);
+
 MMBaseModem *mm_plugin_create_modem (MMPlugin *plugin,
                                      MMDevice *device,
                                      GError **error);
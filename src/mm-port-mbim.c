@@ -13,6 +13,8 @@
  * Copyright (C) 2013 Aleksander Morgado <aleksander@gnu.org>
  */
 
+#define MM_LOG_MODULE MM_LOG_MODULE_MBIM
+
 #include <stdio.h>
 #include <stdlib.h>
 
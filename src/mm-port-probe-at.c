@@ -17,6 +17,7 @@
  */
 
 #define _GNU_SOURCE  /* for strcasestr */
+#define MM_LOG_MODULE MM_LOG_MODULE_PLUGIN_MANAGER
 #include <string.h>
 
 #include <glib.h>
@@ -53,8 +53,8 @@ typedef gboolean (* MMPortProbeAtResponseProcessor) (const gchar *command,
 typedef struct {
     /* The AT command */
     gchar *command;
-    /* Timeout of the command, in seconds */
-    guint timeout;
+    /* Timeout of the command, in milliseconds */
+    guint timeout_ms;
     /* The response processor */
     MMPortProbeAtResponseProcessor response_processor;
 } MMPortProbeAtCommand;
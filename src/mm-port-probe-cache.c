@@ -0,0 +1,372 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#define MM_LOG_MODULE MM_LOG_MODULE_PLUGIN_MANAGER
+
+#include <string.h>
+#include <errno.h>
+
+#include "mm-port-probe-cache.h"
+#include "mm-device.h"
+#include "mm-log.h"
+#include "mm-daemon-enums-types.h"
+
+/*
+ * The probe cache is a key file with one group per port, named after the
+ * identity of the device and the USB interface exposing the port:
+ *
+ *   [1199:68a2:SERIAL tty/qcserial/03]
+ *   Flags=15
+ *   At=true
+ *   Vendor=sierra wireless, incorporated
+ *   ...
+ *
+ * 'Flags' holds the MMPortProbeFlag mask of the results available, and only
+ * the results in that mask are given. An additional group keeps the number
+ * of ports found in each device port layout.
+ */
+
+#define GROUP_PORT_LAYOUTS "port layouts"
+
+#define KEY_FLAGS   "Flags"
+#define KEY_AT      "At"
+#define KEY_VENDOR  "Vendor"
+#define KEY_PRODUCT "Product"
+#define KEY_ICERA   "Icera"
+#define KEY_QCDM    "Qcdm"
+#define KEY_QMI     "Qmi"
+#define KEY_MBIM    "Mbim"
+
+/* Changes are written to disk in batches, once this time has elapsed since
+ * the first pending one */
+#define SAVE_TIMEOUT_SECS 5
+
+G_DEFINE_TYPE (MMPortProbeCache, mm_port_probe_cache, G_TYPE_OBJECT)
+
+struct _MMPortProbeCachePrivate {
+    gchar    *path;
+    GKeyFile *key_file;
+    guint     save_id;
+};
+
+/*****************************************************************************/
+
+static void
+schedule_save (MMPortProbeCache *self);
+
+/* Device identity is given by the USB vendor/product IDs and serial number
+ * instead of mm_create_device_identifier(), as that one requires the results
+ * of probing. Ports out of a USB interface can't be told apart reliably across
+ * reboots, so they are never cached. */
+static gchar *
+build_port_group (MMPortProbe *probe)
+{
+    MMDevice    *device;
+    GUdevDevice *port;
+    const gchar *interface_number;
+    const gchar *driver;
+    gchar       *serial;
+    gchar       *group;
+
+    device = mm_port_probe_peek_device (probe);
+    if (mm_device_is_virtual (device))
+        return NULL;
+
+    port = mm_port_probe_peek_port (probe);
+    interface_number = g_udev_device_get_property (port, "ID_USB_INTERFACE_NUM");
+    driver = g_udev_device_get_property (port, "ID_USB_DRIVER");
+    if (!interface_number || !driver)
+        return NULL;
+
+    /* Key file group names can't have brackets or control chars */
+    serial = g_strdup (g_udev_device_get_sysfs_attr (mm_device_peek_udev_device (device), "serial"));
+    if (serial)
+        g_strcanon (serial, G_CSET_A_2_Z G_CSET_a_2_z G_CSET_DIGITS "-_.", '_');
+
+    group = g_strdup_printf ("%04x:%04x:%s %s/%s/%s",
+                             mm_device_get_vendor (device),
+                             mm_device_get_product (device),
+                             serial ? serial : "",
+                             mm_port_probe_get_port_subsys (probe),
+                             driver,
+                             interface_number);
+    g_free (serial);
+    return group;
+}
+
+gboolean
+mm_port_probe_cache_load_results (MMPortProbeCache *self,
+                                  MMPortProbe      *probe)
+{
+    MMPortProbeFlag  flags;
+    gchar           *group;
+    gchar           *str;
+    gchar           *flags_str;
+
+    g_return_val_if_fail (MM_IS_PORT_PROBE_CACHE (self), FALSE);
+
+    group = build_port_group (probe);
+    if (!group)
+        return FALSE;
+
+    flags = (MMPortProbeFlag) g_key_file_get_integer (self->priv->key_file, group, KEY_FLAGS, NULL);
+    if (flags == MM_PORT_PROBE_NONE) {
+        g_free (group);
+        return FALSE;
+    }
+
+    flags_str = mm_port_probe_flag_build_string_from_mask (flags);
+    mm_dbg ("(%s/%s) loading cached probing results: '%s'",
+            mm_port_probe_get_port_subsys (probe),
+            mm_port_probe_get_port_name (probe),
+            flags_str);
+    g_free (flags_str);
+
+    /* The setters also mark as probed the results implied by the given ones,
+     * which are always consistent with the ones stored */
+    if (flags & MM_PORT_PROBE_AT)
+        mm_port_probe_set_result_at (probe, g_key_file_get_boolean (self->priv->key_file, group, KEY_AT, NULL));
+    if (flags & MM_PORT_PROBE_AT_VENDOR) {
+        str = g_key_file_get_string (self->priv->key_file, group, KEY_VENDOR, NULL);
+        mm_port_probe_set_result_at_vendor (probe, str);
+        g_free (str);
+    }
+    if (flags & MM_PORT_PROBE_AT_PRODUCT) {
+        str = g_key_file_get_string (self->priv->key_file, group, KEY_PRODUCT, NULL);
+        mm_port_probe_set_result_at_product (probe, str);
+        g_free (str);
+    }
+    if (flags & MM_PORT_PROBE_AT_ICERA)
+        mm_port_probe_set_result_at_icera (probe, g_key_file_get_boolean (self->priv->key_file, group, KEY_ICERA, NULL));
+    if (flags & MM_PORT_PROBE_QCDM)
+        mm_port_probe_set_result_qcdm (probe, g_key_file_get_boolean (self->priv->key_file, group, KEY_QCDM, NULL));
+    if (flags & MM_PORT_PROBE_QMI)
+        mm_port_probe_set_result_qmi (probe, g_key_file_get_boolean (self->priv->key_file, group, KEY_QMI, NULL));
+    if (flags & MM_PORT_PROBE_MBIM)
+        mm_port_probe_set_result_mbim (probe, g_key_file_get_boolean (self->priv->key_file, group, KEY_MBIM, NULL));
+
+    g_free (group);
+    return TRUE;
+}
+
+void
+mm_port_probe_cache_save_results (MMPortProbeCache *self,
+                                  MMPortProbe      *probe)
+{
+    MMPortProbeFlag  flags;
+    gchar           *group;
+
+    g_return_if_fail (MM_IS_PORT_PROBE_CACHE (self));
+
+    flags = mm_port_probe_get_probed_flags (probe);
+
+    /* AT results assumed without probing are not real ones */
+    if (mm_port_probe_get_result_at_assumed (probe))
+        flags &= ~(MM_PORT_PROBE_AT | MM_PORT_PROBE_AT_VENDOR | MM_PORT_PROBE_AT_PRODUCT | MM_PORT_PROBE_AT_ICERA);
+
+    /* Results given by cancelled AT probing are not real ones either */
+    if (mm_port_probe_get_at_probing_cancelled (probe)) {
+        flags &= ~(MM_PORT_PROBE_AT_VENDOR | MM_PORT_PROBE_AT_PRODUCT | MM_PORT_PROBE_AT_ICERA);
+        if (!mm_port_probe_is_at (probe))
+            flags &= ~MM_PORT_PROBE_AT;
+    }
+
+    if (flags == MM_PORT_PROBE_NONE)
+        return;
+
+    group = build_port_group (probe);
+    if (!group)
+        return;
+
+    /* Nothing new to store? */
+    if ((MMPortProbeFlag) g_key_file_get_integer (self->priv->key_file, group, KEY_FLAGS, NULL) == flags) {
+        g_free (group);
+        return;
+    }
+
+    /* Rewrite the whole group, so that no stale result is kept */
+    g_key_file_remove_group (self->priv->key_file, group, NULL);
+    g_key_file_set_integer (self->priv->key_file, group, KEY_FLAGS, (gint) flags);
+    if (flags & MM_PORT_PROBE_AT)
+        g_key_file_set_boolean (self->priv->key_file, group, KEY_AT, mm_port_probe_is_at (probe));
+    if ((flags & MM_PORT_PROBE_AT_VENDOR) && mm_port_probe_get_vendor (probe))
+        g_key_file_set_string (self->priv->key_file, group, KEY_VENDOR, mm_port_probe_get_vendor (probe));
+    if ((flags & MM_PORT_PROBE_AT_PRODUCT) && mm_port_probe_get_product (probe))
+        g_key_file_set_string (self->priv->key_file, group, KEY_PRODUCT, mm_port_probe_get_product (probe));
+    if (flags & MM_PORT_PROBE_AT_ICERA)
+        g_key_file_set_boolean (self->priv->key_file, group, KEY_ICERA, mm_port_probe_is_icera (probe));
+    if (flags & MM_PORT_PROBE_QCDM)
+        g_key_file_set_boolean (self->priv->key_file, group, KEY_QCDM, mm_port_probe_is_qcdm (probe));
+    if (flags & MM_PORT_PROBE_QMI)
+        g_key_file_set_boolean (self->priv->key_file, group, KEY_QMI, mm_port_probe_is_qmi (probe));
+    if (flags & MM_PORT_PROBE_MBIM)
+        g_key_file_set_boolean (self->priv->key_file, group, KEY_MBIM, mm_port_probe_is_mbim (probe));
+
+    g_free (group);
+    schedule_save (self);
+}
+
+void
+mm_port_probe_cache_remove_results (MMPortProbeCache *self,
+                                    MMPortProbe      *probe)
+{
+    gchar *group;
+
+    g_return_if_fail (MM_IS_PORT_PROBE_CACHE (self));
+
+    group = build_port_group (probe);
+    if (!group)
+        return;
+
+    if (g_key_file_remove_group (self->priv->key_file, group, NULL)) {
+        mm_dbg ("(%s/%s) cached probing results removed",
+                mm_port_probe_get_port_subsys (probe),
+                mm_port_probe_get_port_name (probe));
+        schedule_save (self);
+    }
+    g_free (group);
+}
+
+/*****************************************************************************/
+
+guint
+mm_port_probe_cache_get_n_ports (MMPortProbeCache *self,
+                                 const gchar      *layout_key)
+{
+    gint n_ports;
+
+    g_return_val_if_fail (MM_IS_PORT_PROBE_CACHE (self), 0);
+
+    n_ports = g_key_file_get_integer (self->priv->key_file, GROUP_PORT_LAYOUTS, layout_key, NULL);
+    return (n_ports > 0 ? (guint) n_ports : 0);
+}
+
+void
+mm_port_probe_cache_learn_n_ports (MMPortProbeCache *self,
+                                   const gchar      *layout_key,
+                                   guint             n_ports)
+{
+    g_return_if_fail (MM_IS_PORT_PROBE_CACHE (self));
+
+    /* Never lowered, a port may just have been missing */
+    if (mm_port_probe_cache_get_n_ports (self, layout_key) >= n_ports)
+        return;
+
+    g_key_file_set_integer (self->priv->key_file, GROUP_PORT_LAYOUTS, layout_key, (gint) n_ports);
+    schedule_save (self);
+}
+
+/*****************************************************************************/
+
+void
+mm_port_probe_cache_flush (MMPortProbeCache *self)
+{
+    GError *error = NULL;
+    gchar  *data;
+    gchar  *dir;
+    gsize   len;
+
+    g_return_if_fail (MM_IS_PORT_PROBE_CACHE (self));
+
+    if (!self->priv->save_id)
+        return;
+
+    g_source_remove (self->priv->save_id);
+    self->priv->save_id = 0;
+
+    dir = g_path_get_dirname (self->priv->path);
+    if (g_mkdir_with_parents (dir, 0755) < 0)
+        mm_warn ("Couldn't create probe cache directory '%s': %s", dir, g_strerror (errno));
+    g_free (dir);
+
+    data = g_key_file_to_data (self->priv->key_file, &len, NULL);
+    if (!g_file_set_contents (self->priv->path, data, len, &error)) {
+        mm_warn ("Couldn't write probe cache: %s", error->message);
+        g_error_free (error);
+    } else
+        mm_dbg ("Probe cache written to '%s'", self->priv->path);
+    g_free (data);
+}
+
+static gboolean
+save_timeout_cb (MMPortProbeCache *self)
+{
+    mm_port_probe_cache_flush (self);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+schedule_save (MMPortProbeCache *self)
+{
+    if (!self->priv->save_id)
+        self->priv->save_id = g_timeout_add_seconds (SAVE_TIMEOUT_SECS, (GSourceFunc) save_timeout_cb, self);
+}
+
+/*****************************************************************************/
+
+MMPortProbeCache *
+mm_port_probe_cache_new (const gchar *path)
+{
+    MMPortProbeCache *self;
+    GError           *error = NULL;
+
+    g_return_val_if_fail (path != NULL, NULL);
+
+    self = g_object_new (MM_TYPE_PORT_PROBE_CACHE, NULL);
+    self->priv->path = g_strdup (path);
+
+    /* A missing or broken cache is just an empty one */
+    if (!g_key_file_load_from_file (self->priv->key_file, path, G_KEY_FILE_NONE, &error)) {
+        if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+            mm_warn ("Couldn't load probe cache '%s': %s", path, error->message);
+        g_error_free (error);
+    } else
+        mm_dbg ("Probe cache loaded from '%s'", path);
+
+    return self;
+}
+
+static void
+mm_port_probe_cache_init (MMPortProbeCache *self)
+{
+    /* Initialize opaque pointer to private data */
+    self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
+                                              MM_TYPE_PORT_PROBE_CACHE,
+                                              MMPortProbeCachePrivate);
+    self->priv->key_file = g_key_file_new ();
+}
+
+static void
+finalize (GObject *object)
+{
+    MMPortProbeCache *self = MM_PORT_PROBE_CACHE (object);
+
+    /* Write any pending change before going away */
+    mm_port_probe_cache_flush (self);
+
+    g_key_file_free (self->priv->key_file);
+    g_free (self->priv->path);
+
+    G_OBJECT_CLASS (mm_port_probe_cache_parent_class)->finalize (object);
+}
+
+static void
+mm_port_probe_cache_class_init (MMPortProbeCacheClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+    g_type_class_add_private (object_class, sizeof (MMPortProbeCachePrivate));
+
+    /* Virtual methods */
+    object_class->finalize = finalize;
+}
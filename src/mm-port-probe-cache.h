@@ -0,0 +1,63 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#ifndef MM_PORT_PROBE_CACHE_H
+#define MM_PORT_PROBE_CACHE_H
+
+#include <glib-object.h>
+
+#include "mm-port-probe.h"
+
+#define MM_TYPE_PORT_PROBE_CACHE            (mm_port_probe_cache_get_type ())
+#define MM_PORT_PROBE_CACHE(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), MM_TYPE_PORT_PROBE_CACHE, MMPortProbeCache))
+#define MM_PORT_PROBE_CACHE_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass),  MM_TYPE_PORT_PROBE_CACHE, MMPortProbeCacheClass))
+#define MM_IS_PORT_PROBE_CACHE(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), MM_TYPE_PORT_PROBE_CACHE))
+#define MM_IS_PORT_PROBE_CACHE_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass),  MM_TYPE_PORT_PROBE_CACHE))
+#define MM_PORT_PROBE_CACHE_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj),  MM_TYPE_PORT_PROBE_CACHE, MMPortProbeCacheClass))
+
+typedef struct _MMPortProbeCache MMPortProbeCache;
+typedef struct _MMPortProbeCacheClass MMPortProbeCacheClass;
+typedef struct _MMPortProbeCachePrivate MMPortProbeCachePrivate;
+
+struct _MMPortProbeCache {
+    GObject parent;
+    MMPortProbeCachePrivate *priv;
+};
+
+struct _MMPortProbeCacheClass {
+    GObjectClass parent;
+};
+
+GType             mm_port_probe_cache_get_type (void);
+MMPortProbeCache *mm_port_probe_cache_new      (const gchar *path);
+
+/* Probing results of a single port */
+gboolean mm_port_probe_cache_load_results   (MMPortProbeCache *self,
+                                             MMPortProbe      *probe);
+void     mm_port_probe_cache_save_results   (MMPortProbeCache *self,
+                                             MMPortProbe      *probe);
+void     mm_port_probe_cache_remove_results (MMPortProbeCache *self,
+                                             MMPortProbe      *probe);
+
+/* Number of ports found in devices with a given port layout; only the
+ * biggest number ever found is kept */
+guint    mm_port_probe_cache_get_n_ports    (MMPortProbeCache *self,
+                                             const gchar      *layout_key);
+void     mm_port_probe_cache_learn_n_ports  (MMPortProbeCache *self,
+                                             const gchar      *layout_key,
+                                             guint             n_ports);
+
+/* Write pending changes to disk right away */
+void     mm_port_probe_cache_flush          (MMPortProbeCache *self);
+
+#endif /* MM_PORT_PROBE_CACHE_H */
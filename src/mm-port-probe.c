@@ -15,6 +15,8 @@
  * Copyright (C) 2011 Aleksander Morgado <aleksander@gnu.org>
  */
 
+#define MM_LOG_MODULE MM_LOG_MODULE_PLUGIN_MANAGER
+
 #include "config.h"
 
 #include <stdio.h>
@@ -31,6 +33,7 @@
 #include "mm-serial-parsers.h"
 #include "mm-port-probe-at.h"
 #include "libqcdm/src/commands.h"
+#include "libqcdm/src/dm-commands.h"
 #include "libqcdm/src/utils.h"
 #include "libqcdm/src/errors.h"
 #include "mm-port-serial-qcdm.h"
@@ -48,6 +51,7 @@
  * Steps and flow of the Probing process:
  * ----> AT Serial Open
  *   |----> Custom Init
+ *   |----> AT or QCDM? (single pipelined check, if both requested and allowed)
  *   |----> AT?
  *      |----> Vendor
  *      |----> Product
@@ -86,6 +90,10 @@ struct _MMPortProbePrivate {
     gboolean is_icera;
     gboolean is_qmi;
     gboolean is_mbim;
+    /* AT probing was cut short, so the AT results are just assumed */
+    gboolean at_probing_cancelled;
+    /* The AT result was given without probing, e.g. by the plugin */
+    gboolean at_assumed;
 
     /* From udev tags */
     gboolean is_ignored;
@@ -101,6 +109,7 @@ mm_port_probe_set_result_at (MMPortProbe *self,
                              gboolean at)
 {
     self->priv->is_at = at;
+    self->priv->at_assumed = FALSE;
     self->priv->flags |= MM_PORT_PROBE_AT;
 
     if (self->priv->is_at) {
@@ -126,6 +135,22 @@ mm_port_probe_set_result_at (MMPortProbe *self,
     }
 }
 
+void
+mm_port_probe_set_result_at_assumed (MMPortProbe *self,
+                                     gboolean at)
+{
+    mm_port_probe_set_result_at (self, at);
+    self->priv->at_assumed = TRUE;
+}
+
+gboolean
+mm_port_probe_get_result_at_assumed (MMPortProbe *self)
+{
+    g_return_val_if_fail (MM_IS_PORT_PROBE (self), FALSE);
+
+    return self->priv->at_assumed;
+}
+
 void
 mm_port_probe_set_result_at_vendor (MMPortProbe *self,
                                     const gchar *at_vendor)
@@ -277,6 +302,16 @@ mm_port_probe_set_result_mbim (MMPortProbe *self,
 
 /*****************************************************************************/
 
+/* Response parser used in the AT port while probing */
+typedef struct {
+    /* The standard AT response parser */
+    gpointer parser;
+    /* Whether QCDM replies are expected as well */
+    gboolean detect_qcdm;
+    /* A QCDM reply was received */
+    gboolean qcdm_detected;
+} ProbeResponseParser;
+
 typedef struct {
     /* ---- Generic task context ---- */
     guint32 flags;
@@ -287,6 +322,8 @@ typedef struct {
 
     guint buffer_full_id;
     MMPortSerial *serial;
+    /* Owned by the AT serial port */
+    ProbeResponseParser *response_parser;
 
     /* ---- AT probing specific context ---- */
 
@@ -313,6 +350,13 @@ typedef struct {
     /* Current AT Result processor */
     void (* at_result_processor) (MMPortProbe *self,
                                   GVariant *result);
+    /* Whether AT and QCDM may be checked at once */
+    gboolean at_qcdm_check;
+    /* The pipelined AT and QCDM check was already run */
+    gboolean at_qcdm_check_run;
+    /* The pipelined AT and QCDM check got no reply, so it counts as
+     * the first AT probing attempt */
+    gboolean at_qcdm_check_timed_out;
 
 #if defined WITH_QMI
     /* ---- QMI probing specific context ---- */
@@ -695,7 +739,7 @@ serial_probe_qcdm_parse_response (MMPortSerialQcdm *port,
             /* second try */
             mm_port_serial_qcdm_command (MM_PORT_SERIAL_QCDM (ctx->serial),
                                          cmd2,
-                                         3,
+                                         3000,
                                          NULL,
                                          (GAsyncReadyCallback) serial_probe_qcdm_parse_response,
                                          self);
@@ -711,14 +755,35 @@ serial_probe_qcdm_parse_response (MMPortSerialQcdm *port,
     serial_probe_schedule (self);
 }
 
+/* Build up the probe command; 0x7E is the frame marker, so put one at the
+ * beginning of the buffer to ensure that the device discards any AT
+ * commands that probing might have sent earlier.  Should help devices
+ * respond more quickly and speed up QCDM probing.
+ */
+static GByteArray *
+build_qcdm_probe_command (void)
+{
+    GByteArray *verinfo;
+    gint        len;
+    guint8      marker = 0x7E;
+
+    verinfo = g_byte_array_sized_new (10);
+    g_byte_array_append (verinfo, &marker, 1);
+    len = qcdm_cmd_version_info_new ((char *) (verinfo->data + 1), 9);
+    if (len <= 0) {
+        g_byte_array_unref (verinfo);
+        return NULL;
+    }
+    verinfo->len = len + 1;
+    return verinfo;
+}
+
 static gboolean
 serial_probe_qcdm (MMPortProbe *self)
 {
     GError              *error = NULL;
     GByteArray          *verinfo = NULL;
     GByteArray          *verinfo2;
-    gint                 len;
-    guint8               marker = 0x7E;
     PortProbeRunContext *ctx;
 
     g_assert (self->priv->task);
@@ -742,6 +807,7 @@ serial_probe_qcdm (MMPortProbe *self)
         }
         mm_port_serial_close (ctx->serial);
         g_object_unref (ctx->serial);
+        ctx->response_parser = NULL;
     }
 
     /* Open the QCDM port */
@@ -769,16 +835,8 @@ serial_probe_qcdm (MMPortProbe *self)
         return G_SOURCE_REMOVE;
     }
 
-    /* Build up the probe command; 0x7E is the frame marker, so put one at the
-     * beginning of the buffer to ensure that the device discards any AT
-     * commands that probing might have sent earlier.  Should help devices
-     * respond more quickly and speed up QCDM probing.
-     */
-    verinfo = g_byte_array_sized_new (10);
-    g_byte_array_append (verinfo, &marker, 1);
-    len = qcdm_cmd_version_info_new ((char *) (verinfo->data + 1), 9);
-    if (len <= 0) {
-        g_byte_array_unref (verinfo);
+    verinfo = build_qcdm_probe_command ();
+    if (!verinfo) {
         task_return_in_idle (self,
                              g_error_new (MM_SERIAL_ERROR,
                                           MM_SERIAL_ERROR_OPEN_FAILED,
@@ -787,7 +845,6 @@ serial_probe_qcdm (MMPortProbe *self)
                                           g_udev_device_get_name (self->priv->port)));
         return G_SOURCE_REMOVE;
     }
-    verinfo->len = len + 1;
 
     /* Queuing the command takes ownership over it; save it for the second try */
     verinfo2 = g_byte_array_sized_new (verinfo->len);
@@ -796,7 +853,7 @@ serial_probe_qcdm (MMPortProbe *self)
 
     mm_port_serial_qcdm_command (MM_PORT_SERIAL_QCDM (ctx->serial),
                                  verinfo,
-                                 3,
+                                 3000,
                                  NULL,
                                  (GAsyncReadyCallback) serial_probe_qcdm_parse_response,
                                  self);
@@ -1034,7 +1091,7 @@ serial_probe_at (MMPortProbe *self)
     mm_port_serial_at_command (
         MM_PORT_SERIAL_AT (ctx->serial),
         ctx->at_commands->command,
-        ctx->at_commands->timeout,
+        ctx->at_commands->timeout_ms,
         FALSE,
         FALSE,
         ctx->at_probing_cancellable,
@@ -1044,30 +1101,30 @@ serial_probe_at (MMPortProbe *self)
 }
 
 static const MMPortProbeAtCommand at_probing[] = {
-    { "AT",  3, mm_port_probe_response_processor_is_at },
-    { "AT",  3, mm_port_probe_response_processor_is_at },
-    { "AT",  3, mm_port_probe_response_processor_is_at },
+    { "AT",  3000, mm_port_probe_response_processor_is_at },
+    { "AT",  3000, mm_port_probe_response_processor_is_at },
+    { "AT",  3000, mm_port_probe_response_processor_is_at },
     { NULL }
 };
 
 static const MMPortProbeAtCommand vendor_probing[] = {
-    { "+CGMI", 3, mm_port_probe_response_processor_string },
-    { "+GMI",  3, mm_port_probe_response_processor_string },
-    { "I",     3, mm_port_probe_response_processor_string },
+    { "+CGMI", 3000, mm_port_probe_response_processor_string },
+    { "+GMI",  3000, mm_port_probe_response_processor_string },
+    { "I",     3000, mm_port_probe_response_processor_string },
     { NULL }
 };
 
 static const MMPortProbeAtCommand product_probing[] = {
-    { "+CGMM", 3, mm_port_probe_response_processor_string },
-    { "+GMM",  3, mm_port_probe_response_processor_string },
-    { "I",     3, mm_port_probe_response_processor_string },
+    { "+CGMM", 3000, mm_port_probe_response_processor_string },
+    { "+GMM",  3000, mm_port_probe_response_processor_string },
+    { "I",     3000, mm_port_probe_response_processor_string },
     { NULL }
 };
 
 static const MMPortProbeAtCommand icera_probing[] = {
-    { "%IPSYS?", 3, mm_port_probe_response_processor_string },
-    { "%IPSYS?", 3, mm_port_probe_response_processor_string },
-    { "%IPSYS?", 3, mm_port_probe_response_processor_string },
+    { "%IPSYS?", 3000, mm_port_probe_response_processor_string },
+    { "%IPSYS?", 3000, mm_port_probe_response_processor_string },
+    { "%IPSYS?", 3000, mm_port_probe_response_processor_string },
     { NULL }
 };
 
@@ -1092,6 +1149,155 @@ at_custom_init_ready (MMPortProbe *self,
     serial_probe_schedule (self);
 }
 
+/***************************************************************/
+/* AT or QCDM?
+ *
+ * When both AT and QCDM probing are requested, a QCDM version info request
+ * and an AT command are sent together in the AT port, so that whichever kind
+ * of port it is, it replies right away: AT ports skip any garbage before the
+ * "AT" prefix, and QCDM ports discard everything up to the frame marker that
+ * starts the QCDM request. This avoids going through all the AT probing
+ * timeouts before even trying QCDM in QCDM ports.
+ *
+ * Not every device copes with getting both kinds of data in the same port,
+ * so this is only done when the caller allows it.
+ */
+
+static gboolean
+is_qcdm_version_info_response (const guint8 *data,
+                               gsize         len)
+{
+    gchar          buf[1024];
+    gsize          used = 0;
+    gsize          frame_len = 0;
+    DmFrameDecoder decoder;
+    DmFrameStatus  status;
+    QcdmResult    *result;
+
+    dm_frame_decoder_init (&decoder, buf, sizeof (buf));
+    while (len > 0) {
+        status = dm_frame_decoder_feed (&decoder, (const char *) data, len, &used, &frame_len);
+        if (status == DM_FRAME_NEED_MORE)
+            break;
+        data += used;
+        len -= used;
+
+        /* Note that the echo of our own request is also a valid frame */
+        if (status == DM_FRAME_READY && frame_len > 1 && buf[0] == DIAG_CMD_VERSION_INFO) {
+            result = qcdm_cmd_version_info_result (buf, frame_len, NULL);
+            if (result) {
+                qcdm_result_unref (result);
+                return TRUE;
+            }
+        }
+    }
+
+    return FALSE;
+}
+
+static void
+serial_probe_at_qcdm_ready (MMPortSerial *port,
+                            GAsyncResult *res,
+                            MMPortProbe  *self)
+{
+    GByteArray          *response;
+    GError              *error = NULL;
+    GError              *result_error = NULL;
+    GVariant            *result = NULL;
+    gchar               *response_str = NULL;
+    PortProbeRunContext *ctx;
+
+    g_assert (self->priv->task);
+    ctx = g_task_get_task_data (self->priv->task);
+
+    response = mm_port_serial_command_finish (port, res, &error);
+    ctx->response_parser->detect_qcdm = FALSE;
+
+    /* If already cancelled, do nothing else */
+    if (task_return_error_in_idle_if_cancelled (self))
+        goto out;
+
+    /* QCDM reply? */
+    if (ctx->response_parser->qcdm_detected) {
+        mm_port_probe_set_result_qcdm (self, TRUE);
+        serial_probe_schedule (self);
+        goto out;
+    }
+
+    /* If AT probing cancelled, let the standard AT probing handle it */
+    if (g_cancellable_is_cancelled (ctx->at_probing_cancellable)) {
+        serial_probe_schedule (self);
+        goto out;
+    }
+
+    /* Otherwise, process the reply as the first AT probing attempt */
+    if (response)
+        response_str = g_strndup ((const gchar *) response->data, response->len);
+    if (mm_port_probe_response_processor_is_at ("AT", response_str, FALSE, error, &result, &result_error))
+        serial_probe_at_result_processor (self, result);
+    else if (result_error) {
+        task_return_in_idle (self,
+                             g_error_new (MM_CORE_ERROR,
+                                          MM_CORE_ERROR_UNSUPPORTED,
+                                          "(%s/%s) error while probing AT features: %s",
+                                          g_udev_device_get_subsystem (self->priv->port),
+                                          g_udev_device_get_name (self->priv->port),
+                                          result_error->message));
+        goto out;
+    } else
+        ctx->at_qcdm_check_timed_out = TRUE;
+
+    serial_probe_schedule (self);
+
+out:
+    if (response)
+        g_byte_array_unref (response);
+    g_clear_pointer (&result, g_variant_unref);
+    g_clear_error (&error);
+    g_clear_error (&result_error);
+    g_free (response_str);
+}
+
+static gboolean
+serial_probe_at_qcdm (MMPortProbe *self)
+{
+    static const guint8  at_command[] = { 'A', 'T', '\r' };
+    GByteArray          *command;
+    PortProbeRunContext *ctx;
+
+    g_assert (self->priv->task);
+    ctx = g_task_get_task_data (self->priv->task);
+    ctx->source_id = 0;
+    ctx->at_qcdm_check_run = TRUE;
+
+    /* If already cancelled, do nothing else */
+    if (task_return_error_in_idle_if_cancelled (self))
+        return G_SOURCE_REMOVE;
+
+    command = build_qcdm_probe_command ();
+    if (!command) {
+        /* Just go on with standard probing */
+        serial_probe_schedule (self);
+        return G_SOURCE_REMOVE;
+    }
+    g_byte_array_append (command, at_command, sizeof (at_command));
+
+    mm_dbg ("(%s/%s) probing AT and QCDM...",
+            g_udev_device_get_subsystem (self->priv->port),
+            g_udev_device_get_name (self->priv->port));
+
+    ctx->response_parser->detect_qcdm = TRUE;
+    mm_port_serial_command (ctx->serial,
+                            command,
+                            3000,
+                            FALSE,
+                            ctx->at_probing_cancellable,
+                            (GAsyncReadyCallback) serial_probe_at_qcdm_ready,
+                            self);
+    g_byte_array_unref (command);
+    return G_SOURCE_REMOVE;
+}
+
 /***************************************************************/
 
 static void
@@ -1124,12 +1330,30 @@ serial_probe_schedule (MMPortProbe *self)
     ctx->at_commands           = NULL;
     ctx->at_commands_wait_secs = 0;
 
+    /* AT and QCDM checks requested and not already probed? If allowed, and
+     * no custom AT probing setup given, check both at once */
+    if (ctx->at_qcdm_check &&
+        !ctx->at_qcdm_check_run &&
+        !ctx->at_custom_probe &&
+        !ctx->at_custom_init &&
+        ctx->response_parser &&
+        (ctx->flags & MM_PORT_PROBE_AT) &&
+        (ctx->flags & MM_PORT_PROBE_QCDM) &&
+        !(self->priv->flags & (MM_PORT_PROBE_AT | MM_PORT_PROBE_QCDM)) &&
+        g_str_equal (g_udev_device_get_subsystem (self->priv->port), "tty")) {
+        ctx->source_id = g_idle_add ((GSourceFunc) serial_probe_at_qcdm, self);
+        return;
+    }
+
     /* AT check requested and not already probed? */
     if ((ctx->flags & MM_PORT_PROBE_AT) &&
         !(self->priv->flags & MM_PORT_PROBE_AT)) {
-        /* Prepare AT probing */
+        /* Prepare AT probing; if the AT and QCDM check got no reply, it
+         * already was the first attempt */
         if (ctx->at_custom_probe)
             ctx->at_commands = ctx->at_custom_probe;
+        else if (ctx->at_qcdm_check_timed_out)
+            ctx->at_commands = &at_probing[1];
         else
             ctx->at_commands = at_probing;
         ctx->at_result_processor = serial_probe_at_result_processor;
@@ -1226,6 +1450,40 @@ serial_parser_filter_cb (gpointer   filter,
     return TRUE;
 }
 
+static gboolean
+serial_probe_response_parse (ProbeResponseParser  *parser,
+                             GString              *response,
+                             GError              **error)
+{
+    if (parser->detect_qcdm) {
+        if (is_qcdm_version_info_response ((const guint8 *) response->str, response->len)) {
+            parser->qcdm_detected = TRUE;
+            g_set_error (error,
+                         MM_SERIAL_ERROR,
+                         MM_SERIAL_ERROR_PARSE_FAILED,
+                         "Got QCDM response");
+            return TRUE;
+        }
+
+        /* QCDM replies start with the command code (0x00 for version info),
+         * so don't let the AT parser skip the leading NULs of one not fully
+         * received yet, unless the port is just spewing NULs */
+        if (response->len > 0 &&
+            response->str[0] == '\0' &&
+            !is_non_at_response ((const guint8 *) response->str, response->len))
+            return FALSE;
+    }
+
+    return mm_serial_parser_v1_parse (parser->parser, response, error);
+}
+
+static void
+serial_probe_response_parser_free (ProbeResponseParser *parser)
+{
+    mm_serial_parser_v1_destroy (parser->parser);
+    g_slice_free (ProbeResponseParser, parser);
+}
+
 static gboolean
 serial_open_at (MMPortProbe *self)
 {
@@ -1270,10 +1528,12 @@ serial_open_at (MMPortProbe *self)
         mm_serial_parser_v1_add_filter (parser,
                                         serial_parser_filter_cb,
                                         NULL);
+        ctx->response_parser = g_slice_new0 (ProbeResponseParser);
+        ctx->response_parser->parser = parser;
         mm_port_serial_at_set_response_parser (MM_PORT_SERIAL_AT (ctx->serial),
-                                               mm_serial_parser_v1_parse,
-                                               parser,
-                                               mm_serial_parser_v1_destroy);
+                                               (MMPortSerialAtResponseParserFn) serial_probe_response_parse,
+                                               ctx->response_parser,
+                                               (GDestroyNotify) serial_probe_response_parser_free);
     }
 
     /* Try to open the port */
@@ -1345,10 +1605,19 @@ mm_port_probe_run_cancel_at_probing (MMPortProbe *self)
     mm_dbg ("(%s/%s) requested to cancel all AT probing",
             g_udev_device_get_subsystem (self->priv->port),
             g_udev_device_get_name (self->priv->port));
+    self->priv->at_probing_cancelled = TRUE;
     g_cancellable_cancel (ctx->at_probing_cancellable);
     return TRUE;
 }
 
+gboolean
+mm_port_probe_get_at_probing_cancelled (MMPortProbe *self)
+{
+    g_return_val_if_fail (MM_IS_PORT_PROBE (self), FALSE);
+
+    return self->priv->at_probing_cancelled;
+}
+
 gboolean
 mm_port_probe_run_finish (MMPortProbe   *self,
                           GAsyncResult  *result,
@@ -1366,6 +1635,7 @@ mm_port_probe_run (MMPortProbe                *self,
                    guint64                     at_send_delay,
                    gboolean                    at_remove_echo,
                    gboolean                    at_send_lf,
+                   gboolean                    at_qcdm_probe,
                    const MMPortProbeAtCommand *at_custom_probe,
                    const MMAsyncMethod        *at_custom_init,
                    GCancellable               *cancellable,
@@ -1389,6 +1659,7 @@ mm_port_probe_run (MMPortProbe                *self,
     ctx->at_send_delay = at_send_delay;
     ctx->at_remove_echo = at_remove_echo;
     ctx->at_send_lf = at_send_lf;
+    ctx->at_qcdm_check = at_qcdm_probe;
     ctx->flags = MM_PORT_PROBE_NONE;
     ctx->at_custom_probe = at_custom_probe;
     ctx->at_custom_init = at_custom_init ? (MMPortProbeAtCustomInit)at_custom_init->async : NULL;
@@ -1456,6 +1727,14 @@ mm_port_probe_run (MMPortProbe                *self,
     g_assert_not_reached ();
 }
 
+MMPortProbeFlag
+mm_port_probe_get_probed_flags (MMPortProbe *self)
+{
+    g_return_val_if_fail (MM_IS_PORT_PROBE (self), MM_PORT_PROBE_NONE);
+
+    return self->priv->flags;
+}
+
 gboolean
 mm_port_probe_is_at (MMPortProbe *self)
 {
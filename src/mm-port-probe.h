@@ -92,6 +92,10 @@ const gchar *mm_port_probe_get_parent_path  (MMPortProbe *self);
 /* Probing result setters */
 void mm_port_probe_set_result_at         (MMPortProbe *self,
                                           gboolean at);
+/* Like mm_port_probe_set_result_at(), for results not actually probed */
+void mm_port_probe_set_result_at_assumed (MMPortProbe *self,
+                                          gboolean at);
+gboolean mm_port_probe_get_result_at_assumed (MMPortProbe *self);
 void mm_port_probe_set_result_at_vendor  (MMPortProbe *self,
                                           const gchar *at_vendor);
 void mm_port_probe_set_result_at_product (MMPortProbe *self,
@@ -111,6 +115,7 @@ void     mm_port_probe_run        (MMPortProbe *self,
                                    guint64 at_send_delay,
                                    gboolean at_remove_echo,
                                    gboolean at_send_lf,
+                                   gboolean at_qcdm_probe,
                                    const MMPortProbeAtCommand *at_custom_probe,
                                    const MMAsyncMethod *at_custom_init,
                                    GCancellable *cancellable,
@@ -121,8 +126,10 @@ gboolean mm_port_probe_run_finish (MMPortProbe *self,
                                    GError **error);
 
 gboolean mm_port_probe_run_cancel_at_probing (MMPortProbe *self);
+gboolean mm_port_probe_get_at_probing_cancelled (MMPortProbe *self);
 
 /* Probing result getters */
+MMPortProbeFlag mm_port_probe_get_probed_flags (MMPortProbe *self);
 MMPortType    mm_port_probe_get_port_type    (MMPortProbe *self);
 gboolean      mm_port_probe_is_at            (MMPortProbe *self);
 gboolean      mm_port_probe_is_qcdm          (MMPortProbe *self);
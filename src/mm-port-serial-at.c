@@ -15,12 +15,15 @@
  */
 
 #define _GNU_SOURCE  /* for strcasestr() */
+#define MM_LOG_MODULE MM_LOG_MODULE_SERIAL
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
 
+#include <ModemManager.h>
+
 #include "mm-port-serial-at.h"
 #include "mm-log.h"
 
@@ -32,16 +35,23 @@ enum {
     PROP_INIT_SEQUENCE_ENABLED,
     PROP_INIT_SEQUENCE,
     PROP_SEND_LF,
+    PROP_CONCAT_COMMANDS,
     LAST_PROP
 };
 
 struct _MMPortSerialAtPrivate {
+    /* Protects the response parser and the unsolicited msg handlers, which
+     * may be used from the I/O worker thread */
+    GMutex lock;
+
     /* Response parser data */
     MMPortSerialAtResponseParserFn response_parser_fn;
     gpointer response_parser_user_data;
     GDestroyNotify response_parser_notify;
 
     GSList *unsolicited_msg_handlers;
+    /* Line prefix to list of indexed unsolicited msg handlers */
+    GHashTable *unsolicited_msg_index;
 
     MMPortSerialAtFlag flags;
 
@@ -50,6 +60,7 @@ struct _MMPortSerialAtPrivate {
     guint init_sequence_enabled;
     gchar **init_sequence;
     gboolean send_lf;
+    gboolean concat_commands;
 };
 
 /*****************************************************************************/
@@ -88,75 +99,106 @@ mm_port_serial_at_set_response_parser (MMPortSerialAt *self,
 {
     g_return_if_fail (MM_IS_PORT_SERIAL_AT (self));
 
+    g_mutex_lock (&self->priv->lock);
     if (self->priv->response_parser_notify)
         self->priv->response_parser_notify (self->priv->response_parser_user_data);
 
     self->priv->response_parser_fn = fn;
     self->priv->response_parser_user_data = user_data;
     self->priv->response_parser_notify = notify;
+    g_mutex_unlock (&self->priv->lock);
 }
 
-void
-mm_port_serial_at_remove_echo (GByteArray *response)
+static gsize
+echo_length (const guint8 *data,
+             gsize len)
 {
-    guint i;
+    gsize i;
 
-    if (response->len <= 2)
-        return;
+    if (len <= 2)
+        return 0;
 
-    for (i = 0; i < (response->len - 1); i++) {
+    for (i = 0; i < (len - 1); i++) {
         /* If there is any content before the first
          * <CR><LF>, assume it's echo or garbage, and skip it */
-        if (response->data[i] == '\r' && response->data[i + 1] == '\n') {
-            if (i > 0)
-                g_byte_array_remove_range (response, 0, i);
-            /* else, good, we're already started with <CR><LF> */
-            break;
-        }
+        if (data[i] == '\r' && data[i + 1] == '\n')
+            return i;
     }
+
+    return 0;
+}
+
+void
+mm_port_serial_at_remove_echo (GByteArray *response)
+{
+    gsize echo_len;
+
+    echo_len = echo_length (response->data, response->len);
+    if (echo_len > 0)
+        g_byte_array_remove_range (response, 0, echo_len);
+}
+
+static void
+buffer_remove_echo (MMPortSerialBuffer *response)
+{
+    const guint8 *data;
+    gsize len;
+
+    data = mm_port_serial_buffer_peek (response, &len);
+    mm_port_serial_buffer_consume (response, echo_length (data, len));
 }
 
 static MMPortSerialResponseType
 parse_response (MMPortSerial *port,
-                GByteArray *response,
+                MMPortSerialBuffer *response,
                 GByteArray **parsed_response,
                 GError **error)
 {
     MMPortSerialAt *self = MM_PORT_SERIAL_AT (port);
+    const guint8 *data;
+    gsize len;
     GString *string;
     gsize parsed_len;
+    gboolean parsed;
     GError *inner_error = NULL;
 
     g_return_val_if_fail (self->priv->response_parser_fn != NULL, FALSE);
 
     /* Remove echo */
     if (self->priv->remove_echo)
-        mm_port_serial_at_remove_echo (response);
+        buffer_remove_echo (response);
 
     /* If there's no response to receive, we're done; e.g. if we only got
      * unsolicited messages */
-    if (!response->len)
+    data = mm_port_serial_buffer_peek (response, &len);
+    if (!len)
         return MM_PORT_SERIAL_RESPONSE_NONE;
 
     /* Construct the string that AT-parsing functions expect */
-    string = g_string_sized_new (response->len + 1);
-    g_string_append_len (string, (const char *) response->data, response->len);
-
-    /* Fully cleanup the response array, we'll consider the contents we got
-     * as the full reply that the command may expect. */
-    g_byte_array_remove_range (response, 0, response->len);
+    string = g_string_sized_new (len + 1);
+    g_string_append_len (string, (const char *) data, len);
 
     /* Parse it; returns FALSE if there is nothing we can do with this
      * response yet. */
-    if (!self->priv->response_parser_fn (self->priv->response_parser_user_data, string, &inner_error)) {
-        /* Copy what we got back in the response buffer. */
-        g_byte_array_append (response, (const guint8 *) string->str, string->len);
+    g_mutex_lock (&self->priv->lock);
+    parsed = self->priv->response_parser_fn (self->priv->response_parser_user_data, string, &inner_error);
+    g_mutex_unlock (&self->priv->lock);
+    if (!parsed) {
+        /* The parser may have cleaned up the string (e.g. leading NULs), so
+         * keep its version in the response buffer if it changed. */
+        if (string->len != len || memcmp (string->str, data, len) != 0)
+            mm_port_serial_buffer_replace (response, (const guint8 *) string->str, string->len);
         g_string_free (string, TRUE);
         return MM_PORT_SERIAL_RESPONSE_NONE;
     }
 
+    /* Fully consume the response buffer, we'll consider the contents we got
+     * as the full reply that the command may expect. */
+    mm_port_serial_buffer_consume (response, len);
+
     /* If we got an error, propagate it without any further response string */
     if (inner_error) {
+        g_string_free (string, TRUE);
         g_propagate_error (error, inner_error);
         return MM_PORT_SERIAL_RESPONSE_ERROR;
     }
@@ -175,8 +217,340 @@ typedef struct {
     gboolean enable;
     gpointer user_data;
     GDestroyNotify notify;
+    /* Whether the handler is indexed by line prefix, or needs to be run
+     * always (fallback) */
+    gboolean indexed;
+    /* Set when a line in the current buffer may match the handler */
+    gboolean pending;
 } MMAtUnsolicitedMsgHandler;
 
+/*****************************************************************************/
+/* Unsolicited message handler index
+ *
+ * Most unsolicited message regexes are of the form '\r\n+PREFIX:...', so
+ * instead of running all of them over the whole response buffer every time
+ * new data arrives, we index the handlers by the literal line prefix that
+ * their pattern requires (e.g. '+CREG', '^RSSI', 'RING'). The response buffer
+ * is split in lines once, and only the handlers whose prefix is found at the
+ * start of a line are run. Handlers whose pattern doesn't allow deriving a
+ * mandatory literal prefix are always run.
+ *
+ * The prefix of a line is the text following a <CR><LF> up to the first
+ * ':', ',', ' ', <CR> or <LF>.
+ */
+
+#define URC_PREFIX_MAX_LEN 32
+#define URC_PREFIX_MAX_N   16
+
+static gboolean
+urc_prefix_is_delimiter (gchar c)
+{
+    return (c == ':' || c == ',' || c == ' ' || c == '\r' || c == '\n');
+}
+
+static gboolean
+urc_pattern_is_quantifier (gchar c)
+{
+    return (c == '?' || c == '*' || c == '+' || c == '{');
+}
+
+/* Reads one literal character from the pattern; returns FALSE if the next
+ * pattern item is not a literal character */
+static gboolean
+urc_pattern_read_literal (const gchar **p,
+                          gchar *out)
+{
+    const gchar *s = *p;
+
+    if (s[0] == '\\') {
+        if (s[1] == 'r')
+            *out = '\r';
+        else if (s[1] == 'n')
+            *out = '\n';
+        else if (s[1] != '\0' && !g_ascii_isalnum (s[1]))
+            *out = s[1];
+        else
+            return FALSE;
+        *p = s + 2;
+        return TRUE;
+    }
+
+    if (s[0] == '\0' || strchr (".^$|()[]{}*+?", s[0]))
+        return FALSE;
+
+    *out = s[0];
+    *p = s + 1;
+    return TRUE;
+}
+
+static gboolean
+urc_pattern_has_top_level_alternation (const gchar *p)
+{
+    guint depth = 0;
+
+    for (; *p; p++) {
+        switch (*p) {
+        case '\\':
+            if (!p[1])
+                return FALSE;
+            p++;
+            break;
+        case '[':
+            /* Skip character class; a ']' right after the opening
+             * bracket (or after '^') is a literal */
+            p++;
+            if (*p == '^')
+                p++;
+            if (*p == ']')
+                p++;
+            while (*p && *p != ']') {
+                if (*p == '\\' && p[1])
+                    p++;
+                p++;
+            }
+            if (!*p)
+                return FALSE;
+            break;
+        case '(':
+            depth++;
+            break;
+        case ')':
+            if (depth > 0)
+                depth--;
+            break;
+        case '|':
+            if (depth == 0)
+                return TRUE;
+            break;
+        default:
+            break;
+        }
+    }
+
+    return FALSE;
+}
+
+/* Parses a group of literal alternatives, e.g. '(CREG|CGREG|CEREG)', and
+ * combines them with the prefixes built so far */
+static gboolean
+urc_pattern_read_group (const gchar **p,
+                        GPtrArray *prefixes)
+{
+    const gchar *s = *p;
+    GPtrArray *alternatives;
+    GString *current;
+    GPtrArray *combined;
+    guint i, j;
+    gboolean success = FALSE;
+
+    g_assert (*s == '(');
+    s++;
+    if (s[0] == '?' && s[1] == ':')
+        s += 2;
+
+    alternatives = g_ptr_array_new_with_free_func ((GDestroyNotify) g_free);
+    current = g_string_new ("");
+    while (TRUE) {
+        gchar c;
+
+        if (*s == '|' || *s == ')') {
+            if (!current->len)
+                goto out;
+            g_ptr_array_add (alternatives, g_strdup (current->str));
+            g_string_truncate (current, 0);
+            if (*s++ == ')')
+                break;
+            continue;
+        }
+
+        if (!urc_pattern_read_literal (&s, &c) ||
+            urc_prefix_is_delimiter (c) ||
+            urc_pattern_is_quantifier (*s))
+            goto out;
+        g_string_append_c (current, c);
+    }
+
+    /* The group itself must be mandatory */
+    if (urc_pattern_is_quantifier (*s))
+        goto out;
+
+    if (prefixes->len * alternatives->len > URC_PREFIX_MAX_N)
+        goto out;
+
+    combined = g_ptr_array_new ();
+    for (i = 0; i < prefixes->len; i++) {
+        for (j = 0; j < alternatives->len; j++) {
+            GString *prefix;
+
+            prefix = g_string_new (((GString *) g_ptr_array_index (prefixes, i))->str);
+            g_string_append (prefix, (const gchar *) g_ptr_array_index (alternatives, j));
+            g_ptr_array_add (combined, prefix);
+        }
+    }
+    for (i = 0; i < prefixes->len; i++)
+        g_string_free ((GString *) g_ptr_array_index (prefixes, i), TRUE);
+    g_ptr_array_set_size (prefixes, 0);
+    for (i = 0; i < combined->len; i++)
+        g_ptr_array_add (prefixes, g_ptr_array_index (combined, i));
+    g_ptr_array_unref (combined);
+
+    *p = s;
+    success = TRUE;
+
+out:
+    g_string_free (current, TRUE);
+    g_ptr_array_unref (alternatives);
+    return success;
+}
+
+/* Returns a NULL-terminated array of the line prefixes which the regex
+ * requires, or NULL if they cannot be derived from the pattern */
+gchar **
+mm_port_serial_at_get_unsolicited_msg_prefixes (GRegex *regex)
+{
+    const gchar *p;
+    GPtrArray *prefixes;
+    gchar **result = NULL;
+    guint i;
+
+    if (g_regex_get_compile_flags (regex) & (G_REGEX_CASELESS | G_REGEX_EXTENDED))
+        return NULL;
+
+    p = g_regex_get_pattern (regex);
+    if (!g_str_has_prefix (p, "\\r\\n") || urc_pattern_has_top_level_alternation (p))
+        return NULL;
+    p += 4;
+
+    prefixes = g_ptr_array_new ();
+    g_ptr_array_add (prefixes, g_string_new (""));
+
+    while (TRUE) {
+        gchar c;
+
+        if (*p == '(') {
+            if (!urc_pattern_read_group (&p, prefixes))
+                goto out;
+            continue;
+        }
+
+        if (!urc_pattern_read_literal (&p, &c))
+            goto out;
+
+        if (urc_prefix_is_delimiter (c)) {
+            /* Delimiter found; the prefix is complete if the delimiter is
+             * mandatory */
+            if (((GString *) g_ptr_array_index (prefixes, 0))->len == 0 ||
+                *p == '?' || *p == '*' || *p == '{')
+                goto out;
+            break;
+        }
+
+        if (urc_pattern_is_quantifier (*p))
+            goto out;
+
+        for (i = 0; i < prefixes->len; i++) {
+            GString *prefix = (GString *) g_ptr_array_index (prefixes, i);
+
+            if (prefix->len == URC_PREFIX_MAX_LEN)
+                goto out;
+            g_string_append_c (prefix, c);
+        }
+    }
+
+    result = g_new0 (gchar *, prefixes->len + 1);
+    for (i = 0; i < prefixes->len; i++)
+        result[i] = g_strdup (((GString *) g_ptr_array_index (prefixes, i))->str);
+
+out:
+    for (i = 0; i < prefixes->len; i++)
+        g_string_free ((GString *) g_ptr_array_index (prefixes, i), TRUE);
+    g_ptr_array_unref (prefixes);
+    return result;
+}
+
+static void
+urc_index_add (MMPortSerialAt *self,
+               MMAtUnsolicitedMsgHandler *handler)
+{
+    gchar **prefixes;
+    guint i;
+
+    prefixes = mm_port_serial_at_get_unsolicited_msg_prefixes (handler->regex);
+    if (!prefixes) {
+        handler->indexed = FALSE;
+        return;
+    }
+
+    handler->indexed = TRUE;
+    for (i = 0; prefixes[i]; i++) {
+        GSList *list;
+
+        list = g_hash_table_lookup (self->priv->unsolicited_msg_index, prefixes[i]);
+        if (list) {
+            /* The list head is owned by the table; append in place */
+            list = g_slist_append (list, handler);
+            g_free (prefixes[i]);
+        } else
+            g_hash_table_insert (self->priv->unsolicited_msg_index,
+                                 prefixes[i],
+                                 g_slist_append (NULL, handler));
+    }
+    g_free (prefixes);
+}
+
+/* Flags as pending all handlers whose prefix is found at the start of a
+ * line in the given data */
+static void
+urc_index_mark_pending (MMPortSerialAt *self,
+                        const guint8 *data,
+                        gsize len)
+{
+    GSList *iter;
+    const guint8 *p;
+    const guint8 *end;
+
+    for (iter = self->priv->unsolicited_msg_handlers; iter; iter = iter->next)
+        ((MMAtUnsolicitedMsgHandler *) iter->data)->pending = FALSE;
+
+    if (g_hash_table_size (self->priv->unsolicited_msg_index) == 0)
+        return;
+
+    p = data;
+    end = data + len;
+    while (p < end && (p = memchr (p, '\r', end - p)) != NULL) {
+        gchar prefix[URC_PREFIX_MAX_LEN + 1];
+        const guint8 *start;
+        gsize prefix_len = 0;
+
+        if (p + 1 >= end)
+            break;
+        if (p[1] != '\n') {
+            p++;
+            continue;
+        }
+
+        start = p + 2;
+        while (start + prefix_len < end &&
+               prefix_len <= URC_PREFIX_MAX_LEN &&
+               !urc_prefix_is_delimiter ((gchar) start[prefix_len]))
+            prefix_len++;
+
+        /* Only full prefixes, i.e. followed by a delimiter */
+        if (prefix_len > 0 &&
+            prefix_len <= URC_PREFIX_MAX_LEN &&
+            start + prefix_len < end) {
+            memcpy (prefix, start, prefix_len);
+            prefix[prefix_len] = '\0';
+            for (iter = g_hash_table_lookup (self->priv->unsolicited_msg_index, prefix); iter; iter = iter->next)
+                ((MMAtUnsolicitedMsgHandler *) iter->data)->pending = TRUE;
+        }
+
+        p = start + prefix_len;
+    }
+}
+
+/*****************************************************************************/
+
 static gint
 unsolicited_msg_handler_cmp (MMAtUnsolicitedMsgHandler *handler,
                              GRegex *regex)
@@ -194,28 +568,36 @@ mm_port_serial_at_add_unsolicited_msg_handler (MMPortSerialAt *self,
 {
     GSList *existing;
     MMAtUnsolicitedMsgHandler *handler;
+    GDestroyNotify old_notify = NULL;
+    gpointer old_user_data = NULL;
 
     g_return_if_fail (MM_IS_PORT_SERIAL_AT (self));
     g_return_if_fail (regex != NULL);
 
+    g_mutex_lock (&self->priv->lock);
     existing = g_slist_find_custom (self->priv->unsolicited_msg_handlers,
                                     regex,
                                     (GCompareFunc)unsolicited_msg_handler_cmp);
     if (existing) {
         handler = existing->data;
         /* We OVERWRITE any existing one, so if any context data existing, free it */
-        if (handler->notify)
-            handler->notify (handler->user_data);
+        old_notify = handler->notify;
+        old_user_data = handler->user_data;
     } else {
-        handler = g_slice_new (MMAtUnsolicitedMsgHandler);
+        handler = g_slice_new0 (MMAtUnsolicitedMsgHandler);
         self->priv->unsolicited_msg_handlers = g_slist_append (self->priv->unsolicited_msg_handlers, handler);
         handler->regex = g_regex_ref (regex);
+        urc_index_add (self, handler);
     }
 
     handler->callback = callback;
     handler->enable = TRUE;
     handler->user_data = user_data;
     handler->notify = notify;
+    g_mutex_unlock (&self->priv->lock);
+
+    if (old_notify)
+        old_notify (old_user_data);
 }
 
 void
@@ -229,6 +611,7 @@ mm_port_serial_at_enable_unsolicited_msg_handler (MMPortSerialAt *self,
     g_return_if_fail (MM_IS_PORT_SERIAL_AT (self));
     g_return_if_fail (regex != NULL);
 
+    g_mutex_lock (&self->priv->lock);
     existing = g_slist_find_custom (self->priv->unsolicited_msg_handlers,
                                     regex,
                                     (GCompareFunc)unsolicited_msg_handler_cmp);
@@ -236,6 +619,7 @@ mm_port_serial_at_enable_unsolicited_msg_handler (MMPortSerialAt *self,
         handler = existing->data;
         handler->enable = enable;
     }
+    g_mutex_unlock (&self->priv->lock);
 }
 
 static gboolean
@@ -253,15 +637,44 @@ remove_eval_cb (const GMatchInfo *match_info,
     return FALSE;
 }
 
+/* An unsolicited message found in the input, along with the input as it was
+ * when found, so that the handler gets the very same matches when run later */
+typedef struct {
+    GRegex *regex;
+    gchar *data;
+    gsize len;
+    gint start;
+} UnsolicitedMsg;
+
 static void
-parse_unsolicited (MMPortSerial *port, GByteArray *response)
+unsolicited_msg_free (UnsolicitedMsg *msg)
+{
+    g_regex_unref (msg->regex);
+    g_free (msg->data);
+    g_slice_free (UnsolicitedMsg, msg);
+}
+
+static GList *
+collect_unsolicited (MMPortSerial *port, MMPortSerialBuffer *response)
 {
     MMPortSerialAt *self = MM_PORT_SERIAL_AT (port);
+    GList *found = NULL;
     GSList *iter;
+    const guint8 *data;
+    gsize len;
+
+    g_mutex_lock (&self->priv->lock);
 
     /* Remove echo */
     if (self->priv->remove_echo)
-        mm_port_serial_at_remove_echo (response);
+        buffer_remove_echo (response);
+
+    data = mm_port_serial_buffer_peek (response, &len);
+    if (!len)
+        goto out;
+
+    /* Split in lines just once, and find which indexed handlers may match */
+    urc_index_mark_pending (self, data, len);
 
     for (iter = self->priv->unsolicited_msg_handlers; iter; iter = iter->next) {
         MMAtUnsolicitedMsgHandler *handler = (MMAtUnsolicitedMsgHandler *) iter->data;
@@ -271,15 +684,22 @@ parse_unsolicited (MMPortSerial *port, GByteArray *response)
         if (!handler->enable)
             continue;
 
+        if (handler->indexed && !handler->pending)
+            continue;
+
         matches = g_regex_match_full (handler->regex,
-                                      (const char *) response->data,
-                                      response->len,
+                                      (const char *) data,
+                                      len,
                                       0, 0, &match_info, NULL);
-        if (handler->callback) {
-            while (g_match_info_matches (match_info)) {
-                handler->callback (self, match_info, handler->user_data);
-                g_match_info_next (match_info, NULL);
-            }
+        if (matches && handler->callback) {
+            UnsolicitedMsg *msg;
+
+            msg = g_slice_new (UnsolicitedMsg);
+            msg->regex = g_regex_ref (handler->regex);
+            msg->data = g_memdup (data, len);
+            msg->len = len;
+            g_match_info_fetch_pos (match_info, 0, &msg->start, NULL);
+            found = g_list_prepend (found, msg);
         }
 
         g_match_info_free (match_info);
@@ -287,19 +707,75 @@ parse_unsolicited (MMPortSerial *port, GByteArray *response)
         if (matches) {
             /* Remove matches */
             char *str;
-            int result_len = response->len;
+            int result_len = len;
 
             str = g_regex_replace_eval (handler->regex,
-                                        (const char *) response->data,
-                                        response->len,
+                                        (const char *) data,
+                                        len,
                                         0, 0,
                                         remove_eval_cb, &result_len, NULL);
 
-            g_byte_array_remove_range (response, 0, response->len);
-            g_byte_array_append (response, (const guint8 *) str, result_len);
+            mm_port_serial_buffer_replace (response, (const guint8 *) str, result_len);
             g_free (str);
+
+            data = mm_port_serial_buffer_peek (response, &len);
+            if (!len)
+                break;
+
+            /* Lines changed, so find again which handlers may match */
+            urc_index_mark_pending (self, data, len);
         }
     }
+
+out:
+    g_mutex_unlock (&self->priv->lock);
+    return g_list_reverse (found);
+}
+
+static void
+dispatch_unsolicited (MMPortSerial *port, gpointer unsolicited)
+{
+    MMPortSerialAt *self = MM_PORT_SERIAL_AT (port);
+    UnsolicitedMsg *msg = (UnsolicitedMsg *) unsolicited;
+    MMPortSerialAtUnsolicitedMsgFn callback = NULL;
+    gpointer user_data = NULL;
+    GSList *existing;
+    GMatchInfo *match_info;
+
+    /* The handler may have been disabled or replaced since the message was
+     * found */
+    g_mutex_lock (&self->priv->lock);
+    existing = g_slist_find_custom (self->priv->unsolicited_msg_handlers,
+                                    msg->regex,
+                                    (GCompareFunc)unsolicited_msg_handler_cmp);
+    if (existing && ((MMAtUnsolicitedMsgHandler *) existing->data)->enable) {
+        callback = ((MMAtUnsolicitedMsgHandler *) existing->data)->callback;
+        user_data = ((MMAtUnsolicitedMsgHandler *) existing->data)->user_data;
+    }
+    g_mutex_unlock (&self->priv->lock);
+
+    if (!callback)
+        return;
+
+    /* Matching again from the first match gives the same matches */
+    g_regex_match_full (msg->regex, msg->data, msg->len, msg->start, 0, &match_info, NULL);
+    while (g_match_info_matches (match_info)) {
+        callback (self, match_info, user_data);
+        g_match_info_next (match_info, NULL);
+    }
+    g_match_info_free (match_info);
+}
+
+static void
+parse_unsolicited (MMPortSerial *port, MMPortSerialBuffer *response)
+{
+    GList *found;
+    GList *l;
+
+    found = collect_unsolicited (port, response);
+    for (l = found; l; l = g_list_next (l))
+        dispatch_unsolicited (port, l->data);
+    g_list_free_full (found, (GDestroyNotify) unsolicited_msg_free);
 }
 
 /*****************************************************************************/
@@ -339,6 +815,15 @@ at_command_to_byte_array (const char *command, gboolean is_raw, gboolean send_lf
     return buf;
 }
 
+static gboolean
+port_send_lf (MMPortSerialAt *self)
+{
+    /* Only TTYs may be configured not to get the trailing line-feed */
+    return (mm_port_get_subsys (MM_PORT (self)) == MM_PORT_SUBSYS_TTY ?
+            self->priv->send_lf :
+            TRUE);
+}
+
 const gchar *
 mm_port_serial_at_command_finish (MMPortSerialAt *self,
                                   GAsyncResult *res,
@@ -393,7 +878,7 @@ serial_command_ready (MMPortSerial *port,
 void
 mm_port_serial_at_command (MMPortSerialAt *self,
                            const char *command,
-                           guint32 timeout_seconds,
+                           guint32 timeout_ms,
                            gboolean is_raw,
                            gboolean allow_cached,
                            GCancellable *cancellable,
@@ -407,11 +892,7 @@ mm_port_serial_at_command (MMPortSerialAt *self,
     g_return_if_fail (MM_IS_PORT_SERIAL_AT (self));
     g_return_if_fail (command != NULL);
 
-    buf = at_command_to_byte_array (command,
-                                    is_raw,
-                                    (mm_port_get_subsys (MM_PORT (self)) == MM_PORT_SUBSYS_TTY ?
-                                     self->priv->send_lf :
-                                     TRUE));
+    buf = at_command_to_byte_array (command, is_raw, port_send_lf (self));
     g_return_if_fail (buf != NULL);
 
     simple = g_simple_async_result_new (G_OBJECT (self),
@@ -421,7 +902,7 @@ mm_port_serial_at_command (MMPortSerialAt *self,
 
     mm_port_serial_command (MM_PORT_SERIAL (self),
                             buf,
-                            timeout_seconds,
+                            timeout_ms,
                             allow_cached,
                             cancellable,
                             (GAsyncReadyCallback)serial_command_ready,
@@ -429,6 +910,268 @@ mm_port_serial_at_command (MMPortSerialAt *self,
     g_byte_array_unref (buf);
 }
 
+/*****************************************************************************/
+/* Concatenated commands */
+
+/* Command name, skipping the "AT" prefix and any argument; e.g. "+CGMI" in
+ * both "AT+CGMI" and "+CGMI?" */
+static const gchar *
+command_name (const gchar *command,
+              gsize *name_len)
+{
+    if (g_ascii_strncasecmp (command, "AT", 2) == 0)
+        command += 2;
+    *name_len = strcspn (command, "=?;\r\n");
+    return command;
+}
+
+/* Whether the information line is prefixed with the name of the given
+ * command, e.g. "+CGMM: E173" for "+CGMM" */
+static gboolean
+line_has_command_prefix (const gchar *line,
+                         const gchar *command)
+{
+    const gchar *name;
+    gsize name_len;
+
+    name = command_name (command, &name_len);
+    return (name_len > 1 &&
+            name[0] == '+' &&
+            g_ascii_strncasecmp (line, name, name_len) == 0 &&
+            line[name_len] == ':');
+}
+
+gchar **
+mm_port_serial_at_split_concat_response (const gchar *const *commands,
+                                         const gchar *response,
+                                         GError **error)
+{
+    GPtrArray *lines;
+    const gchar *p;
+    guint n_commands;
+    guint i;
+
+    n_commands = g_strv_length ((gchar **) commands);
+    lines = g_ptr_array_sized_new (n_commands + 1);
+
+    /* Every command gets exactly one non-empty line of information text */
+    for (p = response; *p; ) {
+        gsize len;
+
+        len = strcspn (p, "\r\n");
+        if (len > 0) {
+            const gchar *line = p;
+            guint j;
+
+            if (lines->len == n_commands) {
+                g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
+                             "Couldn't split concatenated response: more than %u lines",
+                             n_commands);
+                goto failed;
+            }
+
+            /* A line prefixed with the name of another of the commands means
+             * the one it was expected for replied with no text at all */
+            for (j = 0; j < n_commands; j++) {
+                if (j != lines->len && line_has_command_prefix (line, commands[j])) {
+                    g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
+                                 "Couldn't split concatenated response: "
+                                 "reply to '%s' found where '%s' was expected",
+                                 commands[j], commands[lines->len]);
+                    goto failed;
+                }
+            }
+
+            g_ptr_array_add (lines, g_strndup (line, len));
+        }
+        p += len;
+        while (*p == '\r' || *p == '\n')
+            p++;
+    }
+
+    if (lines->len != n_commands) {
+        g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
+                     "Couldn't split concatenated response: got %u lines, expected %u",
+                     lines->len, n_commands);
+        goto failed;
+    }
+
+    g_ptr_array_add (lines, NULL);
+    return (gchar **) g_ptr_array_free (lines, FALSE);
+
+failed:
+    for (i = 0; i < lines->len; i++)
+        g_free (g_ptr_array_index (lines, i));
+    g_ptr_array_free (lines, TRUE);
+    return NULL;
+}
+
+typedef struct {
+    MMPortSerialAt *self;
+    GSimpleAsyncResult *result;
+    gchar **commands;
+    gboolean allow_cached;
+} ConcatContext;
+
+static void
+concat_context_complete_and_free (ConcatContext *ctx)
+{
+    g_simple_async_result_complete (ctx->result);
+    g_object_unref (ctx->result);
+    g_strfreev (ctx->commands);
+    g_object_unref (ctx->self);
+    g_slice_free (ConcatContext, ctx);
+}
+
+gchar **
+mm_port_serial_at_command_concat_finish (MMPortSerialAt *self,
+                                         GAsyncResult *res,
+                                         GError **error)
+{
+    if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error))
+        return NULL;
+
+    return g_strdupv ((gchar **) g_simple_async_result_get_op_res_gpointer (G_SIMPLE_ASYNC_RESULT (res)));
+}
+
+static void
+concat_command_ready (MMPortSerialAt *self,
+                      GAsyncResult *res,
+                      ConcatContext *ctx)
+{
+    const gchar *response;
+    gchar **responses;
+    GError *error = NULL;
+    guint i;
+
+    response = mm_port_serial_at_command_finish (self, res, &error);
+    if (!response) {
+        g_simple_async_result_take_error (ctx->result, error);
+        concat_context_complete_and_free (ctx);
+        return;
+    }
+
+    responses = mm_port_serial_at_split_concat_response ((const gchar *const *) ctx->commands,
+                                                         response,
+                                                         &error);
+    if (!responses) {
+        g_simple_async_result_take_error (ctx->result, error);
+        concat_context_complete_and_free (ctx);
+        return;
+    }
+
+    /* Let later requests of each single command get its reply right away */
+    if (ctx->allow_cached) {
+        for (i = 0; ctx->commands[i]; i++) {
+            GByteArray *command;
+            GByteArray *reply;
+
+            command = at_command_to_byte_array (ctx->commands[i], FALSE, port_send_lf (self));
+            reply = g_byte_array_new ();
+            g_byte_array_append (reply, (const guint8 *) responses[i], strlen (responses[i]));
+            mm_port_serial_set_cached_reply (MM_PORT_SERIAL (self), command, reply);
+            g_byte_array_unref (reply);
+            g_byte_array_unref (command);
+        }
+    }
+
+    g_simple_async_result_set_op_res_gpointer (ctx->result,
+                                               responses,
+                                               (GDestroyNotify) g_strfreev);
+    concat_context_complete_and_free (ctx);
+}
+
+void
+mm_port_serial_at_command_concat (MMPortSerialAt *self,
+                                  const gchar *const *commands,
+                                  guint32 timeout_ms,
+                                  gboolean allow_cached,
+                                  GCancellable *cancellable,
+                                  GAsyncReadyCallback callback,
+                                  gpointer user_data)
+{
+    ConcatContext *ctx;
+    GString *line;
+    guint i;
+
+    g_return_if_fail (MM_IS_PORT_SERIAL_AT (self));
+    g_return_if_fail (commands != NULL && commands[0] != NULL);
+
+    ctx = g_slice_new0 (ConcatContext);
+    ctx->self = g_object_ref (self);
+    ctx->result = g_simple_async_result_new (G_OBJECT (self),
+                                             callback,
+                                             user_data,
+                                             mm_port_serial_at_command_concat);
+    ctx->commands = g_strdupv ((gchar **) commands);
+    ctx->allow_cached = allow_cached;
+
+    /* Build "AT<cmd1>;<cmd2>;...;<cmdN>" */
+    line = g_string_new ("AT");
+    for (i = 0; commands[i]; i++) {
+        const gchar *name;
+        gsize name_len;
+
+        name = command_name (commands[i], &name_len);
+        if (name[strcspn (name, ";\r\n")] != '\0') {
+            g_simple_async_result_set_error (ctx->result,
+                                             MM_CORE_ERROR,
+                                             MM_CORE_ERROR_INVALID_ARGS,
+                                             "Command '%s' can't be concatenated",
+                                             commands[i]);
+            g_string_free (line, TRUE);
+            concat_context_complete_and_free (ctx);
+            return;
+        }
+        if (i > 0)
+            g_string_append_c (line, ';');
+        g_string_append (line, name);
+    }
+
+    mm_port_serial_at_command (self,
+                               line->str,
+                               timeout_ms,
+                               FALSE,
+                               FALSE,
+                               cancellable,
+                               (GAsyncReadyCallback) concat_command_ready,
+                               ctx);
+    g_string_free (line, TRUE);
+}
+
+gboolean
+mm_port_serial_at_get_concat_commands (MMPortSerialAt *self)
+{
+    g_return_val_if_fail (MM_IS_PORT_SERIAL_AT (self), FALSE);
+
+    return self->priv->concat_commands;
+}
+
+/*****************************************************************************/
+
+static gchar *
+get_command_name (MMPortSerial *port,
+                  const GByteArray *command)
+{
+    gsize len;
+
+    /* Raw commands (e.g. SMS PDUs) aren't worth telling apart */
+    if (command->len < 2 || g_ascii_strncasecmp ((const gchar *) command->data, "AT", 2) != 0)
+        return g_strdup ("raw");
+
+    /* Skip the "AT" and leave out arguments, e.g. "+CPMS" for "AT+CPMS=\"SM\"" */
+    for (len = 2; len < command->len && len < 34; len++) {
+        if (strchr ("=?\r\n", command->data[len]))
+            break;
+    }
+
+    /* Plain "AT" */
+    if (len == 2)
+        return g_strdup ("AT");
+
+    return g_strndup ((const gchar *) &command->data[2], len - 2);
+}
+
 static void
 debug_log (MMPortSerial *port, const char *prefix, const char *buf, gsize len)
 {
@@ -498,7 +1241,7 @@ mm_port_serial_at_run_init_sequence (MMPortSerialAt *self)
     for (i = 0; self->priv->init_sequence[i]; i++) {
         mm_port_serial_at_command (self,
                                    self->priv->init_sequence[i],
-                                   3,
+                                   3000,
                                    FALSE,
                                    FALSE,
                                    NULL,
@@ -545,6 +1288,13 @@ mm_port_serial_at_init (MMPortSerialAt *self)
 
     /* By default, don't send line feed */
     self->priv->send_lf = FALSE;
+
+    g_mutex_init (&self->priv->lock);
+
+    self->priv->unsolicited_msg_index = g_hash_table_new_full (g_str_hash,
+                                                               g_str_equal,
+                                                               g_free,
+                                                               (GDestroyNotify) g_slist_free);
 }
 
 static void
@@ -569,6 +1319,9 @@ set_property (GObject *object,
     case PROP_SEND_LF:
         self->priv->send_lf = g_value_get_boolean (value);
         break;
+    case PROP_CONCAT_COMMANDS:
+        self->priv->concat_commands = g_value_get_boolean (value);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
         break;
@@ -596,6 +1349,9 @@ get_property (GObject *object,
     case PROP_SEND_LF:
         g_value_set_boolean (value, self->priv->send_lf);
         break;
+    case PROP_CONCAT_COMMANDS:
+        g_value_set_boolean (value, self->priv->concat_commands);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
         break;
@@ -607,6 +1363,8 @@ finalize (GObject *object)
 {
     MMPortSerialAt *self = MM_PORT_SERIAL_AT (object);
 
+    g_hash_table_destroy (self->priv->unsolicited_msg_index);
+
     while (self->priv->unsolicited_msg_handlers) {
         MMAtUnsolicitedMsgHandler *handler = (MMAtUnsolicitedMsgHandler *) self->priv->unsolicited_msg_handlers->data;
 
@@ -623,6 +1381,7 @@ finalize (GObject *object)
         self->priv->response_parser_notify (self->priv->response_parser_user_data);
 
     g_strfreev (self->priv->init_sequence);
+    g_mutex_clear (&self->priv->lock);
 
     G_OBJECT_CLASS (mm_port_serial_at_parent_class)->finalize (object);
 }
@@ -641,8 +1400,12 @@ mm_port_serial_at_class_init (MMPortSerialAtClass *klass)
     object_class->finalize = finalize;
 
     serial_class->parse_unsolicited = parse_unsolicited;
+    serial_class->collect_unsolicited = collect_unsolicited;
+    serial_class->dispatch_unsolicited = dispatch_unsolicited;
+    serial_class->free_unsolicited = (GDestroyNotify) unsolicited_msg_free;
     serial_class->parse_response = parse_response;
     serial_class->debug_log = debug_log;
+    serial_class->get_command_name = get_command_name;
     serial_class->config = config;
 
     g_object_class_install_property
@@ -676,4 +1439,12 @@ mm_port_serial_at_class_init (MMPortSerialAtClass *klass)
                                "Send line-feed at the end of each AT command sent",
                                FALSE,
                                G_PARAM_READWRITE));
+
+    g_object_class_install_property
+        (object_class, PROP_CONCAT_COMMANDS,
+         g_param_spec_boolean (MM_PORT_SERIAL_AT_CONCAT_COMMANDS,
+                               "Concatenate commands",
+                               "Independent queries may be sent together in a single command line",
+                               FALSE,
+                               G_PARAM_READWRITE));
 }
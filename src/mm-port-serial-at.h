@@ -65,6 +65,7 @@ typedef void (*MMPortSerialAtUnsolicitedMsgFn) (MMPortSerialAt *port,
 #define MM_PORT_SERIAL_AT_INIT_SEQUENCE_ENABLED "init-sequence-enabled"
 #define MM_PORT_SERIAL_AT_INIT_SEQUENCE         "init-sequence"
 #define MM_PORT_SERIAL_AT_SEND_LF               "send-lf"
+#define MM_PORT_SERIAL_AT_CONCAT_COMMANDS       "concat-commands"
 
 struct _MMPortSerialAt {
     MMPortSerial parent;
@@ -97,7 +98,7 @@ void     mm_port_serial_at_set_response_parser (MMPortSerialAt *self,
 
 void         mm_port_serial_at_command        (MMPortSerialAt *self,
                                                const char *command,
-                                               guint32 timeout_seconds,
+                                               guint32 timeout_ms,
                                                gboolean is_raw,
                                                gboolean allow_cached,
                                                GCancellable *cancellable,
@@ -107,6 +108,27 @@ const gchar *mm_port_serial_at_command_finish (MMPortSerialAt *self,
                                                GAsyncResult *res,
                                                GError **error);
 
+/* Run several independent queries in a single command line (e.g.
+ * "AT+CGMI;+CGMM;+CGMR") and split the reply back into one response per
+ * command. Only commands replying with a single line of information text
+ * are safe to be concatenated; if the reply can't be split unambiguously
+ * the operation fails and the commands should be sent one by one. When
+ * allow_cached is set, each response is also stored as the cached reply of
+ * its own command. */
+void     mm_port_serial_at_command_concat        (MMPortSerialAt *self,
+                                                  const gchar *const *commands,
+                                                  guint32 timeout_ms,
+                                                  gboolean allow_cached,
+                                                  GCancellable *cancellable,
+                                                  GAsyncReadyCallback callback,
+                                                  gpointer user_data);
+gchar  **mm_port_serial_at_command_concat_finish (MMPortSerialAt *self,
+                                                  GAsyncResult *res,
+                                                  GError **error);
+
+/* Whether the port was flagged as supporting concatenated commands */
+gboolean mm_port_serial_at_get_concat_commands (MMPortSerialAt *self);
+
 /*
  * Convert a string into a quoted and escaped string. Returns a new
  * allocated string. Follows ITU V.250 5.4.2.2 "String constants".
@@ -115,6 +137,10 @@ gchar   *mm_port_serial_at_quote_string (const char *string);
 
 /* Just for unit tests */
 void     mm_port_serial_at_remove_echo (GByteArray *response);
+gchar  **mm_port_serial_at_split_concat_response (const gchar *const *commands,
+                                                  const gchar *response,
+                                                  GError **error);
+gchar  **mm_port_serial_at_get_unsolicited_msg_prefixes (GRegex *regex);
 
 void     mm_port_serial_at_set_flags (MMPortSerialAt *self,
                                       MMPortSerialAtFlag flags);
@@ -13,6 +13,8 @@
  * Copyright (C) 2012 Aleksander Morgado <aleksander@gnu.org>
  */
 
+#define MM_LOG_MODULE MM_LOG_MODULE_SERIAL
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -70,31 +72,36 @@ remove_eval_cb (const GMatchInfo *match_info,
 
 static MMPortSerialResponseType
 parse_response (MMPortSerial *port,
-                GByteArray *response,
+                MMPortSerialBuffer *response,
                 GByteArray **parsed_response,
                 GError **error)
 {
     MMPortSerialGps *self = MM_PORT_SERIAL_GPS (port);
     gboolean matches;
     GMatchInfo *match_info;
+    const guint8 *data;
+    gsize len;
     gchar *str;
     gint result_len;
     guint i;
 
-    for (i = 0; i < response->len; i++) {
+    data = mm_port_serial_buffer_peek (response, &len);
+    for (i = 0; i < len; i++) {
         /* If there is any content before the first $,
          * assume it's garbage, and skip it */
-        if (response->data[i] == '$') {
-            if (i > 0)
-                g_byte_array_remove_range (response, 0, i);
+        if (data[i] == '$') {
+            if (i > 0) {
+                mm_port_serial_buffer_consume (response, i);
+                data = mm_port_serial_buffer_peek (response, &len);
+            }
             /* else, good, we're already started with $ */
             break;
         }
     }
 
     matches = g_regex_match_full (self->priv->known_traces_regex,
-                                  (const gchar *) response->data,
-                                  response->len,
+                                  (const gchar *) data,
+                                  len,
                                   0, 0, &match_info, NULL);
 
     if (self->priv->callback) {
@@ -116,15 +123,15 @@ parse_response (MMPortSerial *port,
         return MM_PORT_SERIAL_RESPONSE_NONE;
 
     /* Remove matches */
-    result_len = response->len;
+    result_len = len;
     str = g_regex_replace_eval (self->priv->known_traces_regex,
-                                (const char *) response->data,
-                                response->len,
+                                (const char *) data,
+                                len,
                                 0, 0,
                                 remove_eval_cb, &result_len, NULL);
 
     /* Cleanup response buffer */
-    g_byte_array_remove_range (response, 0, response->len);
+    mm_port_serial_buffer_consume (response, len);
 
     /* Build parsed response */
     *parsed_response = g_byte_array_new_take ((guint8 *)str, result_len);
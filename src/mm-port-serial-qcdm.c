@@ -14,6 +14,8 @@
  * Copyright (C) 2009 - 2010 Red Hat, Inc.
  */
 
+#define MM_LOG_MODULE MM_LOG_MODULE_SERIAL
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -24,103 +26,305 @@
 
 #include "mm-port-serial-qcdm.h"
 #include "libqcdm/src/com.h"
+#include "libqcdm/src/dm-commands.h"
 #include "libqcdm/src/utils.h"
 #include "libqcdm/src/errors.h"
 #include "mm-log.h"
 
 G_DEFINE_TYPE (MMPortSerialQcdm, mm_port_serial_qcdm, MM_TYPE_PORT_SERIAL)
 
+/* Biggest unescaped frame we accept, CRC included */
+#define QCDM_FRAME_MAX_SIZE 8192
+
+struct _MMPortSerialQcdmPrivate {
+    /* Log code or event id to MMQcdmFrameHandler */
+    GHashTable *log_handlers;
+    GHashTable *event_handlers;
+    /* Input is fed to the decoder as soon as it is received, so that it is
+     * never scanned twice. Once a frame ends, its status and contents are
+     * kept until processed, and no more input is decoded meanwhile. */
+    DmFrameDecoder decoder;
+    DmFrameStatus frame_status;
+    gsize frame_len;
+    guint8 frame[QCDM_FRAME_MAX_SIZE];
+};
+
+typedef struct {
+    GCallback callback;
+    gpointer user_data;
+    GDestroyNotify notify;
+} MMQcdmFrameHandler;
+
 /*****************************************************************************/
 
-static gboolean
-find_qcdm_start (GByteArray *response, gsize *start)
+static void
+frame_handler_free (MMQcdmFrameHandler *handler)
+{
+    if (handler->notify)
+        handler->notify (handler->user_data);
+    g_slice_free (MMQcdmFrameHandler, handler);
+}
+
+static void
+frame_handler_add (GHashTable *handlers,
+                   guint16 key,
+                   GCallback callback,
+                   gpointer user_data,
+                   GDestroyNotify notify)
+{
+    MMQcdmFrameHandler *handler;
+
+    handler = g_slice_new (MMQcdmFrameHandler);
+    handler->callback = callback;
+    handler->user_data = user_data;
+    handler->notify = notify;
+
+    /* We OVERWRITE any existing one, which gets its context data freed */
+    g_hash_table_replace (handlers, GUINT_TO_POINTER ((guint) key), handler);
+}
+
+void
+mm_port_serial_qcdm_add_log_handler (MMPortSerialQcdm *self,
+                                     guint16 log_code,
+                                     MMPortSerialQcdmLogFn callback,
+                                     gpointer user_data,
+                                     GDestroyNotify notify)
+{
+    g_return_if_fail (MM_IS_PORT_SERIAL_QCDM (self));
+
+    frame_handler_add (self->priv->log_handlers, log_code, (GCallback) callback, user_data, notify);
+}
+
+void
+mm_port_serial_qcdm_remove_log_handler (MMPortSerialQcdm *self,
+                                        guint16 log_code)
+{
+    g_return_if_fail (MM_IS_PORT_SERIAL_QCDM (self));
+
+    g_hash_table_remove (self->priv->log_handlers, GUINT_TO_POINTER ((guint) log_code));
+}
+
+void
+mm_port_serial_qcdm_add_event_handler (MMPortSerialQcdm *self,
+                                       guint16 event_id,
+                                       MMPortSerialQcdmEventFn callback,
+                                       gpointer user_data,
+                                       GDestroyNotify notify)
+{
+    g_return_if_fail (MM_IS_PORT_SERIAL_QCDM (self));
+
+    frame_handler_add (self->priv->event_handlers, event_id, (GCallback) callback, user_data, notify);
+}
+
+void
+mm_port_serial_qcdm_remove_event_handler (MMPortSerialQcdm *self,
+                                          guint16 event_id)
+{
+    g_return_if_fail (MM_IS_PORT_SERIAL_QCDM (self));
+
+    g_hash_table_remove (self->priv->event_handlers, GUINT_TO_POINTER ((guint) event_id));
+}
+
+static void
+dispatch_log (MMPortSerialQcdm *self,
+              const guint8 *frame,
+              gsize len)
+{
+    const DMCmdLog *log = (const DMCmdLog *) frame;
+    MMQcdmFrameHandler *handler;
+    guint16 log_code;
+
+    if (len < sizeof (DMCmdLog))
+        return;
+
+    log_code = GUINT16_FROM_LE (log->log_code);
+    handler = g_hash_table_lookup (self->priv->log_handlers, GUINT_TO_POINTER ((guint) log_code));
+    if (handler && handler->callback)
+        ((MMPortSerialQcdmLogFn) handler->callback) (self,
+                                                     log_code,
+                                                     GUINT64_FROM_LE (log->timestamp),
+                                                     log->data,
+                                                     len - sizeof (DMCmdLog),
+                                                     handler->user_data);
+}
+
+/* Event IDs are 12 bits; the upper bits of the field give the timestamp and
+ * payload sizes of each event in the report. */
+#define EVENT_ID_MASK              0x0FFF
+#define EVENT_PAYLOAD_LEN_SHIFT    13
+#define EVENT_PAYLOAD_LEN_MASK     0x03
+#define EVENT_PAYLOAD_LEN_EXTENDED 0x03
+#define EVENT_TIMESTAMP_TRUNCATED  0x8000
+
+static void
+dispatch_events (MMPortSerialQcdm *self,
+                 const guint8 *frame,
+                 gsize len)
 {
-    int i, last = -1;
-
-    /* Look for 3 bytes and a QCDM frame marker, ie enough data for a valid
-     * frame.  There will usually be three cases here; (1) a QCDM frame
-     * starting with data and terminated by 0x7E, and (2) a QCDM frame starting
-     * with 0x7E and ending with 0x7E, and (3) a non-QCDM frame that still
-     * uses HDLC framing (like Sierra CnS) that starts and ends with 0x7E.
-     */
-    for (i = 0; i < response->len; i++) {
-        if (response->data[i] == 0x7E) {
-            if (i > last + 3) {
-                /* Got a full QCDM frame; 3 non-0x7E bytes and a terminator */
-                if (start)
-                    *start = last + 1;
-                return TRUE;
-            }
-
-            /* Save position of the last QCDM frame marker */
-            last = i;
+    const guint8 *p;
+    const guint8 *end;
+    gsize report_len;
+
+    /* Command code, then length of all the events */
+    if (len < 3)
+        return;
+    report_len = frame[1] | (frame[2] << 8);
+    p = &frame[3];
+    end = p + MIN (report_len, len - 3);
+
+    while (p + 2 <= end) {
+        MMQcdmFrameHandler *handler;
+        guint16 field;
+        guint16 event_id;
+        gsize payload_len;
+
+        field = p[0] | (p[1] << 8);
+        event_id = field & EVENT_ID_MASK;
+        p += 2 + ((field & EVENT_TIMESTAMP_TRUNCATED) ? 2 : 8);
+
+        payload_len = (field >> EVENT_PAYLOAD_LEN_SHIFT) & EVENT_PAYLOAD_LEN_MASK;
+        if (payload_len == EVENT_PAYLOAD_LEN_EXTENDED) {
+            if (p >= end)
+                break;
+            payload_len = *p++;
         }
+        if (p + payload_len > end)
+            break;
+
+        handler = g_hash_table_lookup (self->priv->event_handlers, GUINT_TO_POINTER ((guint) event_id));
+        if (handler && handler->callback)
+            ((MMPortSerialQcdmEventFn) handler->callback) (self,
+                                                           event_id,
+                                                           p,
+                                                           payload_len,
+                                                           handler->user_data);
+        p += payload_len;
+    }
+}
+
+static gboolean
+process_unsolicited_frame (MMPortSerialQcdm *self,
+                           const guint8 *frame,
+                           gsize len)
+{
+    switch (frame[0]) {
+    case DIAG_CMD_LOG:
+        dispatch_log (self, frame, len);
+        return TRUE;
+    case DIAG_CMD_EVENT_REPORT:
+        /* The response to the command enabling event reports uses the same
+         * command code, but doesn't carry any event */
+        if (len <= sizeof (DMCmdEventReport))
+            return FALSE;
+        dispatch_events (self, frame, len);
+        return TRUE;
+    default:
+        return FALSE;
+    }
+}
+
+static DmFrameStatus
+decode_frame (MMPortSerialQcdm *self,
+              MMPortSerialBuffer *response)
+{
+    const guint8 *data;
+    gsize len;
+    gsize used = 0;
+    gsize frame_len = 0;
+
+    /* Don't overwrite a frame not yet processed */
+    if (self->priv->frame_status != DM_FRAME_NEED_MORE)
+        return self->priv->frame_status;
+
+    data = mm_port_serial_buffer_peek (response, &len);
+    if (len == 0)
+        return DM_FRAME_NEED_MORE;
+
+    /* The decoder keeps what it was given, so all the data it used can be
+     * removed from the buffer, even if the frame isn't complete yet. Anything
+     * after the end of the frame is left for the next one. */
+    self->priv->frame_status = dm_frame_decoder_feed (&self->priv->decoder,
+                                                      (const char *) data,
+                                                      len,
+                                                      &used,
+                                                      &frame_len);
+    if (self->priv->frame_status == DM_FRAME_NEED_MORE)
+        used = len;
+    mm_port_serial_buffer_consume (response, used);
+
+    self->priv->frame_len = frame_len;
+    return self->priv->frame_status;
+}
+
+static void
+frame_processed (MMPortSerialQcdm *self)
+{
+    /* The decoder already restarted itself at the end of the frame */
+    self->priv->frame_status = DM_FRAME_NEED_MORE;
+    self->priv->frame_len = 0;
+}
+
+static void
+buffer_cleared (MMPortSerial *port)
+{
+    MMPortSerialQcdm *self = MM_PORT_SERIAL_QCDM (port);
+
+    /* Neither a partial frame nor one not yet processed can be completed
+     * with whatever comes next */
+    dm_frame_decoder_reset (&self->priv->decoder);
+    frame_processed (self);
+}
+
+static void
+parse_unsolicited (MMPortSerial *port,
+                   MMPortSerialBuffer *response)
+{
+    MMPortSerialQcdm *self = MM_PORT_SERIAL_QCDM (port);
+
+    /* Log and event frames are never replies to our commands, so process
+     * them as soon as they are complete, whatever the command being
+     * processed. Stop at the first frame that isn't one of them. */
+    while (decode_frame (self, response) == DM_FRAME_READY) {
+        if (!process_unsolicited_frame (self, self->priv->frame, self->priv->frame_len))
+            return;
+        frame_processed (self);
     }
-    return FALSE;
 }
 
 static MMPortSerialResponseType
 parse_response (MMPortSerial *port,
-                GByteArray *response,
+                MMPortSerialBuffer *response,
                 GByteArray **parsed_response,
                 GError **error)
 {
-    gsize start = 0;
-    gsize used = 0;
-    gsize unescaped_len = 0;
-    guint8 *unescaped_buffer;
-    qcdmbool more = FALSE;
-
-    /* Get the offset into the buffer of where the QCDM frame starts */
-    if (!find_qcdm_start (response, &start)) {
-        /* Discard the unparsable data right away, we do need a QCDM
-         * start, and anything that comes before it is unknown data
-         * that we'll never use. */
-        return MM_PORT_SERIAL_RESPONSE_NONE;
-    }
+    MMPortSerialQcdm *self = MM_PORT_SERIAL_QCDM (port);
 
-    /* If there is anything before the start marker, remove it */
-    g_byte_array_remove_range (response, 0, start);
-    if (response->len == 0)
+    switch (decode_frame (self, response)) {
+    case DM_FRAME_NEED_MORE:
         return MM_PORT_SERIAL_RESPONSE_NONE;
-
-    /* Try to decapsulate the response into a buffer */
-    unescaped_buffer = g_malloc (1024);
-    if (!dm_decapsulate_buffer ((const char *)(response->data),
-                                response->len,
-                                (char *)unescaped_buffer,
-                                1024,
-                                &unescaped_len,
-                                &used,
-                                &more)) {
+    case DM_FRAME_INVALID:
         /* Report an error right away. Not being able to decapsulate a QCDM
          * packet once we got message start marker likely means that this
          * data that we got is not a QCDM message. */
+        frame_processed (self);
         g_set_error (error,
                      MM_SERIAL_ERROR,
                      MM_SERIAL_ERROR_PARSE_FAILED,
                      "Failed to unescape QCDM packet");
-        g_free (unescaped_buffer);
         return MM_PORT_SERIAL_RESPONSE_ERROR;
+    case DM_FRAME_READY:
+        break;
     }
 
-    if (more) {
-        /* Need more data, we leave the original byte array untouched so that
-         * we can retry later when more data arrives. */
-        g_free (unescaped_buffer);
-        return MM_PORT_SERIAL_RESPONSE_NONE;
-    }
+    /* Successfully decapsulated the DM command */
+    *parsed_response = g_byte_array_sized_new (self->priv->frame_len);
+    g_byte_array_append (*parsed_response, self->priv->frame, self->priv->frame_len);
+    frame_processed (self);
 
-    /* Successfully decapsulated the DM command. We'll build a new byte array
-     * with the response, and leave the input buffer cleaned up. */
-    g_assert (unescaped_len <= 1024);
-    unescaped_buffer = g_realloc (unescaped_buffer, unescaped_len);
-    *parsed_response = g_byte_array_new_take (unescaped_buffer, unescaped_len);
+    /* Don't let any log packet already received after the response wait
+     * until more data arrives */
+    parse_unsolicited (port, response);
 
-    /* Remove the data we used from the input buffer, leaving out any
-     * additional data that may already been received (e.g. from the following
-     * message). */
-    g_byte_array_remove_range (response, 0, used);
     return MM_PORT_SERIAL_RESPONSE_BUFFER;
 }
 
@@ -157,7 +361,7 @@ serial_command_ready (MMPortSerial *port,
 void
 mm_port_serial_qcdm_command (MMPortSerialQcdm *self,
                              GByteArray *command,
-                             guint32 timeout_seconds,
+                             guint32 timeout_ms,
                              GCancellable *cancellable,
                              GAsyncReadyCallback callback,
                              gpointer user_data)
@@ -175,7 +379,7 @@ mm_port_serial_qcdm_command (MMPortSerialQcdm *self,
     /* 'command' is expected to be already CRC-ed and escaped */
     mm_port_serial_command (MM_PORT_SERIAL (self),
                             command,
-                            timeout_seconds,
+                            timeout_ms,
                             FALSE, /* never cached */
                             cancellable,
                             (GAsyncReadyCallback)serial_command_ready,
@@ -250,15 +454,44 @@ mm_port_serial_qcdm_new_fd (int fd)
 static void
 mm_port_serial_qcdm_init (MMPortSerialQcdm *self)
 {
+    self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, MM_TYPE_PORT_SERIAL_QCDM, MMPortSerialQcdmPrivate);
+
+    self->priv->log_handlers = g_hash_table_new_full (g_direct_hash,
+                                                      g_direct_equal,
+                                                      NULL,
+                                                      (GDestroyNotify) frame_handler_free);
+    self->priv->event_handlers = g_hash_table_new_full (g_direct_hash,
+                                                        g_direct_equal,
+                                                        NULL,
+                                                        (GDestroyNotify) frame_handler_free);
+    dm_frame_decoder_init (&self->priv->decoder, (char *) self->priv->frame, sizeof (self->priv->frame));
+    self->priv->frame_status = DM_FRAME_NEED_MORE;
+}
+
+static void
+finalize (GObject *object)
+{
+    MMPortSerialQcdm *self = MM_PORT_SERIAL_QCDM (object);
+
+    g_hash_table_destroy (self->priv->log_handlers);
+    g_hash_table_destroy (self->priv->event_handlers);
+
+    G_OBJECT_CLASS (mm_port_serial_qcdm_parent_class)->finalize (object);
 }
 
 static void
 mm_port_serial_qcdm_class_init (MMPortSerialQcdmClass *klass)
 {
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
     MMPortSerialClass *port_class = MM_PORT_SERIAL_CLASS (klass);
 
+    g_type_class_add_private (object_class, sizeof (MMPortSerialQcdmPrivate));
+
     /* Virtual methods */
+    object_class->finalize = finalize;
+    port_class->parse_unsolicited = parse_unsolicited;
     port_class->parse_response = parse_response;
+    port_class->buffer_cleared = buffer_cleared;
     port_class->config_fd = config_fd;
     port_class->debug_log = debug_log;
 }
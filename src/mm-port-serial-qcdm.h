@@ -31,9 +31,24 @@
 
 typedef struct _MMPortSerialQcdm MMPortSerialQcdm;
 typedef struct _MMPortSerialQcdmClass MMPortSerialQcdmClass;
+typedef struct _MMPortSerialQcdmPrivate MMPortSerialQcdmPrivate;
+
+typedef void (*MMPortSerialQcdmLogFn) (MMPortSerialQcdm *port,
+                                       guint16 log_code,
+                                       guint64 timestamp,
+                                       const guint8 *data,
+                                       gsize data_len,
+                                       gpointer user_data);
+
+typedef void (*MMPortSerialQcdmEventFn) (MMPortSerialQcdm *port,
+                                         guint16 event_id,
+                                         const guint8 *data,
+                                         gsize data_len,
+                                         gpointer user_data);
 
 struct _MMPortSerialQcdm {
     MMPortSerial parent;
+    MMPortSerialQcdmPrivate *priv;
 };
 
 struct _MMPortSerialQcdmClass {
@@ -47,7 +62,7 @@ MMPortSerialQcdm *mm_port_serial_qcdm_new_fd (int fd);
 
 void        mm_port_serial_qcdm_command        (MMPortSerialQcdm *self,
                                                 GByteArray *command,
-                                                guint32 timeout_seconds,
+                                                guint32 timeout_ms,
                                                 GCancellable *cancellable,
                                                 GAsyncReadyCallback callback,
                                                 gpointer user_data);
@@ -55,4 +70,21 @@ GByteArray *mm_port_serial_qcdm_command_finish (MMPortSerialQcdm *self,
                                                 GAsyncResult *res,
                                                 GError **error);
 
+/* Handlers for unsolicited log packets and events; logging of the given items
+ * must be enabled in the device with the corresponding QCDM commands. */
+void        mm_port_serial_qcdm_add_log_handler      (MMPortSerialQcdm *self,
+                                                      guint16 log_code,
+                                                      MMPortSerialQcdmLogFn callback,
+                                                      gpointer user_data,
+                                                      GDestroyNotify notify);
+void        mm_port_serial_qcdm_remove_log_handler   (MMPortSerialQcdm *self,
+                                                      guint16 log_code);
+void        mm_port_serial_qcdm_add_event_handler    (MMPortSerialQcdm *self,
+                                                      guint16 event_id,
+                                                      MMPortSerialQcdmEventFn callback,
+                                                      gpointer user_data,
+                                                      GDestroyNotify notify);
+void        mm_port_serial_qcdm_remove_event_handler (MMPortSerialQcdm *self,
+                                                      guint16 event_id);
+
 #endif /* MM_PORT_SERIAL_QCDM_H */
@@ -15,6 +15,7 @@
  */
 
 #define _GNU_SOURCE  /* for strcasestr() */
+#define MM_LOG_MODULE MM_LOG_MODULE_SERIAL
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -34,6 +35,7 @@
 #include <mm-errors-types.h>
 
 #include "mm-port-serial.h"
+#include "mm-main-loop-profiler.h"
 #include "mm-log.h"
 
 static gboolean port_serial_queue_process          (gpointer data);
@@ -44,6 +46,11 @@ static void     port_serial_reopen_cancel          (MMPortSerial *self);
 static void     port_serial_set_cached_reply       (MMPortSerial *self,
                                                     const GByteArray *command,
                                                     const GByteArray *response);
+static void     port_serial_got_response           (MMPortSerial *self,
+                                                    GByteArray   *parsed_response,
+                                                    const GError *error);
+static void     parse_response_buffer              (MMPortSerial *self);
+static gboolean port_serial_deliver_worker_response (MMPortSerial *self);
 
 G_DEFINE_TYPE (MMPortSerial, mm_port_serial, MM_TYPE_PORT)
 
@@ -74,13 +81,19 @@ static guint signals[LAST_SIGNAL] = { 0 };
 
 #define SERIAL_BUF_SIZE 2048
 
+struct _MMPortSerialBuffer {
+    GByteArray *data;
+    /* Offset of the first unconsumed byte in 'data' */
+    gsize head;
+};
+
 struct _MMPortSerialPrivate {
     guint32 open_count;
     gboolean forced_close;
     int fd;
     GHashTable *reply_cache;
     GQueue *queue;
-    GByteArray *response;
+    MMPortSerialBuffer response;
 
     /* For real ports, iochannel, and we implement the eagain limit */
     GIOChannel *iochannel;
@@ -113,8 +126,114 @@ struct _MMPortSerialPrivate {
 
     gpointer flash_ctx;
     gpointer reopen_ctx;
+
+    /* Paced writer, for ports with a send delay */
+    gpointer writer;
+    GThread *writer_thread;
+
+    /* Input read by the I/O worker */
+    GSource *worker_source;
+    gpointer worker_input;
+    /* Responses parsed by the I/O worker while a command was being written */
+    GQueue *worker_responses;
+
+    /* Delays of the I/O worker input until processed in the main context */
+    guint worker_dispatch_count;
+    guint64 worker_dispatch_total;
+    guint64 worker_dispatch_max;
+
+    /* Command name to CommandStats */
+    GHashTable *command_stats;
 };
 
+/*****************************************************************************/
+/* Response buffer */
+
+const guint8 *
+mm_port_serial_buffer_peek (const MMPortSerialBuffer *buffer,
+                            gsize *len)
+{
+    g_assert (buffer->head <= buffer->data->len);
+
+    if (len)
+        *len = buffer->data->len - buffer->head;
+    return buffer->data->data + buffer->head;
+}
+
+gsize
+mm_port_serial_buffer_get_len (const MMPortSerialBuffer *buffer)
+{
+    return buffer->data->len - buffer->head;
+}
+
+void
+mm_port_serial_buffer_consume (MMPortSerialBuffer *buffer,
+                               gsize len)
+{
+    g_return_if_fail (len <= buffer->data->len - buffer->head);
+
+    buffer->head += len;
+
+    /* Fully consumed? Then rewind for free */
+    if (buffer->head == buffer->data->len) {
+        g_byte_array_set_size (buffer->data, 0);
+        buffer->head = 0;
+    }
+}
+
+void
+mm_port_serial_buffer_replace (MMPortSerialBuffer *buffer,
+                               const guint8 *data,
+                               gsize len)
+{
+    /* Contents must not come from the buffer itself */
+    g_byte_array_set_size (buffer->data, 0);
+    buffer->head = 0;
+    if (len)
+        g_byte_array_append (buffer->data, data, len);
+}
+
+static void
+buffer_compact (MMPortSerialBuffer *buffer)
+{
+    if (buffer->head == 0)
+        return;
+
+    g_byte_array_remove_range (buffer->data, 0, buffer->head);
+    buffer->head = 0;
+}
+
+static void
+buffer_append (MMPortSerialBuffer *buffer,
+               const guint8 *data,
+               gsize len)
+{
+    /* Only move the pending data to the start of the storage once the consumed
+     * area is at least as big as the pending data itself; this keeps the cost
+     * of compacting linear in the amount of data read. */
+    if (buffer->head > 0 && buffer->head >= (buffer->data->len - buffer->head))
+        buffer_compact (buffer);
+
+    g_byte_array_append (buffer->data, data, len);
+}
+
+static void
+buffer_clear (MMPortSerialBuffer *buffer)
+{
+    g_byte_array_set_size (buffer->data, 0);
+    buffer->head = 0;
+}
+
+/* Drops any partially received response, along with whatever parsing state
+ * the subclass keeps across reads */
+static void
+port_serial_response_clear (MMPortSerial *self)
+{
+    buffer_clear (&self->priv->response);
+    if (MM_PORT_SERIAL_GET_CLASS (self)->buffer_cleared)
+        MM_PORT_SERIAL_GET_CLASS (self)->buffer_cleared (self);
+}
+
 /*****************************************************************************/
 /* Command */
 
@@ -123,12 +242,13 @@ typedef struct {
     GSimpleAsyncResult *result;
     GCancellable *cancellable;
     GByteArray *command;
-    guint32 timeout;
+    guint32 timeout_ms;
     gboolean allow_cached;
     guint32 eagain_count;
 
     guint32 idx;
     gboolean started;
+    gint64 start_time;
     gboolean done;
 } CommandContext;
 
@@ -161,7 +281,7 @@ mm_port_serial_command_finish (MMPortSerial *self,
 void
 mm_port_serial_command (MMPortSerial *self,
                         GByteArray *command,
-                        guint32 timeout_seconds,
+                        guint32 timeout_ms,
                         gboolean allow_cached,
                         GCancellable *cancellable,
                         GAsyncReadyCallback callback,
@@ -181,7 +301,7 @@ mm_port_serial_command (MMPortSerial *self,
                                              mm_port_serial_command);
     ctx->command = g_byte_array_ref (command);
     ctx->allow_cached = allow_cached;
-    ctx->timeout = timeout_seconds;
+    ctx->timeout_ms = timeout_ms;
     ctx->cancellable = (cancellable ? g_object_ref (cancellable) : NULL);
 
     /* Only accept about 3 seconds of EAGAIN for this command */
@@ -209,6 +329,123 @@ mm_port_serial_command (MMPortSerial *self,
         port_serial_schedule_queue_process (self, 0);
 }
 
+/*****************************************************************************/
+/* Command latency statistics
+ *
+ * Latencies from the first byte sent to the final response are recorded per
+ * port and command name, so that timeouts can be tuned per modem family.
+ * They live as long as the port object does, so that a device name reused by
+ * a different modem never gets the histograms of the previous one.
+ */
+
+/* Upper bounds of the latency histogram buckets, in milliseconds; an
+ * additional last bucket gets everything above */
+static const guint32 latency_bucket_bounds[] = {
+    10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 30000
+};
+
+#define N_LATENCY_BUCKETS (G_N_ELEMENTS (latency_bucket_bounds) + 1)
+
+typedef struct {
+    guint32 count;
+    guint32 timeouts;
+    guint64 total_ms;
+    guint32 max_ms;
+    guint32 buckets[N_LATENCY_BUCKETS];
+} CommandStats;
+
+static gchar *
+port_serial_get_command_name (MMPortSerial *self,
+                              const GByteArray *command)
+{
+    if (MM_PORT_SERIAL_GET_CLASS (self)->get_command_name)
+        return MM_PORT_SERIAL_GET_CLASS (self)->get_command_name (self, command);
+
+    /* Binary protocols are identified by their leading command code */
+    return (command->len > 0 ? g_strdup_printf ("0x%02x", command->data[0]) : g_strdup ("none"));
+}
+
+static void
+command_stats_record (MMPortSerial *self,
+                      CommandContext *ctx,
+                      const GError *error)
+{
+    CommandStats *stats;
+    gchar *name;
+    guint32 elapsed_ms;
+    guint i;
+
+    /* Cached replies and commands never sent don't count */
+    if (!ctx->started)
+        return;
+
+    /* Neither do cancelled ones, as nothing is known about the reply */
+    if (g_error_matches (error, MM_CORE_ERROR, MM_CORE_ERROR_CANCELLED))
+        return;
+
+    name = port_serial_get_command_name (self, ctx->command);
+    stats = g_hash_table_lookup (self->priv->command_stats, name);
+    if (!stats) {
+        stats = g_new0 (CommandStats, 1);
+        g_hash_table_insert (self->priv->command_stats, name, stats);
+    } else
+        g_free (name);
+
+    if (g_error_matches (error, MM_SERIAL_ERROR, MM_SERIAL_ERROR_RESPONSE_TIMEOUT)) {
+        stats->timeouts++;
+        return;
+    }
+
+    elapsed_ms = (guint32) ((g_get_monotonic_time () - ctx->start_time) / 1000);
+    stats->count++;
+    stats->total_ms += elapsed_ms;
+    stats->max_ms = MAX (stats->max_ms, elapsed_ms);
+    for (i = 0; i < G_N_ELEMENTS (latency_bucket_bounds); i++) {
+        if (elapsed_ms < latency_bucket_bounds[i])
+            break;
+    }
+    stats->buckets[i]++;
+}
+
+GVariant *
+mm_port_serial_get_command_stats_bounds (void)
+{
+    return g_variant_new_fixed_array (G_VARIANT_TYPE_UINT32,
+                                      latency_bucket_bounds,
+                                      G_N_ELEMENTS (latency_bucket_bounds),
+                                      sizeof (guint32));
+}
+
+void
+mm_port_serial_get_command_stats (MMPortSerial *self,
+                                  const gchar *modem_path,
+                                  GVariantBuilder *builder)
+{
+    GHashTableIter iter;
+    gpointer name;
+    gpointer value;
+
+    g_return_if_fail (MM_IS_PORT_SERIAL (self));
+
+    g_hash_table_iter_init (&iter, self->priv->command_stats);
+    while (g_hash_table_iter_next (&iter, &name, &value)) {
+        const CommandStats *stats = value;
+
+        g_variant_builder_add (builder, "(sssuutu@au)",
+                               modem_path,
+                               mm_port_get_device (MM_PORT (self)),
+                               (const gchar *) name,
+                               stats->count,
+                               stats->timeouts,
+                               stats->total_ms,
+                               stats->max_ms,
+                               g_variant_new_fixed_array (G_VARIANT_TYPE_UINT32,
+                                                          stats->buckets,
+                                                          N_LATENCY_BUCKETS,
+                                                          sizeof (guint32)));
+    }
+}
+
 /*****************************************************************************/
 
 #if 0
@@ -522,19 +759,19 @@ serial_debug (MMPortSerial *self, const char *prefix, const char *buf, gsize len
 {
     g_return_if_fail (len > 0);
 
+    /* Don't bother escaping the traffic if it won't be logged */
+    if (!mm_log_enabled (LOGL_DEBUG, MM_LOG_MODULE))
+        return;
+
     if (MM_PORT_SERIAL_GET_CLASS (self)->debug_log)
         MM_PORT_SERIAL_GET_CLASS (self)->debug_log (self, prefix, buf, len);
 }
 
 static gboolean
-port_serial_process_command (MMPortSerial *self,
-                             CommandContext *ctx,
-                             GError **error)
+port_serial_start_command (MMPortSerial *self,
+                           CommandContext *ctx,
+                           GError **error)
 {
-    const gchar *p;
-    gsize written;
-    gssize send_len;
-
     if (self->priv->iochannel == NULL && self->priv->socket == NULL) {
         g_set_error_literal (error, MM_SERIAL_ERROR, MM_SERIAL_ERROR_SEND_FAILED,
                              "Sending command failed: device is not enabled");
@@ -550,18 +787,28 @@ port_serial_process_command (MMPortSerial *self,
     /* Only print command the first time */
     if (ctx->started == FALSE) {
         ctx->started = TRUE;
+        ctx->start_time = g_get_monotonic_time ();
         serial_debug (self, "-->", (const char *) ctx->command->data, ctx->command->len);
     }
 
-    if (self->priv->send_delay == 0 || mm_port_get_subsys (MM_PORT (self)) != MM_PORT_SUBSYS_TTY) {
-        /* Send the whole command in one write */
-        send_len = (gssize)ctx->command->len;
-        p = (gchar *)ctx->command->data;
-    } else {
-        /* Send just one byte of the command */
-        send_len = 1;
-        p = (gchar *)&ctx->command->data[ctx->idx];
-    }
+    return TRUE;
+}
+
+static gboolean
+port_serial_process_command (MMPortSerial *self,
+                             CommandContext *ctx,
+                             GError **error)
+{
+    const gchar *p;
+    gsize written;
+    gssize send_len;
+
+    if (!port_serial_start_command (self, ctx, error))
+        return FALSE;
+
+    /* Send whatever is left of the command in one write */
+    send_len = (gssize)(ctx->command->len - ctx->idx);
+    p = (gchar *)&ctx->command->data[ctx->idx];
 
     /* GIOChannel based setup */
     if (self->priv->iochannel) {
@@ -647,6 +894,165 @@ port_serial_process_command (MMPortSerial *self,
     return TRUE;
 }
 
+/*****************************************************************************/
+/* Paced writer
+ *
+ * Ports with a send delay get their commands written one byte at a time,
+ * waiting send_delay microseconds between bytes. That is done in a dedicated
+ * thread, so that the main loop isn't woken up once per byte and so that
+ * input keeps on being read while the command is being written.
+ */
+
+static void port_serial_command_sent (MMPortSerial *self,
+                                      CommandContext *ctx);
+
+typedef struct {
+    MMPortSerial *self;
+    GByteArray *command;
+    int fd;
+    guint64 send_delay;
+    guint32 eagain_count;
+    volatile gint cancelled;
+
+    /* Output */
+    guint32 written;
+    gint write_errno;
+    gboolean eagain_exhausted;
+} PacedWriter;
+
+static gboolean
+paced_writer_done (PacedWriter *writer)
+{
+    MMPortSerial *self = writer->self;
+    CommandContext *ctx;
+    GError *error = NULL;
+
+    /* If the writer was stopped, the port is closed and the command gone */
+    if (self->priv->writer != writer)
+        goto out;
+
+    g_thread_join (self->priv->writer_thread);
+    self->priv->writer_thread = NULL;
+    self->priv->writer = NULL;
+
+    ctx = (CommandContext *) g_queue_peek_head (self->priv->queue);
+    g_assert (ctx != NULL);
+    ctx->idx = writer->written;
+
+    if (writer->eagain_exhausted) {
+        /* If we reach the limit of EAGAIN errors, treat as a timeout error. */
+        self->priv->n_consecutive_timeouts++;
+        g_signal_emit (self, signals[TIMED_OUT], 0, self->priv->n_consecutive_timeouts);
+        error = g_error_new (MM_SERIAL_ERROR, MM_SERIAL_ERROR_SEND_FAILED,
+                             "Sending command failed: '%s'", g_strerror (EAGAIN));
+    } else if (writer->write_errno)
+        error = g_error_new (MM_SERIAL_ERROR, MM_SERIAL_ERROR_SEND_FAILED,
+                             "Sending command failed: '%s'", g_strerror (writer->write_errno));
+
+    if (error) {
+        port_serial_got_response (self, NULL, error);
+        g_error_free (error);
+        goto out;
+    }
+
+    ctx->done = TRUE;
+    port_serial_command_sent (self, ctx);
+
+    /* The reply may already be in the buffer, read while writing */
+    if (self->priv->timeout_id)
+        parse_response_buffer (self);
+
+out:
+    g_byte_array_unref (writer->command);
+    g_object_unref (writer->self);
+    g_slice_free (PacedWriter, writer);
+    return G_SOURCE_REMOVE;
+}
+
+static gpointer
+paced_writer_thread (PacedWriter *writer)
+{
+    gint64 next;
+
+    next = g_get_monotonic_time ();
+    while (writer->written < writer->command->len && !g_atomic_int_get (&writer->cancelled)) {
+        gint64 now;
+        gssize n;
+
+        /* Wait until the next byte is due */
+        now = g_get_monotonic_time ();
+        if (next > now)
+            g_usleep (next - now);
+        next = MAX (next, now) + writer->send_delay;
+
+        n = write (writer->fd, &writer->command->data[writer->written], 1);
+        if (n == 1) {
+            writer->written++;
+            continue;
+        }
+
+        if (n < 0 && errno != EAGAIN && errno != EINTR) {
+            writer->write_errno = errno;
+            break;
+        }
+
+        /* Nothing written, just retry */
+        if (--writer->eagain_count == 0) {
+            writer->eagain_exhausted = TRUE;
+            break;
+        }
+    }
+
+    /* Report back in the main context */
+    g_idle_add ((GSourceFunc) paced_writer_done, writer);
+    return NULL;
+}
+
+static gboolean
+port_serial_writer_start (MMPortSerial *self,
+                          CommandContext *ctx,
+                          GError **error)
+{
+    PacedWriter *writer;
+
+    g_assert (self->priv->writer == NULL);
+
+    if (!port_serial_start_command (self, ctx, error))
+        return FALSE;
+
+    writer = g_slice_new0 (PacedWriter);
+    writer->self = g_object_ref (self);
+    writer->command = g_byte_array_ref (ctx->command);
+    writer->fd = self->priv->fd;
+    writer->send_delay = self->priv->send_delay;
+    writer->eagain_count = ctx->eagain_count;
+    writer->written = ctx->idx;
+
+    self->priv->writer = writer;
+    self->priv->writer_thread = g_thread_new ("serial-writer",
+                                              (GThreadFunc) paced_writer_thread,
+                                              writer);
+    return TRUE;
+}
+
+static void
+port_serial_writer_stop (MMPortSerial *self)
+{
+    PacedWriter *writer = self->priv->writer;
+
+    if (!writer)
+        return;
+
+    /* Wait for the thread to stop using the fd; the writer itself is freed
+     * when its completion is processed in the main context */
+    g_atomic_int_set (&writer->cancelled, TRUE);
+    g_thread_join (self->priv->writer_thread);
+    self->priv->writer_thread = NULL;
+    self->priv->writer = NULL;
+}
+
+/*****************************************************************************/
+
 static void
 port_serial_set_cached_reply (MMPortSerial *self,
                               const GByteArray *command,
@@ -667,6 +1073,17 @@ port_serial_set_cached_reply (MMPortSerial *self,
         g_hash_table_remove (self->priv->reply_cache, command);
 }
 
+void
+mm_port_serial_set_cached_reply (MMPortSerial *self,
+                                 const GByteArray *command,
+                                 const GByteArray *response)
+{
+    g_return_if_fail (MM_IS_PORT_SERIAL (self));
+    g_return_if_fail (response != NULL);
+
+    port_serial_set_cached_reply (self, command, response);
+}
+
 static const GByteArray *
 port_serial_get_cached_reply (MMPortSerial *self,
                               GByteArray *command)
@@ -691,6 +1108,7 @@ port_serial_schedule_queue_process (MMPortSerial *self, guint timeout_ms)
         self->priv->queue_id = g_timeout_add (timeout_ms, port_serial_queue_process, self);
     else
         self->priv->queue_id = g_idle_add (port_serial_queue_process, self);
+    g_source_set_name_by_id (self->priv->queue_id, "serial port command queue");
 }
 
 static void
@@ -719,6 +1137,8 @@ port_serial_got_response (MMPortSerial *self,
 
     ctx = (CommandContext *) g_queue_pop_head (self->priv->queue);
     if (ctx) {
+        command_stats_record (self, ctx, error);
+
         /* Complete the command context with the appropriate result */
         if (error)
             g_simple_async_result_set_from_error (ctx->result, error);
@@ -745,6 +1165,8 @@ port_serial_timed_out (gpointer data)
     MMPortSerial *self = MM_PORT_SERIAL (data);
     GError *error;
 
+    mm_main_loop_profiler_source_dispatched ();
+
     self->priv->timeout_id = 0;
 
     /* Update number of consecutive timeouts found */
@@ -792,6 +1214,8 @@ port_serial_queue_process (gpointer data)
     CommandContext *ctx;
     GError *error = NULL;
 
+    mm_main_loop_profiler_source_dispatched ();
+
     self->priv->queue_id = 0;
 
     ctx = (CommandContext *) g_queue_peek_head (self->priv->queue);
@@ -815,6 +1239,17 @@ port_serial_queue_process (gpointer data)
         /* Cached reply wasn't found, keep on */
     }
 
+    /* TTYs with a send delay get the command written by the paced writer */
+    if (self->priv->send_delay > 0 &&
+        mm_port_get_subsys (MM_PORT (self)) == MM_PORT_SUBSYS_TTY &&
+        self->priv->iochannel) {
+        if (!port_serial_writer_start (self, ctx, &error)) {
+            port_serial_got_response (self, NULL, error);
+            g_error_free (error);
+        }
+        return G_SOURCE_REMOVE;
+    }
+
     /* If error, report it */
     if (!port_serial_process_command (self, ctx, &error)) {
         port_serial_got_response (self, NULL, error);
@@ -822,15 +1257,22 @@ port_serial_queue_process (gpointer data)
         return G_SOURCE_REMOVE;
     }
 
-    /* Schedule the next byte of the command to be sent */
+    /* Schedule sending the rest of the command, if it was partially written */
     if (!ctx->done) {
-        port_serial_schedule_queue_process (self,
-                                            (mm_port_get_subsys (MM_PORT (self)) == MM_PORT_SUBSYS_TTY ?
-                                             self->priv->send_delay / 1000 :
-                                             0));
+        port_serial_schedule_queue_process (self, 0);
         return G_SOURCE_REMOVE;
     }
 
+    port_serial_command_sent (self, ctx);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+port_serial_command_sent (MMPortSerial *self,
+                          CommandContext *ctx)
+{
+    GError *error;
+
     /* Setup the cancellable so that we can stop waiting for a response */
     if (ctx->cancellable) {
         self->priv->cancellable = g_object_ref (ctx->cancellable);
@@ -845,20 +1287,21 @@ port_serial_queue_process (gpointer data)
                                  "Won't wait for the reply");
             port_serial_got_response (self, NULL, error);
             g_error_free (error);
-            return G_SOURCE_REMOVE;
+            return;
         }
     }
 
     /* If the command is finished being sent, schedule the timeout */
-    self->priv->timeout_id = g_timeout_add_seconds (ctx->timeout,
-                                                    port_serial_timed_out,
-                                                    self);
-    return G_SOURCE_REMOVE;
+    self->priv->timeout_id = g_timeout_add (ctx->timeout_ms,
+                                            port_serial_timed_out,
+                                            self);
+    g_source_set_name_by_id (self->priv->timeout_id, "serial port command timeout");
 }
 
 static void
 parse_response_buffer (MMPortSerial *self)
 {
+    CommandContext *ctx;
     GError *error = NULL;
     GByteArray *parsed_response = NULL;
 
@@ -869,7 +1312,16 @@ parse_response_buffer (MMPortSerial *self)
      */
     if (MM_PORT_SERIAL_GET_CLASS (self)->parse_unsolicited)
         MM_PORT_SERIAL_GET_CLASS (self)->parse_unsolicited (self,
-                                                            self->priv->response);
+                                                            &self->priv->response);
+
+    /* Replies can't be expected while the command is still being written */
+    ctx = (CommandContext *) g_queue_peek_head (self->priv->queue);
+    if (ctx && ctx->started && !ctx->done)
+        return;
+
+    /* Replies already parsed by the I/O worker go first */
+    if (port_serial_deliver_worker_response (self))
+        return;
 
     /* Parse response in the subclass.
      *
@@ -879,7 +1331,7 @@ parse_response_buffer (MMPortSerial *self)
      */
     g_assert (MM_PORT_SERIAL_GET_CLASS (self)->parse_response != NULL);
     switch (MM_PORT_SERIAL_GET_CLASS (self)->parse_response (self,
-                                                             self->priv->response,
+                                                             &self->priv->response,
                                                              &parsed_response,
                                                              &error)) {
     case MM_PORT_SERIAL_RESPONSE_BUFFER:
@@ -902,6 +1354,26 @@ parse_response_buffer (MMPortSerial *self)
     }
 }
 
+static void
+port_serial_input_received (MMPortSerial *self,
+                            const gchar *buf,
+                            gsize len)
+{
+    serial_debug (self, "<--", buf, len);
+    buffer_append (&self->priv->response, (const guint8 *) buf, len);
+
+    /* Make sure the response doesn't grow too long */
+    if ((mm_port_serial_buffer_get_len (&self->priv->response) > SERIAL_BUF_SIZE) && self->priv->spew_control) {
+        /* Notify listeners with just the pending data and then trim the buffer */
+        buffer_compact (&self->priv->response);
+        g_signal_emit (self, signals[BUFFER_FULL], 0, self->priv->response.data);
+        mm_port_serial_buffer_consume (&self->priv->response, (SERIAL_BUF_SIZE / 2));
+    }
+
+    /* See if we can parse anything */
+    parse_response_buffer (self);
+}
+
 static gboolean
 common_input_available (MMPortSerial *self,
                         GIOCondition condition)
@@ -909,7 +1381,6 @@ common_input_available (MMPortSerial *self,
     char buf[SERIAL_BUF_SIZE + 1];
     gsize bytes_read;
     GIOStatus status = G_IO_STATUS_NORMAL;
-    CommandContext *ctx;
     const char *device;
     GError *error = NULL;
 
@@ -917,23 +1388,16 @@ common_input_available (MMPortSerial *self,
         device = mm_port_get_device (MM_PORT (self));
         mm_dbg ("(%s) unexpected port hangup!", device);
 
-        if (self->priv->response->len)
-            g_byte_array_remove_range (self->priv->response, 0, self->priv->response->len);
+        port_serial_response_clear (self);
         port_serial_close_force (self);
         return FALSE;
     }
 
     if (condition & G_IO_ERR) {
-        if (self->priv->response->len)
-            g_byte_array_remove_range (self->priv->response, 0, self->priv->response->len);
+        port_serial_response_clear (self);
         return TRUE;
     }
 
-    /* Don't read any input if the current command isn't done being sent yet */
-    ctx = g_queue_peek_nth (self->priv->queue, 0);
-    if (ctx && (ctx->started == TRUE) && (ctx->done == FALSE))
-        return TRUE;
-
     do {
         bytes_read = 0;
 
@@ -976,18 +1440,7 @@ common_input_available (MMPortSerial *self,
             break;
 
         g_assert (bytes_read > 0);
-        serial_debug (self, "<--", buf, bytes_read);
-        g_byte_array_append (self->priv->response, (const guint8 *) buf, bytes_read);
-
-        /* Make sure the response doesn't grow too long */
-        if ((self->priv->response->len > SERIAL_BUF_SIZE) && self->priv->spew_control) {
-            /* Notify listeners and then trim the buffer */
-            g_signal_emit (self, signals[BUFFER_FULL], 0, self->priv->response);
-            g_byte_array_remove_range (self->priv->response, 0, (SERIAL_BUF_SIZE / 2));
-        }
-
-        /* See if we can parse anything */
-        parse_response_buffer (self);
+        port_serial_input_received (self, buf, bytes_read);
 
     } while (   (bytes_read == SERIAL_BUF_SIZE || status == G_IO_STATUS_AGAIN)
              && (self->priv->iochannel_id > 0 || self->priv->socket_source != NULL));
@@ -1000,6 +1453,7 @@ iochannel_input_available (GIOChannel *iochannel,
                            GIOCondition condition,
                            gpointer data)
 {
+    mm_main_loop_profiler_source_dispatched ();
     return common_input_available (MM_PORT_SERIAL (data), condition);
 }
 
@@ -1011,6 +1465,427 @@ socket_input_available (GSocket *socket,
     return common_input_available (MM_PORT_SERIAL (data), condition);
 }
 
+/*****************************************************************************/
+/* I/O worker
+ *
+ * When enabled, input of TTY ports is read by a worker thread shared by all
+ * ports, running its own main context. That keeps reads going even when the
+ * main loop is busy (e.g. with D-Bus requests or other modems).
+ *
+ * For ports able to collect unsolicited messages without dispatching them
+ * (i.e. AT ports), the input is also parsed in the worker: only the
+ * unsolicited messages found and the parsed responses are handed over to the
+ * main context, in batches, where the handlers are run and the responses
+ * given to the commands. The input of other ports is handed over as read, and
+ * parsed in the main context as usual.
+ */
+
+static gboolean io_worker_enabled;
+static GMainContext *io_worker_context;
+
+void
+mm_port_serial_set_io_worker_enabled (gboolean enabled)
+{
+    io_worker_enabled = enabled;
+}
+
+static gpointer
+io_worker_thread (GMainContext *context)
+{
+    GMainLoop *worker_loop;
+
+    g_main_context_push_thread_default (context);
+    worker_loop = g_main_loop_new (context, FALSE);
+    g_main_loop_run (worker_loop);
+    return NULL;
+}
+
+static GMainContext *
+io_worker_get_context (void)
+{
+    /* Only ever called from the main context */
+    if (G_UNLIKELY (!io_worker_context)) {
+        io_worker_context = g_main_context_new ();
+        g_thread_unref (g_thread_new ("serial-io",
+                                      (GThreadFunc) io_worker_thread,
+                                      io_worker_context));
+    }
+    return io_worker_context;
+}
+
+/* Results of parsing the input in the I/O worker, handed over to the main
+ * context in the order they were found */
+typedef enum {
+    WORKER_EVENT_UNSOLICITED,
+    WORKER_EVENT_RESPONSE,
+    WORKER_EVENT_ERROR,
+    WORKER_EVENT_BUFFER_FULL,
+} WorkerEventType;
+
+typedef struct {
+    WorkerEventType type;
+    /* The class the unsolicited message was collected by, to free it */
+    MMPortSerialClass *klass;
+    gpointer unsolicited;
+    GByteArray *data;
+    GError *error;
+} WorkerEvent;
+
+static void
+worker_event_free (WorkerEvent *event)
+{
+    if (event->unsolicited)
+        event->klass->free_unsolicited (event->unsolicited);
+    if (event->data)
+        g_byte_array_unref (event->data);
+    if (event->error)
+        g_error_free (event->error);
+    g_slice_free (WorkerEvent, event);
+}
+
+/* Shared between the port and its watch in the worker context, so that the
+ * watch never needs to touch a port that may be gone */
+typedef struct {
+    volatile gint ref_count;
+
+    /* Protects all the fields below */
+    GMutex lock;
+    MMPortSerial *self;
+    int fd;
+    /* Whether the input gets parsed in the worker; otherwise it's just
+     * handed over as read */
+    gboolean parse;
+    MMPortSerialBuffer buffer;
+    GByteArray *data;
+    GQueue *events;
+    GIOCondition condition;
+    gboolean dispatch_pending;
+    gint64 read_time;
+} WorkerInput;
+
+static WorkerInput *
+worker_input_ref (WorkerInput *input)
+{
+    g_atomic_int_inc (&input->ref_count);
+    return input;
+}
+
+static void
+worker_input_unref (WorkerInput *input)
+{
+    if (g_atomic_int_dec_and_test (&input->ref_count)) {
+        g_byte_array_unref (input->buffer.data);
+        g_byte_array_unref (input->data);
+        g_queue_free_full (input->events, (GDestroyNotify) worker_event_free);
+        g_mutex_clear (&input->lock);
+        g_slice_free (WorkerInput, input);
+    }
+}
+
+static void
+worker_input_push_event (WorkerInput *input,
+                         WorkerEventType type,
+                         gpointer unsolicited,
+                         GByteArray *data,
+                         GError *error)
+{
+    WorkerEvent *event;
+
+    event = g_slice_new0 (WorkerEvent);
+    event->type = type;
+    event->klass = MM_PORT_SERIAL_GET_CLASS (input->self);
+    event->unsolicited = unsolicited;
+    event->data = data;
+    event->error = error;
+    g_queue_push_tail (input->events, event);
+}
+
+/* Runs in the worker, with the input lock held. Same processing as
+ * port_serial_input_received() and parse_response_buffer(), except that
+ * unsolicited message handlers aren't run and responses aren't matched to
+ * commands; those are left to the main context. */
+static void
+worker_input_parse (WorkerInput *input,
+                    const guint8 *buf,
+                    gsize len)
+{
+    MMPortSerial *self = input->self;
+    MMPortSerialClass *klass = MM_PORT_SERIAL_GET_CLASS (self);
+    GList *unsolicited;
+    GList *l;
+    GByteArray *parsed_response = NULL;
+    GError *error = NULL;
+
+    buffer_append (&input->buffer, buf, len);
+
+    /* Make sure the response doesn't grow too long */
+    if ((mm_port_serial_buffer_get_len (&input->buffer) > SERIAL_BUF_SIZE) && self->priv->spew_control) {
+        const guint8 *pending;
+        gsize pending_len;
+        GByteArray *full;
+
+        pending = mm_port_serial_buffer_peek (&input->buffer, &pending_len);
+        full = g_byte_array_sized_new (pending_len);
+        g_byte_array_append (full, pending, pending_len);
+        worker_input_push_event (input, WORKER_EVENT_BUFFER_FULL, NULL, full, NULL);
+        mm_port_serial_buffer_consume (&input->buffer, (SERIAL_BUF_SIZE / 2));
+    }
+
+    unsolicited = klass->collect_unsolicited (self, &input->buffer);
+    for (l = unsolicited; l; l = g_list_next (l))
+        worker_input_push_event (input, WORKER_EVENT_UNSOLICITED, l->data, NULL, NULL);
+    g_list_free (unsolicited);
+
+    switch (klass->parse_response (self, &input->buffer, &parsed_response, &error)) {
+    case MM_PORT_SERIAL_RESPONSE_BUFFER:
+        g_assert (parsed_response);
+        worker_input_push_event (input, WORKER_EVENT_RESPONSE, NULL, parsed_response, NULL);
+        break;
+    case MM_PORT_SERIAL_RESPONSE_ERROR:
+        g_assert (error);
+        worker_input_push_event (input, WORKER_EVENT_ERROR, NULL, NULL, error);
+        break;
+    case MM_PORT_SERIAL_RESPONSE_NONE:
+        break;
+    }
+}
+
+/* Gives the oldest response parsed by the I/O worker to the command being
+ * run, if any. Returns TRUE if there was one. */
+static gboolean
+port_serial_deliver_worker_response (MMPortSerial *self)
+{
+    WorkerEvent *event;
+
+    event = g_queue_pop_head (self->priv->worker_responses);
+    if (!event)
+        return FALSE;
+
+    self->priv->n_consecutive_timeouts = 0;
+    port_serial_got_response (self, event->data, event->error);
+    worker_event_free (event);
+    return TRUE;
+}
+
+static void
+port_serial_worker_event (MMPortSerial *self,
+                          WorkerEvent *event)
+{
+    CommandContext *ctx;
+
+    switch (event->type) {
+    case WORKER_EVENT_UNSOLICITED:
+        MM_PORT_SERIAL_GET_CLASS (self)->dispatch_unsolicited (self, event->unsolicited);
+        break;
+    case WORKER_EVENT_BUFFER_FULL:
+        g_signal_emit (self, signals[BUFFER_FULL], 0, event->data);
+        break;
+    case WORKER_EVENT_RESPONSE:
+    case WORKER_EVENT_ERROR:
+        /* Replies can't be expected while the command is still being
+         * written; keep it until done */
+        g_queue_push_tail (self->priv->worker_responses, event);
+        ctx = (CommandContext *) g_queue_peek_head (self->priv->queue);
+        if (!ctx || !ctx->started || ctx->done)
+            port_serial_deliver_worker_response (self);
+        return;
+    }
+
+    worker_event_free (event);
+}
+
+static gboolean
+worker_input_dispatch (WorkerInput *input)
+{
+    MMPortSerial *self;
+    GByteArray *data;
+    GQueue *events;
+    GIOCondition condition;
+    gint64 delay;
+    gsize i;
+
+    mm_main_loop_profiler_source_dispatched ();
+
+    g_mutex_lock (&input->lock);
+    self = input->self;
+    data = input->data;
+    input->data = g_byte_array_new ();
+    events = input->events;
+    input->events = g_queue_new ();
+    condition = input->condition;
+    input->condition = 0;
+    input->dispatch_pending = FALSE;
+    delay = g_get_monotonic_time () - input->read_time;
+    g_mutex_unlock (&input->lock);
+
+    self->priv->worker_dispatch_count++;
+    self->priv->worker_dispatch_total += delay;
+    self->priv->worker_dispatch_max = MAX (self->priv->worker_dispatch_max, (guint64) delay);
+
+    /* Input of a watch already removed (e.g. port closed) is discarded */
+    if (input->parse) {
+        WorkerEvent *event;
+
+        /* Only the traces of the input are left to do here */
+        for (i = 0; i < data->len && self->priv->worker_input == input; i += SERIAL_BUF_SIZE)
+            serial_debug (self, "<--",
+                          (const gchar *) &data->data[i],
+                          MIN (SERIAL_BUF_SIZE, data->len - i));
+
+        while ((event = g_queue_pop_head (events)) != NULL) {
+            if (self->priv->worker_input == input)
+                port_serial_worker_event (self, event);
+            else
+                worker_event_free (event);
+        }
+    } else {
+        /* Process in chunks, as if read directly */
+        for (i = 0; i < data->len && self->priv->worker_input == input; i += SERIAL_BUF_SIZE)
+            port_serial_input_received (self,
+                                        (const gchar *) &data->data[i],
+                                        MIN (SERIAL_BUF_SIZE, data->len - i));
+    }
+
+    if (condition && self->priv->worker_input == input)
+        common_input_available (self, condition);
+
+    g_queue_free_full (events, (GDestroyNotify) worker_event_free);
+    g_byte_array_unref (data);
+    g_object_unref (self);
+    worker_input_unref (input);
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean
+worker_input_available (GIOChannel *iochannel,
+                        GIOCondition condition,
+                        WorkerInput *input)
+{
+    guint8 buf[SERIAL_BUF_SIZE];
+    GSource *source;
+    gssize n;
+
+    g_mutex_lock (&input->lock);
+
+    /* The watch may have been removed from the main context meanwhile, and
+     * the fd closed right after */
+    if (g_source_is_destroyed (g_main_current_source ())) {
+        g_mutex_unlock (&input->lock);
+        return G_SOURCE_REMOVE;
+    }
+
+    if (condition & G_IO_IN) {
+        do {
+            n = read (input->fd, buf, sizeof (buf));
+            if (n <= 0)
+                break;
+            if (!input->parse)
+                g_byte_array_append (input->data, buf, n);
+            else {
+                /* Raw input is only needed for the traces */
+                if (mm_log_enabled (LOGL_DEBUG, MM_LOG_MODULE))
+                    g_byte_array_append (input->data, buf, n);
+                worker_input_parse (input, buf, n);
+            }
+        } while (n == sizeof (buf));
+    }
+    input->condition |= (condition & (G_IO_ERR | G_IO_HUP));
+    if (input->condition)
+        buffer_clear (&input->buffer);
+
+    /* Hand over to the main context; the port is alive as long as the watch
+     * isn't destroyed, so it's safe to take a reference here */
+    if (!input->dispatch_pending &&
+        (input->data->len > 0 || !g_queue_is_empty (input->events) || input->condition)) {
+        input->dispatch_pending = TRUE;
+        input->read_time = g_get_monotonic_time ();
+        g_object_ref (input->self);
+        source = g_idle_source_new ();
+        g_source_set_name (source, "serial port worker input");
+        g_source_set_callback (source,
+                               (GSourceFunc) worker_input_dispatch,
+                               worker_input_ref (input),
+                               NULL);
+        g_source_attach (source, NULL);
+        g_source_unref (source);
+    }
+
+    g_mutex_unlock (&input->lock);
+
+    /* A hung up port is reported once, the main context closes it */
+    return (condition & G_IO_HUP) ? G_SOURCE_REMOVE : G_SOURCE_CONTINUE;
+}
+
+static void
+worker_watch_enable (MMPortSerial *self, gboolean enable)
+{
+    if (self->priv->worker_source) {
+        WorkerInput *input = self->priv->worker_input;
+
+        /* Once destroyed under the lock, the watch won't use the fd again */
+        g_mutex_lock (&input->lock);
+        g_source_destroy (self->priv->worker_source);
+        g_mutex_unlock (&input->lock);
+        g_source_unref (self->priv->worker_source);
+        self->priv->worker_source = NULL;
+        worker_input_unref (input);
+        self->priv->worker_input = NULL;
+
+        /* Parsed replies not yet given to any command are gone with the
+         * rest of the input */
+        g_queue_foreach (self->priv->worker_responses, (GFunc) worker_event_free, NULL);
+        g_queue_clear (self->priv->worker_responses);
+
+        if (self->priv->worker_dispatch_count > 0)
+            mm_dbg ("(%s) I/O worker input dispatched %u times, with %" G_GUINT64_FORMAT " us average and %" G_GUINT64_FORMAT " us max delay",
+                    mm_port_get_device (MM_PORT (self)),
+                    self->priv->worker_dispatch_count,
+                    self->priv->worker_dispatch_total / self->priv->worker_dispatch_count,
+                    self->priv->worker_dispatch_max);
+    }
+
+    if (enable) {
+        WorkerInput *input;
+
+        input = g_slice_new0 (WorkerInput);
+        input->ref_count = 1;
+        g_mutex_init (&input->lock);
+        input->self = self;
+        input->fd = self->priv->fd;
+        input->parse = (MM_PORT_SERIAL_GET_CLASS (self)->collect_unsolicited != NULL);
+        input->buffer.data = g_byte_array_sized_new (500);
+        input->data = g_byte_array_new ();
+        input->events = g_queue_new ();
+        self->priv->worker_input = input;
+
+        self->priv->worker_source = g_io_create_watch (self->priv->iochannel,
+                                                       G_IO_IN | G_IO_ERR | G_IO_HUP);
+        g_source_set_callback (self->priv->worker_source,
+                               (GSourceFunc) worker_input_available,
+                               worker_input_ref (input),
+                               (GDestroyNotify) worker_input_unref);
+        g_source_attach (self->priv->worker_source, io_worker_get_context ());
+    }
+}
+
+void
+mm_port_serial_get_io_worker_stats (MMPortSerial *self,
+                                    guint *n_dispatches,
+                                    guint64 *total_delay,
+                                    guint64 *max_delay)
+{
+    g_return_if_fail (MM_IS_PORT_SERIAL (self));
+
+    if (n_dispatches)
+        *n_dispatches = self->priv->worker_dispatch_count;
+    if (total_delay)
+        *total_delay = self->priv->worker_dispatch_total;
+    if (max_delay)
+        *max_delay = self->priv->worker_dispatch_max;
+}
+
+/*****************************************************************************/
+
 static void
 data_watch_enable (MMPortSerial *self, gboolean enable)
 {
@@ -1030,12 +1905,25 @@ data_watch_enable (MMPortSerial *self, gboolean enable)
         self->priv->socket_source = NULL;
     }
 
+    if (self->priv->worker_source) {
+        if (enable)
+            g_warn_if_fail (self->priv->worker_source == NULL);
+        worker_watch_enable (self, FALSE);
+    }
+
     if (enable) {
-        if (self->priv->iochannel) {
+        if (self->priv->iochannel && io_worker_enabled) {
+            worker_watch_enable (self, TRUE);
+        } else if (self->priv->iochannel) {
+            gchar *name;
+
             self->priv->iochannel_id = g_io_add_watch (self->priv->iochannel,
                                                        G_IO_IN | G_IO_ERR | G_IO_HUP,
                                                        iochannel_input_available,
                                                        self);
+            name = g_strdup_printf ("serial port %s input", mm_port_get_device (MM_PORT (self)));
+            g_source_set_name_by_id (self->priv->iochannel_id, name);
+            g_free (name);
         } else if (self->priv->socket) {
             self->priv->socket_source = g_socket_create_source (self->priv->socket,
                                                                 G_IO_IN | G_IO_ERR | G_IO_HUP,
@@ -1332,6 +2220,9 @@ _close_internal (MMPortSerial *self, gboolean force)
 
         mm_port_set_connected (MM_PORT (self), FALSE);
 
+        /* Stop writing before the fd goes away */
+        port_serial_writer_stop (self);
+
         g_get_current_time (&tv_start);
 
         /* Serial port specific setup */
@@ -1388,6 +2279,9 @@ _close_internal (MMPortSerial *self, gboolean force)
             mm_warn ("(%s): close blocked by driver for more than 7 seconds!", device);
     }
 
+    /* Whatever was received so far won't be completed once reopened */
+    port_serial_response_clear (self);
+
     /* Clear the command queue */
     for (i = 0; i < g_queue_get_length (self->priv->queue); i++) {
         CommandContext *ctx;
@@ -1889,7 +2783,9 @@ mm_port_serial_init (MMPortSerial *self)
     self->priv->send_delay = 1000;
 
     self->priv->queue = g_queue_new ();
-    self->priv->response = g_byte_array_sized_new (500);
+    self->priv->response.data = g_byte_array_sized_new (500);
+    self->priv->worker_responses = g_queue_new ();
+    self->priv->command_stats = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
 }
 
 static void
@@ -1998,8 +2894,10 @@ finalize (GObject *object)
     MMPortSerial *self = MM_PORT_SERIAL (object);
 
     g_hash_table_destroy (self->priv->reply_cache);
-    g_byte_array_unref (self->priv->response);
+    g_hash_table_destroy (self->priv->command_stats);
+    g_byte_array_unref (self->priv->response.data);
     g_queue_free (self->priv->queue);
+    g_queue_free_full (self->priv->worker_responses, (GDestroyNotify) worker_event_free);
 
     G_OBJECT_CLASS (mm_port_serial_parent_class)->finalize (object);
 }
@@ -50,6 +50,20 @@ typedef struct _MMPortSerial MMPortSerial;
 typedef struct _MMPortSerialClass MMPortSerialClass;
 typedef struct _MMPortSerialPrivate MMPortSerialPrivate;
 
+/* Accumulated input data, as seen by the parsers. Data processed by a parser
+ * is consumed from the head of the buffer, which just advances a read offset;
+ * the storage is compacted lazily when new data arrives. */
+typedef struct _MMPortSerialBuffer MMPortSerialBuffer;
+
+const guint8 *mm_port_serial_buffer_peek    (const MMPortSerialBuffer *buffer,
+                                             gsize *len);
+gsize         mm_port_serial_buffer_get_len (const MMPortSerialBuffer *buffer);
+void          mm_port_serial_buffer_consume (MMPortSerialBuffer *buffer,
+                                             gsize len);
+void          mm_port_serial_buffer_replace (MMPortSerialBuffer *buffer,
+                                             const guint8 *data,
+                                             gsize len);
+
 struct _MMPortSerial {
     MMPort parent;
     MMPortSerialPrivate *priv;
@@ -60,9 +74,9 @@ struct _MMPortSerialClass {
 
     /* Called for subclasses to parse unsolicited responses.  If any recognized
      * unsolicited response is found, it should be removed from the 'response'
-     * byte array before returning.
+     * buffer before returning.
      */
-    void     (*parse_unsolicited) (MMPortSerial *self, GByteArray *response);
+    void     (*parse_unsolicited) (MMPortSerial *self, MMPortSerialBuffer *response);
 
     /*
      * Called to parse the device's response to a command or determine if the
@@ -77,14 +91,31 @@ struct _MMPortSerialClass {
      * If there is no response, @MM_PORT_SERIAL_RESPONSE_NONE will be returned,
      * and neither @error nor @parsed_response will be set.
      *
-     * The implementation is allowed to cleanup the @response byte array, e.g. to
-     * just remove 1 single response if more than one found.
+     * The implementation is expected to consume from the @response buffer the
+     * data it processed, e.g. to just remove 1 single response if more than
+     * one found.
      */
     MMPortSerialResponseType (*parse_response) (MMPortSerial *self,
-                                                GByteArray *response,
+                                                MMPortSerialBuffer *response,
                                                 GByteArray **parsed_response,
                                                 GError **error);
 
+    /* Optional; like parse_unsolicited(), but instead of running the handlers
+     * of the unsolicited messages found, they're returned as a list of items
+     * to be given later to dispatch_unsolicited() and free_unsolicited().
+     * Ports implementing it get their input parsed in the I/O worker thread
+     * when enabled, so both this method and parse_response() must be safe to
+     * run there.
+     */
+    GList *  (*collect_unsolicited)  (MMPortSerial *self, MMPortSerialBuffer *response);
+    void     (*dispatch_unsolicited) (MMPortSerial *self, gpointer unsolicited);
+    void     (*free_unsolicited)     (gpointer unsolicited);
+
+    /* Optional; called when the response buffer is cleared, e.g. on hangup
+     * or when the port gets closed, so that subclasses can reset any parsing
+     * state kept across reads. */
+    void     (*buffer_cleared)       (MMPortSerial *self);
+
     /* Called to configure the serial port fd after it's opened.  On error, should
      * return FALSE and set 'error' as appropriate.
      */
@@ -99,6 +130,11 @@ struct _MMPortSerialClass {
                                    const char *buf,
                                    gsize len);
 
+    /* Called to get a short name identifying the command in the latency
+     * statistics, e.g. "+CGMI". If not given, the first byte is used. */
+    gchar * (*get_command_name)   (MMPortSerial *self,
+                                   const GByteArray *command);
+
     /* Signals */
     void (*buffer_full)           (MMPortSerial *port, const GByteArray *buffer);
     void (*timed_out)             (MMPortSerial *port, guint n_consecutive_replies);
@@ -107,6 +143,10 @@ struct _MMPortSerialClass {
 
 GType mm_port_serial_get_type (void);
 
+/* Read the input of TTY ports in a dedicated I/O worker thread; applies to
+ * ports opened afterwards */
+void mm_port_serial_set_io_worker_enabled (gboolean enabled);
+
 MMPortSerial *mm_port_serial_new (const char *name, MMPortType ptype);
 
 /* Keep in mind that port open/close is refcounted, so ensure that
@@ -141,7 +181,7 @@ void     mm_port_serial_flash_cancel      (MMPortSerial *self);
 
 void        mm_port_serial_command        (MMPortSerial *self,
                                            GByteArray *command,
-                                           guint32 timeout_seconds,
+                                           guint32 timeout_ms,
                                            gboolean allow_cached,
                                            GCancellable *cancellable,
                                            GAsyncReadyCallback callback,
@@ -150,4 +190,25 @@ GByteArray *mm_port_serial_command_finish (MMPortSerial *self,
                                            GAsyncResult *res,
                                            GError **error);
 
+/* Store a reply obtained by other means (e.g. as part of a concatenated
+ * command line) so that later cached requests of the command get it */
+void        mm_port_serial_set_cached_reply (MMPortSerial *self,
+                                             const GByteArray *command,
+                                             const GByteArray *response);
+
+/* Input handed over from the I/O worker to the main context: number of
+ * hand-overs, and their accumulated and maximum delays in microseconds */
+void        mm_port_serial_get_io_worker_stats (MMPortSerial *self,
+                                                guint *n_dispatches,
+                                                guint64 *total_delay,
+                                                guint64 *max_delay);
+
+/* Command latency statistics of the port, added to an array of
+ * (modem, device, command name, count, timeouts, total ms, max ms, histogram),
+ * with the histogram bucket upper bounds (in ms) given separately */
+void        mm_port_serial_get_command_stats        (MMPortSerial *self,
+                                                     const gchar *modem_path,
+                                                     GVariantBuilder *builder);
+GVariant   *mm_port_serial_get_command_stats_bounds (void);
+
 #endif /* MM_PORT_SERIAL_H */
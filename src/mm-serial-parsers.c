@@ -14,6 +14,9 @@
  * Copyright (C) 2009 Red Hat, Inc.
  */
 
+#define _GNU_SOURCE  /* for memmem() */
+#define MM_LOG_MODULE MM_LOG_MODULE_SERIAL
+
 #include <string.h>
 #include <stdlib.h>
 
@@ -79,6 +82,157 @@ remove_matches (GRegex *r, GString *string)
     g_free (str);
 }
 
+/*****************************************************************************/
+/* Final result code fast path
+ *
+ * Most responses end with one of a handful of well-known final result codes,
+ * and most of the times we're called the response is still incomplete. Both
+ * cases can be recognized just looking at the last line of the response,
+ * without running the whole list of regular expressions. Whenever the scanner
+ * isn't fully sure that the regular expressions would give the same result, it
+ * reports so and the regular expressions are used instead.
+ */
+
+typedef enum {
+    FINAL_RESULT_UNKNOWN,   /* Run the regular expressions */
+    FINAL_RESULT_NONE,      /* No final result code */
+    FINAL_RESULT_OK,
+    FINAL_RESULT_CME_ERROR,
+    FINAL_RESULT_CMS_ERROR,
+    FINAL_RESULT_ERROR,
+} FinalResult;
+
+static gboolean
+contains (const gchar *str,
+          gsize len,
+          const gchar *needle)
+{
+    return !!memmem (str, len, needle, strlen (needle));
+}
+
+static gboolean
+ends_with (const gchar *str,
+           gsize len,
+           const gchar *suffix)
+{
+    gsize suffix_len;
+
+    suffix_len = strlen (suffix);
+    return (len >= suffix_len && memcmp (str + len - suffix_len, suffix, suffix_len) == 0);
+}
+
+/* Characters matched by \s, and also <VT> just in case */
+static gboolean
+is_space (gchar c)
+{
+    return (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v');
+}
+
+/* Parses '<prefix>[ \t]*<digits>' and returns the start of the digits */
+static const gchar *
+line_get_error_code (const gchar *line,
+                     gsize line_len,
+                     const gchar *prefix)
+{
+    const gchar *p;
+    const gchar *end;
+    const gchar *digits;
+
+    if (line_len < strlen (prefix) || memcmp (line, prefix, strlen (prefix)) != 0)
+        return NULL;
+
+    end = line + line_len;
+    p = line + strlen (prefix);
+    while (p < end && (*p == ' ' || *p == '\t'))
+        p++;
+    digits = p;
+    while (p < end && g_ascii_isdigit (*p))
+        p++;
+
+    return ((p == end && digits < end) ? digits : NULL);
+}
+
+static FinalResult
+final_result_scan (const gchar *str,
+                   gsize len,
+                   gsize *ok_start,
+                   gint *error_code)
+{
+    gsize end;
+    gsize line_start;
+    gsize line_len;
+    const gchar *line;
+    const gchar *digits;
+
+    if (!len)
+        return FINAL_RESULT_NONE;
+
+    /* '\r\nOK(\r\n)+$' */
+    end = len;
+    while (end >= 2 && str[end - 2] == '\r' && str[end - 1] == '\n')
+        end -= 2;
+    if (end < len && ends_with (str, end, "\r\nOK")) {
+        *ok_start = end - 4;
+        return FINAL_RESULT_OK;
+    }
+
+    /* CONNECT and the SMS prompt aren't handled here */
+    if (contains (str, len, "\r\nCONNECT"))
+        return FINAL_RESULT_UNKNOWN;
+    for (end = len; end > 0 && is_space (str[end - 1]); end--);
+    if (end > 0 && str[end - 1] == '>')
+        return FINAL_RESULT_UNKNOWN;
+
+    /* Any of the '+CME ERROR:', '+CMS ERROR:' or 'MODEM ERROR:' formats
+     * may span several lines, so only handle them if they're the only ones
+     * and in the last line */
+    if (ends_with (str, len, "\r\n")) {
+        line_len = len - 2;
+        for (line_start = line_len; line_start > 0; line_start--) {
+            if (line_start >= 2 && str[line_start - 2] == '\r' && str[line_start - 1] == '\n')
+                break;
+        }
+        /* The line needs to be preceded by <CR><LF> */
+        if (line_start >= 2) {
+            line = str + line_start;
+            line_len -= line_start;
+
+            digits = line_get_error_code (line, line_len, "+CME ERROR:");
+            if (digits) {
+                *error_code = atoi (digits);
+                return FINAL_RESULT_CME_ERROR;
+            }
+
+            digits = line_get_error_code (line, line_len, "+CMS ERROR:");
+            if (digits) {
+                *error_code = atoi (digits);
+                return FINAL_RESULT_CMS_ERROR;
+            }
+
+            if (line_len == 5 && memcmp (line, "ERROR", 5) == 0 && !contains (str, len, "ERROR:"))
+                return FINAL_RESULT_ERROR;
+        }
+
+        /* Anchored at the end */
+        if (ends_with (str, len, "COMMAND NOT SUPPORT\r\n") ||
+            ends_with (str, len, "NO DIALTONE\r\n"))
+            return FINAL_RESULT_UNKNOWN;
+    }
+
+    /* Not anchored at the end */
+    if (contains (str, len, "ERROR:")      ||
+        contains (str, len, "\r\nERROR")      ||
+        contains (str, len, "\r\nNO CARRIER") ||
+        contains (str, len, "BUSY")           ||
+        contains (str, len, "NO ANSWER")      ||
+        contains (str, len, "\r\nNA\r\n"))
+        return FINAL_RESULT_UNKNOWN;
+
+    return FINAL_RESULT_NONE;
+}
+
+/*****************************************************************************/
+
 typedef struct {
     /* Regular expressions for successful replies */
     GRegex *regex_ok;
@@ -98,6 +252,8 @@ typedef struct {
     /* User-provided parser filter */
     mm_serial_parser_v1_filter_fn filter_callback;
     gpointer                      filter_user_data;
+    /* Whether the final result code fast path is used */
+    gboolean fast_path;
 } MMSerialParserV1;
 
 gpointer
@@ -125,6 +281,7 @@ mm_serial_parser_v1_new (void)
     parser->regex_custom_error = NULL;
     parser->filter_callback = NULL;
     parser->filter_user_data = NULL;
+    parser->fast_path = TRUE;
 
     return parser;
 }
@@ -160,16 +317,30 @@ mm_serial_parser_v1_add_filter (gpointer data,
     parser->filter_user_data = user_data;
 }
 
+void
+mm_serial_parser_v1_set_fast_path (gpointer data,
+                                   gboolean enabled)
+{
+    MMSerialParserV1 *parser = (MMSerialParserV1 *) data;
+
+    g_return_if_fail (parser != NULL);
+
+    parser->fast_path = enabled;
+}
+
 gboolean
 mm_serial_parser_v1_parse (gpointer data,
                            GString *response,
                            GError **error)
 {
     MMSerialParserV1 *parser = (MMSerialParserV1 *) data;
-    GMatchInfo *match_info;
+    GMatchInfo *match_info = NULL;
     GError *local_error = NULL;
     gboolean found = FALSE;
     char *str = NULL;
+    FinalResult result = FINAL_RESULT_UNKNOWN;
+    gsize ok_start = 0;
+    gint error_code = 0;
 
     g_return_val_if_fail (parser != NULL, FALSE);
     g_return_val_if_fail (response != NULL, FALSE);
@@ -201,31 +372,45 @@ mm_serial_parser_v1_parse (gpointer data,
         found = g_regex_match_full (parser->regex_custom_successful,
                                     response->str, response->len,
                                     0, 0, NULL, NULL);
+        if (found) {
+            response_clean (response);
+            return TRUE;
+        }
     }
 
-    if (!found) {
+    /* Try to recognize the final result code without regexes */
+    if (parser->fast_path)
+        result = final_result_scan (response->str, response->len, &ok_start, &error_code);
+
+    if (result == FINAL_RESULT_OK) {
+        g_string_truncate (response, ok_start);
+        response_clean (response);
+        return TRUE;
+    }
+
+    if (result == FINAL_RESULT_UNKNOWN) {
         found = g_regex_match_full (parser->regex_ok,
                                     response->str, response->len,
                                     0, 0, NULL, NULL);
         if (found)
             remove_matches (parser->regex_ok, response);
-    }
 
-    if (!found) {
-        found = g_regex_match_full (parser->regex_connect,
-                                    response->str, response->len,
-                                    0, 0, NULL, NULL);
-    }
+        if (!found) {
+            found = g_regex_match_full (parser->regex_connect,
+                                        response->str, response->len,
+                                        0, 0, NULL, NULL);
+        }
 
-    if (!found) {
-        found = g_regex_match_full (parser->regex_sms,
-                                    response->str, response->len,
-                                    0, 0, NULL, NULL);
-    }
+        if (!found) {
+            found = g_regex_match_full (parser->regex_sms,
+                                        response->str, response->len,
+                                        0, 0, NULL, NULL);
+        }
 
-    if (found) {
-        response_clean (response);
-        return TRUE;
+        if (found) {
+            response_clean (response);
+            return TRUE;
+        }
     }
 
     /* Now failures */
@@ -242,6 +427,29 @@ mm_serial_parser_v1_parse (gpointer data,
             goto done;
         }
         g_match_info_free (match_info);
+        match_info = NULL;
+    }
+
+    /* Final result codes already recognized */
+    switch (result) {
+    case FINAL_RESULT_NONE:
+        return FALSE;
+    case FINAL_RESULT_CME_ERROR:
+        found = TRUE;
+        local_error = mm_mobile_equipment_error_for_code (error_code);
+        goto done;
+    case FINAL_RESULT_CMS_ERROR:
+        found = TRUE;
+        local_error = mm_message_error_for_code (error_code);
+        goto done;
+    case FINAL_RESULT_ERROR:
+        found = TRUE;
+        local_error = mm_mobile_equipment_error_for_code (MM_MOBILE_EQUIPMENT_ERROR_UNKNOWN);
+        goto done;
+    case FINAL_RESULT_UNKNOWN:
+    case FINAL_RESULT_OK:
+    default:
+        break;
     }
 
     /* Numeric CME errors */
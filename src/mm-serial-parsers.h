@@ -26,6 +26,10 @@ gboolean mm_serial_parser_v1_parse                (gpointer parser,
                                                    GString *response,
                                                    GError **error);
 void     mm_serial_parser_v1_destroy              (gpointer parser);
+/* Enabled by default; the final result codes are then recognized without
+ * regular expressions whenever possible */
+void     mm_serial_parser_v1_set_fast_path        (gpointer parser,
+                                                   gboolean enabled);
 gboolean mm_serial_parser_v1_is_known_error       (const GError *error);
 
 /* Parser filter: when FALSE returned, error should be set. This error will be
@@ -14,6 +14,8 @@
  * Copyright (C) 2016 Aleksander Morgado <aleksander@aleksander.es>
  */
 
+#define MM_LOG_MODULE MM_LOG_MODULE_QMI
+
 #include <config.h>
 #include <stdio.h>
 #include <stdlib.h>
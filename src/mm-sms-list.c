@@ -13,6 +13,8 @@
  * Copyright (C) 2012 Google, Inc.
  */
 
+#define MM_LOG_MODULE MM_LOG_MODULE_SMS
+
 #include <config.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -41,6 +43,7 @@ static GParamSpec *properties[PROP_LAST];
 enum {
     SIGNAL_ADDED,
     SIGNAL_DELETED,
+    SIGNAL_BATCH_DONE,
     SIGNAL_LAST
 };
 static guint signals[SIGNAL_LAST];
@@ -50,8 +53,146 @@ struct _MMSmsListPrivate {
     MMBaseModem *modem;
     /* List of sms objects */
     GList *list;
+    guint n_sms;
+    /* Path to GList link in the list */
+    GHashTable *path_index;
+    /* PartIndexAndStorage to the MMBaseSms holding the part */
+    GHashTable *part_index;
+    /* Multipart reference and number to the MMBaseSms being assembled */
+    GHashTable *multipart_index;
+    /* SMS objects added with add_sms(), whose parts aren't indexed */
+    GList *local;
+    /* Cached list of paths, rebuilt on demand */
+    GStrv paths;
+    /* Batch import status */
+    guint batch_depth;
+    guint batch_n_changes;
 };
 
+/*****************************************************************************/
+/* Indices */
+
+#define MULTIPART_KEY_TAG "sms-list-multipart-key"
+#define PART_KEYS_TAG     "sms-list-part-keys"
+
+typedef struct {
+    guint part_index;
+    MMSmsStorage storage;
+} PartIndexAndStorage;
+
+static guint
+part_index_and_storage_hash (const PartIndexAndStorage *key)
+{
+    return (key->part_index * 31) + key->storage;
+}
+
+static gboolean
+part_index_and_storage_equal (const PartIndexAndStorage *a,
+                              const PartIndexAndStorage *b)
+{
+    return (a->part_index == b->part_index && a->storage == b->storage);
+}
+
+static void
+part_index_and_storage_free (PartIndexAndStorage *key)
+{
+    g_slice_free (PartIndexAndStorage, key);
+}
+
+static void
+part_keys_free (GSList *keys)
+{
+    g_slist_free_full (keys, (GDestroyNotify)part_index_and_storage_free);
+}
+
+static gchar *
+build_multipart_key (guint reference,
+                     const gchar *number)
+{
+    return g_strdup_printf ("%u/%s", reference, number ? number : "");
+}
+
+static void
+index_part (MMSmsList *self,
+            MMBaseSms *sms,
+            MMSmsPart *part)
+{
+    PartIndexAndStorage *key;
+    GSList *keys;
+
+    if (mm_sms_part_get_index (part) == SMS_PART_INVALID_INDEX ||
+        mm_base_sms_get_storage (sms) == MM_SMS_STORAGE_UNKNOWN)
+        return;
+
+    key = g_slice_new (PartIndexAndStorage);
+    key->part_index = mm_sms_part_get_index (part);
+    key->storage = mm_base_sms_get_storage (sms);
+    g_hash_table_replace (self->priv->part_index, key, sms);
+
+    /* Keys are owned by the SMS, as part indices are reset once deleted */
+    keys = g_object_steal_data (G_OBJECT (sms), PART_KEYS_TAG);
+    g_object_set_data_full (G_OBJECT (sms),
+                            PART_KEYS_TAG,
+                            g_slist_prepend (keys, key),
+                            (GDestroyNotify)part_keys_free);
+}
+
+static void
+index_sms (MMSmsList *self,
+           MMBaseSms *sms,
+           const gchar *multipart_key)
+{
+    GList *l;
+
+    self->priv->list = g_list_prepend (self->priv->list, sms);
+    self->priv->n_sms++;
+    if (mm_base_sms_get_path (sms))
+        g_hash_table_insert (self->priv->path_index,
+                             g_strdup (mm_base_sms_get_path (sms)),
+                             self->priv->list);
+    for (l = mm_base_sms_get_parts (sms); l; l = g_list_next (l))
+        index_part (self, sms, (MMSmsPart *)l->data);
+    if (multipart_key) {
+        g_hash_table_insert (self->priv->multipart_index,
+                             g_strdup (multipart_key),
+                             sms);
+        g_object_set_data_full (G_OBJECT (sms),
+                                MULTIPART_KEY_TAG,
+                                g_strdup (multipart_key),
+                                g_free);
+    }
+
+    g_clear_pointer (&self->priv->paths, g_strfreev);
+}
+
+static void
+unindex_sms (MMSmsList *self,
+             GList *link)
+{
+    MMBaseSms *sms;
+    const gchar *multipart_key;
+    GSList *k;
+
+    sms = MM_BASE_SMS (link->data);
+
+    for (k = g_object_get_data (G_OBJECT (sms), PART_KEYS_TAG); k; k = g_slist_next (k)) {
+        if (g_hash_table_lookup (self->priv->part_index, k->data) == sms)
+            g_hash_table_remove (self->priv->part_index, k->data);
+    }
+    g_object_set_data (G_OBJECT (sms), PART_KEYS_TAG, NULL);
+    multipart_key = g_object_get_data (G_OBJECT (sms), MULTIPART_KEY_TAG);
+    if (multipart_key)
+        g_hash_table_remove (self->priv->multipart_index, multipart_key);
+    if (mm_base_sms_get_path (sms))
+        g_hash_table_remove (self->priv->path_index, mm_base_sms_get_path (sms));
+    self->priv->local = g_list_remove (self->priv->local, sms);
+
+    self->priv->list = g_list_delete_link (self->priv->list, link);
+    self->priv->n_sms--;
+    g_clear_pointer (&self->priv->paths, g_strfreev);
+    g_object_unref (sms);
+}
+
 /*****************************************************************************/
 
 gboolean
@@ -86,18 +227,19 @@ mm_sms_list_has_local_multipart_reference (MMSmsList *self,
 guint
 mm_sms_list_get_count (MMSmsList *self)
 {
-    return g_list_length (self->priv->list);
+    return self->priv->n_sms;
 }
 
-GStrv
-mm_sms_list_get_paths (MMSmsList *self)
+const gchar *const *
+mm_sms_list_peek_paths (MMSmsList *self)
 {
-    GStrv path_list = NULL;
     GList *l;
     guint i;
 
-    path_list = g_new0 (gchar *,
-                        1 + g_list_length (self->priv->list));
+    if (self->priv->paths)
+        return (const gchar *const *)self->priv->paths;
+
+    self->priv->paths = g_new0 (gchar *, 1 + self->priv->n_sms);
 
     for (i = 0, l = self->priv->list; l; l = g_list_next (l)) {
         const gchar *path;
@@ -105,10 +247,41 @@ mm_sms_list_get_paths (MMSmsList *self)
         /* Don't try to add NULL paths (not yet exported SMS objects) */
         path = mm_base_sms_get_path (MM_BASE_SMS (l->data));
         if (path)
-            path_list[i++] = g_strdup (path);
+            self->priv->paths[i++] = g_strdup (path);
     }
 
-    return path_list;
+    return (const gchar *const *)self->priv->paths;
+}
+
+GStrv
+mm_sms_list_get_paths (MMSmsList *self)
+{
+    return g_strdupv ((gchar **)mm_sms_list_peek_paths (self));
+}
+
+/*****************************************************************************/
+
+static void
+emit_added (MMSmsList *self,
+            MMBaseSms *sms,
+            gboolean received)
+{
+    if (self->priv->batch_depth > 0)
+        self->priv->batch_n_changes++;
+
+    g_signal_emit (self, signals[SIGNAL_ADDED], 0,
+                   mm_base_sms_get_path (sms),
+                   received);
+}
+
+static void
+emit_deleted (MMSmsList *self,
+              const gchar *path)
+{
+    if (self->priv->batch_depth > 0)
+        self->priv->batch_n_changes++;
+
+    g_signal_emit (self, signals[SIGNAL_DELETED], 0, path);
 }
 
 /*****************************************************************************/
@@ -137,13 +310,6 @@ mm_sms_list_delete_sms_finish (MMSmsList *self,
     return !g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error);
 }
 
-static guint
-cmp_sms_by_path (MMBaseSms *sms,
-                 const gchar *path)
-{
-    return g_strcmp0 (mm_base_sms_get_path (sms), path);
-}
-
 static void
 delete_ready (MMBaseSms *sms,
               GAsyncResult *res,
@@ -160,22 +326,16 @@ delete_ready (MMBaseSms *sms,
     }
 
     /* The SMS was properly deleted, we now remove it from our list */
-    l = g_list_find_custom (ctx->self->priv->list,
-                            ctx->path,
-                            (GCompareFunc)cmp_sms_by_path);
-    if (l) {
-        g_object_unref (MM_BASE_SMS (l->data));
-        ctx->self->priv->list = g_list_delete_link (ctx->self->priv->list, l);
-    }
+    l = g_hash_table_lookup (ctx->self->priv->path_index, ctx->path);
+    if (l)
+        unindex_sms (ctx->self, l);
 
     /* We don't need to unref the SMS any more, but we can use the
      * reference we got in the method, which is the one kept alive
      * during the async operation. */
     mm_base_sms_unexport (sms);
 
-    g_signal_emit (ctx->self,
-                   signals[SIGNAL_DELETED], 0,
-                   ctx->path);
+    emit_deleted (ctx->self, ctx->path);
 
     g_simple_async_result_set_op_res_gboolean (ctx->result, TRUE);
     delete_sms_context_complete_and_free (ctx);
@@ -190,9 +350,7 @@ mm_sms_list_delete_sms (MMSmsList *self,
     DeleteSmsContext *ctx;
     GList *l;
 
-    l = g_list_find_custom (self->priv->list,
-                            (gpointer)sms_path,
-                            (GCompareFunc)cmp_sms_by_path);
+    l = g_hash_table_lookup (self->priv->path_index, sms_path);
     if (!l) {
         g_simple_async_report_error_in_idle (G_OBJECT (self),
                                              callback,
@@ -220,32 +378,323 @@ mm_sms_list_delete_sms (MMSmsList *self,
 
 /*****************************************************************************/
 
+typedef struct {
+    MMSmsList *self;
+    GSimpleAsyncResult *result;
+    MMSmsDeleteFilter filter;
+    /* Pending groups of SMS, one list per storage */
+    GList *groups;
+    /* SMS being deleted one by one, if no bulk removal available */
+    GList *current;
+    guint n_deleted;
+    guint n_failed;
+} DeleteManyContext;
+
+static void
+delete_many_context_complete_and_free (DeleteManyContext *ctx)
+{
+    mm_sms_list_end_batch (ctx->self);
+    g_simple_async_result_complete_in_idle (ctx->result);
+    g_object_unref (ctx->result);
+    g_object_unref (ctx->self);
+    g_slice_free (DeleteManyContext, ctx);
+}
+
+gboolean
+mm_sms_list_delete_many_finish (MMSmsList *self,
+                                GAsyncResult *res,
+                                GError **error)
+{
+    return !g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error);
+}
+
+static void
+remove_deleted_sms (MMSmsList *self,
+                    MMBaseSms *sms)
+{
+    GList *l;
+    gchar *path;
+
+    path = g_strdup (mm_base_sms_get_path (sms));
+    l = g_hash_table_lookup (self->priv->path_index, path);
+    if (l) {
+        g_object_ref (sms);
+        unindex_sms (self, l);
+        mm_base_sms_unexport (sms);
+        emit_deleted (self, path);
+        g_object_unref (sms);
+    }
+    g_free (path);
+}
+
+static gboolean
+sms_has_stored_parts (MMBaseSms *sms)
+{
+    GList *l;
+
+    for (l = mm_base_sms_get_parts (sms); l; l = g_list_next (l)) {
+        if (mm_sms_part_get_index ((MMSmsPart *)l->data) != SMS_PART_INVALID_INDEX)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+static void delete_many_next_group (DeleteManyContext *ctx);
+static void delete_many_next_sms   (DeleteManyContext *ctx);
+
+static void
+delete_many_sms_ready (MMBaseSms *sms,
+                       GAsyncResult *res,
+                       DeleteManyContext *ctx)
+{
+    GError *error = NULL;
+
+    if (!mm_base_sms_delete_finish (sms, res, &error)) {
+        mm_dbg ("Couldn't delete SMS at '%s': '%s'",
+                mm_base_sms_get_path (sms),
+                error->message);
+        g_error_free (error);
+        ctx->n_failed++;
+    } else {
+        remove_deleted_sms (ctx->self, sms);
+        ctx->n_deleted++;
+    }
+
+    ctx->current = g_list_next (ctx->current);
+    delete_many_next_sms (ctx);
+}
+
+static void
+delete_many_next_sms (DeleteManyContext *ctx)
+{
+    if (!ctx->current) {
+        g_list_free_full (ctx->groups->data, (GDestroyNotify)g_object_unref);
+        ctx->groups = g_list_delete_link (ctx->groups, ctx->groups);
+        delete_many_next_group (ctx);
+        return;
+    }
+
+    mm_base_sms_delete (MM_BASE_SMS (ctx->current->data),
+                        (GAsyncReadyCallback)delete_many_sms_ready,
+                        ctx);
+}
+
+static void
+delete_many_group_ready (MMIfaceModemMessaging *modem,
+                         GAsyncResult *res,
+                         DeleteManyContext *ctx)
+{
+    GError *error = NULL;
+    GList *group;
+    GList *l;
+
+    group = ctx->groups->data;
+    ctx->groups = g_list_delete_link (ctx->groups, ctx->groups);
+
+    if (!MM_IFACE_MODEM_MESSAGING_GET_INTERFACE (modem)->delete_sms_many_finish (modem, res, &error)) {
+        mm_dbg ("Couldn't delete all SMS from storage '%s': '%s'",
+                mm_sms_storage_get_string (mm_base_sms_get_storage (MM_BASE_SMS (group->data))),
+                error->message);
+        g_error_free (error);
+    }
+
+    /* Parts successfully removed get their index reset, so an SMS is gone
+     * only if none of its parts are still stored */
+    for (l = group; l; l = g_list_next (l)) {
+        if (sms_has_stored_parts (MM_BASE_SMS (l->data))) {
+            ctx->n_failed++;
+            continue;
+        }
+        /* No longer stored in the device */
+        mm_gdbus_sms_set_state (MM_GDBUS_SMS (l->data), MM_SMS_STATE_UNKNOWN);
+        remove_deleted_sms (ctx->self, MM_BASE_SMS (l->data));
+        ctx->n_deleted++;
+    }
+
+    g_list_free_full (group, (GDestroyNotify)g_object_unref);
+    delete_many_next_group (ctx);
+}
+
+static void
+delete_many_next_group (DeleteManyContext *ctx)
+{
+    MMIfaceModemMessaging *modem;
+    GList *group;
+
+    if (!ctx->groups) {
+        mm_dbg ("Deleted %u SMS (%u failed)", ctx->n_deleted, ctx->n_failed);
+        if (ctx->n_failed > 0)
+            g_simple_async_result_set_error (ctx->result,
+                                             MM_CORE_ERROR,
+                                             MM_CORE_ERROR_FAILED,
+                                             "Couldn't delete %u SMS",
+                                             ctx->n_failed);
+        else
+            g_simple_async_result_set_op_res_gboolean (ctx->result, TRUE);
+        delete_many_context_complete_and_free (ctx);
+        return;
+    }
+
+    group = ctx->groups->data;
+    modem = MM_IFACE_MODEM_MESSAGING (ctx->self->priv->modem);
+
+    /* All SMS in the group share storage */
+    if (MM_IFACE_MODEM_MESSAGING_GET_INTERFACE (modem)->delete_sms_many &&
+        MM_IFACE_MODEM_MESSAGING_GET_INTERFACE (modem)->delete_sms_many_finish) {
+        MM_IFACE_MODEM_MESSAGING_GET_INTERFACE (modem)->delete_sms_many (
+            modem,
+            mm_base_sms_get_storage (MM_BASE_SMS (group->data)),
+            group,
+            ctx->filter,
+            (GAsyncReadyCallback)delete_many_group_ready,
+            ctx);
+        return;
+    }
+
+    ctx->current = group;
+    delete_many_next_sms (ctx);
+}
+
+static gint
+cmp_sms_by_storage (MMBaseSms *a,
+                    MMBaseSms *b)
+{
+    return (gint)mm_base_sms_get_storage (a) - (gint)mm_base_sms_get_storage (b);
+}
+
 void
-mm_sms_list_add_sms (MMSmsList *self,
-                     MMBaseSms *sms)
+mm_sms_list_delete_many (MMSmsList *self,
+                         const gchar *const *sms_paths,
+                         MMSmsDeleteFilter filter,
+                         GAsyncReadyCallback callback,
+                         gpointer user_data)
 {
-    self->priv->list = g_list_prepend (self->priv->list, g_object_ref (sms));
-    g_signal_emit (self, signals[SIGNAL_ADDED], 0,
-                   mm_base_sms_get_path (sms),
-                   FALSE);
+    DeleteManyContext *ctx;
+    GList *sms_list = NULL;
+    GList *l;
+
+    if (sms_paths) {
+        GHashTable *seen;
+        guint i;
+
+        seen = g_hash_table_new (g_direct_hash, g_direct_equal);
+        for (i = 0; sms_paths[i]; i++) {
+            GList *link;
+
+            link = g_hash_table_lookup (self->priv->path_index, sms_paths[i]);
+            if (!link) {
+                g_simple_async_report_error_in_idle (G_OBJECT (self),
+                                                     callback,
+                                                     user_data,
+                                                     MM_CORE_ERROR,
+                                                     MM_CORE_ERROR_NOT_FOUND,
+                                                     "No SMS found with path '%s'",
+                                                     sms_paths[i]);
+                g_list_free_full (sms_list, (GDestroyNotify)g_object_unref);
+                g_hash_table_unref (seen);
+                return;
+            }
+            if (g_hash_table_contains (seen, link->data))
+                continue;
+            g_hash_table_add (seen, link->data);
+            sms_list = g_list_prepend (sms_list, g_object_ref (link->data));
+        }
+        g_hash_table_unref (seen);
+        sms_list = g_list_reverse (sms_list);
+    } else {
+        for (l = self->priv->list; l; l = g_list_next (l)) {
+            if (filter == MM_SMS_DELETE_FILTER_ALL ||
+                (mm_base_sms_get_delete_filter (MM_BASE_SMS (l->data)) & filter))
+                sms_list = g_list_prepend (sms_list, g_object_ref (l->data));
+        }
+        sms_list = g_list_reverse (sms_list);
+    }
+
+    ctx = g_slice_new0 (DeleteManyContext);
+    ctx->self = g_object_ref (self);
+    ctx->result = g_simple_async_result_new (G_OBJECT (self),
+                                             callback,
+                                             user_data,
+                                             mm_sms_list_delete_many);
+    ctx->filter = (sms_paths ? MM_SMS_DELETE_FILTER_NONE : filter);
+
+    mm_dbg ("Deleting %u SMS...", g_list_length (sms_list));
+    mm_sms_list_begin_batch (self);
+
+    /* Group by storage; the sort is stable so the original order is kept
+     * within each storage. Non-stored SMS just need to be removed. */
+    sms_list = g_list_sort (sms_list, (GCompareFunc)cmp_sms_by_storage);
+    while (sms_list) {
+        MMSmsStorage storage;
+        GList *group;
+
+        storage = mm_base_sms_get_storage (MM_BASE_SMS (sms_list->data));
+        group = sms_list;
+        for (l = sms_list; l->next && mm_base_sms_get_storage (MM_BASE_SMS (l->next->data)) == storage; l = l->next);
+        sms_list = l->next;
+        l->next = NULL;
+        if (sms_list)
+            sms_list->prev = NULL;
+
+        if (storage == MM_SMS_STORAGE_UNKNOWN) {
+            for (l = group; l; l = g_list_next (l)) {
+                remove_deleted_sms (self, MM_BASE_SMS (l->data));
+                ctx->n_deleted++;
+            }
+            g_list_free_full (group, (GDestroyNotify)g_object_unref);
+            continue;
+        }
+
+        ctx->groups = g_list_append (ctx->groups, group);
+    }
+
+    delete_many_next_group (ctx);
 }
 
 /*****************************************************************************/
 
-static guint
-cmp_sms_by_concat_reference (MMBaseSms *sms,
-                             gpointer user_data)
+void
+mm_sms_list_begin_batch (MMSmsList *self)
 {
-    if (!mm_base_sms_is_multipart (sms))
-        return -1;
+    self->priv->batch_depth++;
+}
+
+void
+mm_sms_list_end_batch (MMSmsList *self)
+{
+    guint n_changes;
+
+    g_return_if_fail (self->priv->batch_depth > 0);
+
+    if (--self->priv->batch_depth > 0)
+        return;
 
-    return (GPOINTER_TO_UINT (user_data) - mm_base_sms_get_multipart_reference (sms));
+    n_changes = self->priv->batch_n_changes;
+    self->priv->batch_n_changes = 0;
+    if (n_changes > 0)
+        g_signal_emit (self, signals[SIGNAL_BATCH_DONE], 0, n_changes);
 }
 
-typedef struct {
-    guint part_index;
-    MMSmsStorage storage;
-} PartIndexAndStorage;
+gboolean
+mm_sms_list_in_batch (MMSmsList *self)
+{
+    return self->priv->batch_depth > 0;
+}
+
+/*****************************************************************************/
+
+void
+mm_sms_list_add_sms (MMSmsList *self,
+                     MMBaseSms *sms)
+{
+    /* Parts of local SMS get their index only once stored, so these are
+     * looked up separately */
+    index_sms (self, g_object_ref (sms), NULL);
+    self->priv->local = g_list_prepend (self->priv->local, sms);
+    emit_added (self, sms, FALSE);
+}
+
+/*****************************************************************************/
 
 static guint
 cmp_sms_by_part_index_and_storage (MMBaseSms *sms,
@@ -272,10 +721,8 @@ take_singlepart (MMSmsList *self,
     if (!sms)
         return FALSE;
 
-    self->priv->list = g_list_prepend (self->priv->list, sms);
-    g_signal_emit (self, signals[SIGNAL_ADDED], 0,
-                   mm_base_sms_get_path (sms),
-                   state == MM_SMS_STATE_RECEIVED);
+    index_sms (self, sms, NULL);
+    emit_added (self, sms, state == MM_SMS_STATE_RECEIVED);
     return TRUE;
 }
 
@@ -286,17 +733,21 @@ take_multipart (MMSmsList *self,
                 MMSmsStorage storage,
                 GError **error)
 {
-    GList *l;
     MMBaseSms *sms;
     guint concat_reference;
+    gchar *key;
 
     concat_reference = mm_sms_part_get_concat_reference (part);
-    l = g_list_find_custom (self->priv->list,
-                            GUINT_TO_POINTER (concat_reference),
-                            (GCompareFunc)cmp_sms_by_concat_reference);
-    if (l)
+    key = build_multipart_key (concat_reference, mm_sms_part_get_number (part));
+    sms = g_hash_table_lookup (self->priv->multipart_index, key);
+    if (sms) {
+        g_free (key);
         /* Try to take the part */
-        return mm_base_sms_multipart_take_part (MM_BASE_SMS (l->data), part, error);
+        if (!mm_base_sms_multipart_take_part (sms, part, error))
+            return FALSE;
+        index_part (self, sms, part);
+        return TRUE;
+    }
 
     /* Create new Multipart */
     sms = mm_base_sms_multipart_new (self->priv->modem,
@@ -306,14 +757,16 @@ take_multipart (MMSmsList *self,
                                      mm_sms_part_get_concat_max (part),
                                      part,
                                      error);
-    if (!sms)
+    if (!sms) {
+        g_free (key);
         return FALSE;
+    }
 
-    self->priv->list = g_list_prepend (self->priv->list, sms);
-    g_signal_emit (self, signals[SIGNAL_ADDED], 0,
-                   mm_base_sms_get_path (sms),
-                   (state == MM_SMS_STATE_RECEIVED ||
-                    state == MM_SMS_STATE_RECEIVING));
+    index_sms (self, sms, key);
+    g_free (key);
+    emit_added (self, sms,
+                (state == MM_SMS_STATE_RECEIVED ||
+                 state == MM_SMS_STATE_RECEIVING));
 
     return TRUE;
 }
@@ -332,7 +785,10 @@ mm_sms_list_has_part (MMSmsList *self,
     ctx.part_index = index;
     ctx.storage = storage;
 
-    return !!g_list_find_custom (self->priv->list,
+    if (g_hash_table_contains (self->priv->part_index, &ctx))
+        return TRUE;
+
+    return !!g_list_find_custom (self->priv->local,
                                  &ctx,
                                  (GCompareFunc)cmp_sms_by_part_index_and_storage);
 }
@@ -442,6 +898,16 @@ mm_sms_list_init (MMSmsList *self)
     self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
                                               MM_TYPE_SMS_LIST,
                                               MMSmsListPrivate);
+    self->priv->path_index = g_hash_table_new_full (g_str_hash,
+                                                    g_str_equal,
+                                                    g_free,
+                                                    NULL);
+    self->priv->part_index = g_hash_table_new ((GHashFunc)part_index_and_storage_hash,
+                                               (GEqualFunc)part_index_and_storage_equal);
+    self->priv->multipart_index = g_hash_table_new_full (g_str_hash,
+                                                         g_str_equal,
+                                                         g_free,
+                                                         NULL);
 }
 
 static void
@@ -450,7 +916,15 @@ dispose (GObject *object)
     MMSmsList *self = MM_SMS_LIST (object);
 
     g_clear_object (&self->priv->modem);
+    g_clear_pointer (&self->priv->path_index, g_hash_table_unref);
+    g_clear_pointer (&self->priv->part_index, g_hash_table_unref);
+    g_clear_pointer (&self->priv->multipart_index, g_hash_table_unref);
+    g_clear_pointer (&self->priv->paths, g_strfreev);
+    g_list_free (self->priv->local);
+    self->priv->local = NULL;
     g_list_free_full (self->priv->list, (GDestroyNotify)g_object_unref);
+    self->priv->list = NULL;
+    self->priv->n_sms = 0;
 
     G_OBJECT_CLASS (mm_sms_list_parent_class)->dispose (object);
 }
@@ -494,4 +968,13 @@ mm_sms_list_class_init (MMSmsListClass *klass)
                       NULL, NULL,
                       g_cclosure_marshal_generic,
                       G_TYPE_NONE, 1, G_TYPE_STRING);
+
+    signals[SIGNAL_BATCH_DONE] =
+        g_signal_new (MM_SMS_BATCH_DONE,
+                      G_OBJECT_CLASS_TYPE (object_class),
+                      G_SIGNAL_RUN_FIRST,
+                      G_STRUCT_OFFSET (MMSmsListClass, sms_batch_done),
+                      NULL, NULL,
+                      g_cclosure_marshal_generic,
+                      G_TYPE_NONE, 1, G_TYPE_UINT);
 }
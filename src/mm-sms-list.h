@@ -21,6 +21,7 @@
 
 #include "mm-base-modem.h"
 #include "mm-sms-part.h"
+#include "mm-base-sms.h"
 
 #define MM_TYPE_SMS_LIST            (mm_sms_list_get_type ())
 #define MM_SMS_LIST(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), MM_TYPE_SMS_LIST, MMSmsList))
@@ -37,6 +38,7 @@ typedef struct _MMSmsListPrivate MMSmsListPrivate;
 
 #define MM_SMS_ADDED     "sms-added"
 #define MM_SMS_DELETED   "sms-deleted"
+#define MM_SMS_BATCH_DONE "sms-batch-done"
 
 struct _MMSmsList {
     GObject parent;
@@ -52,6 +54,8 @@ struct _MMSmsListClass {
                            gboolean received);
     void (*sms_deleted)   (MMSmsList *self,
                            const gchar *sms_path);
+    void (*sms_batch_done) (MMSmsList *self,
+                            guint n_changes);
 };
 
 GType mm_sms_list_get_type (void);
@@ -61,6 +65,9 @@ MMSmsList *mm_sms_list_new (MMBaseModem *modem);
 GStrv mm_sms_list_get_paths (MMSmsList *self);
 guint mm_sms_list_get_count (MMSmsList *self);
 
+/* Cached array, valid until the list changes */
+const gchar *const *mm_sms_list_peek_paths (MMSmsList *self);
+
 gboolean mm_sms_list_has_part (MMSmsList *self,
                                MMSmsStorage storage,
                                guint index);
@@ -74,6 +81,12 @@ gboolean mm_sms_list_take_part (MMSmsList *self,
 void mm_sms_list_add_sms (MMSmsList *self,
                           MMBaseSms *sms);
 
+/* While a batch is ongoing, listeners may defer whatever they do on each
+ * 'sms-added' or 'sms-deleted' until 'sms-batch-done' is emitted */
+void     mm_sms_list_begin_batch (MMSmsList *self);
+void     mm_sms_list_end_batch   (MMSmsList *self);
+gboolean mm_sms_list_in_batch    (MMSmsList *self);
+
 void     mm_sms_list_delete_sms        (MMSmsList *self,
                                         const gchar *sms_path,
                                         GAsyncReadyCallback callback,
@@ -82,6 +95,17 @@ gboolean mm_sms_list_delete_sms_finish (MMSmsList *self,
                                         GAsyncResult *res,
                                         GError **error);
 
+/* Delete the given SMS, or all the ones matching 'filter' if 'sms_paths' is
+ * NULL, grouping the removals by storage */
+void     mm_sms_list_delete_many        (MMSmsList *self,
+                                         const gchar *const *sms_paths,
+                                         MMSmsDeleteFilter filter,
+                                         GAsyncReadyCallback callback,
+                                         gpointer user_data);
+gboolean mm_sms_list_delete_many_finish (MMSmsList *self,
+                                         GAsyncResult *res,
+                                         GError **error);
+
 gboolean mm_sms_list_has_local_multipart_reference (MMSmsList *self,
                                                     const gchar *number,
                                                     guint8 reference);
@@ -13,6 +13,8 @@
  * Copyright (C) 2013 Google, Inc.
  */
 
+#define MM_LOG_MODULE MM_LOG_MODULE_SMS
+
 #include <ctype.h>
 #include <string.h>
 
@@ -314,13 +316,20 @@ mm_sms_part_cdma_new_from_pdu (guint index,
                                const gchar *hexpdu,
                                GError **error)
 {
+    guint8 buf[256];
+    gsize hex_len;
     gsize pdu_len;
     guint8 *pdu;
     MMSmsPart *part;
 
-    /* Convert PDU from hex to binary */
-    pdu = (guint8 *) mm_utils_hexstr2bin (hexpdu, &pdu_len);
-    if (!pdu) {
+    /* Convert PDU from hex to binary; in the stack unless it's too long,
+     * which the binary PDU parser will complain about anyway */
+    hex_len = strlen (hexpdu);
+    pdu_len = hex_len / 2;
+    pdu = (pdu_len <= sizeof (buf)) ? buf : g_malloc (pdu_len);
+    if (!mm_utils_hexstr2bin_buf (hexpdu, hex_len, pdu)) {
+        if (pdu != buf)
+            g_free (pdu);
         g_set_error_literal (error,
                              MM_CORE_ERROR,
                              MM_CORE_ERROR_FAILED,
@@ -329,7 +338,8 @@ mm_sms_part_cdma_new_from_pdu (guint index,
     }
 
     part = mm_sms_part_cdma_new_from_binary_pdu (index, pdu, pdu_len, error);
-    g_free (pdu);
+    if (pdu != buf)
+        g_free (pdu);
 
     return part;
 }
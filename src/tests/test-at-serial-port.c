@@ -15,9 +15,19 @@
 
 #include <config.h>
 #include <string.h>
+#include <pty.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <signal.h>
 #include <glib.h>
 
 #include "mm-port-serial-at.h"
+#include "mm-serial-parsers.h"
 #include "mm-log.h"
 
 typedef struct {
@@ -64,6 +74,783 @@ at_serial_echo_removal (void)
     }
 }
 
+/*****************************************************************************/
+/* Serial parser, with and without the final result code fast path */
+
+/* Responses as received after echo removal */
+static const gchar *parser_responses[] = {
+    "\r\nOK\r\n",
+    "\r\nOK\r\n\r\n",
+    "\r\nHUAWEI\r\n\r\nOK\r\n",
+    "\r\n+CSQ: 23,99\r\n\r\nOK\r\n",
+    "\r\n+CPIN: READY\r\n\r\nOK\r\n",
+    "\r\n+COPS: (2,\"Vodafone\",\"voda\",\"21401\",2),(1,\"Orange\",\"Orange\",\"21403\",2),,(0,1,2,3,4),(0,1,2)\r\n\r\nOK\r\n",
+    "\r\n+CGDCONT: 1,\"IP\",\"internet\",\"0.0.0.0\",0,0\r\n+CGDCONT: 2,\"IPV4V6\",\"ims\",\"0.0.0.0\",0,0\r\n\r\nOK\r\n",
+    "\r\n+CME ERROR: 10\r\n",
+    "\r\n+CME ERROR:100\r\n",
+    "\r\n+CME ERROR: SIM not inserted\r\n",
+    "\r\n+CMS ERROR: 321\r\n",
+    "\r\n+CMS ERROR: invalid memory index\r\n",
+    "\r\nMODEM ERROR: 4\r\n",
+    "\r\nERROR\r\n",
+    "\r\n+CGMI: foo\r\n\r\nERROR\r\n",
+    "\r\nCOMMAND NOT SUPPORT\r\n",
+    "\r\nCONNECT 3600000\r\n",
+    "\r\nCONNECT\r\n",
+    "\r\n> ",
+    "\r\nNO CARRIER\r\n",
+    "\r\nBUSY\r\n",
+    "\r\nNO DIALTONE\r\n",
+    "\r\nNA\r\n",
+};
+
+static gboolean
+parse_response (gpointer parser,
+                const gchar *response,
+                gsize response_len,
+                gboolean fast_path,
+                GString **parsed,
+                GError **error)
+{
+    gboolean found;
+
+    mm_serial_parser_v1_set_fast_path (parser, fast_path);
+    *parsed = g_string_new_len (response, response_len);
+    found = mm_serial_parser_v1_parse (parser, *parsed, error);
+    g_assert (found || !*error);
+    return found;
+}
+
+static void
+at_serial_parser_fast_path (void)
+{
+    gpointer parser;
+    guint i;
+
+    parser = mm_serial_parser_v1_new ();
+
+    for (i = 0; i < G_N_ELEMENTS (parser_responses); i++) {
+        gsize len;
+
+        /* Also try with every partial response, as when read in chunks */
+        for (len = 1; len <= strlen (parser_responses[i]); len++) {
+            GString *fast_parsed;
+            GString *slow_parsed;
+            GError *fast_error = NULL;
+            GError *slow_error = NULL;
+            gboolean fast_found;
+            gboolean slow_found;
+
+            fast_found = parse_response (parser, parser_responses[i], len, TRUE, &fast_parsed, &fast_error);
+            slow_found = parse_response (parser, parser_responses[i], len, FALSE, &slow_parsed, &slow_error);
+
+            g_assert_cmpint (fast_found, ==, slow_found);
+            g_assert_cmpstr (fast_parsed->str, ==, slow_parsed->str);
+            if (slow_error) {
+                g_assert (fast_error);
+                g_assert_cmpuint (fast_error->domain, ==, slow_error->domain);
+                g_assert_cmpint (fast_error->code, ==, slow_error->code);
+            } else
+                g_assert (!fast_error);
+
+            g_clear_error (&fast_error);
+            g_clear_error (&slow_error);
+            g_string_free (fast_parsed, TRUE);
+            g_string_free (slow_parsed, TRUE);
+        }
+    }
+
+    mm_serial_parser_v1_destroy (parser);
+}
+
+#define PARSER_BENCHMARK_ITERATIONS 1000
+
+static gdouble
+parser_benchmark_run (gpointer parser,
+                      gboolean fast_path)
+{
+    guint n;
+
+    g_test_timer_start ();
+
+    for (n = 0; n < PARSER_BENCHMARK_ITERATIONS; n++) {
+        guint i;
+
+        for (i = 0; i < G_N_ELEMENTS (parser_responses); i++) {
+            gsize len;
+
+            for (len = 1; len <= strlen (parser_responses[i]); len++) {
+                GString *parsed;
+                GError *error = NULL;
+
+                parse_response (parser, parser_responses[i], len, fast_path, &parsed, &error);
+                g_clear_error (&error);
+                g_string_free (parsed, TRUE);
+            }
+        }
+    }
+
+    return g_test_timer_elapsed ();
+}
+
+static void
+at_serial_parser_benchmark (void)
+{
+    gpointer parser;
+    gdouble slow;
+    gdouble fast;
+
+    parser = mm_serial_parser_v1_new ();
+    slow = parser_benchmark_run (parser, FALSE);
+    fast = parser_benchmark_run (parser, TRUE);
+    mm_serial_parser_v1_destroy (parser);
+
+    g_test_minimized_result (slow, "regex parser: %.3f seconds", slow);
+    g_test_minimized_result (fast, "fast path parser: %.3f seconds (%.1fx)", fast, slow / fast);
+}
+
+/*****************************************************************************/
+/* Splitting the reply of concatenated commands */
+
+static const gchar *concat_commands[] = { "+CGMI", "+CGMM", "AT+CGMR", "+CGSN", NULL };
+
+static void
+at_serial_split_concat_response (void)
+{
+    static const gchar *valid[] = {
+        /* Parsed responses, as given after removing the final OK */
+        "huawei\r\n\r\nE173\r\n\r\n11.126.85.00.209\r\n\r\n353142034588555",
+        "+CGMI: huawei\r\n\r\n+CGMM: E173\r\n\r\n+CGMR: 11.126.85.00.209\r\n\r\n353142034588555\r\n",
+    };
+    static const gchar *invalid[] = {
+        /* One missing line */
+        "huawei\r\n\r\nE173\r\n\r\n353142034588555",
+        /* Multi-line revision */
+        "huawei\r\n\r\nE173\r\n\r\n11.126.85.00.209\r\nbuilt 2010\r\n\r\n353142034588555",
+        /* Prefixed reply to a command found in place of another one */
+        "huawei\r\n\r\n+CGMR: 11.126.85.00.209\r\n\r\n353142034588555\r\nfoo",
+        "",
+    };
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (valid); i++) {
+        gchar **responses;
+        GError *error = NULL;
+
+        responses = mm_port_serial_at_split_concat_response (concat_commands, valid[i], &error);
+        g_assert_no_error (error);
+        g_assert (responses != NULL);
+        g_assert_cmpuint (g_strv_length (responses), ==, 4);
+        g_assert (g_str_has_suffix (responses[0], "huawei"));
+        g_assert (g_str_has_suffix (responses[1], "E173"));
+        g_assert (g_str_has_suffix (responses[2], "11.126.85.00.209"));
+        g_assert_cmpstr (responses[3], ==, "353142034588555");
+        g_strfreev (responses);
+    }
+
+    for (i = 0; i < G_N_ELEMENTS (invalid); i++) {
+        gchar **responses;
+        GError *error = NULL;
+
+        responses = mm_port_serial_at_split_concat_response (concat_commands, invalid[i], &error);
+        g_assert (responses == NULL);
+        g_assert (error != NULL);
+        g_error_free (error);
+    }
+}
+
+/*****************************************************************************/
+/* Line prefixes derived from unsolicited message regexes */
+
+typedef struct {
+    const gchar *pattern;
+    GRegexCompileFlags flags;
+    /* Comma-separated list of prefixes, NULL if none can be derived */
+    const gchar *prefixes;
+} UrcPrefixTest;
+
+static const UrcPrefixTest urc_prefix_tests[] = {
+    /* Anchored, single prefix */
+    { "\\r\\n\\+CREG: (\\d+)\\r\\n", 0, "+CREG" },
+    { "\\r\\n\\^RSSI:\\s*(\\d+)\\r\\n", 0, "^RSSI" },
+    { "\\r\\nRING\\r\\n", 0, "RING" },
+    { "\\r\\n\\+CRING,(.*)\\r\\n", 0, "+CRING" },
+    /* Alternation within a group */
+    { "\\r\\n\\+(CREG|CGREG|CEREG): (\\d+)\\r\\n", 0, "+CREG,+CGREG,+CEREG" },
+    { "\\r\\n\\+(?:CREG|CGREG):", 0, "+CREG,+CGREG" },
+    { "\\r\\n(\\+|\\^)RSSI:", 0, "+RSSI,^RSSI" },
+    /* Not anchored to the start of a line */
+    { "\\+CREG: (\\d+)\\r\\n", 0, NULL },
+    /* No literal prefix */
+    { "\\r\\n.*RING\\r\\n", 0, NULL },
+    { "\\r\\n[+^]RSSI:", 0, NULL },
+    /* Alternation at the top level */
+    { "\\r\\n\\+CREG: (\\d+)|\\r\\nRING\\r\\n", 0, NULL },
+    /* Optional parts */
+    { "\\r\\n\\+?CRING: (\\S+)\\r\\n", 0, NULL },
+    { "\\r\\n(CREG|CGREG)?:", 0, NULL },
+    { "\\r\\n\\+CREG:?\\s*(\\d+)", 0, NULL },
+    /* No delimiter after the prefix */
+    { "\\r\\nRING", 0, NULL },
+    /* Unsupported flags */
+    { "\\r\\n\\^BOOT:(\\d+)\\r\\n", G_REGEX_CASELESS, NULL },
+};
+
+static void
+at_serial_urc_prefixes (void)
+{
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (urc_prefix_tests); i++) {
+        GRegex *regex;
+        gchar **prefixes;
+
+        regex = g_regex_new (urc_prefix_tests[i].pattern,
+                             G_REGEX_RAW | G_REGEX_OPTIMIZE | urc_prefix_tests[i].flags,
+                             0,
+                             NULL);
+        g_assert (regex != NULL);
+
+        prefixes = mm_port_serial_at_get_unsolicited_msg_prefixes (regex);
+        if (!urc_prefix_tests[i].prefixes)
+            g_assert (prefixes == NULL);
+        else {
+            gchar *joined;
+
+            g_assert (prefixes != NULL);
+            joined = g_strjoinv (",", prefixes);
+            g_assert_cmpstr (joined, ==, urc_prefix_tests[i].prefixes);
+            g_free (joined);
+        }
+
+        g_strfreev (prefixes);
+        g_regex_unref (regex);
+    }
+}
+
+/*****************************************************************************/
+/* Concatenated commands sent through a fake modem */
+
+typedef struct {
+    int master;
+    int slave;
+    gboolean valid;
+    pid_t child;
+} TestData;
+
+static void
+test_pty_create (TestData *d)
+{
+    struct termios stbuf;
+    int ret;
+
+    ret = openpty (&d->master, &d->slave, NULL, NULL, NULL);
+    g_assert (ret == 0);
+    d->valid = TRUE;
+
+    /* set raw mode on both sides using kernel default parameters */
+    memset (&stbuf, 0, sizeof (stbuf));
+    tcgetattr (d->slave, &stbuf);
+    tcflush (d->slave, TCIOFLUSH);
+    cfmakeraw (&stbuf);
+    tcsetattr (d->slave, TCSANOW, &stbuf);
+    tcsetattr (d->master, TCSANOW, &stbuf);
+    fcntl (d->slave, F_SETFL, O_NONBLOCK);
+    fcntl (d->master, F_SETFL, O_NONBLOCK);
+}
+
+static void
+test_pty_cleanup (TestData *d)
+{
+    if (d->valid) {
+        if (d->child)
+            kill (d->child, SIGKILL);
+        if (d->master >= 0)
+            close (d->master);
+        if (d->slave >= 0)
+            close (d->slave);
+        memset (d, 0, sizeof (*d));
+    }
+}
+
+static gboolean
+wait_for_child (TestData *d, guint32 timeout)
+{
+    GTimer *timer;
+    int status, ret;
+
+    timer = g_timer_new ();
+    do {
+        status = 0;
+        ret = waitpid (d->child, &status, WNOHANG);
+        if (ret == 0 && g_timer_elapsed (timer, NULL) > timeout) {
+            kill (d->child, SIGKILL);
+            ret = waitpid (d->child, &status, 0);
+        } else if (ret == 0)
+            usleep (10000);
+    } while ((ret <= 0) || (!WIFEXITED (status) && !WIFSIGNALED (status)));
+    g_timer_destroy (timer);
+
+    d->child = 0;
+    return (WIFEXITED (status) && WEXITSTATUS (status) == 0);
+}
+
+/* Reads a full command line, up to the trailing <CR> */
+static gchar *
+server_wait_command (int fd)
+{
+    GString *command;
+    guint retries = 0;
+
+    command = g_string_new (NULL);
+    while (retries < 300) {
+        gchar c;
+
+        errno = 0;
+        if (read (fd, &c, 1) != 1) {
+            g_assert (errno == EAGAIN || errno == 0);
+            usleep (10000);
+            retries++;
+            continue;
+        }
+        if (c == '\r')
+            return g_string_free (command, FALSE);
+        g_string_append_c (command, c);
+    }
+
+    g_string_free (command, TRUE);
+    return NULL;
+}
+
+static void
+server_send_response (int fd, const gchar *response)
+{
+    gsize len;
+    gsize i = 0;
+
+    len = strlen (response);
+    while (i < len) {
+        ssize_t written;
+
+        written = write (fd, &response[i], len - i);
+        if (written < 0) {
+            g_assert (errno == EAGAIN);
+            usleep (1000);
+            continue;
+        }
+        i += written;
+    }
+}
+
+static MMPortSerialAt *
+at_port_new_fd (int fd)
+{
+    MMPortSerialAt *port;
+    gchar *name;
+
+    name = g_strdup_printf ("port%d", fd);
+    port = MM_PORT_SERIAL_AT (g_object_new (MM_TYPE_PORT_SERIAL_AT,
+                                            MM_PORT_DEVICE, name,
+                                            MM_PORT_SUBSYS, MM_PORT_SUBSYS_TTY,
+                                            MM_PORT_TYPE, MM_PORT_TYPE_AT,
+                                            MM_PORT_SERIAL_FD, fd,
+                                            MM_PORT_SERIAL_SEND_DELAY, (guint64) 0,
+                                            MM_PORT_SERIAL_AT_INIT_SEQUENCE_ENABLED, FALSE,
+                                            MM_PORT_SERIAL_AT_CONCAT_COMMANDS, TRUE,
+                                            NULL));
+    g_free (name);
+
+    mm_port_serial_at_set_response_parser (port,
+                                           mm_serial_parser_v1_parse,
+                                           mm_serial_parser_v1_new (),
+                                           mm_serial_parser_v1_destroy);
+    return port;
+}
+
+static const gchar *concat_test_commands[] = { "+CGMI", "+CGMM", "+CGMR", NULL };
+
+static void
+concat_cached_command_ready (MMPortSerialAt *port,
+                             GAsyncResult *res,
+                             GMainLoop *loop)
+{
+    const gchar *response;
+    GError *error = NULL;
+
+    /* Must have been replied from the cache, the fake modem doesn't reply
+     * to anything else */
+    response = mm_port_serial_at_command_finish (port, res, &error);
+    g_assert_no_error (error);
+    g_assert_cmpstr (response, ==, "E173");
+
+    g_main_loop_quit (loop);
+}
+
+static void
+concat_command_ready (MMPortSerialAt *port,
+                      GAsyncResult *res,
+                      GMainLoop *loop)
+{
+    gchar **responses;
+    GError *error = NULL;
+
+    responses = mm_port_serial_at_command_concat_finish (port, res, &error);
+    g_assert_no_error (error);
+    g_assert (responses != NULL);
+    g_assert_cmpuint (g_strv_length (responses), ==, 3);
+    g_assert_cmpstr (responses[0], ==, "huawei");
+    g_assert_cmpstr (responses[1], ==, "E173");
+    g_assert_cmpstr (responses[2], ==, "11.126.85.00.209");
+    g_strfreev (responses);
+
+    mm_port_serial_at_command (port,
+                               "+CGMM",
+                               1000,
+                               FALSE,
+                               TRUE, /* allow cached */
+                               NULL,
+                               (GAsyncReadyCallback) concat_cached_command_ready,
+                               loop);
+}
+
+static void
+concat_test_child (int fd)
+{
+    MMPortSerialAt *port;
+    GMainLoop *loop;
+    GError *error = NULL;
+    gboolean success;
+
+    loop = g_main_loop_new (NULL, FALSE);
+
+    port = at_port_new_fd (fd);
+    g_assert (mm_port_serial_at_get_concat_commands (port));
+
+    success = mm_port_serial_open (MM_PORT_SERIAL (port), &error);
+    g_assert_no_error (error);
+    g_assert (success);
+
+    mm_port_serial_at_command_concat (port,
+                                      concat_test_commands,
+                                      3000,
+                                      TRUE, /* allow cached */
+                                      NULL,
+                                      (GAsyncReadyCallback) concat_command_ready,
+                                      loop);
+    g_main_loop_run (loop);
+    g_main_loop_unref (loop);
+
+    mm_port_serial_close (MM_PORT_SERIAL (port));
+    g_object_unref (port);
+}
+
+static void
+test_concat_commands (TestData *d)
+{
+    gchar *command;
+    pid_t cpid;
+
+    signal (SIGCHLD, SIG_DFL);
+    cpid = fork ();
+    g_assert (cpid >= 0);
+
+    if (cpid == 0) {
+        /* In the child */
+        concat_test_child (d->slave);
+        exit (0);
+    }
+    /* Parent, acting as the modem */
+    d->child = cpid;
+
+    command = server_wait_command (d->master);
+    g_assert_cmpstr (command, ==, "AT+CGMI;+CGMM;+CGMR");
+    g_free (command);
+
+    server_send_response (d->master,
+                          "\r\nhuawei\r\n"
+                          "\r\nE173\r\n"
+                          "\r\n11.126.85.00.209\r\n"
+                          "\r\nOK\r\n");
+
+    g_assert (wait_for_child (d, 5));
+}
+
+/*****************************************************************************/
+/* Input parsed in the I/O worker thread */
+
+typedef struct {
+    GMainLoop *loop;
+    GThread *main_thread;
+    guint n_rings;
+} WorkerTestContext;
+
+static void
+worker_ring_received (MMPortSerialAt *port,
+                      GMatchInfo *match_info,
+                      WorkerTestContext *ctx)
+{
+    gchar *type;
+
+    /* Handlers always run in the main context */
+    g_assert (g_thread_self () == ctx->main_thread);
+
+    type = g_match_info_fetch (match_info, 1);
+    g_assert_cmpstr (type, ==, "VOICE");
+    g_free (type);
+    ctx->n_rings++;
+}
+
+static void
+worker_command_ready (MMPortSerialAt *port,
+                      GAsyncResult *res,
+                      WorkerTestContext *ctx)
+{
+    const gchar *response;
+    GError *error = NULL;
+
+    g_assert (g_thread_self () == ctx->main_thread);
+
+    response = mm_port_serial_at_command_finish (port, res, &error);
+    g_assert_no_error (error);
+    g_assert_cmpstr (response, ==, "huawei");
+
+    /* The unsolicited messages preceding the reply were dispatched first */
+    g_assert_cmpuint (ctx->n_rings, ==, 2);
+
+    g_main_loop_quit (ctx->loop);
+}
+
+static void
+worker_test_child (int fd)
+{
+    WorkerTestContext ctx;
+    MMPortSerialAt *port;
+    GRegex *regex;
+    GError *error = NULL;
+    gboolean success;
+    guint n_dispatches = 0;
+    guint64 total_delay = 0;
+    guint64 max_delay = 0;
+
+    mm_port_serial_set_io_worker_enabled (TRUE);
+
+    ctx.loop = g_main_loop_new (NULL, FALSE);
+    ctx.main_thread = g_thread_self ();
+    ctx.n_rings = 0;
+
+    port = at_port_new_fd (fd);
+    regex = g_regex_new ("\\r\\n\\+CRING:\\s*(\\S+)\\r\\n",
+                         G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    mm_port_serial_at_add_unsolicited_msg_handler (port,
+                                                   regex,
+                                                   (MMPortSerialAtUnsolicitedMsgFn) worker_ring_received,
+                                                   &ctx,
+                                                   NULL);
+    g_regex_unref (regex);
+
+    success = mm_port_serial_open (MM_PORT_SERIAL (port), &error);
+    g_assert_no_error (error);
+    g_assert (success);
+
+    mm_port_serial_at_command (port,
+                               "+CGMI",
+                               3000,
+                               FALSE,
+                               FALSE,
+                               NULL,
+                               (GAsyncReadyCallback) worker_command_ready,
+                               &ctx);
+    g_main_loop_run (ctx.loop);
+    g_main_loop_unref (ctx.loop);
+
+    mm_port_serial_get_io_worker_stats (MM_PORT_SERIAL (port), &n_dispatches, &total_delay, &max_delay);
+    g_assert_cmpuint (n_dispatches, >, 0);
+    g_assert_cmpuint (max_delay, <=, total_delay);
+
+    mm_port_serial_close (MM_PORT_SERIAL (port));
+    g_object_unref (port);
+}
+
+static void
+test_io_worker (TestData *d)
+{
+    gchar *command;
+    pid_t cpid;
+
+    signal (SIGCHLD, SIG_DFL);
+    cpid = fork ();
+    g_assert (cpid >= 0);
+
+    if (cpid == 0) {
+        /* In the child */
+        worker_test_child (d->slave);
+        exit (0);
+    }
+    /* Parent, acting as the modem */
+    d->child = cpid;
+
+    command = server_wait_command (d->master);
+    g_assert_cmpstr (command, ==, "AT+CGMI");
+    g_free (command);
+
+    /* Unsolicited messages before and within the reply */
+    server_send_response (d->master, "\r\n+CRING: VOICE\r\n");
+    usleep (50000);
+    server_send_response (d->master,
+                          "\r\nhuawei\r\n"
+                          "\r\n+CRING: VOICE\r\n"
+                          "\r\nOK\r\n");
+
+    g_assert (wait_for_child (d, 5));
+}
+
+/*****************************************************************************/
+/* Unsolicited messages dispatched through the prefix index */
+
+typedef enum {
+    URC_CREG,          /* '+CREG', shared with URC_CREG_LOCATION */
+    URC_CREG_LOCATION, /* '+CREG', shared with URC_CREG */
+    URC_MODE,          /* '^MODE' or '^SYSINFO' */
+    URC_BOOT,          /* no prefix, always run */
+    URC_CGREG,         /* '+CGREG', never received */
+    URC_LAST
+} UrcId;
+
+static const struct {
+    const gchar *pattern;
+    GRegexCompileFlags flags;
+} dispatch_urcs[URC_LAST] = {
+    [URC_CREG]          = { "\\r\\n\\+CREG: (\\d)\\r\\n", 0 },
+    [URC_CREG_LOCATION] = { "\\r\\n\\+CREG: (\\d),\"(\\w+)\",\"(\\w+)\"\\r\\n", 0 },
+    [URC_MODE]          = { "\\r\\n\\^(MODE|SYSINFO):(\\d+),(\\d+)\\r\\n", 0 },
+    [URC_BOOT]          = { "\\r\\n\\^BOOT:(\\d+)\\r\\n", G_REGEX_CASELESS },
+    [URC_CGREG]         = { "\\r\\n\\+CGREG: (\\d)\\r\\n", 0 },
+};
+
+typedef struct {
+    GMainLoop *loop;
+    guint received[URC_LAST];
+} DispatchTestContext;
+
+static void
+dispatch_urc_received (MMPortSerialAt *port,
+                       GMatchInfo *match_info,
+                       guint *received)
+{
+    (*received)++;
+}
+
+static void
+dispatch_command_ready (MMPortSerialAt *port,
+                        GAsyncResult *res,
+                        DispatchTestContext *ctx)
+{
+    const gchar *response;
+    GError *error = NULL;
+
+    response = mm_port_serial_at_command_finish (port, res, &error);
+    g_assert_no_error (error);
+    g_assert_cmpstr (response, ==, "huawei");
+
+    /* Both handlers sharing the '+CREG' prefix got their own message */
+    g_assert_cmpuint (ctx->received[URC_CREG], ==, 1);
+    g_assert_cmpuint (ctx->received[URC_CREG_LOCATION], ==, 1);
+    /* Found through one of the alternatives of the group */
+    g_assert_cmpuint (ctx->received[URC_MODE], ==, 1);
+    /* Not indexed, but still run */
+    g_assert_cmpuint (ctx->received[URC_BOOT], ==, 1);
+    g_assert_cmpuint (ctx->received[URC_CGREG], ==, 0);
+
+    g_main_loop_quit (ctx->loop);
+}
+
+static void
+dispatch_test_child (int fd)
+{
+    DispatchTestContext ctx;
+    MMPortSerialAt *port;
+    GError *error = NULL;
+    gboolean success;
+    guint i;
+
+    memset (&ctx, 0, sizeof (ctx));
+    ctx.loop = g_main_loop_new (NULL, FALSE);
+
+    port = at_port_new_fd (fd);
+    for (i = 0; i < URC_LAST; i++) {
+        GRegex *regex;
+
+        regex = g_regex_new (dispatch_urcs[i].pattern,
+                             G_REGEX_RAW | G_REGEX_OPTIMIZE | dispatch_urcs[i].flags,
+                             0,
+                             NULL);
+        g_assert (regex != NULL);
+        mm_port_serial_at_add_unsolicited_msg_handler (port,
+                                                       regex,
+                                                       (MMPortSerialAtUnsolicitedMsgFn) dispatch_urc_received,
+                                                       &ctx.received[i],
+                                                       NULL);
+        g_regex_unref (regex);
+    }
+
+    success = mm_port_serial_open (MM_PORT_SERIAL (port), &error);
+    g_assert_no_error (error);
+    g_assert (success);
+
+    mm_port_serial_at_command (port,
+                               "+CGMI",
+                               3000,
+                               FALSE,
+                               FALSE,
+                               NULL,
+                               (GAsyncReadyCallback) dispatch_command_ready,
+                               &ctx);
+    g_main_loop_run (ctx.loop);
+    g_main_loop_unref (ctx.loop);
+
+    mm_port_serial_close (MM_PORT_SERIAL (port));
+    g_object_unref (port);
+}
+
+static void
+test_urc_dispatch (TestData *d)
+{
+    gchar *command;
+    pid_t cpid;
+
+    signal (SIGCHLD, SIG_DFL);
+    cpid = fork ();
+    g_assert (cpid >= 0);
+
+    if (cpid == 0) {
+        /* In the child */
+        dispatch_test_child (d->slave);
+        exit (0);
+    }
+    /* Parent, acting as the modem */
+    d->child = cpid;
+
+    command = server_wait_command (d->master);
+    g_assert_cmpstr (command, ==, "AT+CGMI");
+    g_free (command);
+
+    server_send_response (d->master,
+                          "\r\n+CREG: 1\r\n"
+                          "\r\n+CREG: 5,\"00AB\",\"1234\"\r\n"
+                          "\r\n^SYSINFO:2,3\r\n"
+                          "\r\n^boot:12345\r\n");
+    usleep (50000);
+    server_send_response (d->master,
+                          "\r\nhuawei\r\n"
+                          "\r\nOK\r\n");
+
+    g_assert (wait_for_child (d, 5));
+}
+
+/*****************************************************************************/
+
+MM_LOG_DEFINE_LEVELS (LOGL_ALL);
+
 void
 _mm_log (const char *loc,
          const char *func,
@@ -84,12 +871,23 @@ _mm_log (const char *loc,
 #endif
 }
 
+typedef void (*TCFunc) (TestData *, gconstpointer);
+#define TESTCASE_PTY(s, t) g_test_add (s, TestData, NULL, (TCFunc)test_pty_create, (TCFunc)t, (TCFunc)test_pty_cleanup);
+
 int main (int argc, char **argv)
 {
     g_type_init ();
     g_test_init (&argc, &argv, NULL);
 
     g_test_add_func ("/ModemManager/AT-serial/echo-removal", at_serial_echo_removal);
+    g_test_add_func ("/ModemManager/AT-serial/parser-fast-path", at_serial_parser_fast_path);
+    g_test_add_func ("/ModemManager/AT-serial/split-concat-response", at_serial_split_concat_response);
+    g_test_add_func ("/ModemManager/AT-serial/urc-prefixes", at_serial_urc_prefixes);
+    TESTCASE_PTY ("/ModemManager/AT-serial/concat-commands", test_concat_commands);
+    TESTCASE_PTY ("/ModemManager/AT-serial/io-worker", test_io_worker);
+    TESTCASE_PTY ("/ModemManager/AT-serial/urc-dispatch", test_urc_dispatch);
+    if (g_test_perf ())
+        g_test_add_func ("/ModemManager/AT-serial/parser-benchmark", at_serial_parser_benchmark);
 
     return g_test_run ();
 }
@@ -362,6 +362,443 @@ test_take_convert_ucs2_bad_ascii2 (void *f, gpointer d)
 }
 
 
+static void
+test_hex_ucs2_round_trip (void *f, gpointer d)
+{
+    static const struct {
+        const gchar *utf8;
+        const gchar *hex;
+    } values[] = {
+        { "T-Mobile",  "0054002D004D006F00620069006C0065" },
+        { "Órange €",  "00D300720061006E00670065002020AC" },
+        { "日本語",     "65E5672C8A9E" },
+        { "",          "" },
+    };
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (values); i++) {
+        gchar *hex;
+        gchar *utf8;
+
+        hex = mm_modem_charset_utf8_to_hex (values[i].utf8, MM_MODEM_CHARSET_UCS2);
+        g_assert_cmpstr (hex, ==, values[i].hex);
+        utf8 = mm_modem_charset_hex_to_utf8 (hex, MM_MODEM_CHARSET_UCS2);
+        g_assert_cmpstr (utf8, ==, values[i].utf8);
+        g_free (utf8);
+        g_free (hex);
+    }
+}
+
+static void
+test_hex_ucs2_surrogates (void *f, gpointer d)
+{
+    gchar *str;
+
+    /* Surrogate pairs are decoded, as UTF-16 */
+    str = mm_modem_charset_hex_to_utf8 ("0041D83DDE000042", MM_MODEM_CHARSET_UCS2);
+    g_assert_cmpstr (str, ==, "A\xF0\x9F\x98\x80" "B");
+    g_free (str);
+
+    /* Unpaired surrogates are invalid */
+    str = mm_modem_charset_hex_to_utf8 ("D83D0041", MM_MODEM_CHARSET_UCS2);
+    g_assert (str == NULL);
+    str = mm_modem_charset_hex_to_utf8 ("DE000041", MM_MODEM_CHARSET_UCS2);
+    g_assert (str == NULL);
+    str = mm_modem_charset_hex_to_utf8 ("0041D83D", MM_MODEM_CHARSET_UCS2);
+    g_assert (str == NULL);
+
+    /* Odd number of bytes */
+    str = mm_modem_charset_hex_to_utf8 ("004100", MM_MODEM_CHARSET_UCS2);
+    g_assert (str == NULL);
+
+    /* But characters out of the BMP can't be encoded in UCS-2 */
+    str = mm_modem_charset_utf8_to_hex ("A\xF0\x9F\x98\x80", MM_MODEM_CHARSET_UCS2);
+    g_assert (str == NULL);
+}
+
+static void
+test_hex_8859_1 (void *f, gpointer d)
+{
+    gchar *str;
+
+    str = mm_modem_charset_utf8_to_hex ("Órange ñ", MM_MODEM_CHARSET_8859_1);
+    g_assert_cmpstr (str, ==, "D372616E676520F1");
+    g_free (str);
+
+    str = mm_modem_charset_hex_to_utf8 ("D372616E676520F1", MM_MODEM_CHARSET_8859_1);
+    g_assert_cmpstr (str, ==, "Órange ñ");
+    g_free (str);
+
+    /* Not representable */
+    str = mm_modem_charset_utf8_to_hex ("€", MM_MODEM_CHARSET_8859_1);
+    g_assert (str == NULL);
+}
+
+static void
+test_byte_array_append (void *f, gpointer d)
+{
+    GByteArray *array;
+
+    array = g_byte_array_new ();
+
+    g_assert (mm_modem_charset_byte_array_append (array, "Hi", TRUE, MM_MODEM_CHARSET_IRA));
+    g_assert (mm_modem_charset_byte_array_append (array, "é", FALSE, MM_MODEM_CHARSET_UCS2));
+    g_assert (mm_modem_charset_byte_array_append (array, "é", FALSE, MM_MODEM_CHARSET_8859_1));
+    g_assert (mm_modem_charset_byte_array_append (array, "é", FALSE, MM_MODEM_CHARSET_UTF8));
+
+    g_assert_cmpuint (array->len, ==, 4 + 2 + 1 + 2);
+    g_assert (memcmp (array->data, "\"Hi\"\x00\xE9\xE9\xC3\xA9", array->len) == 0);
+
+    g_byte_array_unref (array);
+}
+
+static void
+test_take_convert_pccp437 (void *f, gpointer d)
+{
+    gchar *src, *converted;
+
+    /* Converted with iconv, twice so that the cached converter is reused */
+    src = g_strdup ("\x82t\x82");
+    converted = mm_charset_take_and_convert_to_utf8 (src, MM_MODEM_CHARSET_PCCP437);
+    g_assert_cmpstr (converted, ==, "été");
+    converted = mm_utf8_take_and_convert_to_charset (converted, MM_MODEM_CHARSET_PCCP437);
+    g_assert_cmpstr (converted, ==, "\x82t\x82");
+    g_free (converted);
+}
+
+/*****************************************************************************/
+/* Reference septet and hex codecs, processing a bit or a char at a time */
+
+static void
+reference_gsm_unpack (const guint8 *gsm,
+                      guint32 num_septets,
+                      guint8 start_offset,
+                      guint8 *out)
+{
+    guint32 i;
+
+    for (i = 0; i < num_septets; i++) {
+        guint32 bit;
+
+        out[i] = 0;
+        for (bit = 0; bit < 7; bit++) {
+            guint32 pos = start_offset + (i * 7) + bit;
+
+            if (gsm[pos / 8] & (1 << (pos % 8)))
+                out[i] |= 1 << bit;
+        }
+    }
+}
+
+static void
+reference_gsm_pack (const guint8 *src,
+                    guint32 src_len,
+                    guint8 start_offset,
+                    guint8 *out)
+{
+    guint32 i;
+
+    for (i = 0; i < src_len; i++) {
+        guint32 bit;
+
+        for (bit = 0; bit < 7; bit++) {
+            guint32 pos = start_offset + (i * 7) + bit;
+
+            if (src[i] & (1 << bit))
+                out[pos / 8] |= 1 << (pos % 8);
+        }
+    }
+}
+
+static gboolean
+reference_hex_decode (const gchar *hex,
+                      gsize hex_len,
+                      guint8 *out)
+{
+    gsize i;
+
+    if (hex_len % 2)
+        return FALSE;
+
+    for (i = 0; i < hex_len; i += 2) {
+        gint a;
+
+        a = mm_utils_hex2byte (&hex[i]);
+        if (a < 0)
+            return FALSE;
+        out[i / 2] = a;
+    }
+    return TRUE;
+}
+
+static void
+reference_hex_encode (const guint8 *bin,
+                      gsize len,
+                      gchar *out)
+{
+    gsize i;
+
+    for (i = 0; i < len; i++)
+        g_snprintf (&out[i * 2], 3, "%.2X", bin[i]);
+    out[len * 2] = '\0';
+}
+
+static void
+test_pack_unpack_gsm7_lengths (void *f, gpointer d)
+{
+    guint8 src[200];
+    guint32 len;
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (src); i++)
+        src[i] = g_test_rand_int_range (0, 0x80);
+
+    /* All lengths, so that both the word and per-septet paths are used */
+    for (len = 0; len <= G_N_ELEMENTS (src); len++) {
+        guint8 offset;
+
+        for (offset = 0; offset < 8; offset++) {
+            guint8 expected[200] = { 0 };
+            guint8 *packed;
+            guint8 *unpacked;
+            guint32 packed_len = 0;
+            guint32 unpacked_len = 0;
+
+            reference_gsm_pack (src, len, offset, expected);
+            packed = gsm_pack (src, len, offset, &packed_len);
+            g_assert_cmpuint (packed_len, ==, (len * 7 + offset + 7) / 8);
+            g_assert (memcmp (packed, expected, packed_len) == 0);
+
+            unpacked = gsm_unpack (packed, len, offset, &unpacked_len);
+            g_assert_cmpuint (unpacked_len, ==, len);
+            g_assert (memcmp (unpacked, src, len) == 0);
+
+            g_free (unpacked);
+            g_free (packed);
+        }
+    }
+}
+
+static void
+test_hex_codecs (void *f, gpointer d)
+{
+    guint8 bin[100];
+    guint8 decoded[100];
+    gchar hex[201];
+    gchar expected[201];
+    gsize len;
+    gsize i;
+
+    for (i = 0; i < G_N_ELEMENTS (bin); i++)
+        bin[i] = g_test_rand_int_range (0, 0x100);
+
+    for (len = 0; len <= G_N_ELEMENTS (bin); len++) {
+        mm_utils_bin2hexstr_buf (bin, len, hex);
+        reference_hex_encode (bin, len, expected);
+        g_assert_cmpstr (hex, ==, expected);
+
+        g_assert (mm_utils_hexstr2bin_buf (hex, len * 2, decoded));
+        g_assert (memcmp (decoded, bin, len) == 0);
+
+        /* Lowercase */
+        for (i = 0; i < len * 2; i++)
+            hex[i] = g_ascii_tolower (hex[i]);
+        g_assert (mm_utils_hexstr2bin_buf (hex, len * 2, decoded));
+        g_assert (memcmp (decoded, bin, len) == 0);
+
+        /* Invalid chars in every position */
+        for (i = 0; i < len * 2; i++) {
+            static const gchar invalid[] = { 'g', 'G', '/', ':', '@', '`', ' ', '\xB0' };
+            gchar c;
+
+            c = hex[i];
+            hex[i] = invalid[i % G_N_ELEMENTS (invalid)];
+            g_assert (!mm_utils_hexstr2bin_buf (hex, len * 2, decoded));
+            hex[i] = c;
+        }
+    }
+
+    /* Odd length */
+    g_assert (!mm_utils_hexstr2bin_buf ("ABC", 3, decoded));
+}
+
+/*****************************************************************************/
+
+#define CODECS_BENCHMARK_ITERATIONS 20000
+
+/* Real PDUs: multipart GSM 7-bit, UDH with GSM 7-bit, and UCS2 */
+static const gchar *benchmark_pdus[] = {
+    "07912160130320F5440B916171056429F5000021405291650569A00500034C0201A9E8F41C949E"
+    "83C2207B599E07B1DFEE33885E9ED341E4F23C7D7697C920FA1B54C697E5E3F4BC0C6AD7D9F434"
+    "081E96D341E3303C2C4EB3D3F4BC0B94A483E6E8779D4D06CDD1EF3BA80E0785E7A0B7BB0C6A97"
+    "E7F3F0B9CC02B9DF7450780EA2DFDF2C50780EA2A3CBA0BA9B5C96B3F369F71954768FDFE4B4FB"
+    "0C9297E1F2F2BCECA6CF41",
+    "07911356131313F64004850120390011609232239180A006080400100201D7327BFD6EB340E232"
+    "1BF46E83EA7790F59D1E97DBE1341B442F83C465763D3DA797E56537C81D0ECB41AB59CC1693C1"
+    "6031D96C064241E5656838AF03A96230982A269BCD462917C8FA4E8FCBED709A0D7ABBE9F6B0FB"
+    "5C7683D27350984D4FABC9A0B33C4C4FCF5D20EBFB2D079DCB62793DBD06D9C36E50FB2D4E97D9"
+    "A0B49B5E96BBCB",
+    "002100098136397339F70008224F60597D4F60597D4F60597D4F60597D4F60597D4F60597D4F60597D4F60597D4F60",
+};
+
+static void
+report_throughput (const gchar *what,
+                   gsize bytes,
+                   gdouble reference,
+                   gdouble elapsed)
+{
+    g_test_minimized_result (elapsed,
+                             "%s: reference %.1f MB/s, %.1f MB/s (%.1fx)",
+                             what,
+                             (bytes / reference) / 1e6,
+                             (bytes / elapsed) / 1e6,
+                             reference / elapsed);
+}
+
+static void
+test_codecs_benchmark (void *f, gpointer d)
+{
+    guint8 bin[3][256];
+    gsize bin_len[3];
+    gchar hex[513];
+    guint8 septets[160];
+    guint8 packed[140];
+    gsize total_hex = 0;
+    gsize total_bin = 0;
+    gdouble reference;
+    gdouble elapsed;
+    guint n;
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (benchmark_pdus); i++) {
+        bin_len[i] = strlen (benchmark_pdus[i]) / 2;
+        g_assert (mm_utils_hexstr2bin_buf (benchmark_pdus[i], bin_len[i] * 2, bin[i]));
+        total_hex += bin_len[i] * 2;
+        total_bin += bin_len[i];
+    }
+
+    /* Hex decoding */
+    g_test_timer_start ();
+    for (n = 0; n < CODECS_BENCHMARK_ITERATIONS; n++)
+        for (i = 0; i < G_N_ELEMENTS (benchmark_pdus); i++)
+            reference_hex_decode (benchmark_pdus[i], bin_len[i] * 2, bin[i]);
+    reference = g_test_timer_elapsed ();
+    g_test_timer_start ();
+    for (n = 0; n < CODECS_BENCHMARK_ITERATIONS; n++)
+        for (i = 0; i < G_N_ELEMENTS (benchmark_pdus); i++)
+            mm_utils_hexstr2bin_buf (benchmark_pdus[i], bin_len[i] * 2, bin[i]);
+    elapsed = g_test_timer_elapsed ();
+    report_throughput ("hex decode", total_hex * CODECS_BENCHMARK_ITERATIONS, reference, elapsed);
+
+    /* Hex encoding */
+    g_test_timer_start ();
+    for (n = 0; n < CODECS_BENCHMARK_ITERATIONS; n++)
+        for (i = 0; i < G_N_ELEMENTS (benchmark_pdus); i++)
+            reference_hex_encode (bin[i], bin_len[i], hex);
+    reference = g_test_timer_elapsed ();
+    g_test_timer_start ();
+    for (n = 0; n < CODECS_BENCHMARK_ITERATIONS; n++)
+        for (i = 0; i < G_N_ELEMENTS (benchmark_pdus); i++)
+            mm_utils_bin2hexstr_buf (bin[i], bin_len[i], hex);
+    elapsed = g_test_timer_elapsed ();
+    report_throughput ("hex encode", total_bin * CODECS_BENCHMARK_ITERATIONS, reference, elapsed);
+
+    /* Septets of a full single-part message */
+    for (i = 0; i < G_N_ELEMENTS (septets); i++)
+        septets[i] = bin[0][i % bin_len[0]] & 0x7F;
+
+    g_test_timer_start ();
+    for (n = 0; n < CODECS_BENCHMARK_ITERATIONS; n++) {
+        memset (packed, 0, sizeof (packed));
+        reference_gsm_pack (septets, G_N_ELEMENTS (septets), 0, packed);
+    }
+    reference = g_test_timer_elapsed ();
+    g_test_timer_start ();
+    for (n = 0; n < CODECS_BENCHMARK_ITERATIONS; n++)
+        g_free (gsm_pack (septets, G_N_ELEMENTS (septets), 0, NULL));
+    elapsed = g_test_timer_elapsed ();
+    report_throughput ("GSM 7-bit pack", G_N_ELEMENTS (septets) * CODECS_BENCHMARK_ITERATIONS, reference, elapsed);
+
+    g_test_timer_start ();
+    for (n = 0; n < CODECS_BENCHMARK_ITERATIONS; n++)
+        reference_gsm_unpack (packed, G_N_ELEMENTS (septets), 0, septets);
+    reference = g_test_timer_elapsed ();
+    g_test_timer_start ();
+    for (n = 0; n < CODECS_BENCHMARK_ITERATIONS; n++) {
+        guint32 unpacked_len;
+
+        g_free (gsm_unpack (packed, G_N_ELEMENTS (septets), 0, &unpacked_len));
+    }
+    elapsed = g_test_timer_elapsed ();
+    report_throughput ("GSM 7-bit unpack", G_N_ELEMENTS (septets) * CODECS_BENCHMARK_ITERATIONS, reference, elapsed);
+}
+
+/*****************************************************************************/
+
+#define CHARSETS_BENCHMARK_ITERATIONS 20000
+
+/* What the conversion did before, opening a new iconv descriptor each time */
+static gchar *
+reference_hex_to_utf8 (const gchar *hex,
+                       const gchar *iconv_from)
+{
+    gchar *bin;
+    gchar *utf8;
+    gsize len = 0;
+
+    bin = mm_utils_hexstr2bin (hex, &len);
+    utf8 = g_convert (bin, len, "UTF-8//TRANSLIT", iconv_from, NULL, NULL, NULL);
+    g_free (bin);
+    return utf8;
+}
+
+static void
+test_charsets_benchmark (void *f, gpointer d)
+{
+    static const struct {
+        MMModemCharset charset;
+        const gchar *iconv_from;
+        const gchar *utf8;
+    } values[] = {
+        /* Operator name */
+        { MM_MODEM_CHARSET_UCS2,    "UCS-2BE",   "T-Mobile" },
+        /* USSD response */
+        { MM_MODEM_CHARSET_UCS2,    "UCS-2BE",   "Su saldo es de 12,34 €. Recargue antes del 31/12 para no perder su bono de datos." },
+        /* Phonebook entry */
+        { MM_MODEM_CHARSET_8859_1,  "ISO8859-1", "José Núñez" },
+        /* No fast path */
+        { MM_MODEM_CHARSET_PCCP437, "CP437",     "Müller" },
+    };
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (values); i++) {
+        gchar *hex;
+        gdouble reference;
+        gdouble elapsed;
+        guint n;
+
+        hex = mm_modem_charset_utf8_to_hex (values[i].utf8, values[i].charset);
+        g_assert (hex != NULL);
+
+        g_test_timer_start ();
+        for (n = 0; n < CHARSETS_BENCHMARK_ITERATIONS; n++)
+            g_free (reference_hex_to_utf8 (hex, values[i].iconv_from));
+        reference = g_test_timer_elapsed ();
+
+        g_test_timer_start ();
+        for (n = 0; n < CHARSETS_BENCHMARK_ITERATIONS; n++)
+            g_free (mm_modem_charset_hex_to_utf8 (hex, values[i].charset));
+        elapsed = g_test_timer_elapsed ();
+
+        g_test_minimized_result (elapsed,
+                                 "%s '%s': g_convert %.3f seconds, converted %.3f seconds (%.1fx)",
+                                 mm_modem_charset_to_string (values[i].charset),
+                                 values[i].utf8,
+                                 reference, elapsed, reference / elapsed);
+        g_free (hex);
+    }
+}
+
 typedef GTestFixtureFunc TCFunc;
 
 #define TESTCASE(t, d) g_test_create_case (#t, 0, d, NULL, (TCFunc) t, NULL)
@@ -390,11 +827,25 @@ int main (int argc, char **argv)
     g_test_suite_add (suite, TESTCASE (test_pack_gsm7_last_septet_alone, NULL));
 
     g_test_suite_add (suite, TESTCASE (test_pack_gsm7_7_chars_offset, NULL));
+    g_test_suite_add (suite, TESTCASE (test_pack_unpack_gsm7_lengths, NULL));
+
+    g_test_suite_add (suite, TESTCASE (test_hex_codecs, NULL));
 
     g_test_suite_add (suite, TESTCASE (test_take_convert_ucs2_hex_utf8, NULL));
     g_test_suite_add (suite, TESTCASE (test_take_convert_ucs2_bad_ascii, NULL));
     g_test_suite_add (suite, TESTCASE (test_take_convert_ucs2_bad_ascii2, NULL));
 
+    g_test_suite_add (suite, TESTCASE (test_hex_ucs2_round_trip, NULL));
+    g_test_suite_add (suite, TESTCASE (test_hex_ucs2_surrogates, NULL));
+    g_test_suite_add (suite, TESTCASE (test_hex_8859_1, NULL));
+    g_test_suite_add (suite, TESTCASE (test_byte_array_append, NULL));
+    g_test_suite_add (suite, TESTCASE (test_take_convert_pccp437, NULL));
+
+    if (g_test_perf ()) {
+        g_test_suite_add (suite, TESTCASE (test_charsets_benchmark, NULL));
+        g_test_suite_add (suite, TESTCASE (test_codecs_benchmark, NULL));
+    }
+
     result = g_test_run ();
 
     return result;
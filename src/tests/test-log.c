@@ -0,0 +1,197 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <config.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <ModemManager.h>
+#include <mm-errors-types.h>
+
+#include "mm-log.h"
+
+/*****************************************************************************/
+
+static void
+set_level_ok (const gchar *level)
+{
+    GError *error = NULL;
+
+    g_assert (mm_log_set_level (level, &error));
+    g_assert_no_error (error);
+}
+
+static void
+set_level_fail (const gchar *level)
+{
+    GError *error = NULL;
+
+    g_assert (!mm_log_set_level (level, &error));
+    g_assert_error (error, MM_CORE_ERROR, MM_CORE_ERROR_INVALID_ARGS);
+    g_error_free (error);
+
+    /* Levels set before are kept */
+    g_assert (mm_log_enabled (LOGL_DEBUG, MM_LOG_MODULE_CORE));
+    g_assert (mm_log_enabled (LOGL_DEBUG, MM_LOG_MODULE_SERIAL));
+}
+
+static void
+log_set_level_global (void)
+{
+    guint i;
+
+    set_level_ok ("WARN");
+    for (i = 0; i < MM_LOG_MODULE_LAST; i++) {
+        g_assert (mm_log_enabled (LOGL_ERR, i));
+        g_assert (mm_log_enabled (LOGL_WARN, i));
+        g_assert (!mm_log_enabled (LOGL_INFO, i));
+    }
+
+    set_level_ok (" debug ");
+    for (i = 0; i < MM_LOG_MODULE_LAST; i++)
+        g_assert (mm_log_enabled (LOGL_DEBUG, i));
+}
+
+static void
+log_set_level_modules (void)
+{
+    set_level_ok ("ERR, serial=DEBUG,qmi = WARN");
+    g_assert (!mm_log_enabled (LOGL_WARN, MM_LOG_MODULE_CORE));
+    g_assert (mm_log_enabled (LOGL_DEBUG, MM_LOG_MODULE_SERIAL));
+    g_assert (mm_log_enabled (LOGL_WARN, MM_LOG_MODULE_QMI));
+    g_assert (!mm_log_enabled (LOGL_INFO, MM_LOG_MODULE_QMI));
+
+    /* Modules not given get the default level */
+    set_level_ok ("sms=DEBUG");
+    g_assert (mm_log_enabled (LOGL_DEBUG, MM_LOG_MODULE_SMS));
+    g_assert (mm_log_enabled (LOGL_INFO, MM_LOG_MODULE_CORE));
+    g_assert (!mm_log_enabled (LOGL_DEBUG, MM_LOG_MODULE_CORE));
+}
+
+static void
+log_set_level_invalid (void)
+{
+    set_level_ok ("DEBUG");
+
+    /* Empty */
+    set_level_fail ("");
+    set_level_fail ("  \t ");
+    set_level_fail (",");
+    set_level_fail ("DEBUG,");
+
+    /* Unknown level */
+    set_level_fail ("VERBOSE");
+    set_level_fail ("serial=VERBOSE");
+    set_level_fail ("serial=");
+
+    /* Unknown module */
+    set_level_fail ("foo=DEBUG");
+    set_level_fail ("INFO,foo=DEBUG");
+
+    /* Global level not given first */
+    set_level_fail ("serial=DEBUG,INFO");
+}
+
+/*****************************************************************************/
+/* Fatal messages written to the log file before aborting */
+
+static void
+log_fatal_child (const gchar *path,
+                 GLogLevelFlags level)
+{
+    struct rlimit limit = { 0, 0 };
+
+    /* No core dumps from the expected abort */
+    setrlimit (RLIMIT_CORE, &limit);
+
+    /* Flush interval long enough for nothing to be written in the background */
+    g_assert (mm_log_setup ("DEBUG", path, FALSE, FALSE, FALSE, 60000, 0, NULL));
+    mm_info ("queued message");
+    g_log (G_LOG_DOMAIN, level | G_LOG_FLAG_FATAL, "fatal message");
+    _exit (0);
+}
+
+static void
+test_fatal (GLogLevelFlags level)
+{
+    gchar *path;
+    gchar *contents;
+    const gchar *queued;
+    const gchar *fatal;
+    pid_t cpid;
+    int status;
+    int fd;
+
+    fd = g_file_open_tmp ("test-log-XXXXXX", &path, NULL);
+    g_assert_cmpint (fd, >=, 0);
+    close (fd);
+
+    cpid = fork ();
+    g_assert (cpid >= 0);
+    if (cpid == 0)
+        log_fatal_child (path, level);
+
+    g_assert_cmpint (waitpid (cpid, &status, 0), ==, cpid);
+    g_assert (WIFSIGNALED (status));
+
+    g_assert (g_file_get_contents (path, &contents, NULL, NULL));
+    queued = strstr (contents, "queued message");
+    fatal = strstr (contents, "fatal message");
+    g_assert (queued != NULL);
+    g_assert (fatal != NULL);
+    /* Whatever was queued goes first */
+    g_assert (queued < fatal);
+
+    g_free (contents);
+    g_unlink (path);
+    g_free (path);
+}
+
+static void
+log_fatal_error (void)
+{
+    test_fatal (G_LOG_LEVEL_ERROR);
+}
+
+static void
+log_fatal_critical (void)
+{
+    test_fatal (G_LOG_LEVEL_CRITICAL);
+}
+
+static void
+log_fatal_warning (void)
+{
+    test_fatal (G_LOG_LEVEL_WARNING);
+}
+
+/*****************************************************************************/
+
+int main (int argc, char **argv)
+{
+    g_type_init ();
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/ModemManager/log/set-level/global", log_set_level_global);
+    g_test_add_func ("/ModemManager/log/set-level/modules", log_set_level_modules);
+    g_test_add_func ("/ModemManager/log/set-level/invalid", log_set_level_invalid);
+    g_test_add_func ("/ModemManager/log/fatal/error", log_fatal_error);
+    g_test_add_func ("/ModemManager/log/fatal/critical", log_fatal_critical);
+    g_test_add_func ("/ModemManager/log/fatal/warning", log_fatal_warning);
+
+    return g_test_run ();
+}
@@ -195,6 +195,48 @@ test_cmgl_response_pantech_multiple (void *f, gpointer d)
     test_cmgl_response (str, expected, G_N_ELEMENTS (expected));
 }
 
+static void
+test_cmgl_response_next (void *f, gpointer d)
+{
+    const gchar *str =
+        "+CMGL: 17,3,35\r\n079100F40D1101000F001000B917118336058F300001954747A0E4ACF41F27298CDCE83C6EF371B0402814020\r\n"
+        "\r\n+CMTI: \"SM\",3\r\n"
+        "+CMGL: 15, 1 ,,35\r\n\"079100F40D1101000F001000B917118336058F300\"\r\n"
+        "+CMGL: 13,3,35\r\n\r\n";
+    const gchar *cursor = str;
+    MM3gppPduInfo *info;
+    GError *error = NULL;
+
+    info = mm_3gpp_parse_pdu_cmgl_response_next (&cursor, &error);
+    g_assert_no_error (error);
+    g_assert (info != NULL);
+    g_assert_cmpint (info->index, ==, 17);
+    g_assert_cmpint (info->status, ==, 3);
+    g_assert_cmpstr (info->pdu, ==, "079100F40D1101000F001000B917118336058F300001954747A0E4ACF41F27298CDCE83C6EF371B0402814020");
+    mm_3gpp_pdu_info_free (info);
+
+    /* The URC in between is skipped, and the PDU unquoted */
+    info = mm_3gpp_parse_pdu_cmgl_response_next (&cursor, &error);
+    g_assert_no_error (error);
+    g_assert (info != NULL);
+    g_assert_cmpint (info->index, ==, 15);
+    g_assert_cmpint (info->status, ==, 1);
+    g_assert_cmpstr (info->pdu, ==, "079100F40D1101000F001000B917118336058F300");
+    mm_3gpp_pdu_info_free (info);
+
+    /* Entry without PDU */
+    info = mm_3gpp_parse_pdu_cmgl_response_next (&cursor, &error);
+    g_assert_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED);
+    g_assert (info == NULL);
+    g_clear_error (&error);
+
+    /* Nothing else */
+    info = mm_3gpp_parse_pdu_cmgl_response_next (&cursor, &error);
+    g_assert_no_error (error);
+    g_assert (info == NULL);
+    g_assert_cmpstr (cursor, ==, "");
+}
+
 /*****************************************************************************/
 /* Test CMGR responses */
 
@@ -2718,6 +2760,59 @@ test_crsm_response (void)
 }
 
 /*****************************************************************************/
+/* Test the regex registry */
+
+static void
+test_regex_registry (void *f, gpointer d)
+{
+    GRegex *r1;
+    GRegex *r2;
+    GRegex *r3;
+    guint n_compiled;
+    guint n_hits;
+    guint n_compiled_after;
+    guint n_hits_after;
+
+    mm_regex_registry_get_stats (&n_compiled, &n_hits);
+
+    /* First lookup compiles */
+    r1 = mm_regex_registry_get ("\\+TESTREG:\\s*(\\d+)", G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    g_assert (r1 != NULL);
+    mm_regex_registry_get_stats (&n_compiled_after, &n_hits_after);
+    g_assert_cmpuint (n_compiled_after, ==, n_compiled + 1);
+    g_assert_cmpuint (n_hits_after, ==, n_hits);
+
+    /* Same pattern and flags, same regex */
+    r2 = mm_regex_registry_get ("\\+TESTREG:\\s*(\\d+)", G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    g_assert (r2 == r1);
+    mm_regex_registry_get_stats (&n_compiled_after, &n_hits_after);
+    g_assert_cmpuint (n_compiled_after, ==, n_compiled + 1);
+    g_assert_cmpuint (n_hits_after, ==, n_hits + 1);
+
+    /* Same pattern with other flags, another regex */
+    r3 = mm_regex_registry_get ("\\+TESTREG:\\s*(\\d+)", G_REGEX_RAW | G_REGEX_OPTIMIZE | G_REGEX_CASELESS);
+    g_assert (r3 != NULL);
+    g_assert (r3 != r1);
+    g_assert (g_regex_match (r3, "+testreg: 1", 0, NULL));
+    mm_regex_registry_get_stats (&n_compiled_after, &n_hits_after);
+    g_assert_cmpuint (n_compiled_after, ==, n_compiled + 2);
+    g_assert_cmpuint (n_hits_after, ==, n_hits + 1);
+
+    /* The registry keeps its own reference */
+    g_regex_unref (r1);
+    g_regex_unref (r2);
+    g_regex_unref (r3);
+    r1 = mm_regex_registry_get ("\\+TESTREG:\\s*(\\d+)", G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    g_assert (g_regex_match (r1, "+TESTREG: 12", 0, NULL));
+    mm_regex_registry_get_stats (&n_compiled_after, &n_hits_after);
+    g_assert_cmpuint (n_compiled_after, ==, n_compiled + 2);
+    g_assert_cmpuint (n_hits_after, ==, n_hits + 2);
+    g_regex_unref (r1);
+}
+
+/*****************************************************************************/
+
+MM_LOG_DEFINE_LEVELS (LOGL_ALL);
 
 void
 _mm_log (const char *loc,
@@ -2882,6 +2977,7 @@ int main (int argc, char **argv)
     g_test_suite_add (suite, TESTCASE (test_cmgl_response_generic_multiple, NULL));
     g_test_suite_add (suite, TESTCASE (test_cmgl_response_pantech, NULL));
     g_test_suite_add (suite, TESTCASE (test_cmgl_response_pantech_multiple, NULL));
+    g_test_suite_add (suite, TESTCASE (test_cmgl_response_next, NULL));
 
     g_test_suite_add (suite, TESTCASE (test_cmgr_response_generic, NULL));
     g_test_suite_add (suite, TESTCASE (test_cmgr_response_telit, NULL));
@@ -2894,6 +2990,8 @@ int main (int argc, char **argv)
 
     g_test_suite_add (suite, TESTCASE (test_crsm_response, NULL));
 
+    g_test_suite_add (suite, TESTCASE (test_regex_registry, NULL));
+
     result = g_test_run ();
 
     reg_test_data_free (reg_data);
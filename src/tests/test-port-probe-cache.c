@@ -0,0 +1,518 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <string.h>
+#include <unistd.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "mm-port-probe-cache.h"
+#include "mm-daemon-enums-types.h"
+#include "mm-log.h"
+
+/*
+ * The probe cache is built here along with fake devices, ports and probes,
+ * given by the implementation of the few accessors it uses.
+ */
+
+/*****************************************************************************/
+/* Fakes */
+
+typedef struct {
+    const gchar *interface_number;
+    const gchar *driver;
+    const gchar *serial;
+} FakeUdevDevice;
+
+typedef struct {
+    guint16 vendor;
+    guint16 product;
+    FakeUdevDevice udev;
+} FakeDevice;
+
+typedef struct {
+    FakeDevice *device;
+    FakeUdevDevice *port;
+    MMPortProbeFlag flags;
+    gboolean at;
+    gboolean at_assumed;
+    gboolean at_probing_cancelled;
+    gchar *vendor;
+    gchar *product;
+    gboolean icera;
+    gboolean qcdm;
+    gboolean qmi;
+    gboolean mbim;
+} FakeProbe;
+
+const gchar *
+g_udev_device_get_property (GUdevDevice *device,
+                            const gchar *key)
+{
+    FakeUdevDevice *fake = (FakeUdevDevice *) device;
+
+    if (g_str_equal (key, "ID_USB_INTERFACE_NUM"))
+        return fake->interface_number;
+    if (g_str_equal (key, "ID_USB_DRIVER"))
+        return fake->driver;
+    return NULL;
+}
+
+const gchar *
+g_udev_device_get_sysfs_attr (GUdevDevice *device,
+                              const gchar *name)
+{
+    FakeUdevDevice *fake = (FakeUdevDevice *) device;
+
+    if (g_str_equal (name, "serial"))
+        return fake->serial;
+    return NULL;
+}
+
+gboolean
+mm_device_is_virtual (MMDevice *self)
+{
+    return FALSE;
+}
+
+GUdevDevice *
+mm_device_peek_udev_device (MMDevice *self)
+{
+    return (GUdevDevice *) &((FakeDevice *) self)->udev;
+}
+
+guint16
+mm_device_get_vendor (MMDevice *self)
+{
+    return ((FakeDevice *) self)->vendor;
+}
+
+guint16
+mm_device_get_product (MMDevice *self)
+{
+    return ((FakeDevice *) self)->product;
+}
+
+MMDevice *
+mm_port_probe_peek_device (MMPortProbe *self)
+{
+    return (MMDevice *) ((FakeProbe *) self)->device;
+}
+
+GUdevDevice *
+mm_port_probe_peek_port (MMPortProbe *self)
+{
+    return (GUdevDevice *) ((FakeProbe *) self)->port;
+}
+
+const gchar *
+mm_port_probe_get_port_name (MMPortProbe *self)
+{
+    return "ttyUSB0";
+}
+
+const gchar *
+mm_port_probe_get_port_subsys (MMPortProbe *self)
+{
+    return "tty";
+}
+
+gchar *
+mm_port_probe_flag_build_string_from_mask (MMPortProbeFlag mask)
+{
+    return g_strdup_printf ("0x%x", mask);
+}
+
+MMPortProbeFlag
+mm_port_probe_get_probed_flags (MMPortProbe *self)
+{
+    return ((FakeProbe *) self)->flags;
+}
+
+gboolean
+mm_port_probe_get_result_at_assumed (MMPortProbe *self)
+{
+    return ((FakeProbe *) self)->at_assumed;
+}
+
+gboolean
+mm_port_probe_get_at_probing_cancelled (MMPortProbe *self)
+{
+    return ((FakeProbe *) self)->at_probing_cancelled;
+}
+
+/* Same implied results as the real setters */
+void
+mm_port_probe_set_result_at (MMPortProbe *self,
+                             gboolean at)
+{
+    FakeProbe *probe = (FakeProbe *) self;
+
+    probe->at = at;
+    probe->at_assumed = FALSE;
+    probe->flags |= MM_PORT_PROBE_AT;
+    if (at) {
+        probe->qcdm = probe->qmi = probe->mbim = FALSE;
+        probe->flags |= (MM_PORT_PROBE_QCDM | MM_PORT_PROBE_QMI | MM_PORT_PROBE_MBIM);
+    } else {
+        probe->icera = FALSE;
+        probe->flags |= (MM_PORT_PROBE_AT_VENDOR | MM_PORT_PROBE_AT_PRODUCT | MM_PORT_PROBE_AT_ICERA);
+    }
+}
+
+void
+mm_port_probe_set_result_at_vendor (MMPortProbe *self,
+                                    const gchar *at_vendor)
+{
+    FakeProbe *probe = (FakeProbe *) self;
+
+    g_free (probe->vendor);
+    probe->vendor = g_strdup (at_vendor);
+    probe->flags |= MM_PORT_PROBE_AT_VENDOR;
+}
+
+void
+mm_port_probe_set_result_at_product (MMPortProbe *self,
+                                     const gchar *at_product)
+{
+    FakeProbe *probe = (FakeProbe *) self;
+
+    g_free (probe->product);
+    probe->product = g_strdup (at_product);
+    probe->flags |= MM_PORT_PROBE_AT_PRODUCT;
+}
+
+void
+mm_port_probe_set_result_at_icera (MMPortProbe *self,
+                                   gboolean is_icera)
+{
+    ((FakeProbe *) self)->icera = is_icera;
+    ((FakeProbe *) self)->flags |= MM_PORT_PROBE_AT_ICERA;
+}
+
+void
+mm_port_probe_set_result_qcdm (MMPortProbe *self,
+                               gboolean qcdm)
+{
+    ((FakeProbe *) self)->qcdm = qcdm;
+    ((FakeProbe *) self)->flags |= MM_PORT_PROBE_QCDM;
+}
+
+void
+mm_port_probe_set_result_qmi (MMPortProbe *self,
+                              gboolean qmi)
+{
+    ((FakeProbe *) self)->qmi = qmi;
+    ((FakeProbe *) self)->flags |= MM_PORT_PROBE_QMI;
+}
+
+void
+mm_port_probe_set_result_mbim (MMPortProbe *self,
+                               gboolean mbim)
+{
+    ((FakeProbe *) self)->mbim = mbim;
+    ((FakeProbe *) self)->flags |= MM_PORT_PROBE_MBIM;
+}
+
+gboolean mm_port_probe_is_at (MMPortProbe *self)            { return ((FakeProbe *) self)->at; }
+gboolean mm_port_probe_is_icera (MMPortProbe *self)         { return ((FakeProbe *) self)->icera; }
+gboolean mm_port_probe_is_qcdm (MMPortProbe *self)          { return ((FakeProbe *) self)->qcdm; }
+gboolean mm_port_probe_is_qmi (MMPortProbe *self)           { return ((FakeProbe *) self)->qmi; }
+gboolean mm_port_probe_is_mbim (MMPortProbe *self)          { return ((FakeProbe *) self)->mbim; }
+const gchar *mm_port_probe_get_vendor (MMPortProbe *self)   { return ((FakeProbe *) self)->vendor; }
+const gchar *mm_port_probe_get_product (MMPortProbe *self)  { return ((FakeProbe *) self)->product; }
+
+/*****************************************************************************/
+
+static FakeDevice test_device = {
+    .vendor  = 0x1199,
+    .product = 0x68a2,
+    .udev    = { NULL, NULL, "ABC[123]" },
+};
+
+static FakeUdevDevice test_port = { "03", "qcserial", NULL };
+
+static void
+fake_probe_init (FakeProbe *probe)
+{
+    memset (probe, 0, sizeof (*probe));
+    probe->device = &test_device;
+    probe->port = &test_port;
+}
+
+static void
+fake_probe_clear (FakeProbe *probe)
+{
+    g_free (probe->vendor);
+    g_free (probe->product);
+}
+
+static gchar *
+cache_path_new (void)
+{
+    gchar *dir;
+    gchar *path;
+
+    dir = g_dir_make_tmp ("mm-probe-cache-XXXXXX", NULL);
+    g_assert (dir);
+    path = g_build_filename (dir, "probe-cache", NULL);
+    g_free (dir);
+    return path;
+}
+
+static void
+cache_path_free (gchar *path)
+{
+    gchar *dir;
+
+    g_unlink (path);
+    dir = g_path_get_dirname (path);
+    g_rmdir (dir);
+    g_free (dir);
+    g_free (path);
+}
+
+/* Saves the probe and reloads the results in another cache instance, as
+ * done when restarting */
+static gboolean
+save_and_reload (const gchar *path,
+                 FakeProbe *saved,
+                 FakeProbe *loaded)
+{
+    MMPortProbeCache *cache;
+    gboolean result;
+
+    cache = mm_port_probe_cache_new (path);
+    mm_port_probe_cache_save_results (cache, (MMPortProbe *) saved);
+    g_object_unref (cache);
+
+    cache = mm_port_probe_cache_new (path);
+    fake_probe_init (loaded);
+    result = mm_port_probe_cache_load_results (cache, (MMPortProbe *) loaded);
+    g_object_unref (cache);
+    return result;
+}
+
+static void
+test_save_load (void)
+{
+    FakeProbe saved;
+    FakeProbe loaded;
+    gchar *path;
+
+    path = cache_path_new ();
+
+    fake_probe_init (&saved);
+    mm_port_probe_set_result_at ((MMPortProbe *) &saved, TRUE);
+    mm_port_probe_set_result_at_vendor ((MMPortProbe *) &saved, "sierra wireless, incorporated");
+    mm_port_probe_set_result_at_product ((MMPortProbe *) &saved, "MC7710");
+    mm_port_probe_set_result_at_icera ((MMPortProbe *) &saved, FALSE);
+
+    g_assert (save_and_reload (path, &saved, &loaded));
+    g_assert_cmpuint (loaded.flags, ==, saved.flags);
+    g_assert (loaded.at);
+    g_assert (!loaded.at_assumed);
+    g_assert_cmpstr (loaded.vendor, ==, "sierra wireless, incorporated");
+    g_assert_cmpstr (loaded.product, ==, "MC7710");
+    g_assert (!loaded.icera);
+    g_assert (!loaded.qcdm);
+    g_assert (!loaded.qmi);
+    g_assert (!loaded.mbim);
+
+    fake_probe_clear (&saved);
+    fake_probe_clear (&loaded);
+    cache_path_free (path);
+}
+
+static void
+test_assumed_at_not_saved (void)
+{
+    FakeProbe saved;
+    FakeProbe loaded;
+    gchar *path;
+
+    path = cache_path_new ();
+
+    /* Nothing but the assumed AT result: nothing to store */
+    fake_probe_init (&saved);
+    mm_port_probe_set_result_at ((MMPortProbe *) &saved, FALSE);
+    saved.at_assumed = TRUE;
+    g_assert (!save_and_reload (path, &saved, &loaded));
+    fake_probe_clear (&loaded);
+
+    /* Only the probed QCDM result is stored */
+    mm_port_probe_set_result_qcdm ((MMPortProbe *) &saved, TRUE);
+    g_assert (save_and_reload (path, &saved, &loaded));
+    g_assert_cmpuint (loaded.flags, ==, MM_PORT_PROBE_QCDM);
+    g_assert (loaded.qcdm);
+
+    fake_probe_clear (&saved);
+    fake_probe_clear (&loaded);
+    cache_path_free (path);
+}
+
+static void
+test_cancelled_at_not_saved (void)
+{
+    FakeProbe saved;
+    FakeProbe loaded;
+    gchar *path;
+
+    path = cache_path_new ();
+
+    /* AT found, but vendor and product probing cut short */
+    fake_probe_init (&saved);
+    mm_port_probe_set_result_at ((MMPortProbe *) &saved, TRUE);
+    mm_port_probe_set_result_at_vendor ((MMPortProbe *) &saved, NULL);
+    saved.at_probing_cancelled = TRUE;
+
+    g_assert (save_and_reload (path, &saved, &loaded));
+    g_assert (loaded.flags & MM_PORT_PROBE_AT);
+    g_assert (!(loaded.flags & MM_PORT_PROBE_AT_VENDOR));
+    g_assert (loaded.at);
+
+    fake_probe_clear (&saved);
+    fake_probe_clear (&loaded);
+    cache_path_free (path);
+}
+
+static void
+test_invalidate (void)
+{
+    MMPortProbeCache *cache;
+    FakeProbe saved;
+    FakeProbe loaded;
+    gchar *path;
+
+    path = cache_path_new ();
+
+    fake_probe_init (&saved);
+    mm_port_probe_set_result_at ((MMPortProbe *) &saved, FALSE);
+    mm_port_probe_set_result_qcdm ((MMPortProbe *) &saved, TRUE);
+    g_assert (save_and_reload (path, &saved, &loaded));
+    fake_probe_clear (&loaded);
+
+    /* Outdated results are removed, also from disk */
+    cache = mm_port_probe_cache_new (path);
+    mm_port_probe_cache_remove_results (cache, (MMPortProbe *) &saved);
+    fake_probe_init (&loaded);
+    g_assert (!mm_port_probe_cache_load_results (cache, (MMPortProbe *) &loaded));
+    mm_port_probe_cache_flush (cache);
+    g_object_unref (cache);
+
+    cache = mm_port_probe_cache_new (path);
+    g_assert (!mm_port_probe_cache_load_results (cache, (MMPortProbe *) &loaded));
+    g_assert_cmpuint (loaded.flags, ==, MM_PORT_PROBE_NONE);
+    g_object_unref (cache);
+
+    fake_probe_clear (&saved);
+    fake_probe_clear (&loaded);
+    cache_path_free (path);
+}
+
+static void
+test_not_cacheable (void)
+{
+    FakeUdevDevice no_interface = { NULL, "option", NULL };
+    FakeProbe saved;
+    FakeProbe loaded;
+    gchar *path;
+
+    path = cache_path_new ();
+
+    /* Ports out of a USB interface are never cached */
+    fake_probe_init (&saved);
+    saved.port = &no_interface;
+    mm_port_probe_set_result_at ((MMPortProbe *) &saved, TRUE);
+    g_assert (!save_and_reload (path, &saved, &loaded));
+    g_assert (!g_file_test (path, G_FILE_TEST_EXISTS));
+
+    fake_probe_clear (&saved);
+    fake_probe_clear (&loaded);
+    cache_path_free (path);
+}
+
+static void
+test_port_layout_not_lowered (void)
+{
+    MMPortProbeCache *cache;
+    gchar *path;
+
+    path = cache_path_new ();
+
+    cache = mm_port_probe_cache_new (path);
+    g_assert_cmpuint (mm_port_probe_cache_get_n_ports (cache, "layout"), ==, 0);
+    mm_port_probe_cache_learn_n_ports (cache, "layout", 4);
+    g_assert_cmpuint (mm_port_probe_cache_get_n_ports (cache, "layout"), ==, 4);
+
+    /* A device with a port missing doesn't lower the count */
+    mm_port_probe_cache_learn_n_ports (cache, "layout", 3);
+    g_assert_cmpuint (mm_port_probe_cache_get_n_ports (cache, "layout"), ==, 4);
+    mm_port_probe_cache_flush (cache);
+    g_object_unref (cache);
+
+    /* Neither once reloaded, while it can still be raised */
+    cache = mm_port_probe_cache_new (path);
+    g_assert_cmpuint (mm_port_probe_cache_get_n_ports (cache, "layout"), ==, 4);
+    mm_port_probe_cache_learn_n_ports (cache, "layout", 2);
+    g_assert_cmpuint (mm_port_probe_cache_get_n_ports (cache, "layout"), ==, 4);
+    mm_port_probe_cache_learn_n_ports (cache, "layout", 5);
+    g_assert_cmpuint (mm_port_probe_cache_get_n_ports (cache, "layout"), ==, 5);
+    mm_port_probe_cache_flush (cache);
+    g_object_unref (cache);
+
+    cache = mm_port_probe_cache_new (path);
+    g_assert_cmpuint (mm_port_probe_cache_get_n_ports (cache, "layout"), ==, 5);
+    g_object_unref (cache);
+
+    cache_path_free (path);
+}
+
+/*****************************************************************************/
+
+MM_LOG_DEFINE_LEVELS (LOGL_ALL);
+
+void
+_mm_log (const char *loc,
+         const char *func,
+         guint32 level,
+         const char *fmt,
+         ...)
+{
+#if defined ENABLE_TEST_MESSAGE_TRACES
+    /* Dummy log function */
+    va_list args;
+    gchar *msg;
+
+    va_start (args, fmt);
+    msg = g_strdup_vprintf (fmt, args);
+    va_end (args);
+    g_print ("%s\n", msg);
+    g_free (msg);
+#endif
+}
+
+int main (int argc, char **argv)
+{
+    g_type_init ();
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/ModemManager/probe-cache/save-load", test_save_load);
+    g_test_add_func ("/ModemManager/probe-cache/assumed-at-not-saved", test_assumed_at_not_saved);
+    g_test_add_func ("/ModemManager/probe-cache/cancelled-at-not-saved", test_cancelled_at_not_saved);
+    g_test_add_func ("/ModemManager/probe-cache/invalidate", test_invalidate);
+    g_test_add_func ("/ModemManager/probe-cache/not-cacheable", test_not_cacheable);
+    g_test_add_func ("/ModemManager/probe-cache/port-layout-not-lowered", test_port_layout_not_lowered);
+
+    return g_test_run ();
+}
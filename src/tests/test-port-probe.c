@@ -0,0 +1,367 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <config.h>
+#include <string.h>
+#include <pty.h>
+#include <unistd.h>
+#include <termios.h>
+#include <fcntl.h>
+#include <glib.h>
+
+#include "mm-port-probe.h"
+#include "libqcdm/src/utils.h"
+#include "mm-log.h"
+
+/*
+ * The port probe is built here along with fake udev devices, which just give
+ * the name of a pty, and probes a fake modem running in the other side of the
+ * pty.
+ */
+
+/*****************************************************************************/
+/* Fake udev devices */
+
+GType
+g_udev_device_get_type (void)
+{
+    return G_TYPE_OBJECT;
+}
+
+const gchar *
+g_udev_device_get_name (GUdevDevice *device)
+{
+    return g_object_get_data (G_OBJECT (device), "name");
+}
+
+const gchar *
+g_udev_device_get_subsystem (GUdevDevice *device)
+{
+    return "tty";
+}
+
+const gchar *
+g_udev_device_get_sysfs_path (GUdevDevice *device)
+{
+    return NULL;
+}
+
+GUdevDevice *
+g_udev_device_get_parent (GUdevDevice *device)
+{
+    return NULL;
+}
+
+gboolean
+g_udev_device_get_property_as_boolean (GUdevDevice *device,
+                                       const gchar *key)
+{
+    return FALSE;
+}
+
+GType
+mm_device_get_type (void)
+{
+    return G_TYPE_OBJECT;
+}
+
+gchar *
+mm_port_probe_flag_build_string_from_mask (MMPortProbeFlag mask)
+{
+    return g_strdup_printf ("0x%x", mask);
+}
+
+/*****************************************************************************/
+/* Fake modem */
+
+typedef enum {
+    FAKE_MODEM_AT,
+    FAKE_MODEM_QCDM,
+} FakeModemType;
+
+typedef struct {
+    FakeModemType type;
+    /* Whether all input is echoed back */
+    gboolean echo;
+    int master;
+    int slave;
+    gchar *name;
+    guint watch_id;
+    /* QCDM requests decoding */
+    DmFrameDecoder decoder;
+    char frame[512];
+    /* Whether any QCDM frame marker was received */
+    gboolean got_frame_marker;
+} FakeModem;
+
+static const char verinfo_rsp[] = {
+    0x00, 0x41, 0x75, 0x67, 0x20, 0x31, 0x39, 0x20, 0x32, 0x30, 0x30, 0x38,
+    0x32, 0x30, 0x3a, 0x34, 0x38, 0x3a, 0x34, 0x37, 0x4f, 0x63, 0x74, 0x20,
+    0x32, 0x39, 0x20, 0x32, 0x30, 0x30, 0x37, 0x31, 0x39, 0x3a, 0x30, 0x30,
+    0x3a, 0x30, 0x30, 0x53, 0x43, 0x4e, 0x52, 0x5a, 0x2e, 0x2e, 0x2e, 0x2a,
+    0x06, 0x04, 0xb9, 0x0b, 0x02, 0x00, 0xb2, 0x19, 0xc4, 0x7e
+};
+
+static void
+fake_modem_write (FakeModem *modem,
+                  const char *buf,
+                  gsize len)
+{
+    g_assert_cmpint (write (modem->master, buf, len), ==, (gssize) len);
+}
+
+static void
+fake_modem_process (FakeModem *modem,
+                    const char *buf,
+                    gsize len)
+{
+    gsize used;
+    gsize frame_len;
+    gsize i;
+
+    if (memchr (buf, 0x7E, len))
+        modem->got_frame_marker = TRUE;
+
+    switch (modem->type) {
+    case FAKE_MODEM_AT:
+        /* V.250 modems reply to each command line, whatever comes before the
+         * "AT" prefix */
+        for (i = 0; i < len; i++) {
+            if (buf[i] == '\r')
+                fake_modem_write (modem, "\r\nOK\r\n", 6);
+        }
+        break;
+    case FAKE_MODEM_QCDM:
+        /* Reply to version info requests, ignore anything else */
+        while (len > 0) {
+            if (dm_frame_decoder_feed (&modem->decoder, buf, len, &used, &frame_len) == DM_FRAME_NEED_MORE)
+                break;
+            if (frame_len == 1 && modem->frame[0] == 0x00)
+                fake_modem_write (modem, verinfo_rsp, sizeof (verinfo_rsp));
+            buf += used;
+            len -= used;
+        }
+        break;
+    }
+}
+
+static gboolean
+fake_modem_input (GIOChannel *channel,
+                  GIOCondition condition,
+                  FakeModem *modem)
+{
+    char buf[512];
+    gssize n;
+
+    while ((n = read (modem->master, buf, sizeof (buf))) > 0) {
+        if (modem->echo)
+            fake_modem_write (modem, buf, n);
+        fake_modem_process (modem, buf, n);
+    }
+    return TRUE;
+}
+
+static FakeModem *
+fake_modem_new (FakeModemType type,
+                gboolean echo)
+{
+    FakeModem *modem;
+    GIOChannel *channel;
+    struct termios stbuf;
+    char name[128];
+
+    modem = g_new0 (FakeModem, 1);
+    modem->type = type;
+    modem->echo = echo;
+    dm_frame_decoder_init (&modem->decoder, modem->frame, sizeof (modem->frame));
+
+    /* The slave side is kept open, so that the pty stays valid while the
+     * probe opens and closes it */
+    g_assert_cmpint (openpty (&modem->master, &modem->slave, name, NULL, NULL), ==, 0);
+    g_assert (g_str_has_prefix (name, "/dev/"));
+    modem->name = g_strdup (&name[strlen ("/dev/")]);
+
+    memset (&stbuf, 0, sizeof (stbuf));
+    tcgetattr (modem->master, &stbuf);
+    cfmakeraw (&stbuf);
+    tcsetattr (modem->master, TCSANOW, &stbuf);
+    fcntl (modem->master, F_SETFL, O_NONBLOCK);
+
+    channel = g_io_channel_unix_new (modem->master);
+    modem->watch_id = g_io_add_watch (channel, G_IO_IN, (GIOFunc) fake_modem_input, modem);
+    g_io_channel_unref (channel);
+
+    return modem;
+}
+
+static void
+fake_modem_free (FakeModem *modem)
+{
+    g_source_remove (modem->watch_id);
+    close (modem->master);
+    close (modem->slave);
+    g_free (modem->name);
+    g_free (modem);
+}
+
+/*****************************************************************************/
+
+static void
+probe_ready (MMPortProbe *probe,
+             GAsyncResult *res,
+             GMainLoop *loop)
+{
+    GError *error = NULL;
+
+    g_assert (mm_port_probe_run_finish (probe, res, &error));
+    g_assert_no_error (error);
+    g_main_loop_quit (loop);
+}
+
+static gboolean
+probe_timed_out (gpointer unused)
+{
+    g_assert_not_reached ();
+    return G_SOURCE_REMOVE;
+}
+
+static MMPortProbe *
+run_probe (FakeModem *modem,
+           gboolean at_qcdm_probe)
+{
+    GObject *port;
+    MMPortProbe *probe;
+    GMainLoop *loop;
+    guint timeout_id;
+
+    port = g_object_new (G_TYPE_OBJECT, NULL);
+    g_object_set_data_full (port, "name", g_strdup (modem->name), g_free);
+    probe = mm_port_probe_new (NULL, G_UDEV_DEVICE (port));
+    g_object_unref (port);
+
+    /* Each kind of port must reply to the first request, so this is well
+     * below the time needed to go through all probing timeouts */
+    loop = g_main_loop_new (NULL, FALSE);
+    timeout_id = g_timeout_add_seconds (5, probe_timed_out, NULL);
+    mm_port_probe_run (probe,
+                       MM_PORT_PROBE_AT | MM_PORT_PROBE_QCDM,
+                       0,     /* send delay */
+                       TRUE,  /* remove echo */
+                       FALSE, /* send LF */
+                       at_qcdm_probe,
+                       NULL,
+                       NULL,
+                       NULL,
+                       (GAsyncReadyCallback) probe_ready,
+                       loop);
+    g_main_loop_run (loop);
+    g_source_remove (timeout_id);
+    g_main_loop_unref (loop);
+
+    return probe;
+}
+
+static void
+test_at_port (void)
+{
+    FakeModem *modem;
+    MMPortProbe *probe;
+
+    modem = fake_modem_new (FAKE_MODEM_AT, FALSE);
+    probe = run_probe (modem, TRUE);
+    g_assert (mm_port_probe_is_at (probe));
+    g_assert (!mm_port_probe_is_qcdm (probe));
+    g_object_unref (probe);
+    fake_modem_free (modem);
+}
+
+static void
+test_echoing_at_port (void)
+{
+    FakeModem *modem;
+    MMPortProbe *probe;
+
+    /* The echo of the QCDM request must not be taken as a QCDM reply */
+    modem = fake_modem_new (FAKE_MODEM_AT, TRUE);
+    probe = run_probe (modem, TRUE);
+    g_assert (mm_port_probe_is_at (probe));
+    g_assert (!mm_port_probe_is_qcdm (probe));
+    g_object_unref (probe);
+    fake_modem_free (modem);
+}
+
+static void
+test_qcdm_port (void)
+{
+    FakeModem *modem;
+    MMPortProbe *probe;
+
+    modem = fake_modem_new (FAKE_MODEM_QCDM, FALSE);
+    probe = run_probe (modem, TRUE);
+    g_assert (!mm_port_probe_is_at (probe));
+    g_assert (mm_port_probe_is_qcdm (probe));
+    g_object_unref (probe);
+    fake_modem_free (modem);
+}
+
+static void
+test_at_port_not_allowed (void)
+{
+    FakeModem *modem;
+    MMPortProbe *probe;
+
+    /* Unless allowed, AT ports never get QCDM requests */
+    modem = fake_modem_new (FAKE_MODEM_AT, FALSE);
+    probe = run_probe (modem, FALSE);
+    g_assert (mm_port_probe_is_at (probe));
+    g_assert (!modem->got_frame_marker);
+    g_object_unref (probe);
+    fake_modem_free (modem);
+}
+
+/*****************************************************************************/
+
+MM_LOG_DEFINE_LEVELS (LOGL_ALL);
+
+void
+_mm_log (const char *loc,
+         const char *func,
+         guint32 level,
+         const char *fmt,
+         ...)
+{
+#if defined ENABLE_TEST_MESSAGE_TRACES
+    /* Dummy log function */
+    va_list args;
+    gchar *msg;
+
+    va_start (args, fmt);
+    msg = g_strdup_vprintf (fmt, args);
+    va_end (args);
+    g_print ("%s\n", msg);
+    g_free (msg);
+#endif
+}
+
+int main (int argc, char **argv)
+{
+    g_type_init ();
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/ModemManager/port-probe/at-qcdm/at", test_at_port);
+    g_test_add_func ("/ModemManager/port-probe/at-qcdm/echoing-at", test_echoing_at_port);
+    g_test_add_func ("/ModemManager/port-probe/at-qcdm/qcdm", test_qcdm_port);
+    g_test_add_func ("/ModemManager/port-probe/at-qcdm/not-allowed", test_at_port_not_allowed);
+
+    return g_test_run ();
+}
@@ -31,6 +31,8 @@
 
 #include "mm-port-serial-qcdm.h"
 #include "libqcdm/src/commands.h"
+#include "libqcdm/src/dm-commands.h"
+#include "libqcdm/src/log-items.h"
 #include "libqcdm/src/utils.h"
 #include "libqcdm/src/com.h"
 #include "libqcdm/src/errors.h"
@@ -201,7 +203,7 @@ qcdm_request_verinfo (MMPortSerialQcdm *port,
         g_byte_array_free (verinfo, TRUE);
     verinfo->len = len;
 
-    mm_port_serial_qcdm_command (port, verinfo, 3, NULL, cb, loop);
+    mm_port_serial_qcdm_command (port, verinfo, 3000, NULL, cb, loop);
     g_byte_array_unref (verinfo);
 }
 
@@ -400,6 +402,266 @@ test_leading_frame_markers (TestData *d)
     g_assert (wait_for_child (d, 3));
 }
 
+static guint n_logs_received;
+
+static void
+qcdm_log_received_cb (MMPortSerialQcdm *port,
+                      guint16 log_code,
+                      guint64 timestamp,
+                      const guint8 *data,
+                      gsize data_len,
+                      gpointer user_data)
+{
+    g_assert_cmpuint (log_code, ==, DM_LOG_ITEM_EVDO_POWER);
+    g_assert_cmpuint (timestamp, ==, 0x0102030405060708ULL);
+    g_assert_cmpuint (data_len, ==, 4);
+    g_assert_cmpint (data[0], ==, 0x7e);
+    g_assert_cmpint (data[3], ==, 0xaa);
+    n_logs_received++;
+}
+
+static void
+qcdm_verinfo_expect_log_cb (MMPortSerialQcdm *port,
+                            GAsyncResult *res,
+                            GMainLoop *loop)
+{
+    /* The log packets were received before the response, but shouldn't
+     * have been taken as the response */
+    g_assert_cmpuint (n_logs_received, ==, 2);
+    qcdm_verinfo_expect_success_cb (port, res, loop);
+}
+
+static void
+qcdm_log_test_child (int fd)
+{
+    MMPortSerialQcdm *port;
+    GMainLoop *loop;
+    gboolean success;
+    GError *error = NULL;
+
+    /* In the child */
+    g_type_init ();
+
+    loop = g_main_loop_new (NULL, FALSE);
+
+    port = mm_port_serial_qcdm_new_fd (fd);
+    g_assert (port);
+
+    mm_port_serial_qcdm_add_log_handler (port,
+                                         DM_LOG_ITEM_EVDO_POWER,
+                                         qcdm_log_received_cb,
+                                         NULL,
+                                         NULL);
+
+    success = mm_port_serial_open (MM_PORT_SERIAL (port), &error);
+    g_assert_no_error (error);
+    g_assert (success);
+
+    qcdm_request_verinfo (port, (GAsyncReadyCallback)qcdm_verinfo_expect_log_cb, loop);
+    g_main_loop_run (loop);
+    g_main_loop_unref (loop);
+
+    mm_port_serial_close (MM_PORT_SERIAL (port));
+    g_object_unref (port);
+}
+
+/* Test that unsolicited log packets received while waiting for the response
+ * to a command are given to the log handlers, and not taken as the response.
+ */
+static void
+test_log_packets (TestData *d)
+{
+    char req[512];
+    gsize req_len;
+    pid_t cpid;
+    char log[sizeof (DMCmdLog) + 4 + 2];
+    char rsp[128];
+    DMCmdLog *log_hdr = (DMCmdLog *) log;
+    gsize log_len;
+    gsize rsp_len = 0;
+    const char verinfo_rsp[] = {
+        0x00, 0x41, 0x75, 0x67, 0x20, 0x31, 0x39, 0x20, 0x32, 0x30, 0x30, 0x38,
+        0x32, 0x30, 0x3a, 0x34, 0x38, 0x3a, 0x34, 0x37, 0x4f, 0x63, 0x74, 0x20,
+        0x32, 0x39, 0x20, 0x32, 0x30, 0x30, 0x37, 0x31, 0x39, 0x3a, 0x30, 0x30,
+        0x3a, 0x30, 0x30, 0x53, 0x43, 0x4e, 0x52, 0x5a, 0x2e, 0x2e, 0x2e, 0x2a,
+        0x06, 0x04, 0xb9, 0x0b, 0x02, 0x00, 0xb2, 0x19, 0xc4, 0x7e
+    };
+
+    /* A log packet whose data needs escaping */
+    memset (log, 0, sizeof (log));
+    log_hdr->code = DIAG_CMD_LOG;
+    log_hdr->len = GUINT16_TO_LE (sizeof (DMCmdLog) - 4 + 4);
+    log_hdr->_unknown2 = log_hdr->len;
+    log_hdr->log_code = GUINT16_TO_LE (DM_LOG_ITEM_EVDO_POWER);
+    log_hdr->timestamp = GUINT64_TO_LE (0x0102030405060708ULL);
+    log_hdr->data[0] = 0x7e;
+    log_hdr->data[1] = 0x7d;
+    log_hdr->data[3] = 0xaa;
+
+    /* Two log packets, the second one preceded by a frame marker */
+    log_len = dm_encapsulate_buffer (log, sizeof (DMCmdLog) + 4, sizeof (log), rsp, sizeof (rsp));
+    g_assert (log_len > 0);
+    rsp_len = log_len;
+    rsp[rsp_len++] = 0x7e;
+    memcpy (&rsp[rsp_len], rsp, log_len);
+    rsp_len += log_len;
+
+    signal (SIGCHLD, SIG_DFL);
+    cpid = fork ();
+    g_assert (cpid >= 0);
+
+    if (cpid == 0) {
+        /* In the child */
+        qcdm_log_test_child (d->slave);
+        exit (0);
+    }
+    /* Parent */
+    d->child = cpid;
+
+    req_len = server_wait_request (d->master, req, sizeof (req));
+    g_assert (req_len == 1);
+    g_assert_cmpint (req[0], ==, 0x00);
+
+    server_send_response (d->master, rsp, rsp_len);
+    server_send_response (d->master, verinfo_rsp, sizeof (verinfo_rsp));
+
+    /* We expect the child to exit normally */
+    g_assert (wait_for_child (d, 3));
+}
+
+typedef struct {
+    GMainLoop *loop;
+    gboolean reopened;
+} ReopenTestContext;
+
+static gboolean
+qcdm_close_port_cb (MMPortSerialQcdm *port)
+{
+    /* Close while in the middle of a response frame */
+    mm_port_serial_close (MM_PORT_SERIAL (port));
+    return G_SOURCE_REMOVE;
+}
+
+static void
+qcdm_verinfo_expect_closed_cb (MMPortSerialQcdm *port,
+                               GAsyncResult *res,
+                               ReopenTestContext *ctx)
+{
+    GError *error = NULL;
+    GByteArray *response;
+    gboolean success;
+
+    response = mm_port_serial_qcdm_command_finish (port, res, &error);
+    g_assert (error != NULL);
+    g_error_free (error);
+    g_assert (response == NULL);
+
+    /* The next response is received from scratch */
+    success = mm_port_serial_open (MM_PORT_SERIAL (port), &error);
+    g_assert_no_error (error);
+    g_assert (success);
+    ctx->reopened = TRUE;
+
+    qcdm_request_verinfo (port, (GAsyncReadyCallback)qcdm_verinfo_expect_success_cb, ctx->loop);
+}
+
+static void
+qcdm_reopen_test_child (const gchar *device)
+{
+    MMPortSerialQcdm *port;
+    ReopenTestContext ctx;
+    GByteArray *verinfo;
+    gboolean success;
+    GError *error = NULL;
+    gint len;
+
+    /* In the child */
+    g_type_init ();
+
+    ctx.loop = g_main_loop_new (NULL, FALSE);
+    ctx.reopened = FALSE;
+
+    /* Opened by name, so that it can be reopened */
+    port = MM_PORT_SERIAL_QCDM (g_object_new (MM_TYPE_PORT_SERIAL_QCDM,
+                                              MM_PORT_DEVICE, device,
+                                              MM_PORT_SUBSYS, MM_PORT_SUBSYS_TTY,
+                                              MM_PORT_TYPE, MM_PORT_TYPE_QCDM,
+                                              MM_PORT_SERIAL_SEND_DELAY, (guint64) 0,
+                                              NULL));
+
+    success = mm_port_serial_open (MM_PORT_SERIAL (port), &error);
+    g_assert_no_error (error);
+    g_assert (success);
+
+    verinfo = g_byte_array_sized_new (50);
+    len = qcdm_cmd_version_info_new ((char *) verinfo->data, 50);
+    g_assert_cmpint (len, >, 0);
+    verinfo->len = len;
+    mm_port_serial_qcdm_command (port, verinfo, 3000, NULL,
+                                 (GAsyncReadyCallback)qcdm_verinfo_expect_closed_cb,
+                                 &ctx);
+    g_byte_array_unref (verinfo);
+
+    g_timeout_add (500, (GSourceFunc)qcdm_close_port_cb, port);
+    g_main_loop_run (ctx.loop);
+    g_main_loop_unref (ctx.loop);
+    g_assert (ctx.reopened);
+
+    mm_port_serial_close (MM_PORT_SERIAL (port));
+    g_object_unref (port);
+}
+
+/* Test that a partial frame received before the port is closed is discarded,
+ * and doesn't corrupt the first frame received once reopened.
+ */
+static void
+test_reopen_partial_frame (TestData *d)
+{
+    char req[512];
+    gsize req_len;
+    pid_t cpid;
+    const char *device;
+    const char rsp[] = {
+        0x00, 0x41, 0x75, 0x67, 0x20, 0x31, 0x39, 0x20, 0x32, 0x30, 0x30, 0x38,
+        0x32, 0x30, 0x3a, 0x34, 0x38, 0x3a, 0x34, 0x37, 0x4f, 0x63, 0x74, 0x20,
+        0x32, 0x39, 0x20, 0x32, 0x30, 0x30, 0x37, 0x31, 0x39, 0x3a, 0x30, 0x30,
+        0x3a, 0x30, 0x30, 0x53, 0x43, 0x4e, 0x52, 0x5a, 0x2e, 0x2e, 0x2e, 0x2a,
+        0x06, 0x04, 0xb9, 0x0b, 0x02, 0x00, 0xb2, 0x19, 0xc4, 0x7e
+    };
+
+    device = ttyname (d->slave);
+    g_assert (device != NULL);
+    g_assert (g_str_has_prefix (device, "/dev/"));
+    device += strlen ("/dev/");
+
+    signal (SIGCHLD, SIG_DFL);
+    cpid = fork ();
+    g_assert (cpid >= 0);
+
+    if (cpid == 0) {
+        /* In the child */
+        qcdm_reopen_test_child (device);
+        exit (0);
+    }
+    /* Parent */
+    d->child = cpid;
+
+    /* Just the first half of the response, without the frame end */
+    req_len = server_wait_request (d->master, req, sizeof (req));
+    g_assert (req_len == 1);
+    g_assert_cmpint (req[0], ==, 0x00);
+    server_send_response (d->master, rsp, sizeof (rsp) / 2);
+
+    /* Full response once reopened */
+    req_len = server_wait_request (d->master, req, sizeof (req));
+    g_assert (req_len == 1);
+    g_assert_cmpint (req[0], ==, 0x00);
+    server_send_response (d->master, rsp, sizeof (rsp));
+
+    /* We expect the child to exit normally */
+    g_assert (wait_for_child (d, 3));
+}
+
 static void
 test_pty_create (TestData *d)
 {
@@ -440,6 +702,8 @@ test_pty_cleanup (TestData *d)
     }
 }
 
+MM_LOG_DEFINE_LEVELS (LOGL_ALL);
+
 void
 _mm_log (const char *loc,
          const char *func,
@@ -471,6 +735,8 @@ int main (int argc, char **argv)
     TESTCASE_PTY ("/MM/QCDM/Sierra-Cns-Rejected", test_sierra_cns_rejected);
     TESTCASE_PTY ("/MM/QCDM/Random-Data-Rejected", test_random_data_rejected);
     TESTCASE_PTY ("/MM/QCDM/Leading-Frame-Markers", test_leading_frame_markers);
+    TESTCASE_PTY ("/MM/QCDM/Log-Packets", test_log_packets);
+    TESTCASE_PTY ("/MM/QCDM/Reopen-Partial-Frame", test_reopen_partial_frame);
 
     return g_test_run ();
 }
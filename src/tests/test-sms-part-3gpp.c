@@ -454,6 +454,54 @@ test_pdu_not_stored (void)
         NULL, 0);
 }
 
+#define PDU_PARSER_BENCHMARK_ITERATIONS 20000
+
+static void
+test_pdu_parser_benchmark (void)
+{
+    /* Same PDUs as in the tests above */
+    static const gchar *hexpdus[] = {
+        "07911356131313F64004850120390011609232239180A006080400100201D7327BFD6EB340E232"
+        "1BF46E83EA7790F59D1E97DBE1341B442F83C465763D3DA797E56537C81D0ECB41AB59CC1693C1"
+        "6031D96C064241E5656838AF03A96230982A269BCD462917C8FA4E8FCBED709A0D7ABBE9F6B0FB"
+        "5C7683D27350984D4FABC9A0B33C4C4FCF5D20EBFB2D079DCB62793DBD06D9C36E50FB2D4E97D9"
+        "A0B49B5E96BBCB",
+        "07912160130320F5440B916171056429F5000021405291650569A00500034C0201A9E8F41C949E"
+        "83C2207B599E07B1DFEE33885E9ED341E4F23C7D7697C920FA1B54C697E5E3F4BC0C6AD7D9F434"
+        "081E96D341E3303C2C4EB3D3F4BC0B94A483E6E8779D4D06CDD1EF3BA80E0785E7A0B7BB0C6A97"
+        "E7F3F0B9CC02B9DF7450780EA2DFDF2C50780EA2A3CBA0BA9B5C96B3F369F71954768FDFE4B4FB"
+        "0C9297E1F2F2BCECA6CF41",
+        "07912160130320F6440B916171056429F5000021405291651569320500034C0202E9E8301D4447"
+        "9741F0B09C3E0785E56590BCCC0ED3CB6410FD0D7ABBCBA0B0FB4D4797E52E10",
+        "002100098136397339F70008224F60597D4F60597D4F60597D4F60597D4F60597D4F60597D4F60597D4F60597D4F60",
+        "07914356060013F1065A098136397339F7219011700463802190117004638030",
+    };
+    gsize total = 0;
+    gdouble elapsed;
+    guint n;
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (hexpdus); i++)
+        total += strlen (hexpdus[i]);
+
+    g_test_timer_start ();
+    for (n = 0; n < PDU_PARSER_BENCHMARK_ITERATIONS; n++) {
+        for (i = 0; i < G_N_ELEMENTS (hexpdus); i++) {
+            MMSmsPart *part;
+
+            part = mm_sms_part_3gpp_new_from_pdu (0, hexpdus[i], NULL);
+            g_assert (part != NULL);
+            mm_sms_part_free (part);
+        }
+    }
+    elapsed = g_test_timer_elapsed ();
+
+    g_test_minimized_result (elapsed,
+                             "%.0f PDUs/s, %.1f MB/s of hex PDU",
+                             (PDU_PARSER_BENCHMARK_ITERATIONS * G_N_ELEMENTS (hexpdus)) / elapsed,
+                             ((total * PDU_PARSER_BENCHMARK_ITERATIONS) / elapsed) / 1e6);
+}
+
 /********************* SMS ADDRESS ENCODER TESTS *********************/
 
 static void
@@ -841,6 +889,8 @@ test_text_split_two_pdu_ucs2 (void)
 
 /************************************************************/
 
+MM_LOG_DEFINE_LEVELS (LOGL_ALL);
+
 void
 _mm_log (const char *loc,
          const char *func,
@@ -882,6 +932,8 @@ int main (int argc, char **argv)
     g_test_add_func ("/MM/SMS/3GPP/PDU-Parser/pdu-multipart", test_pdu_multipart);
     g_test_add_func ("/MM/SMS/3GPP/PDU-Parser/pdu-stored-by-us", test_pdu_stored_by_us);
     g_test_add_func ("/MM/SMS/3GPP/PDU-Parser/pdu-not-stored", test_pdu_not_stored);
+    if (g_test_perf ())
+        g_test_add_func ("/MM/SMS/3GPP/PDU-Parser/benchmark", test_pdu_parser_benchmark);
 
     g_test_add_func ("/MM/SMS/3GPP/Address-Encoder/smsc-intl", test_address_encode_smsc_intl);
     g_test_add_func ("/MM/SMS/3GPP/Address-Encoder/smsc-unknown", test_address_encode_smsc_unknown);
@@ -505,6 +505,8 @@ test_create_pdu_text_unicode_encoding (void)
 
 /************************************************************/
 
+MM_LOG_DEFINE_LEVELS (LOGL_ALL);
+
 void
 _mm_log (const char *loc,
          const char *func,
@@ -83,6 +83,8 @@ signals_handler (int signum)
     }
 }
 
+MM_LOG_DEFINE_LEVELS (LOGL_ALL);
+
 void
 _mm_log (const char *loc,
          const char *func,